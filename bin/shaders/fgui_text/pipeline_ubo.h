@@ -15,11 +15,14 @@ using uint4 = struct { uint32_t x,y,z,w; };
 
 // nested struct type
 struct args_31_32 {
-    float4x4         transform;
+    float4           axes;
+    float2           translation;
     uint32_t         colorPacked;
     uint32_t         packedProps;
     uint32_t         outlineColorPacked;
     uint32_t         packedParamSDF;
+    uint32_t         textureSlot;
+    uint32_t         padding;
 };
 
 // nested struct type
@@ -34,9 +37,9 @@ struct global_UBO {
 };
 static_assert(sizeof(global_UBO) == 128, "size mismatch");
 
-// "args"  set=0 bind=0  size=40960
+// "args"  set=0 bind=0  size=24576
 struct args_UBO {
     args_31          imageDatas;
 };
-static_assert(sizeof(args_UBO) == 40960, "size mismatch");
+static_assert(sizeof(args_UBO) == 24576, "size mismatch");
 
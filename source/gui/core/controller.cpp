@@ -9,7 +9,7 @@ namespace gui {
 
     // ============= ControllerAction =============
 
-    void ControllerAction::run(Controller* ctl, std::string const& prevPage, std::string const& curPage) {
+    void ControllerAction::run(Controller* ctl, name_t prevPage, name_t curPage) {
         bool fromOk = std::find(fromPages.begin(), fromPages.end(), prevPage) != fromPages.end();
         bool toOk = std::find(toPages.begin(), toPages.end(), curPage) != toPages.end();
         if (fromOk && toOk) {
@@ -23,12 +23,12 @@ namespace gui {
         int cnt = buffer.read<int16_t>();
         fromPages.resize(cnt);
         for (int i = 0; i < cnt; ++i) {
-            fromPages[i] = buffer.read<csref>();
+            fromPages[i] = buffer.readName();
         }
         cnt = buffer.read<int16_t>();
         toPages.resize(cnt);
         for (int i = 0; i < cnt; ++i) {
-            toPages[i] = buffer.read<csref>();
+            toPages[i] = buffer.readName();
         }
     }
 
@@ -44,9 +44,9 @@ namespace gui {
 
     void ChangePageAction::setup(ByteBuffer& buffer) {
         ControllerAction::setup(buffer);
-        objectId       = buffer.read<csref>();
-        controllerName = buffer.read<csref>();
-        targetPage     = buffer.read<csref>();
+        objectId       = buffer.readName();
+        controllerName = buffer.readName();
+        targetPage     = buffer.readName();
     }
 
     void ChangePageAction::enter(Controller* ctl) {
@@ -114,6 +114,10 @@ namespace gui {
     }
 
     void Controller::setSelectedPage(std::string const& name) {
+        setSelectedPage(GetNamePool().find(name));
+    }
+
+    void Controller::setSelectedPage(name_t name) {
         auto it = std::find(pageNames_.begin(), pageNames_.end(), name);
         if (it != pageNames_.end())
             setSelectedIndex((int)(it - pageNames_.begin()));
@@ -122,18 +126,26 @@ namespace gui {
     }
 
     std::string const& Controller::selectedPageId() const {
+        return NameString(selectedPageAtom());
+    }
+
+    name_t Controller::selectedPageAtom() const {
         if (selectedIndex_ < 0 || selectedIndex_ >= (int)pageIDs_.size())
-            return ByteBuffer::EmptyString;
+            return EmptyName;
         return pageIDs_[selectedIndex_];
     }
 
     std::string Controller::selectedPage() const {
         if (selectedIndex_ < 0 || selectedIndex_ >= (int)pageNames_.size())
             return "";
-        return pageNames_[selectedIndex_];
+        return NameString(pageNames_[selectedIndex_]);
     }
 
     bool Controller::hasPage(std::string const& name) const {
+        return hasPage(GetNamePool().find(name));
+    }
+
+    bool Controller::hasPage(name_t name) const {
         return std::find(pageNames_.begin(), pageNames_.end(), name) != pageNames_.end();
     }
 
@@ -141,8 +153,8 @@ namespace gui {
         if (prevIndex_ < 0 || selectedIndex_ < 0) {
             return;
         } 
-        std::string prev = (prevIndex_ < (int)pageIDs_.size()) ? pageIDs_[prevIndex_] : "";
-        std::string cur  = (selectedIndex_ < (int)pageIDs_.size()) ? pageIDs_[selectedIndex_] : "";
+        name_t prev = (prevIndex_ < (int)pageIDs_.size()) ? pageIDs_[prevIndex_] : EmptyName;
+        name_t cur  = (selectedIndex_ < (int)pageIDs_.size()) ? pageIDs_[selectedIndex_] : EmptyName;
         for (auto* action : actions_) {
             action->run(this, prev, cur);
         }
@@ -153,7 +165,7 @@ namespace gui {
         int beginPos = buffer.pos();
 
         buffer.seekToBlock(beginPos, CtlBlock::Props);
-        name_                  = buffer.read<csref>();
+        name_                  = buffer.readName();
         autoRadioGroupDepth_   = buffer.read<bool>();
 
         buffer.seekToBlock(beginPos, CtlBlock::Pages);
@@ -161,8 +173,8 @@ namespace gui {
         pageIDs_.reserve(cnt);
         pageNames_.reserve(cnt);
         for (int i = 0; i < cnt; ++i) {
-            pageIDs_.push_back(buffer.read<csref>());
-            pageNames_.push_back(buffer.read<csref>());
+            pageIDs_.push_back(buffer.readName());
+            pageNames_.push_back(buffer.readName());
         }
 
         int homePageIndex = 0;
@@ -174,7 +186,7 @@ namespace gui {
                 break;
             case 2:
             case 3: {
-                auto varName = buffer.read<csref>();
+                auto varName = buffer.readName();
                 auto it = std::find(pageNames_.begin(), pageNames_.end(), varName);
                 if (it != pageNames_.end())
                     homePageIndex = (int)(it - pageNames_.begin());
@@ -3,6 +3,7 @@
 #include "core/declare.h"
 #include "core/events/event_dispatcher.h"
 #include "utils/byte_buffer.h"
+#include "utils/name_pool.h"
 
 namespace gui {
 
@@ -13,12 +14,12 @@ namespace gui {
 
     class ControllerAction {
     public:
-        std::vector<std::string> fromPages;
-        std::vector<std::string> toPages;
+        std::vector<name_t> fromPages;
+        std::vector<name_t> toPages;
 
         virtual ~ControllerAction() = default;
 
-        void run(Controller* ctl, std::string const& prevPage, std::string const& curPage);
+        void run(Controller* ctl, name_t prevPage, name_t curPage);
         virtual void enter(Controller* ctl) {}
         virtual void leave(Controller* ctl) {}
 
@@ -29,9 +30,9 @@ namespace gui {
 
     class ChangePageAction : public ControllerAction {
     public:
-        std::string objectId;
-        std::string controllerName;
-        std::string targetPage;
+        name_t      objectId = EmptyName;
+        name_t      controllerName = EmptyName;
+        name_t      targetPage = EmptyName;
         void setup(ByteBuffer& buffer) override;
         void enter(Controller* ctl) override;
         void leave(Controller* ctl) override;
@@ -53,14 +54,14 @@ namespace gui {
         friend class GButton;
         friend class Object;
     private:
-        std::string                  name_;
+        name_t                       name_ = EmptyName;
         Component*                   parent_ = nullptr;
         bool                         autoRadioGroupDepth_ = false;
         bool                         changing_ = false;
         int                          selectedIndex_ = -1;
         int                          prevIndex_ = -1;
-        std::vector<std::string>     pageIDs_;
-        std::vector<std::string>     pageNames_;
+        std::vector<name_t>          pageIDs_;
+        std::vector<name_t>          pageNames_;
         std::vector<ControllerAction*> actions_;
 
         static uint32_t nextPageID_;
@@ -72,20 +73,25 @@ namespace gui {
         void setup(ByteBuffer& buffer);
         void runActions();
 
-        std::string const& name() const { return name_; }
+        std::string const& name() const { return NameString(name_); }
+        name_t nameAtom() const { return name_; }
         Component* parent() const { return parent_; }
         int selectedIndex() const { return selectedIndex_; }
         int previousIndex() const { return prevIndex_; }
 
         void setSelectedIndex(int index);
         void setSelectedPage(std::string const& name);
+        void setSelectedPage(name_t name);
 
         std::string const& selectedPageId() const;
+        /// gear 表和页面比较都用这个，没有选中时是 EmptyName
+        name_t selectedPageAtom() const;
         std::string selectedPage() const;
 
         int pageCount() const { return (int)pageIDs_.size(); }
-        std::string const& pageName(int index) const { return pageNames_[index]; }
+        std::string const& pageName(int index) const { return NameString(pageNames_[index]); }
         bool hasPage(std::string const& name) const;
+        bool hasPage(name_t name) const;
 
         void dispose() { clearEventListeners(); }
     };
@@ -0,0 +1,80 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cmath>
+
+namespace gui {
+
+    /*
+     *  2D 仿射变换 (3x2)，列主序，和 glm 一样右乘点
+     *  | a  c  tx |
+     *  | b  d  ty |
+     *  UI 里只有平面变换，代替 glm::mat4：复合 12 次乘法，存储 24 字节
+     *  内存布局 (a, b, c, d, tx, ty) 和 shader 里的 float4 + float2 一致
+     * */
+    struct affine2d {
+        float a = 1.0f, b = 0.0f;       // x 轴
+        float c = 0.0f, d = 1.0f;       // y 轴
+        float tx = 0.0f, ty = 0.0f;     // 平移
+
+        static affine2d translation(float x, float y) {
+            return { 1.0f, 0.0f, 0.0f, 1.0f, x, y };
+        }
+
+        static affine2d scaling(float sx, float sy) {
+            return { sx, 0.0f, 0.0f, sy, 0.0f, 0.0f };
+        }
+
+        static affine2d rotation(float radians) {
+            float const cs = std::cos(radians);
+            float const sn = std::sin(radians);
+            return { cs, sn, -sn, cs, 0.0f, 0.0f };
+        }
+
+        // 和原来 glm 的 shearMat[1][0] = x, shearMat[0][1] = y 一致
+        static affine2d shear(float x, float y) {
+            return { 1.0f, y, x, 1.0f, 0.0f, 0.0f };
+        }
+
+        affine2d operator*(affine2d const& o) const {
+            return {
+                a * o.a + c * o.b,
+                b * o.a + d * o.b,
+                a * o.c + c * o.d,
+                b * o.c + d * o.d,
+                a * o.tx + c * o.ty + tx,
+                b * o.tx + d * o.ty + ty,
+            };
+        }
+
+        glm::vec2 transformPoint(glm::vec2 const& p) const {
+            return { a * p.x + c * p.y + tx, b * p.x + d * p.y + ty };
+        }
+
+        // 退化（det 为 0）时返回单位矩阵
+        affine2d inverse() const {
+            float const det = a * d - b * c;
+            if (det == 0.0f) {
+                return {};
+            }
+            float const inv = 1.0f / det;
+            return {
+                d * inv,
+                -b * inv,
+                -c * inv,
+                a * inv,
+                (c * ty - d * tx) * inv,
+                (b * tx - a * ty) * inv,
+            };
+        }
+
+        // 给还需要 4x4 的地方用（global UBO 的 batchWorld）
+        glm::mat4 toMat4() const {
+            glm::mat4 mat(1.0f);
+            mat[0][0] = a;  mat[0][1] = b;
+            mat[1][0] = c;  mat[1][1] = d;
+            mat[3][0] = tx; mat[3][1] = ty;
+            return mat;
+        }
+    };
+
+}
@@ -33,23 +33,23 @@ namespace gui {
         while(true) {
             GearDisplay* display = dynamic_cast<GearDisplay*>(this);
             if(display) {
-                buffer.readRefStringArray(display->pages, pageCount);
+                buffer.readNameArray(display->pages, pageCount);
                 break;
             }
             GearDisplay2* display2 = dynamic_cast<GearDisplay2*>(this);
             if(display2) {
-                buffer.readRefStringArray(display2->pages, pageCount);
+                buffer.readNameArray(display2->pages, pageCount);
                 break;
             }
             // 普通
             for (int i = 0; i < pageCount; ++i) {
-                std::string page = buffer.read<csref>();
-                if (!page.empty()) {
+                name_t page = buffer.readName();
+                if (page != EmptyName) {
                     addStatus(page, buffer);
                 };
             }
             if (buffer.read<bool>()) {
-                addStatus("", buffer);
+                addStatus(EmptyName, buffer);
             }
             break;
         }
@@ -74,7 +74,7 @@ namespace gui {
         int cnt = buffer.read<int16_t>();
         pages.resize(cnt);
         for (int i = 0; i < cnt; ++i)
-            pages[i] = buffer.read<csref>();
+            pages[i] = buffer.readName();
         setupTween(buffer);
     }
 
@@ -84,7 +84,7 @@ namespace gui {
             _displayLockToken = 1;
 
         if (pages.empty()
-            || std::find(pages.begin(), pages.end(), _controller->selectedPageId()) != pages.end())
+            || std::find(pages.begin(), pages.end(), _controller->selectedPageAtom()) != pages.end())
             _visible = 1;
         else
             _visible = 0;
@@ -119,13 +119,13 @@ namespace gui {
         int cnt = buffer.read<int16_t>();
         pages.resize(cnt);
         for (int i = 0; i < cnt; ++i)
-            pages[i] = buffer.read<csref>();
+            pages[i] = buffer.readName();
         setupTween(buffer);
     }
 
     void GearDisplay2::apply() {
         if (pages.empty()
-            || std::find(pages.begin(), pages.end(), _controller->selectedPageId()) != pages.end())
+            || std::find(pages.begin(), pages.end(), _controller->selectedPageAtom()) != pages.end())
             _visible = 1;
         else
             _visible = 0;
@@ -141,8 +141,8 @@ namespace gui {
     }
 
     // ============= GearXY =============
-    void GearXY::addStatus(std::string const& page, ByteBuffer& buffer) {
-        auto& v = page.empty() ? _default : _storage[page];
+    void GearXY::addStatus(name_t page, ByteBuffer& buffer) {
+        auto& v = page == EmptyName ? _default : _storage[page];
         v.x  = (float)buffer.read<int>();
         v.y  = (float)buffer.read<int>();
     }
@@ -164,7 +164,7 @@ namespace gui {
         if (buffer.version >= 2 && buffer.read<bool>()) {
             _positionsInPercent = true;
             for (size_t i = 0; i < _storage.size(); ++i) {
-                auto pg = buffer.read<csref>();
+                auto pg = buffer.readName();
                 auto& v = _storage[pg];
                 v.px = buffer.read<float>();
                 v.py = buffer.read<float>();
@@ -177,14 +177,14 @@ namespace gui {
 
     void GearXY::apply() {
         if (!_controller) return;
-        auto it = _storage.find(_controller->selectedPageId());
+        auto it = _storage.find(_controller->selectedPageAtom());
         auto& v = (it != _storage.end()) ? it->second : _default;
         _owner->setPosition({v.x, v.y, 0});
     }
 
     void GearXY::updateState() {
         if (!_controller) return;
-        auto& v = _storage[_controller->selectedPageId()];
+        auto& v = _storage[_controller->selectedPageAtom()];
         v.x = _owner->x();
         v.y = _owner->y();
     }
@@ -199,8 +199,8 @@ namespace gui {
         }
     }
 
-    void GearSize::addStatus(std::string const& page, ByteBuffer& buffer) {
-        auto& v = page.empty() ? _default : _storage[page];
+    void GearSize::addStatus(name_t page, ByteBuffer& buffer) {
+        auto& v = page == EmptyName ? _default : _storage[page];
         v.w = (float)buffer.read<int>();
         v.h = (float)buffer.read<int>();
         v.scaleX = buffer.read<float>();
@@ -209,7 +209,7 @@ namespace gui {
 
     void GearSize::apply() {
         if (!_controller) return;
-        auto it = _storage.find(_controller->selectedPageId());
+        auto it = _storage.find(_controller->selectedPageAtom());
         auto& v = (it != _storage.end()) ? it->second : _default;
         _owner->setSize({v.w, v.h});
         _owner->setScale(v.scaleX, v.scaleY);
@@ -217,7 +217,7 @@ namespace gui {
 
     void GearSize::updateState() {
         if (!_controller) return;
-        auto& v = _storage[_controller->selectedPageId()];
+        auto& v = _storage[_controller->selectedPageAtom()];
         v.w = _owner->width();
         v.h = _owner->height();
         v.scaleX = _owner->scaleX();
@@ -239,15 +239,15 @@ namespace gui {
         }
     }
 
-    void GearColor::addStatus(std::string const& page, ByteBuffer& buffer) {
-        auto& v = page.empty() ? _default : _storage[page];
+    void GearColor::addStatus(name_t page, ByteBuffer& buffer) {
+        auto& v = page == EmptyName ? _default : _storage[page];
         v.color       = buffer.read<Color4B>();
         v.strokeColor = buffer.read<Color4B>();
     }
 
     void GearColor::apply() {
         if (!_controller) return;
-        auto it = _storage.find(_controller->selectedPageId());
+        auto it = _storage.find(_controller->selectedPageAtom());
         auto& gv = (it != _storage.end()) ? it->second : _default;
 
         if (_tweenConfig && _tweenConfig->tween && Package::constructing_ == 0 && !disableAllTweenEffect) {
@@ -305,7 +305,7 @@ namespace gui {
             _owner->releaseDisplayLock(_tweenConfig->displayLockToken);
             _tweenConfig->displayLockToken = 0;
         }
-        _owner->dispatchEvent("onGearStop", this);
+        _owner->dispatchEvent(EventTypes::GearStop, this);
     }
 
     // ============= GearLook =============
@@ -318,8 +318,8 @@ namespace gui {
         }
     }
 
-    void GearLook::addStatus(std::string const& page, ByteBuffer& buffer) {
-        auto& v = page.empty() ? _default : _storage[page];
+    void GearLook::addStatus(name_t page, ByteBuffer& buffer) {
+        auto& v = page == EmptyName ? _default : _storage[page];
         v.alpha    = buffer.read<float>();
         v.rotation = buffer.read<float>();
         v.grayed   = buffer.read<bool>();
@@ -328,7 +328,7 @@ namespace gui {
 
     void GearLook::apply() {
         if (!_controller) return;
-        auto it = _storage.find(_controller->selectedPageId());
+        auto it = _storage.find(_controller->selectedPageAtom());
         auto& v = (it != _storage.end()) ? it->second : _default;
         _owner->setAlpha(v.alpha);
         _owner->setRotation(v.rotation);
@@ -344,14 +344,14 @@ namespace gui {
         }
     }
 
-    void GearText::addStatus(std::string const& page, ByteBuffer& buffer) {
-        auto& v = page.empty() ? _default : _storage[page];
+    void GearText::addStatus(name_t page, ByteBuffer& buffer) {
+        auto& v = page == EmptyName ? _default : _storage[page];
         v = buffer.read<csref>();
     }
 
     void GearText::apply() {
         if (!_controller) return;
-        auto it = _storage.find(_controller->selectedPageId());
+        auto it = _storage.find(_controller->selectedPageAtom());
         auto& v = (it != _storage.end()) ? it->second : _default;
         if (auto* txt = dynamic_cast<GTextField*>(_owner)) txt->setText(v);
     }
@@ -364,14 +364,14 @@ namespace gui {
         }
     }
 
-    void GearIcon::addStatus(std::string const& page, ByteBuffer& buffer) {
-        auto& v = page.empty() ? _default : _storage[page];
+    void GearIcon::addStatus(name_t page, ByteBuffer& buffer) {
+        auto& v = page == EmptyName ? _default : _storage[page];
         v = buffer.read<csref>();
     }
 
     void GearIcon::apply() {
         if (!_controller) return;
-        auto it = _storage.find(_controller->selectedPageId());
+        auto it = _storage.find(_controller->selectedPageAtom());
         auto& v = (it != _storage.end()) ? it->second : _default;
         if (auto* img = dynamic_cast<Image*>(_owner)) img->setIcon(v);
     }
@@ -385,14 +385,14 @@ namespace gui {
         }
     }
 
-    void GearFontSize::addStatus(std::string const& page, ByteBuffer& buffer) {
-        auto& v = page.empty() ? _default : _storage[page];
+    void GearFontSize::addStatus(name_t page, ByteBuffer& buffer) {
+        auto& v = page == EmptyName ? _default : _storage[page];
         v = (float)buffer.read<int>();
     }
 
     void GearFontSize::apply() {
         if (!_controller) return;
-        auto it = _storage.find(_controller->selectedPageId());
+        auto it = _storage.find(_controller->selectedPageAtom());
         float v = (it != _storage.end()) ? it->second : _default;
         if (auto* txt = dynamic_cast<GTextField*>(_owner)) txt->setFontSize(v);
     }
@@ -7,6 +7,7 @@
 #include <core/data_types/tweener.h>
 #include <core/ui/IColorGear.h>
 #include "utils/byte_buffer.h"
+#include "utils/name_pool.h"
 
 namespace gui {
 
@@ -62,7 +63,7 @@ namespace gui {
         virtual void apply() = 0;
         virtual void updateState() {}
     protected:
-        virtual void addStatus(std::string const& page, ByteBuffer& buffer) = 0;
+        virtual void addStatus(name_t page, ByteBuffer& buffer) = 0;
         virtual void init() = 0;
         void setupTween(ByteBuffer& buffer);
     };
@@ -70,7 +71,7 @@ namespace gui {
     // ============= GearDisplay =============
     class GearDisplay : public GearBase {
     public:
-        std::vector<std::string> pages;
+        std::vector<name_t> pages;
         GearDisplay(Object* owner);
         void setup(ByteBuffer& buffer) override;
         void apply() override;
@@ -79,7 +80,7 @@ namespace gui {
         void releaseLock(uint32_t token);
         bool connected() const;
     protected:
-        void addStatus(std::string const&, ByteBuffer&) override {}
+        void addStatus(name_t, ByteBuffer&) override {}
         void init() override;
     private:
         int          _visible = 0;
@@ -89,7 +90,7 @@ namespace gui {
     // ============= GearXY =============
     class GearXY : public GearBase {
         struct Value { float x, y, px, py; };
-        std::unordered_map<std::string, Value> _storage;
+        std::unordered_map<name_t, Value> _storage;
         Value _default = {};
         bool _positionsInPercent = false;
     public:
@@ -98,7 +99,7 @@ namespace gui {
         void apply() override;
         void updateState() override;
     protected:
-        void addStatus(std::string const& page, ByteBuffer& buffer) override;
+        void addStatus(name_t page, ByteBuffer& buffer) override;
         void init() override;
     };
 
@@ -110,20 +111,20 @@ namespace gui {
     };
 
     class GearSize : public GearBase {
-        std::unordered_map<std::string, GearSizeValue> _storage;
+        std::unordered_map<name_t, GearSizeValue> _storage;
         GearSizeValue _default;
     public:
         GearSize(Object* owner) : GearBase(owner) {}
         void apply() override;
         void updateState() override;
     protected:
-        void addStatus(std::string const& page, ByteBuffer& buffer) override;
+        void addStatus(name_t page, ByteBuffer& buffer) override;
         void init() override;
     };
 
     // ============= GearColor =============
     class GearColor : public GearBase, public ITweenListener {
-        std::unordered_map<std::string, GearColorValue> _storage;
+        std::unordered_map<name_t, GearColorValue> _storage;
         GearColorValue _default = {};
         IColorGear*          _colorGear = nullptr;         // init() 中缓存，避免 dynamic_cast
         IOutlineColorGear*   _outlineColorGear = nullptr;
@@ -137,7 +138,7 @@ namespace gui {
         {}
         void apply() override;
     protected:
-        void addStatus(std::string const& page, ByteBuffer& buffer) override;
+        void addStatus(name_t page, ByteBuffer& buffer) override;
         void init() override;
         void onTweenStart(Tweener* tweener) override;
         void onTweenUpdate(Tweener* tweener) override;
@@ -153,37 +154,37 @@ namespace gui {
     };
 
     class GearLook : public GearBase {
-        std::unordered_map<std::string, GearLookValue> _storage;
+        std::unordered_map<name_t, GearLookValue> _storage;
         GearLookValue _default;
     public:
         GearLook(Object* owner) : GearBase(owner) {}
         void apply() override;
     protected:
-        void addStatus(std::string const& page, ByteBuffer& buffer) override;
+        void addStatus(name_t page, ByteBuffer& buffer) override;
         void init() override;
     };
 
     // ============= GearText =============
     class GearText : public GearBase {
-        std::unordered_map<std::string, std::string> _storage;
+        std::unordered_map<name_t, std::string> _storage;
         std::string _default;
     public:
         GearText(Object* owner) : GearBase(owner) {}
         void apply() override;
     protected:
-        void addStatus(std::string const& page, ByteBuffer& buffer) override;
+        void addStatus(name_t page, ByteBuffer& buffer) override;
         void init() override;
     };
 
     // ============= GearIcon =============
     class GearIcon : public GearBase {
-        std::unordered_map<std::string, std::string> _storage;
+        std::unordered_map<name_t, std::string> _storage;
         std::string _default;
     public:
         GearIcon(Object* owner) : GearBase(owner) {}
         void apply() override;
     protected:
-        void addStatus(std::string const& page, ByteBuffer& buffer) override;
+        void addStatus(name_t page, ByteBuffer& buffer) override;
         void init() override;
     };
 
@@ -191,7 +192,7 @@ namespace gui {
     // 编辑器的预览模式可见性，运行时行为和 GearDisplay 一样
     class GearDisplay2 : public GearBase {
     public:
-        std::vector<std::string>   pages;
+        std::vector<name_t>        pages;
         int                        condition = 0;
 
         GearDisplay2(Object* owner);
@@ -200,7 +201,7 @@ namespace gui {
 
         bool evaluate(bool connected);
     protected:
-        void addStatus(std::string const&, ByteBuffer&) override {}
+        void addStatus(name_t, ByteBuffer&) override {}
         void init() override;
     private:
         int     _visible = 0;
@@ -208,13 +209,13 @@ namespace gui {
 
     // ============= GearFontSize =============
     class GearFontSize : public GearBase {
-        std::unordered_map<std::string, float> _storage;
+        std::unordered_map<name_t, float> _storage;
         float _default = 12.0f;
     public:
         GearFontSize(Object* owner) : GearBase(owner) {}
         void apply() override;
     protected:
-        void addStatus(std::string const& page, ByteBuffer& buffer) override;
+        void addStatus(name_t page, ByteBuffer& buffer) override;
         void init() override;
     };
 
@@ -1,9 +1,106 @@
 #include "tween_manager.h"
+#include <core/ease/ease.h>
 #include <cassert>
 #include <chrono>
+#include <cstring>
+#include <type_traits>
 
 namespace gui {
 
+    uint32_t TweenManager::tween_lanes_t::push(Tweener* t) {
+        tweener.push_back(t);
+        elapsed.push_back(0);
+        delay.push_back(0);
+        duration.push_back(0);
+        timeScale.push_back(1.0f);
+        easeType.push_back(EaseType::QuadOut);
+        easeOvershoot.push_back(1.70158f);
+        easePeriod.push_back(0);
+        normalized.push_back(0);
+        state.push_back(0);
+        from.emplace_back();
+        delta.emplace_back();
+        value.emplace_back();
+        target.emplace_back();
+        propType.push_back(TweenPropType::None);
+        return (uint32_t)tweener.size() - 1;
+    }
+
+    void TweenManager::tween_lanes_t::move(size_t dst, size_t src) {
+        tweener[dst] = tweener[src];
+        elapsed[dst] = elapsed[src];
+        delay[dst] = delay[src];
+        duration[dst] = duration[src];
+        timeScale[dst] = timeScale[src];
+        easeType[dst] = easeType[src];
+        easeOvershoot[dst] = easeOvershoot[src];
+        easePeriod[dst] = easePeriod[src];
+        normalized[dst] = normalized[src];
+        state[dst] = state[src];
+        from[dst] = from[src];
+        delta[dst] = delta[src];
+        value[dst] = value[src];
+        target[dst] = target[src];
+        propType[dst] = propType[src];
+    }
+
+    void TweenManager::tween_lanes_t::resize(size_t count) {
+        tweener.resize(count);
+        elapsed.resize(count);
+        delay.resize(count);
+        duration.resize(count);
+        timeScale.resize(count);
+        easeType.resize(count);
+        easeOvershoot.resize(count);
+        easePeriod.resize(count);
+        normalized.resize(count);
+        state.resize(count);
+        from.resize(count);
+        delta.resize(count);
+        value.resize(count);
+        target.resize(count);
+        propType.resize(count);
+    }
+
+    size_t TweenManager::handle_hash_t::operator()(Handle const& handle) const noexcept {
+        // Handle 没有提供 hash，它是 POD，按字节做 FNV-1a
+        static_assert(std::is_trivially_copyable_v<Handle>, "Handle must be trivially copyable");
+        uint8_t bytes[sizeof(Handle)];
+        memcpy(bytes, &handle, sizeof(Handle));
+        uint64_t hash = 1469598103934665603ull;
+        for (auto b : bytes) {
+            hash ^= b;
+            hash *= 1099511628211ull;
+        }
+        return (size_t)hash;
+    }
+
+    void TweenManager::_addTarget(Tweener* t) {
+        if (t->target_) {
+            _byTarget.emplace(t->target_, t);
+        }
+    }
+
+    void TweenManager::_removeTarget(Tweener* t) {
+        if (!t->target_) {
+            return;
+        }
+        auto range = _byTarget.equal_range(t->target_);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == t) {
+                _byTarget.erase(it);
+                return;
+            }
+        }
+    }
+
+    void TweenManager::_recycle(Tweener* t) {
+        _removeTarget(t);
+        t->_reset();
+        t->slot_ = ~0u;
+        _pool.push_back(t);
+    }
+
     Tweener* TweenManager::createTween() {
         Tweener* tweener;
         if (!_pool.empty()) {
@@ -12,41 +109,36 @@ namespace gui {
         } else {
             tweener = new Tweener();
         }
+        // 加入活跃列表，热数据的默认值在 _init 里填
+        tweener->slot_ = _lanes.push(tweener);
         tweener->_init();
-
-        // 加入活跃列表
-        _activeTweens.push_back(tweener);
-        _activeCount++;
-
         return tweener;
     }
 
     bool TweenManager::isTweening(Handle target, TweenPropType propType) const {
-        if (!target) return false;
-
-        bool anyType = (propType == TweenPropType::None);
-        for (size_t i = 0; i < _activeTweens.size(); ++i) {
-            auto* t = _activeTweens[i];
-            if (t && t->target_ == target && !t->killed_
-                && (anyType || t->propType_ == propType)) {
-                return true;
-            }
-        }
-        return false;
+        return getTween(target, propType) != nullptr;
     }
 
     bool TweenManager::killTweens(Handle target, TweenPropType propType, bool completed) {
         if (!target) return false;
 
-        bool flag = false;
         bool anyType = (propType == TweenPropType::None);
-        for (auto* t : _activeTweens) {
-            if (t && t->target_ == target && !t->killed_
-                && (anyType || t->propType_ == propType)) {
-                t->kill(completed);
-                flag = true;
+        // kill 可能回调进来再 kill，先把要杀的挪到自己的列表里
+        std::vector<Tweener*> list;
+        list.swap(_killList);
+        auto range = _byTarget.equal_range(target);
+        for (auto it = range.first; it != range.second; ++it) {
+            auto* t = it->second;
+            if (!t->killed_ && (anyType || t->propType_ == propType)) {
+                list.push_back(t);
             }
         }
+        for (auto* t : list) {
+            t->kill(completed);
+        }
+        bool flag = !list.empty();
+        list.clear();
+        _killList.swap(list);
         return flag;
     }
 
@@ -54,9 +146,10 @@ namespace gui {
         if (!target) return nullptr;
 
         bool anyType = (propType == TweenPropType::None);
-        for (auto* t : _activeTweens) {
-            if (t && t->target_ == target && !t->killed_
-                && (anyType || t->propType_ == propType)) {
+        auto range = _byTarget.equal_range(target);
+        for (auto it = range.first; it != range.second; ++it) {
+            auto* t = it->second;
+            if (!t->killed_ && (anyType || t->propType_ == propType)) {
                 return t;
             }
         }
@@ -74,60 +167,125 @@ namespace gui {
             if (dt <= 0 || dt > 0.5f) dt = 0.016f;
         }
 
-        if (_activeCount == 0) return;
+        size_t const count = _lanes.size();
+        if (count == 0) return;
 
-        // 遍历更新 + 回收 killed 的 → 对象池
-        // 使用双指针压缩空洞，避免每次 erase（O(n²)）
-        size_t writePos = 0;
-        for (size_t i = 0; i < _activeTweens.size(); ++i) {
-            auto* t = _activeTweens[i];
-            if (!t) continue;
+        // 1. 只在数组上推进快速路径的时间，决定每个 Tween 这一帧怎么走
+        _actions.resize(count);
+        _eased.resize(count);
+        _fastLanes.clear();
+        for (auto& group : _easeGroups) {
+            group.clear();
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            uint8_t const state = _lanes.state[i];
+            float const step = dt * _lanes.timeScale[i];
+            if (!_fastPath || (state & (LaneSimple | LanePaused)) != LaneSimple || step == 0) {
+                _actions[i] = LaneAction::Full;
+                continue;
+            }
+            float const exeTime = (_lanes.elapsed[i] += step) - _lanes.delay[i];
+            if (exeTime >= _lanes.duration[i]) {
+                _actions[i] = LaneAction::Finish;
+                continue;
+            }
+            _actions[i] = LaneAction::Fast;
+            _eased[i] = exeTime;
+            _fastLanes.push_back(i);
+            _easeGroups[(size_t)_lanes.easeType[i]].push_back(i);
+        }
 
-            if (t->killed_) {
-                // 回收进池
-                t->_reset();
-                _pool.push_back(t);
-                _activeTweens[i] = nullptr;
-                _activeCount--;
-            } else {
-                // 检查 target 是否已销毁
-                if (t->target_) {
-                    if (!t->target_.as<void*>()) {
-                        t->killed_ = true;
-                        t->_reset();
-                        _pool.push_back(t);
-                        _activeTweens[i] = nullptr;
-                        _activeCount--;
-                        continue;
-                    }
+        // 2. 同一种 ease 的放在一起批量算，多项式的走 SIMD，其它的逐个算，参数也在 lanes 里
+        for (size_t type = 0; type < kEaseTypeCount; ++type) {
+            auto const& group = _easeGroups[type];
+            if (group.empty()) {
+                continue;
+            }
+            _easeIn.resize(group.size());
+            for (size_t k = 0; k < group.size(); ++k) {
+                _easeIn[k] = _eased[group[k]] / _lanes.duration[group[k]];
+            }
+            if (!ease::evaluateBatch((EaseType)type, _easeIn.data(), _easeIn.data(), group.size())) {
+                for (auto i : group) {
+                    _eased[i] = ease::evaluate((EaseType)type, _eased[i], _lanes.duration[i], _lanes.easeOvershoot[i], _lanes.easePeriod[i]);
                 }
+                continue;
+            }
+            for (size_t k = 0; k < group.size(); ++k) {
+                _eased[group[k]] = _easeIn[k];
+            }
+        }
 
-                if (!t->paused_) {
-                    t->_update(dt);
-                }
+        // 3. 插值也在数组上算
+        for (auto i : _fastLanes) {
+            float const eased = _eased[i];
+            glm::vec4 v = _lanes.from[i] + _lanes.delta[i] * eased;
+            if (_lanes.state[i] & LaneSnap) {
+                v = glm::round(v);
+            }
+            _lanes.value[i] = v;
+            _lanes.normalized[i] = eased;
+        }
 
-                // 更新后可能被 kill
-                if (t->killed_) {
-                    t->_reset();
-                    _pool.push_back(t);
-                    _activeTweens[i] = nullptr;
-                    _activeCount--;
+        // 4. 按原来的顺序写回、回调；回调里新建的 Tween 在 count 之后，下一帧才走
+        for (uint32_t i = 0; i < count; ++i) {
+            uint8_t const state = _lanes.state[i];
+            if (state & LaneKilled) {
+                continue;
+            }
+            if (_actions[i] == LaneAction::Fast && !(state & LaneNotify)) {
+                // 没有回调：只用 lanes 写 target
+                Handle const target = _lanes.target[i];
+                if (!target) {
                     continue;
                 }
-
-                // 压缩：把存活的移到前面
-                if (writePos != i) {
-                    _activeTweens[writePos] = t;
-                    _activeTweens[i] = nullptr;
+                if (!target.as<void*>()) { // target 已销毁
+                    _lanes.tweener[i]->_markKilled();
+                    continue;
                 }
-                writePos++;
+                if (_lanes.propType[i] != TweenPropType::None) {
+                    TValue value;
+                    value.setVec4(_lanes.value[i]);
+                    SetObjectTweenProps(target.as<Object>(), _lanes.propType[i], value);
+                }
+                continue;
+            }
+            Tweener* t = _lanes.tweener[i];
+            if (!t->_targetAlive()) { // target 已销毁
+                t->_markKilled();
+                continue;
+            }
+            switch (_actions[i]) {
+            case LaneAction::Fast:
+                t->_applyLane(_lanes.value[i], _eased[i]);
+                break;
+            case LaneAction::Finish:
+                t->_afterAdvance();
+                break;
+            case LaneAction::Full:
+                if (!(state & LanePaused)) {
+                    t->_update(dt);
+                }
+                break;
             }
         }
 
-        // 截断尾部空洞
-        if (writePos < _activeTweens.size()) {
-            _activeTweens.resize(writePos);
+        // 5. 回收 killed 的 → 对象池，活着的往前压，保持顺序
+        size_t writePos = 0;
+        size_t const total = _lanes.size();
+        for (size_t i = 0; i < total; ++i) {
+            Tweener* t = _lanes.tweener[i];
+            if (t->killed_) {
+                _recycle(t);
+                continue;
+            }
+            if (writePos != i) {
+                _lanes.move(writePos, i);
+                t->slot_ = (uint32_t)writePos;
+            }
+            writePos++;
         }
+        _lanes.resize(writePos);
     }
 
     void TweenManager::clean() {
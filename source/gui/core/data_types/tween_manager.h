@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <unordered_map>
 #include <core/declare.h>
 #include <core/data_types/tweener.h>
 #include <utils/singleton.h>
@@ -8,8 +9,13 @@ namespace gui {
 
     /// Tween 管理器 — 单例
     /// 负责 Tweener 的对象池、活跃列表维护、每帧更新
+    /// 1. 每帧都要碰的时间状态（elapsed/delay/duration/timeScale/ease）按 SoA 放在 _lanes 里，下标是 Tweener::slot_
+    /// 2. target → Tweener 的索引，isTweening/killTweens/getTween 不用扫所有活跃 Tween
+    /// 3. 已经开始、没有 repeat/breakpoint/path 的普通插值走快速路径：在数组上推进时间，按 ease 分组批量计算，
+    ///    起止值也在 lanes 里，插值直接在数组上算；没有 update 回调的按顺序直接写 target，不经过 Tweener
     class TweenManager : public comm::Singleton<TweenManager> {
         friend class comm::Singleton<TweenManager>;
+        friend class Tweener;
     public:
         /// 创建或从池中复用 Tweener，自动加入活跃列表
         Tweener* createTween();
@@ -24,23 +30,81 @@ namespace gui {
         Tweener* getTween(Handle target, TweenPropType propType) const;
 
         /// 每帧调用，遍历活跃 Tween 并更新
-        /// dt 为 0 时自动用内部时钟计算帧间隔
+        /// dt 为 0 时自动用内部时钟计算帧间隔；update 期间新建的 Tween 下一帧才开始走
         void update(float dt = 0);
 
         /// 清空对象池
         void clean();
 
-        /// 活跃 Tween 总数
-        size_t activeCount() const { return _activeCount; }
+        /// 活跃 Tween 总数（含这一帧刚 kill、还没回收的）
+        size_t activeCount() const { return _lanes.size(); }
+
+        /// 调试/对比用：关掉之后所有 Tween 都走 Tweener::_update（改成 SoA 之前的路径）
+        void setFastPath(bool enabled) { _fastPath = enabled; }
 
     private:
         TweenManager() = default;
 
+        enum LaneState : uint8_t {
+            LanePaused  = 1,
+            LaneSimple  = 2,    ///> 可以走快速路径，Tweener::update 每次重新判定并装载 from/delta/target，改了相关参数的 setter 清掉
+            LaneKilled  = 4,    ///> 和 Tweener::killed_ 同步，写回时不用碰 Tweener
+            LaneSnap    = 8,
+            LaneNotify  = 16,   ///> 有 update 回调/listener，写回要经过 Tweener
+        };
+
+        enum class LaneAction : uint8_t {
+            Fast,       ///> 快速路径，ease 和插值都在 lanes 上算好了
+            Finish,     ///> 快速路径推进后到头了，走完整的结束逻辑
+            Full,       ///> 原来的完整 _update
+        };
+
+        struct tween_lanes_t {
+            std::vector<Tweener*>   tweener;
+            std::vector<float>      elapsed;
+            std::vector<float>      delay;
+            std::vector<float>      duration;
+            std::vector<float>      timeScale;
+            std::vector<EaseType>   easeType;
+            std::vector<float>      easeOvershoot;  ///> easeOvershootOrAmplitude
+            std::vector<float>      easePeriod;
+            std::vector<float>      normalized;     ///> 最近一次的 ease 结果，getNormalizedTime
+            std::vector<uint8_t>    state;
+            // 快速路径的插值数据，LaneSimple 时有效
+            std::vector<glm::vec4>  from;
+            std::vector<glm::vec4>  delta;
+            std::vector<glm::vec4>  value;
+            std::vector<Handle>     target;
+            std::vector<TweenPropType> propType;
+
+            size_t size() const { return tweener.size(); }
+            uint32_t push(Tweener* t);
+            void move(size_t dst, size_t src);
+            void resize(size_t count);
+        };
+
+        struct handle_hash_t {
+            size_t operator()(Handle const& handle) const noexcept;
+        };
+
+        void _addTarget(Tweener* t);
+        void _removeTarget(Tweener* t);
+        void _recycle(Tweener* t);
+
         static constexpr size_t kInitCapacity = 30;
+        static constexpr size_t kEaseTypeCount = (size_t)EaseType::Custom + 1;
 
-        std::vector<Tweener*>   _activeTweens;  // 活跃列表（可能有 nullptr 空洞）
+        tween_lanes_t           _lanes;         // 活跃 Tween 的热数据，顺序就是更新顺序
         std::vector<Tweener*>   _pool;          // 对象池（killed 后回收）
-        size_t                  _activeCount = 0;
+        std::unordered_multimap<Handle, Tweener*, handle_hash_t> _byTarget;
+        // update 里复用的临时数组
+        std::vector<LaneAction> _actions;
+        std::vector<float>      _eased;         // 按 slot，快速路径的 exeTime，批量算完换成 ease 结果
+        std::vector<float>      _easeIn;
+        std::vector<uint32_t>   _easeGroups[kEaseTypeCount];
+        std::vector<uint32_t>   _fastLanes;     // 这一帧走快速路径的 slot，按顺序
+        std::vector<Tweener*>   _killList;
+        bool                    _fastPath = true;
     };
 
     /// GTween — 公共静态 API
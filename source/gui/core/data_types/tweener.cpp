@@ -2,6 +2,7 @@
 #include "../declare.h"
 #include <core/ease/ease.h>
 #include <core/data_types/interpolatable_path.h>
+#include <core/data_types/tween_manager.h>
 #include <core/ui/object.h>
 
 namespace gui {
@@ -16,18 +17,13 @@ namespace gui {
         , target_(Handle())
         , propType_(TweenPropType::None)
         , valueType_(TweenValueType::None)
-        , delay_(0.0f)
-        , duration_(0.0f)
+        , slot_(~0u)
         , breakpoint_(0.0f)
-        , easeType_(EaseType::Linear)
-        , easePeriod_(0.3f)
-        , easeOvershootOrAmplitude_(1.70158f)
         , repeat_(0)
         , yoyo_(false)
-        , timeScale_(1.0f)
         , snapping_(false)   
     {
-        _init();
+        // 只由 TweenManager::createTween 创建，分配好 slot 之后再 _init
     }
 
     Tweener::~Tweener() = default;
@@ -36,7 +32,8 @@ namespace gui {
         valueType_ = TweenValueType::Float;
         startVal.val.x = start;
         endVal.val.x = end;
-        duration_ = duration;
+        if (!_hasSlot()) return this;
+        TweenManager::Instance()->_lanes.duration[slot_] = duration;
         return this;
     }
 
@@ -44,7 +41,8 @@ namespace gui {
         valueType_ = TweenValueType::Vec2;
         startVal.setVec2(start);
         endVal.setVec2(end);
-        duration_ = duration;
+        if (!_hasSlot()) return this;
+        TweenManager::Instance()->_lanes.duration[slot_] = duration;
         return this;
     }
 
@@ -52,7 +50,8 @@ namespace gui {
         valueType_ = TweenValueType::Vec3;
         startVal.setVec3(start);
         endVal.setVec3(end);
-        duration_ = duration;
+        if (!_hasSlot()) return this;
+        TweenManager::Instance()->_lanes.duration[slot_] = duration;
         return this;
     }
 
@@ -60,7 +59,8 @@ namespace gui {
         valueType_ = TweenValueType::Vec4;
         startVal.setVec4(start);
         endVal.setVec4(end);
-        duration_ = duration;
+        if (!_hasSlot()) return this;
+        TweenManager::Instance()->_lanes.duration[slot_] = duration;
         return this;
     }
 
@@ -68,7 +68,8 @@ namespace gui {
         valueType_ = TweenValueType::Color4B;
         startVal.setColor4B(start);
         endVal.setColor4B(end);
-        duration_ = duration;
+        if (!_hasSlot()) return this;
+        TweenManager::Instance()->_lanes.duration[slot_] = duration;
         return this;
     }
 
@@ -76,7 +77,8 @@ namespace gui {
         valueType_ = TweenValueType::Double;
         startVal.d = start;
         endVal.d = end;
-        duration_ = duration;
+        if (!_hasSlot()) return this;
+        TweenManager::Instance()->_lanes.duration[slot_] = duration;
         return this;
     }
 
@@ -85,7 +87,8 @@ namespace gui {
         startVal.val.x = start.x;
         startVal.val.y = start.y;
         startVal.val.w = amplitude;
-        duration_ = duration;
+        if (!_hasSlot()) return this;
+        TweenManager::Instance()->_lanes.duration[slot_] = duration;
         return this;
     }
 
@@ -153,48 +156,57 @@ namespace gui {
     }
 
     Tweener* Tweener::setDelay(float val) {
-        delay_  = val;
+        if (!_hasSlot()) return this;
+        TweenManager::Instance()->_lanes.delay[slot_] = val;
         return this;
     }
 
     Tweener* Tweener::setDuration(float val) {
-        duration_ = val;
+        if (!_hasSlot()) return this;
+        TweenManager::Instance()->_lanes.duration[slot_] = val;
         return this;
     }
 
     Tweener* Tweener::setBreakpoint(float val) {
         breakpoint_ = val;
+        _clearSimple();
         return this;
     }
 
     Tweener* Tweener::setEase(EaseType type) {
-        easeType_ = type;
+        if (!_hasSlot()) return this;
+        TweenManager::Instance()->_lanes.easeType[slot_] = type;
         return this;
     }
 
     Tweener* Tweener::setEasePeriod(float val) {
-        easePeriod_ = val;
+        if (!_hasSlot()) return this;
+        TweenManager::Instance()->_lanes.easePeriod[slot_] = val;
         return this;
     }
 
     Tweener* Tweener::setEaseOvershootOrAmplitude(float val) {
-        easeOvershootOrAmplitude_ = val;
+        if (!_hasSlot()) return this;
+        TweenManager::Instance()->_lanes.easeOvershoot[slot_] = val;
         return this;
     }
 
     Tweener* Tweener::setRepeat(int repeat, bool yoyo) {
         repeat_ = repeat;
         yoyo_ = yoyo;
+        _clearSimple();
         return this;
     }
 
     Tweener* Tweener::setTimeScale(float value) {
-        timeScale_ = value;
+        if (!_hasSlot()) return this;
+        TweenManager::Instance()->_lanes.timeScale[slot_] = value;
         return this;
     }
 
     Tweener* Tweener::setSnapping(bool value) {
         snapping_ = value;
+        _clearSimple();
         return this;
     }
 
@@ -205,12 +217,17 @@ namespace gui {
     }
 
     Tweener* Tweener::setTarget(Handle uid) {
+        if (!_hasSlot()) return this; // 池里的不能进 target 索引
+        auto* manager = TweenManager::Instance();
+        manager->_removeTarget(this);
         target_ = uid;
+        manager->_addTarget(this);
+        _clearSimple();
         return this;
     }
 
     Tweener* Tweener::setTarget(Handle uid, TweenPropType type) {
-        target_ = uid;
+        setTarget(uid);
         propType_ = type;
         return this;
     }
@@ -222,11 +239,13 @@ namespace gui {
 
     Tweener* Tweener::setPath(InterpoPath* path) {
         path_ = path;
+        _clearSimple();
         return this;
     }
 
     Tweener* Tweener::setUpdateCallback(TweenCallback const& callback) {
         onUpdate_ = callback;
+        _clearSimple();
         return this;
     }
 
@@ -247,20 +266,34 @@ namespace gui {
 
     Tweener* Tweener::setListener(ITweenListener* listener) {
         listener_ = listener;
+        _clearSimple();
         return this;
     }
 
     Tweener* Tweener::setPaused(bool paused) {
-        paused_ = paused;
+        if (!_hasSlot()) return this;
+        auto& state = TweenManager::Instance()->_lanes.state[slot_];
+        if (paused) {
+            state |= TweenManager::LanePaused;
+        } else {
+            state &= ~TweenManager::LanePaused;
+        }
         return this;
     }
 
+    bool Tweener::isPaused() const {
+        if (!_hasSlot()) return false;
+        return TweenManager::Instance()->_lanes.state[slot_] & TweenManager::LanePaused;
+    }
+
     float Tweener::getDelay() const {
-        return delay_;
+        if (!_hasSlot()) return 0;
+        return TweenManager::Instance()->_lanes.delay[slot_];
     }
 
     float Tweener::getDuration() const {
-        return duration_;
+        if (!_hasSlot()) return 0;
+        return TweenManager::Instance()->_lanes.duration[slot_];
     }
 
     int Tweener::getRepeat() const {
@@ -272,7 +305,8 @@ namespace gui {
     }
 
     float Tweener::getNormalizedTime() const {
-        return normalizedTime_;
+        if (!_hasSlot()) return 0;
+        return TweenManager::Instance()->_lanes.normalized[slot_];
     }
 
     bool Tweener::completed() const {
@@ -284,13 +318,15 @@ namespace gui {
     }
 
     void Tweener::seek(float time) {
-        if(killed_) {
+        if(killed_ || !_hasSlot()) {
             return;
         }
-        elapsedTime_ = time;
-        if(elapsedTime_ < delay_) {
+        auto& lanes = TweenManager::Instance()->_lanes;
+        float& elapsed = lanes.elapsed[slot_];
+        elapsed = time;
+        if(elapsed < lanes.delay[slot_]) {
             if(started_) {
-                elapsedTime_ = delay_;
+                elapsed = lanes.delay[slot_];
             } else {
                 return;
             }
@@ -304,18 +340,21 @@ namespace gui {
         }
         if(complete) {
             if(ended_ == 0) {
+                auto& lanes = TweenManager::Instance()->_lanes;
+                float const delay = lanes.delay[slot_];
+                float const duration = lanes.duration[slot_];
                 if(breakpoint_ >= 0) {
-                    elapsedTime_ = delay_ + breakpoint_;
+                    lanes.elapsed[slot_] = delay + breakpoint_;
                 } else if( repeat_ >= 0) {
-                    elapsedTime_ = delay_ + duration_ * (repeat_+1);
+                    lanes.elapsed[slot_] = delay + duration * (repeat_+1);
                 } else {
-                    elapsedTime_ = delay_ + duration_ * 2;
+                    lanes.elapsed[slot_] = delay + duration * 2;
                 }
                 update();
             }
             callCompleteCallback();
         }
-        killed_ = true;
+        _markKilled();
     }
 
     Userdata const& Tweener::getUserData() const {
@@ -324,22 +363,24 @@ namespace gui {
 
 
     void Tweener::_init() {
-        delay_ = 0;
-        duration_ = 0;
+        auto& lanes = TweenManager::Instance()->_lanes;
+        lanes.delay[slot_] = 0;
+        lanes.duration[slot_] = 0;
+        lanes.easeType[slot_] = EaseType::QuadOut;
+        lanes.timeScale[slot_] = 1;
+        lanes.elapsed[slot_] = 0;
+        lanes.easePeriod[slot_] = 0;
+        lanes.easeOvershoot[slot_] = 1.70158f;
+        lanes.normalized[slot_] = 0;
+        lanes.state[slot_] = 0;
+        lanes.target[slot_] = Handle();
         breakpoint_ = -1;
-        easeType_ = EaseType::QuadOut;
-        timeScale_ = 1;
-        easePeriod_ = 0;
-        easeOvershootOrAmplitude_ = 1.70158f;
         snapping_ = false;
         repeat_ = 0;
         yoyo_ = false;
         valueType_ = TweenValueType::None;
         started_ = false;
-        paused_ = false;
         killed_ = false;
-        elapsedTime_ = 0;
-        normalizedTime_ = 0;
         ended_ = 0;
         path_ = nullptr;
         target_ = Handle();
@@ -365,37 +406,41 @@ namespace gui {
     void Tweener::_update(float dt) {
         if (ended_ != 0) { // 可能被 seek 标记为已完成
             callCompleteCallback();
-            killed_ = true;
+            _markKilled();
             return;
         }
 
-        if (timeScale_ != 1.0f)
-            dt *= timeScale_;
+        dt *= TweenManager::Instance()->_lanes.timeScale[slot_];
         if (dt == 0)
             return;
 
-        elapsedTime_ += dt;
+        TweenManager::Instance()->_lanes.elapsed[slot_] += dt;
+        _afterAdvance();
+    }
+
+    void Tweener::_afterAdvance() {
         update();
 
         if (ended_ != 0) {
             if (!killed_) {
                 callCompleteCallback();
-                killed_ = true;
+                _markKilled();
             }
         }
     }
 
     void Tweener::update() {
+        auto& lanes = TweenManager::Instance()->_lanes;
         ended_ = 0;
         if(TweenValueType::None == valueType_) {  // 空的，没任何意义
-            if(elapsedTime_ >= delay_ + duration_) {
+            if(lanes.elapsed[slot_] >= lanes.delay[slot_] + lanes.duration[slot_]) {
                 ended_ = 1;
             }
             return;
         }
         // 基本判断
         if(!started_) {
-            if(elapsedTime_ < delay_) { // 还未开始？
+            if(lanes.elapsed[slot_] < lanes.delay[slot_]) { // 还未开始？
                 return;
             }
             started_ = true;
@@ -404,15 +449,17 @@ namespace gui {
                 return;
             }
         }
+        // 回调里可能改了参数，这里再读
+        float const duration = lanes.duration[slot_];
         bool reversed = false;
-        float exeTime = elapsedTime_ - delay_;
+        float exeTime = lanes.elapsed[slot_] - lanes.delay[slot_];
         if(breakpoint_ >= 0 && exeTime >= breakpoint_) {
             exeTime = breakpoint_;
             ended_ = 2; // 被breakpoint打断
         }
         if(repeat_) {
-            int round = (int)floor(exeTime/duration_);
-            exeTime -= duration_ * round;
+            int round = (int)floor(exeTime/duration);
+            exeTime -= duration * round;
             if(yoyo_) {
                 reversed = (round % 2 == 1);
             }
@@ -420,19 +467,33 @@ namespace gui {
                 if(yoyo_) {
                     reversed = (repeat_ % 2 == 1);
                 }
-                exeTime = duration_;
+                exeTime = duration;
                 ended_ = 1;
             }
-        } else if(exeTime >= duration_) {
-            exeTime = duration_;
+        } else if(exeTime >= duration) {
+            exeTime = duration;
             ended_ = 1;
         }
-        normalizedTime_ = ease::evaluate(easeType_, reversed ? (duration_ - exeTime) : exeTime, duration_, easeOvershootOrAmplitude_, easePeriod_);
+        float const normalizedTime = ease::evaluate(lanes.easeType[slot_], reversed ? (duration - exeTime) : exeTime, duration, lanes.easeOvershoot[slot_], lanes.easePeriod[slot_]);
+        lanes.normalized[slot_] = normalizedTime;
+        // 开始了、还在走、只是普通插值的，下一帧可以走 TweenManager 的快速路径
+        bool const simple = ended_ == 0
+            && repeat_ == 0 && breakpoint_ < 0 && !path_
+            && valueType_ >= TweenValueType::Float && valueType_ <= TweenValueType::Vec4;
+        if (simple) {
+            _loadLane();
+        } else {
+            lanes.state[slot_] &= ~TweenManager::LaneSimple;
+        }
+        if(valueType_ != TweenValueType::Double && valueType_ != TweenValueType::Shake && !path_) {
+            _applyEased(normalizedTime);
+            return;
+        }
         this->val.reset();
         this->deltaVal.reset();
 
         if(valueType_ == TweenValueType::Double) { // 双精度浮点插值
-            double d = startVal.d + (endVal.d - startVal.d) * normalizedTime_;
+            double d = startVal.d + (endVal.d - startVal.d) * normalizedTime;
             if(snapping_) {
                 d = round(d);
             }
@@ -441,7 +502,7 @@ namespace gui {
             val.x = float(d);
         } else if(valueType_ == TweenValueType::Shake) { // 随机值
             if (ended_ == 0) {
-                float r = startVal.val.w * (1 - normalizedTime_);
+                float r = startVal.val.w * (1 - normalizedTime);
                 float rx = (rand_0_1() * 2 - 1) * r;
                 float ry = (rand_0_1() * 2 - 1) * r;
                 rx = rx > 0 ? ceil(rx) : floor(rx);
@@ -454,7 +515,7 @@ namespace gui {
                 val.setVec3(startVal.vec3());
             }
         } else if(path_) { // 路径插值
-            glm::vec3 v3 = path_->pointAt(normalizedTime_);
+            glm::vec3 v3 = path_->pointAt(normalizedTime);
             if(snapping_) {
                 v3.x = round(v3.x);
                 v3.y = round(v3.y);
@@ -462,26 +523,77 @@ namespace gui {
             }
             deltaVal.setVec3(v3 - val.vec3());
             val.setVec3(v3);
-        } else { // float/vec2/vec3/vec4
-            assert(valueType_ > 0 && valueType_ <= 4);
-            for(uint32_t i = 0; i<valueType_; ++i) {
-                float fval = startVal.val[i] + (endVal.val[i] - startVal.val[i]) * normalizedTime_;
-                if(snapping_) {
-                    fval = round(fval);
-                }
-                deltaVal.val[i] = fval - val.val[i];
-                val.val[i] = fval;
+        }
+        _applyTarget();
+        callUpdateCallback();
+    }
+
+    void Tweener::_applyEased(float eased) { // float/vec2/vec3/vec4
+        assert(valueType_ > 0 && valueType_ <= 4);
+        this->val.reset();
+        this->deltaVal.reset();
+        for(uint32_t i = 0; i<valueType_; ++i) {
+            float fval = startVal.val[i] + (endVal.val[i] - startVal.val[i]) * eased;
+            if(snapping_) {
+                fval = round(fval);
             }
+            deltaVal.val[i] = fval - val.val[i];
+            val.val[i] = fval;
         }
-        //
+        _applyTarget();
+        callUpdateCallback();
+    }
+
+    void Tweener::_applyLane(glm::vec4 value, float eased) {
+        // 和 _applyEased 的结果一致：没用到的分量是 0，deltaVal 相对 reset 之后的 val
+        val.setVec4(value);
+        deltaVal.setVec4(value);
+        _applyTarget();
+        callUpdateCallback();
+    }
+
+    void Tweener::_loadLane() {
+        auto& lanes = TweenManager::Instance()->_lanes;
+        glm::vec4 from(0), delta(0);
+        for(uint32_t i = 0; i<valueType_; ++i) {
+            from[i] = startVal.val[i];
+            delta[i] = endVal.val[i] - startVal.val[i];
+        }
+        lanes.from[slot_] = from;
+        lanes.delta[slot_] = delta;
+        lanes.target[slot_] = target_;
+        lanes.propType[slot_] = propType_;
+        uint8_t state = lanes.state[slot_] & ~(TweenManager::LaneSnap | TweenManager::LaneNotify);
+        state |= TweenManager::LaneSimple;
+        if (snapping_) state |= TweenManager::LaneSnap;
+        if (listener_ || onUpdate_) state |= TweenManager::LaneNotify;
+        lanes.state[slot_] = state;
+    }
+
+    void Tweener::_markKilled() {
+        killed_ = true;
+        if (_hasSlot()) {
+            TweenManager::Instance()->_lanes.state[slot_] |= TweenManager::LaneKilled;
+        }
+    }
+
+    void Tweener::_applyTarget() {
         if (target_ && propType_ != TweenPropType::None) {
             auto* obj = target_.as<Object>();
             if (obj) {
                 SetObjectTweenProps(obj, propType_, val);
             }
         }
+    }
 
-        callUpdateCallback();
+    bool Tweener::_targetAlive() const {
+        return !target_ || target_.as<void*>();
+    }
+
+    void Tweener::_clearSimple() {
+        if (_hasSlot()) {
+            TweenManager::Instance()->_lanes.state[slot_] &= ~TweenManager::LaneSimple;
+        }
     }
 
     void Tweener::callStartCallback() {
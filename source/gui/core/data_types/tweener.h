@@ -83,12 +83,15 @@ namespace gui {
         Handle getTarget() const;
         float getNormalizedTime() const;
         bool isKilled() const { return killed_; }
+        bool isPaused() const;
         bool allCompleted() const;
         bool completed() const;
         void seek(float time);
         void kill(bool complete = false);
         Userdata const& getUserData() const;
 
+        // 快速路径用的是进入时装载到 TweenManager lanes 里的 startVal/endVal
+        // val/deltaVal 只在有 update 回调或 listener 时才每帧刷新
         TValue startVal;
         TValue endVal;
         TValue deltaVal;
@@ -105,6 +108,16 @@ namespace gui {
         void _init();
         void _reset();
         void _update(float dt);
+        void _afterAdvance();           // elapsed 已经推进过：update + 结束判定
+        void _applyEased(float eased);  // 插值、写 target、回调
+        void _applyLane(glm::vec4 value, float eased); // 快速路径：值已经在 lanes 上算好，写 target、回调
+        void _applyTarget();
+        void _loadLane();               // 可以走快速路径时把起止值/target 装进 lanes
+        void _markKilled();
+        bool _targetAlive() const;
+        // 被 TweenManager 回收进池之后 slot_ 为 ~0u，外面还拿着指针调用的 setter/getter 什么都不做
+        bool _hasSlot() const { return slot_ != ~0u; }
+        void _clearSimple();
         void update();
         void callStartCallback();
         void callUpdateCallback();
@@ -117,22 +130,14 @@ namespace gui {
         UnderlyingEnum<TweenValueType>      valueType_;
         //
         uint8_t             killed_:1;
-        uint8_t             paused_:1;
         uint8_t             yoyo_:1;
         uint8_t             snapping_:1;
         uint8_t             started_:1;
         uint8_t             ended_:3;
-        //
-        float               delay_;
-        float               duration_;
+        // delay/duration/timeScale/elapsed/ease 参数/normalizedTime/paused 在 TweenManager 的 _lanes 里
+        uint32_t            slot_;
         float               breakpoint_;
-        float               easeOvershootOrAmplitude_;
-        float               easePeriod_;
-        float               timeScale_;
-        float               elapsedTime_;
-        float               normalizedTime_;
         int                 repeat_;
-        EaseType            easeType_;
         Userdata            userdata_;
         InterpoPath*        path_;
 
@@ -43,14 +43,21 @@ namespace gui {
 
         // batch 节点缓存的局部矩阵，transform_dirty 时重算
         struct batch_local_matrix {
-            glm::mat4 mat;
+            affine2d mat;
+        };
+
+        // batch 节点下的非 batch 节点缓存的 local-to-batch 矩阵（相对所属 batch 节点）
+        // Asm_Transform 时从最上层的脏节点自顶向下重算，每个节点只乘一次自己的局部矩阵
+        struct local_to_batch {
+            affine2d mat;
         };
 
         // 普通可显示的item有这个组件
         struct item_batch_info {
             entt::entity    batchEntity;    // 所属batch节点
-            int             batchIdx;       // 第几个 ui_render_batch_t (512个inst切一次)
-            int             instIndex;      // batch 内 args 的第几个位置
+            int             batchIdx;       // 第几个 ui_render_batches_t（材质连续段）
+            int             subIdx;         // 段内第几个 ui_render_batch_t（实例数或顶点数超了才切）
+            int             instIndex;      // sub-batch 内 args 的第几个位置
         };
 
         // root 节点有这个组件
@@ -71,6 +78,9 @@ namespace gui {
         // image/font/shape 都有这个组件
         struct mesh_dirty {};
 
+        // 已经在 batch 里的 item 只是 mesh 变了，先尝试原地改写 batch 里它的那一段，不重建整个 batch
+        struct mesh_need_patch {};
+
         struct image_ext {
             Color4B             color;
             FlipType            flip;
@@ -116,6 +126,9 @@ namespace gui {
 
         struct transform_dirty {};
 
+        // updateItemTransforms 里临时用：子树里有节点要重算 local-to-batch，遍历完就清掉
+        struct transform_subtree_dirty {};
+
         // args 需要同步到 batch cache 的标记 + 位掩码
         enum ArgsSyncMask : uint8_t {
             Asm_Transform  = 1 << 0,  // local-to-batch 矩阵需重算
@@ -128,6 +141,12 @@ namespace gui {
             uint8_t mask;
         };
 
+        // 进了 Stage 点击索引的对象（的 display object）有这个组件，index 是索引里的下标
+        struct hit_entry {
+            uint32_t index;
+        };
+        struct hit_bounds_dirty {}; // 变换变了，点击索引里这棵子树的矩阵和 AABB 要重算
+
         struct visible {}; // 控件本身的可见性
         struct final_visible {}; // 最终提交相关的可见性
         struct visible_dirty {}; // 可见性是不是需要重计算
@@ -102,6 +102,9 @@ namespace gui {
     static void markArgsNeedSync(entt::entity e, uint8_t mask) {
         auto& s = reg.get_or_emplace<dispcomp::args_need_sync>(e);
         s.mask |= mask;
+        if((mask & dispcomp::Asm_Transform) && reg.any_of<dispcomp::hit_entry>(e)) { // 在点击索引里，AABB 要重算
+            reg.emplace_or_replace<dispcomp::hit_bounds_dirty>(e);
+        }
     }
 
     void DisplayObject::setPosition(glm::vec2 const& pos) {
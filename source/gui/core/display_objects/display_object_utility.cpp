@@ -1,6 +1,5 @@
 #include "display_object_utility.h"
 #include "core/display_objects/display_components.h"
-#include <glm/ext/matrix_transform.hpp>
 #include <vector>
 
 namespace gui {
@@ -68,78 +67,145 @@ namespace gui {
     }
 
     // 实体自身的局部矩阵 (相对直接父节点)
-    glm::mat4 buildLocalMatrix(entt::entity ett) {
-        if (!reg.any_of<dispcomp::basic_transform>(ett)) {
-            return glm::mat4(1.0f);
-        }
-        auto& transform = reg.get<dispcomp::basic_transform>(ett);
-        glm::mat4 mat = glm::translate(glm::mat4(1.0f),
-            glm::vec3(transform.position.x, transform.position.y, 0.0f));
-        if (reg.any_of<dispcomp::rotation>(ett)) {
-            auto& rot = reg.get<dispcomp::rotation>(ett);
-            mat = glm::rotate(mat, rot.val, glm::vec3(0.0f, 0.0f, 1.0f));
-        }
-        if (reg.any_of<dispcomp::skew>(ett)) {
-            auto& sk = reg.get<dispcomp::skew>(ett);
-            if (sk.val.x != 0.0f || sk.val.y != 0.0f) {
-                glm::mat4 shearMat(1.0f);
-                shearMat[1][0] = sk.val.x;
-                shearMat[0][1] = sk.val.y;
-                mat = mat * shearMat;
+    affine2d buildLocalMatrix(entt::entity ett) {
+        auto transform = reg.try_get<dispcomp::basic_transform>(ett);
+        if (!transform) {
+            return affine2d();
+        }
+        auto rot = reg.try_get<dispcomp::rotation>(ett);
+        auto sk = reg.try_get<dispcomp::skew>(ett);
+        auto sc = reg.try_get<dispcomp::scale>(ett);
+        affine2d mat = affine2d::translation(transform->position.x, transform->position.y);
+        if (rot) {
+            mat = mat * affine2d::rotation(rot->val);
+        }
+        if (sk) {
+            if (sk->val.x != 0.0f || sk->val.y != 0.0f) {
+                mat = mat * affine2d::shear(sk->val.x, sk->val.y);
             }
         }
-        if (reg.any_of<dispcomp::scale>(ett)) {
-            auto& sc = reg.get<dispcomp::scale>(ett);
-            mat = glm::scale(mat, glm::vec3(sc.val.x, sc.val.y, 1.0f));
+        if (sc) {
+            mat = mat * affine2d::scaling(sc->val.x, sc->val.y);
         }
-        mat = glm::translate(mat, glm::vec3(
-            -transform.pivot.x * transform.size.x,
-            -transform.pivot.y * transform.size.y, 0.0f));
+        mat = mat * affine2d::translation(
+            -transform->pivot.x * transform->size.x,
+            -transform->pivot.y * transform->size.y);
         return mat;
     }
 
-    glm::mat4 accumulateLocalToBatch(entt::entity item, entt::entity batch) {
+    affine2d accumulateLocalToBatch(entt::entity item, entt::entity batch) {
         std::vector<entt::entity> chain;
         auto curr = item;
-        while (curr != batch && curr != entt::null) {
+        while (curr != batch && curr != entt::null && !isBatchNode(curr)) {
             chain.push_back(curr);
             curr = getParent(curr);
         }
-        glm::mat4 mat(1.0f);
+        affine2d mat;
         for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
             mat = mat * buildLocalMatrix(*it);
         }
         return mat;
     }
 
-    void updateItemTransforms() {
-        // 将args_need_sync传递到子控件里
-        reg.view<dispcomp::args_need_sync, dispcomp::children>(entt::exclude_t<dispcomp::batch_node>()).each([](entt::entity ett, dispcomp::args_need_sync& sync, dispcomp::children& children) {
-            if (!(sync.mask & dispcomp::Asm_Transform)) {
+    // 父节点是 batch 节点（或没有父节点）时为单位矩阵
+    static affine2d const& parentLocalToBatch(entt::entity ett) {
+        static const affine2d identity;
+        auto parent = reg.try_get<dispcomp::parent>(ett);
+        if (!parent || parent->val == entt::null || reg.any_of<dispcomp::batch_node>(parent->val)) {
+            return identity;
+        }
+        auto cache = reg.try_get<dispcomp::local_to_batch>(parent->val);
+        if (!cache) { // 父节点还没算过（新挂上来的），补算一次
+            affine2d mat = accumulateLocalToBatch(parent->val, entt::null);
+            cache = &reg.emplace<dispcomp::local_to_batch>(parent->val, mat);
+        }
+        return cache->mat;
+    }
+
+    // 从脏节点往上打 transform_subtree_dirty，碰到已经打过的就停，每个节点最多打一次
+    // 爬到 batch 节点下面的第一层时记下来，作为自顶向下遍历的起点
+    static void markDirtySubtree(entt::entity ett, std::vector<entt::entity>& tops) {
+        while (!reg.any_of<dispcomp::transform_subtree_dirty>(ett)) {
+            reg.emplace<dispcomp::transform_subtree_dirty>(ett);
+            entt::entity parent = getParent(ett);
+            if (parent == entt::null || isBatchNode(parent)) {
+                tops.push_back(ett);
                 return;
             }
-            std::vector<entt::entity> objects = children.val;
-            while(!objects.empty()) {
-                auto child = objects.back();
-                objects.pop_back();
-                auto & args_sync = reg.get_or_emplace<dispcomp::args_need_sync>(child);
-                if(args_sync.mask & dispcomp::Asm_Transform) {
-                    continue;
+            ett = parent;
+        }
+    }
+
+    void updateItemTransforms() {
+        struct visit_t {
+            entt::entity    ett;
+            uint8_t         mask;       ///> 从祖先继承下来的同步标记
+            bool            dirty;      ///> 祖先的矩阵变了，这个节点的 local-to-batch 已经由父节点算好
+        };
+        static std::vector<entt::entity> tops;
+        static std::vector<visit_t> stack;
+        // 1. 脏节点的祖先链打上子树脏标记
+        tops.clear();
+        reg.view<dispcomp::args_need_sync>(entt::exclude_t<dispcomp::batch_node>()).each([](entt::entity ett, dispcomp::args_need_sync& sync) {
+            if (sync.mask & dispcomp::Asm_Transform) {
+                markDirtySubtree(ett, tops);
+            }
+        });
+        if (tops.empty()) {
+            return;
+        }
+        // 2. 一次自顶向下：只进有标记的子树，遇到脏节点之后整棵子树都重算，每个节点乘一次自己的局部矩阵
+        stack.clear();
+        for (auto top : tops) {
+            stack.push_back({ top, 0, false });
+        }
+        while (!stack.empty()) {
+            visit_t visit = stack.back();
+            stack.pop_back();
+            auto sync = reg.try_get<dispcomp::args_need_sync>(visit.ett);
+            bool const dirty = visit.dirty || (sync && (sync->mask & dispcomp::Asm_Transform));
+            affine2d mat; // 只是路过（自己没变、往下找脏节点）的不用算
+            if (dirty && !visit.dirty) { // 最上层的脏节点，父节点的缓存是新的
+                mat = parentLocalToBatch(visit.ett) * buildLocalMatrix(visit.ett);
+                reg.get_or_emplace<dispcomp::local_to_batch>(visit.ett).mat = mat;
+            } else if (dirty) {
+                mat = reg.get<dispcomp::local_to_batch>(visit.ett).mat; // 拷贝，下面 emplace 子节点可能让引用失效
+            }
+            uint8_t mask = visit.mask;
+            if (dirty) {
+                bool isItem = false;
+                if (auto gfx = reg.try_get<dispcomp::item_render_data>(visit.ett)) {
+                    gfx->args.transfrom = mat;
+                    isItem = true;
                 }
-                args_sync.mask |= sync.mask;
-                if (reg.any_of<dispcomp::children>(child) && !reg.any_of<dispcomp::batch_node>(child)) { // batch节点就不往下遍历了
-                    objects.insert(objects.end(), reg.get<dispcomp::children>(child).val.begin(), reg.get<dispcomp::children>(child).val.end());
+                if (sync) {
+                    mask |= sync->mask;
+                    sync->mask = (sync->mask | visit.mask) & ~dispcomp::Asm_Transform;
+                    if (!isItem && !sync->mask) {
+                        reg.remove<dispcomp::args_need_sync>(visit.ett);
+                    }
+                } else if (isItem) { // 矩阵变了，需要同步到 batch cache
+                    reg.emplace<dispcomp::args_need_sync>(visit.ett, (uint8_t)(visit.mask & ~dispcomp::Asm_Transform));
                 }
             }
-        });
-        // 处理 Asm_Transform 标记：重算 local-to-batch 矩阵，写入 gfx.args.transfrom
-        reg.view<dispcomp::args_need_sync, dispcomp::item_batch_info, dispcomp::item_render_data>().each([](entt::entity ett, dispcomp::args_need_sync& sync, dispcomp::item_batch_info& info, dispcomp::item_render_data& gfx) {
-            if (!(sync.mask & dispcomp::Asm_Transform)) {
-                return;
+            auto children = reg.try_get<dispcomp::children>(visit.ett);
+            if (!children) {
+                continue;
             }
-            gfx.args.transfrom = accumulateLocalToBatch(ett, info.batchEntity);
-            sync.mask &= ~dispcomp::Asm_Transform;
-        });
+            for (auto child : children->val) {
+                if (reg.any_of<dispcomp::batch_node>(child)) { // batch节点就不往下遍历了
+                    continue;
+                }
+                if (dirty) {
+                    auto& cache = reg.get_or_emplace<dispcomp::local_to_batch>(child);
+                    cache.mat = mat * buildLocalMatrix(child);
+                    stack.push_back({ child, mask, true });
+                } else if (reg.any_of<dispcomp::transform_subtree_dirty>(child)) {
+                    stack.push_back({ child, 0, false });
+                }
+            }
+        }
+        reg.clear<dispcomp::transform_subtree_dirty>();
     }
 
     void syncArgsToBatch(entt::entity entity) {
@@ -157,11 +223,14 @@ namespace gui {
         if (!batchData || info.batchIdx >= (int)batchData->batches.size()) return;
 
         auto& batches_t = batchData->batches[info.batchIdx];
-        int subIdx = info.instIndex / 512;
-        int idxInSub = info.instIndex % 512;
-        if (subIdx >= (int)batches_t.batches.size()) return;
-
-        batches_t.batches[subIdx]->cachedArgs[idxInSub] = gfx.args;
+        if (info.subIdx >= (int)batches_t.batches.size()) return;
+        auto& cachedArgs = batches_t.batches[info.subIdx]->cachedArgs;
+        if (info.instIndex >= (int)cachedArgs.size()) return;
+
+        auto& cached = cachedArgs[info.instIndex];
+        uint32_t textureSlot = cached.textureSlot; // 槽位是 batch 分配的，registry 里没有
+        cached = gfx.args;
+        cached.textureSlot = textureSlot;
         reg.remove<dispcomp::args_need_sync>(entity);
     }
 
@@ -32,7 +32,7 @@ namespace gui {
     /// 处理所有需要重算 local-to-batch 矩阵的 item，更新 gfx.args.transfrom
     void updateItemTransforms();
 
-    glm::mat4 buildLocalMatrix(entt::entity ett);
-    glm::mat4 accumulateLocalToBatch(entt::entity item, entt::entity batch);
+    affine2d buildLocalMatrix(entt::entity ett);
+    affine2d accumulateLocalToBatch(entt::entity item, entt::entity batch);
 
 }
\ No newline at end of file
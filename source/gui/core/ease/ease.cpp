@@ -2,6 +2,11 @@
 #define _USE_MATH_DEFINES
 #include <cmath>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GUI_EASE_SSE2 1
+#include <emmintrin.h>
+#endif
+
 /****************************************
  * 也没什么东西，就直接从fairygui里抄过来了
 ****************************************/
@@ -202,6 +207,78 @@ namespace gui {
             return easeOut(time * 2 - duration, duration) * 0.5f + 0.5f;
         }
 
+        namespace {
+
+            // 标量和 SSE 共用一份公式，V 是 float 或者 f4
+            inline float splat(float v, float) { return v; }
+            inline float select_lt(float x, float limit, float a, float b) { return x < limit ? a : b; }
+
+#if GUI_EASE_SSE2
+            struct f4 {
+                __m128 v;
+            };
+            inline f4 operator+(f4 a, f4 b) { return { _mm_add_ps(a.v, b.v) }; }
+            inline f4 operator-(f4 a, f4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+            inline f4 operator*(f4 a, f4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+            inline f4 splat(float v, f4) { return { _mm_set1_ps(v) }; }
+            inline f4 select_lt(f4 x, f4 limit, f4 a, f4 b) {
+                __m128 mask = _mm_cmplt_ps(x.v, limit.v);
+                return { _mm_or_ps(_mm_and_ps(mask, a.v), _mm_andnot_ps(mask, b.v)) };
+            }
+#endif
+
+            bool isPolynomial(EaseType type) {
+                return type >= EaseType::Linear && type <= EaseType::QuintInOut
+                    && type != EaseType::SineIn && type != EaseType::SineOut && type != EaseType::SineInOut;
+            }
+
+            template<class V>
+            V polynomial(EaseType type, V p) {
+                V const one = splat(1.0f, p);
+                V const two = splat(2.0f, p);
+                V const half = splat(0.5f, p);
+                V const t = p * two;            // InOut 的前半段/后半段
+                V const u = p - one;            // Out: time / duration - 1
+                V const w = t - two;            // InOut 后半段
+                switch (type) {
+                case EaseType::QuadIn:      return p * p;
+                case EaseType::QuadOut:     return p * (two - p);
+                case EaseType::QuadInOut: {
+                    V const v = t - one;
+                    return select_lt(t, one, half * t * t, half * (one - v * (v - two)));
+                }
+                case EaseType::CubicIn:     return p * p * p;
+                case EaseType::CubicOut:    return u * u * u + one;
+                case EaseType::CubicInOut:  return select_lt(t, one, half * t * t * t, half * (w * w * w + two));
+                case EaseType::QuartIn:     return p * p * p * p;
+                case EaseType::QuartOut:    return one - u * u * u * u;
+                case EaseType::QuartInOut:  return select_lt(t, one, half * t * t * t * t, half * (two - w * w * w * w));
+                case EaseType::QuintIn:     return p * p * p * p * p;
+                case EaseType::QuintOut:    return u * u * u * u * u + one;
+                case EaseType::QuintInOut:  return select_lt(t, one, half * t * t * t * t * t, half * (w * w * w * w * w + two));
+                default:                    return p; // Linear
+                }
+            }
+
+        }
+
+        bool evaluateBatch(EaseType type, float const* p, float* out, size_t count) {
+            if (!isPolynomial(type)) {
+                return false;
+            }
+            size_t i = 0;
+#if GUI_EASE_SSE2
+            for (; i + 4 <= count; i += 4) {
+                f4 r = polynomial(type, f4{ _mm_loadu_ps(p + i) });
+                _mm_storeu_ps(out + i, r.v);
+            }
+#endif
+            for (; i < count; ++i) {
+                out[i] = polynomial(type, p[i]);
+            }
+            return true;
+        }
+
     }
 
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ease_type.h"
+#include <cstddef>
 
 namespace gui {
 
@@ -8,6 +9,10 @@ namespace gui {
 
         float evaluate(EaseType type, float time, float duration, float overshootOrAmplitude, float period);
 
+        /// 多项式类（Linear/Quad/Cubic/Quart/Quint）批量计算，p = time / duration，结果和 evaluate 一致
+        /// 其它类型不处理，返回 false
+        bool evaluateBatch(EaseType type, float const* p, float* out, size_t count);
+
     }    
 
 }
\ No newline at end of file
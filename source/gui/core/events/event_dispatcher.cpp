@@ -14,40 +14,59 @@ namespace gui {
         , data_(data)
     {}
 
-    EventContext::EventContext(std::string const& event, EventDispatcher* sender, void* data)
+    EventContext::EventContext(EventType type, EventDispatcher* sender, void* data)
         : event_()
         , sender_(sender->getHandle())
         , stopped_(0)
         , defaultPrevented_(0)
         , captureTouch_(1)
         , data_(data)
-        , strEvent_(event)
+        , type_(type)
     {}
 
     // ============= EventBridge =============
 
-    void EventBridge::remove(EventCallback const& cb) {
+    void EventBridge::retire(std::vector<EventCallback>& list, EventCallback const& cb) {
         // 按函数指针比较, std::function 不直接支持 ==, 用地址近似
-        auto it = std::remove_if(dispatchers.begin(), dispatchers.end(),
-            [&](EventCallback const& f) {
-                return f.target_type() == cb.target_type();
-            });
-        dispatchers.erase(it, dispatchers.end());
+        auto match = [&](EventCallback const& f) {
+            return f && f.target_type() == cb.target_type();
+        };
+        if (dispatching) { // 正在派发，下标不能动，先置空
+            for (auto& f : list) {
+                if (match(f)) {
+                    f = nullptr;
+                    retired = true;
+                }
+            }
+            return;
+        }
+        list.erase(std::remove_if(list.begin(), list.end(), match), list.end());
+    }
+
+    void EventBridge::remove(EventCallback const& cb) {
+        retire(dispatchers, cb);
     }
 
     void EventBridge::removeCapture(EventCallback const& cb) {
-        auto it = std::remove_if(captures.begin(), captures.end(),
-            [&](EventCallback const& f) {
-                return f.target_type() == cb.target_type();
-            });
-        captures.erase(it, captures.end());
+        retire(captures, cb);
     }
 
     void EventBridge::fire(EventContext* ctx, bool capture) {
         auto& list = capture ? captures : dispatchers;
-        for (auto& cb : list) {
+        ++dispatching;
+        // 按下标走：回调里加监听会让 vector 扩容，新加的这一轮不调
+        size_t const count = list.size();
+        for (size_t i = 0; i < count; ++i) {
             if (ctx->isStopped()) break;
-            cb(ctx);
+            if (list[i]) {
+                list[i](ctx);
+            }
+        }
+        if (--dispatching == 0 && retired) {
+            auto isNull = [](EventCallback const& f) { return !f; };
+            captures.erase(std::remove_if(captures.begin(), captures.end(), isNull), captures.end());
+            dispatchers.erase(std::remove_if(dispatchers.begin(), dispatchers.end(), isNull), dispatchers.end());
+            retired = false;
         }
     }
 
@@ -57,12 +76,35 @@ namespace gui {
         for (auto* item : callbackItems_) delete item;
     }
 
-    EventBridge& EventDispatcher::getBridge(std::string const& type) {
-        auto it = _bridges.find(type);
-        if (it != _bridges.end()) return it->second;
+    EventBridge& EventDispatcher::getBridge(EventType type) {
         return _bridges[type];
     }
 
+    void EventDispatcher::updateListenerBits() {
+        _listenerBits = 0;
+        for (auto const& [type, bridge] : _bridges) {
+            if (!bridge.isEmpty()) {
+                _listenerBits |= EventBit(type);
+            }
+        }
+    }
+
+    bool EventDispatcher::fireListeners(EventType type, EventContext* ctx, bool capture) {
+        if (!mayListen(type)) {
+            return false;
+        }
+        auto it = _bridges.find(type);
+        if (it == _bridges.end()) {
+            return false;
+        }
+        auto const& list = capture ? it->second.captures : it->second.dispatchers;
+        if (list.empty()) {
+            return false;
+        }
+        it->second.fire(ctx, capture);
+        return true;
+    }
+
     // ---- Value-based (backward compat) ----
 
     void EventDispatcher::addEventListener(Value event, EventCallback const& callback, EventTag tag) {
@@ -105,6 +147,7 @@ namespace gui {
             }
         }
         _bridges.clear();
+        _listenerBits = 0;
     }
 
     bool EventDispatcher::hasEventListener(Value event, EventTag tag) const {
@@ -140,47 +183,79 @@ namespace gui {
         }
     }
 
-    // ---- string-based ----
+    // ---- EventType ----
 
-    void EventDispatcher::addEventListener(std::string const& type, EventCallback callback) {
+    void EventDispatcher::addEventListener(EventType type, EventCallback callback) {
         getBridge(type).add(std::move(callback));
+        _listenerBits |= EventBit(type);
     }
 
-    void EventDispatcher::removeEventListener(std::string const& type, EventCallback callback) {
+    void EventDispatcher::removeEventListener(EventType type, EventCallback const& callback) {
         auto it = _bridges.find(type);
-        if (it != _bridges.end()) it->second.remove(callback);
+        if (it != _bridges.end()) {
+            it->second.remove(callback);
+            updateListenerBits();
+        }
     }
 
-    void EventDispatcher::addCapture(std::string const& type, EventCallback callback) {
+    void EventDispatcher::addCapture(EventType type, EventCallback callback) {
         getBridge(type).addCapture(std::move(callback));
+        _listenerBits |= EventBit(type);
     }
 
-    void EventDispatcher::removeCapture(std::string const& type, EventCallback callback) {
+    void EventDispatcher::removeCapture(EventType type, EventCallback const& callback) {
         auto it = _bridges.find(type);
-        if (it != _bridges.end()) it->second.removeCapture(callback);
+        if (it != _bridges.end()) {
+            it->second.removeCapture(callback);
+            updateListenerBits();
+        }
     }
 
-    bool EventDispatcher::hasEventListener(std::string const& type) const {
+    bool EventDispatcher::hasEventListener(EventType type) const {
+        if (!mayListen(type)) {
+            return false;
+        }
         auto it = _bridges.find(type);
         return it != _bridges.end() && !it->second.isEmpty();
     }
 
-    bool EventDispatcher::dispatchEvent(std::string const& type, void* data) {
+    bool EventDispatcher::dispatchEvent(EventType type, void* data) {
+        if (!mayListen(type)) {
+            return false;
+        }
         EventContext ctx(type, this, data);
         return internalDispatch(type, &ctx);
     }
 
-    bool EventDispatcher::internalDispatch(std::string const& type, EventContext* ctx) {
-        auto it = _bridges.find(type);
-        if (it == _bridges.end() || it->second.isEmpty()) return false;
-        it->second.fire(ctx, false);  // bubble phase
-        return true;
+    bool EventDispatcher::internalDispatch(EventType type, EventContext* ctx) {
+        return fireListeners(type, ctx, false);  // bubble phase
     }
 
-    bool EventDispatcher::bubbleEvent(std::string const& type, void* data) {
-        EventContext ctx(type, this, data);
+    bool EventDispatcher::bubbleEvent(EventType type, void* data) {
         // base implementation: just dispatch on self
-        return internalDispatch(type, &ctx);
+        return dispatchEvent(type, data);
+    }
+
+    // ---- string-based ----
+
+    void EventDispatcher::removeEventListener(std::string const& type, EventCallback const& callback) {
+        removeEventListener(GetNamePool().find(type), callback);
+    }
+
+    void EventDispatcher::removeCapture(std::string const& type, EventCallback const& callback) {
+        removeCapture(GetNamePool().find(type), callback);
+    }
+
+    bool EventDispatcher::hasEventListener(std::string const& type) const {
+        return hasEventListener(GetNamePool().find(type));
+    }
+
+    bool EventDispatcher::dispatchEvent(std::string const& type, void* data) {
+        return dispatchEvent(GetNamePool().find(type), data);
+    }
+
+    bool EventDispatcher::bubbleEvent(std::string const& type, void* data) {
+        return bubbleEvent(GetNamePool().find(type), data);
     }
 
 }
@@ -6,11 +6,26 @@
 #include <string>
 #include <LightWeightCommon/utils/handle.h>
 #include "core/data_types/value.h"
+#include "utils/name_pool.h"
 
 namespace gui {
 
     using namespace comm;
 
+    /// 字符串事件驻留成 name_t，派发、查找、冒泡都只比整数
+    using EventType = name_t;
+
+    /// 常用事件，启动时驻留一次
+    struct EventTypes {
+        static inline EventType const TouchBegin = InternName("onTouchBegin");
+        static inline EventType const Click = InternName("onClick");
+        static inline EventType const RollOver = InternName("onRollOver");
+        static inline EventType const RollOut = InternName("onRollOut");
+        static inline EventType const GearStop = InternName("onGearStop");
+        static inline EventType const AddedToStage = InternName("AddedToStage");
+        static inline EventType const RemoveFromStage = InternName("RemoveFromStage");
+    };
+
     class EventContext {
     private:
         Value               event_;
@@ -22,31 +37,37 @@ namespace gui {
         Value               dataValue_;
     public:
         EventContext(Value event, EventDispatcher* sender, void* data);
-        EventContext(std::string const& event, EventDispatcher* sender, void* data);
+        EventContext(EventType type, EventDispatcher* sender, void* data);
 
         Value event() const { return event_; }
-        std::string const& strEvent() const { return strEvent_; }
+        EventType type() const { return type_; }
+        std::string const& strEvent() const { return NameString(type_); }
         void* data() const { return data_; }
         void stopPropagation() { stopped_ = 1; }
         bool isStopped() const { return stopped_; }
 
     private:
-        std::string         strEvent_;   // 字符串类型事件
+        EventType           type_ = EmptyName;   // 字符串类型事件
     };
 
     using EventCallback = std::function<void(EventContext* context)>;
 
     /// 单个事件类型的回调集合 (Capture + Bubble)
+    /// 派发中删除的回调只置空，派发完再压缩；派发中新加的这一轮不调用
     struct EventBridge {
         std::vector<EventCallback> captures;
         std::vector<EventCallback> dispatchers;
+        uint32_t                   dispatching = 0;
+        bool                       retired = false;
 
         bool isEmpty() const { return captures.empty() && dispatchers.empty(); }
-        void add(EventCallback const& cb) { dispatchers.push_back(cb); }
+        void add(EventCallback cb) { dispatchers.push_back(std::move(cb)); }
         void remove(EventCallback const& cb);
-        void addCapture(EventCallback const& cb) { captures.push_back(cb); }
+        void addCapture(EventCallback cb) { captures.push_back(std::move(cb)); }
         void removeCapture(EventCallback const& cb);
         void fire(EventContext* ctx, bool capture);
+    private:
+        void retire(std::vector<EventCallback>& list, EventCallback const& cb);
     };
 
     class EventTag {
@@ -72,16 +93,24 @@ namespace gui {
     private:
         ObjectHandle                            handle_;
         std::vector<EventCallbackItem*>         callbackItems_;    // Value-based (backward compat)
-        std::unordered_map<std::string, EventBridge>  _bridges;
+        std::unordered_map<EventType, EventBridge>  _bridges;
+        uint64_t                                _listenerBits = 0; // 有监听的事件 EventBit 的并集，派发/冒泡先测这个
 
-        bool internalDispatch(std::string const& type, EventContext* ctx);
+        bool internalDispatch(EventType type, EventContext* ctx);
         void cleanRetired();
+        void updateListenerBits();
+        EventBridge& getBridge(EventType type);
 
     public:
         EventDispatcher() = default;
         virtual ~EventDispatcher();
 
-        EventBridge& getBridge(std::string const& type);
+        static uint64_t EventBit(EventType type) { return 1ull << (type & 63); }
+        /// 可能有这个事件的监听（按位近似，可能误判为有，不会漏）
+        bool mayListen(EventType type) const { return (_listenerBits & EventBit(type)) != 0; }
+
+        /// 触发这个对象上 type 的 capture 或 bubble 回调，没有监听返回 false
+        bool fireListeners(EventType type, EventContext* ctx, bool capture);
 
         // ---- Value-based (backward compat) ----
         void addEventListener(Value event, EventCallback const& callback, EventTag tag = EventTag());
@@ -90,19 +119,29 @@ namespace gui {
         bool hasEventListener(Value event, EventTag tag = EventTag()) const;
         bool dispatchEvent(Value event, void* data = nullptr, Value dataValue = Value());
 
-        // ---- string-based (FairyGUI 主线) ----
-        void addEventListener(std::string const& type, EventCallback callback);
-        void addEventListener(const char* type, EventCallback callback) { addEventListener(std::string(type), std::move(callback)); }
-        void removeEventListener(std::string const& type, EventCallback callback);
-        void addCapture(std::string const& type, EventCallback callback);
-        void removeCapture(std::string const& type, EventCallback callback);
-        bool hasEventListener(std::string const& type) const;
-        bool dispatchEvent(std::string const& type, void* data = nullptr);
-        bool dispatchEvent(const char* type, void* data = nullptr) { return dispatchEvent(std::string(type), data); }
+        // ---- EventType (FairyGUI 主线) ----
+        void addEventListener(EventType type, EventCallback callback);
+        void removeEventListener(EventType type, EventCallback const& callback);
+        void addCapture(EventType type, EventCallback callback);
+        void removeCapture(EventType type, EventCallback const& callback);
+        bool hasEventListener(EventType type) const;
+        bool dispatchEvent(EventType type, void* data = nullptr);
 
         /// Bubble: 从当前对象沿父链向上冒泡，每层先 capture 再 dispatch
-        virtual bool bubbleEvent(std::string const& type, void* data = nullptr);
-        bool bubbleEvent(const char* type, void* data = nullptr) { return bubbleEvent(std::string(type), data); }
+        virtual bool bubbleEvent(EventType type, void* data = nullptr);
+
+        // ---- 字符串版本：注册时驻留，派发/查询只查不插（没驻留过说明没人监听） ----
+        void addEventListener(std::string const& type, EventCallback callback) { addEventListener(InternName(type), std::move(callback)); }
+        void addEventListener(const char* type, EventCallback callback) { addEventListener(InternName(type), std::move(callback)); }
+        void removeEventListener(std::string const& type, EventCallback const& callback);
+        void addCapture(std::string const& type, EventCallback callback) { addCapture(InternName(type), std::move(callback)); }
+        void removeCapture(std::string const& type, EventCallback const& callback);
+        bool hasEventListener(std::string const& type) const;
+        bool hasEventListener(const char* type) const { return hasEventListener(GetNamePool().find(type)); }
+        bool dispatchEvent(std::string const& type, void* data = nullptr);
+        bool dispatchEvent(const char* type, void* data = nullptr) { return dispatchEvent(GetNamePool().find(type), data); }
+        bool bubbleEvent(std::string const& type, void* data = nullptr);
+        bool bubbleEvent(const char* type, void* data = nullptr) { return bubbleEvent(GetNamePool().find(type), data); }
 
         Handle getHandle() { return handle_.handle(); }
     };
@@ -1,4 +1,5 @@
 #include "font_manager.h"
+#include <ugi/multithread/worker_pool.h>
 #include <ugi/device.h>
 #include <ugi/texture.h>
 #include <ugi/buffer.h>
@@ -10,6 +11,7 @@
 #include <cstring>
 #include <cmath>
 #include <cassert>
+#include <algorithm>
 
 #define STB_TRUETYPE_IMPLEMENTATION
 #include <stb_truetype.h>
@@ -18,6 +20,12 @@ namespace gui {
 
     FontManager::~FontManager() {
         // _texArray 由 UGI 管理，不在此释放
+        if (_bakeWorkers) {
+            _bakeWorkers->waitIdle();
+            _bakeWorkers->destroy();
+            delete _bakeWorkers;
+            _bakeWorkers = nullptr;
+        }
     }
 
     bool FontManager::initialize(ugi::Device* device, ugi::GPUAsyncLoadManager* asyncMgr, Config const& cfg) {
@@ -25,8 +33,11 @@ namespace gui {
         _asyncLoadMgr = asyncMgr;
         _cfg = cfg;
 
-        _tilesPerRow    = _cfg.atlasSize / _cfg.tileSize;
-        _tilesPerLayer  = _tilesPerRow * _tilesPerRow;
+        _atlas.initialize(_cfg.atlasSize, _cfg.maxLayers);
+        if (_cfg.bakeThreads && !_bakeWorkers) {
+            _bakeWorkers = new ugi::WorkerPool();
+            _bakeWorkers->initialize(_cfg.bakeThreads);
+        }
 
         // 创建纹理数组
         ugi::tex_desc_t desc;
@@ -62,30 +73,74 @@ namespace gui {
         auto it = _glyphCache.find(key);
         if (it != _glyphCache.end()) {
             _lruList.splice(_lruList.begin(), _lruList, it->second);
-            return it->second->second;
+            return it->second->second.info;
         }
 
-        // 未命中 → stb 生成 SDF
-        GlyphInfo info;
-        if (!generateGlyph(fontID, charCode, info)) {
+        // 未命中 → stb 生成 SDF，图集不够时里面会淘汰旧字形
+        CachedGlyph glyph;
+        if (!generateGlyph(fontID, charCode, glyph)) {
             return GlyphInfo{};
         }
 
-        // 缓存满了 → 淘汰最久未使用的
-        if (_glyphCache.size() >= kMaxCacheSize) {
-            auto& lruEntry = _lruList.back();
-            _glyphCache.erase(lruEntry.first);
-            _lruList.pop_back();
-        }
-
         // 插入缓存 (最前 = MRU)
-        _lruList.emplace_front(key, info);
+        _lruList.emplace_front(key, glyph);
         _glyphCache[key] = _lruList.begin();
 
-        return info;
+        return glyph.info;
+    }
+
+    void FontManager::evictGlyph(LruIter it) {
+        auto const& rect = it->second.rect;
+        // 同一帧刚生成还没上传的，上传也一起取消，免得和新分到这里的字形写同一块
+        std::erase_if(_pendingUploads, [&](UploadItem const& up) {
+            return up.rect.layer == rect.layer && up.rect.x == rect.x && up.rect.y == rect.y;
+        });
+        _atlas.free(rect);
+        _glyphCache.erase(it->first);
+        _lruList.erase(it);
+        ++_atlasGeneration;
+    }
+
+    void FontManager::evictLayer(uint32_t layer) {
+        for (auto it = _lruList.begin(); it != _lruList.end();) {
+            if (it->second.rect.layer == layer) {
+                _glyphCache.erase(it->first);
+                it = _lruList.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        std::erase_if(_pendingUploads, [&](UploadItem const& up) { return up.rect.layer == layer; });
+        _atlas.resetLayer(layer);
+        ++_atlasGeneration;
+    }
+
+    bool FontManager::allocateGlyphRect(uint32_t width, uint32_t height, atlas_rect_t& outRect) {
+        if (_atlas.allocate(width, height, outRect)) {
+            return true;
+        }
+        // 1. 从最久没用的开始挤，腾出来的地方放得下就停
+        for (uint32_t i = 0; i < kMaxEvictPerGlyph && _lruList.size(); ++i) {
+            evictGlyph(std::prev(_lruList.end()));
+            if (_atlas.allocate(width, height, outRect)) {
+                return true;
+            }
+        }
+        // 2. 还放不下说明碎得厉害，占用最低的那层整层回收，层上的字形用到时再重新生成
+        if (!_atlas.layerCount()) {
+            return false;
+        }
+        uint32_t emptiest = 0;
+        for (uint32_t layer = 1; layer < _atlas.layerCount(); ++layer) {
+            if (_atlas.occupancy(layer) < _atlas.occupancy(emptiest)) {
+                emptiest = layer;
+            }
+        }
+        evictLayer(emptiest);
+        return _atlas.allocate(width, height, outRect);
     }
 
-    bool FontManager::generateGlyph(int fontID, uint32_t charCode, GlyphInfo& outInfo) {
+    bool FontManager::generateGlyph(int fontID, uint32_t charCode, CachedGlyph& out) {
         if (fontID < 0 || fontID >= (int)_fonts.size()) return false;
 
         auto& font = _fonts[fontID];
@@ -107,36 +162,51 @@ namespace gui {
             ratio = (float)_cfg.tileSize / (maxDim + _cfg.extraBorder * 2);
         }
 
-        auto sdfBuf = stbtt_GetCodepointSDF(&font.info, scale * rs, charCode,
-            (int)_cfg.extraBorder, 128, (float)_cfg.searchDistance / rs,
-            &bmpW, &bmpH, &offX, &offY);
-        if (!sdfBuf) return false;
-
-        // 分配 tile
-        uint32_t tileIdx = _nextTile++;
-        uint32_t layer  = tileIdx / _tilesPerLayer;
-        uint32_t local  = tileIdx % _tilesPerLayer;
-        uint32_t row    = local / _tilesPerRow;
-        uint32_t col    = local % _tilesPerRow;
+        // 主线程只算尺寸和度量，SDF 本身可以晚点再有
+        float sdfScale = scale * rs;
+        float distScale = (float)_cfg.searchDistance / rs;
+        if (!GlyphSDFBox(font.info, charCode, sdfScale, (int)_cfg.extraBorder, bmpW, bmpH, offX, offY)) {
+            return false;
+        }
 
-        if (layer >= _cfg.maxLayers) {
-            stbtt_FreeSDF(sdfBuf, nullptr);
+        // 按实际位图尺寸（加 padding）在图集里分一块
+        atlas_rect_t rect;
+        if (!allocateGlyphRect(bmpW + kGlyphPadding * 2, bmpH + kGlyphPadding * 2, rect)) {
             return false;
         }
 
-        // CPU 缓冲区暂存，记录给 tickUpload 用
-        uint32_t bufOff = (uint32_t)_uploadBuffer.size();
-        size_t copySize = (size_t)bmpW * bmpH;
-        _uploadBuffer.resize(bufOff + copySize);
-        memcpy(_uploadBuffer.data() + bufOff, sdfBuf, copySize);
-        stbtt_FreeSDF(sdfBuf, nullptr);
+        // padding 一起上传，先整块清零，把这块原来的内容清掉；后台烘焙期间这个字就是透明的
+        uint8_t* pixels = queueUpload(rect);
+        if (_bakeWorkers) {
+            if (++_bakeSerial == 0) { // 0 留给“已就绪”
+                ++_bakeSerial;
+            }
+            out.bakeSerial = _bakeSerial;
+            GlyphKey key{uint16_t(fontID), uint16_t(charCode)};
+            _bakeWorkers->post([this, info = font.info, key, serial = out.bakeSerial, rect, sdfScale, distScale]() {
+                thread_local sdf_scratch_t scratch;
+                BakedGlyph baked{ key, serial, rect, std::vector<uint8_t>((size_t)rect.width * rect.height, 0) };
+                uint8_t* dst = baked.pixels.data() + kGlyphPadding * rect.width + kGlyphPadding;
+                if (!BakeGlyphSDF(info, key.charCode, sdfScale, (int)_cfg.extraBorder, 128, distScale, dst, (int)rect.width, scratch)) {
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(_bakeMutex);
+                _bakedGlyphs.push_back(std::move(baked));
+            });
+        } else {
+            BakeGlyphSDF(font.info, charCode, sdfScale, (int)_cfg.extraBorder, 128, distScale,
+                         pixels + kGlyphPadding * rect.width + kGlyphPadding, (int)rect.width, _scratch);
+            out.bakeSerial = 0;
+        }
 
-        outInfo.glyphIndex     = tileIdx;
+        auto& outInfo = out.info;
+        out.rect = rect;
+        outInfo.glyphIndex     = (uint32_t)stbtt_FindGlyphIndex(&font.info, charCode);
         outInfo.bitmapWidth    = bmpW;
         outInfo.bitmapHeight   = bmpH;
-        outInfo.bitmapLayer    = layer;
-        outInfo.bitmapOffsetX  = (int32_t)(col * _cfg.tileSize);
-        outInfo.bitmapOffsetY  = (int32_t)(row * _cfg.tileSize);
+        outInfo.bitmapLayer    = rect.layer;
+        outInfo.bitmapOffsetX  = (int32_t)(rect.x + kGlyphPadding);
+        outInfo.bitmapOffsetY  = (int32_t)(rect.y + kGlyphPadding);
 
         outInfo.bitmapBearingX = (float)offX;
         outInfo.bitmapBearingY = (float)offY;
@@ -144,22 +214,56 @@ namespace gui {
         outInfo.SDFScale       = ratio;
 
         float texSize = (float)_cfg.atlasSize;
-        outInfo.texU = (col * _cfg.tileSize) / texSize;
-        outInfo.texV = (row * _cfg.tileSize) / texSize;
+        outInfo.texU = (float)rect.layer + outInfo.bitmapOffsetX / texSize;
+        outInfo.texV = outInfo.bitmapOffsetY / texSize;
         outInfo.texW = (float)bmpW / texSize;
         outInfo.texH = (float)bmpH / texSize;
 
-        // 记下给 tickUpload，值语义，生命周期随 vector
-        _pendingUploads.push_back({bufOff, outInfo});
-
         return true;
     }
 
+    uint8_t* FontManager::queueUpload(atlas_rect_t const& rect) {
+        uint32_t bufOff = (uint32_t)_uploadBuffer.size();
+        _uploadBuffer.resize(bufOff + (size_t)rect.width * rect.height, 0);
+        _pendingUploads.push_back({bufOff, rect});
+        return _uploadBuffer.data() + bufOff;
+    }
+
+    void FontManager::collectBakedGlyphs() {
+        std::vector<BakedGlyph> baked;
+        {
+            std::lock_guard<std::mutex> lock(_bakeMutex);
+            baked.swap(_bakedGlyphs);
+        }
+        for (auto& glyph : baked) {
+            // 烘焙期间被淘汰了（或者淘汰后又重新生成了一次）就丢掉
+            auto it = _glyphCache.find(glyph.key);
+            if (it == _glyphCache.end() || it->second->second.bakeSerial != glyph.serial) {
+                continue;
+            }
+            it->second->second.bakeSerial = 0;
+            auto const& rect = glyph.rect;
+            // 清零的那次上传还没提交就直接覆盖，避免同一批里两个 region 写同一块
+            auto up = std::find_if(_pendingUploads.begin(), _pendingUploads.end(), [&](UploadItem const& item) {
+                return item.rect.layer == rect.layer && item.rect.x == rect.x && item.rect.y == rect.y;
+            });
+            uint8_t* dst = up != _pendingUploads.end() ? _uploadBuffer.data() + up->bufferOffset : queueUpload(rect);
+            memcpy(dst, glyph.pixels.data(), glyph.pixels.size());
+        }
+    }
+
     void FontManager::tickUpload(ugi::Device* device) {
-        if (_pendingUploads.empty()) return;
+        collectBakedGlyphs();
+        if (_pendingUploads.empty()) {
+            _uploadBuffer.clear(); // 可能全被淘汰取消了
+            return;
+        }
 
         size_t bufSize = _uploadBuffer.size();
         auto staging = device->createBuffer(ugi::BufferType::StagingBuffer, (uint32_t)bufSize);
+        if (!staging) {
+            return; // 保留待上传的字形，下一帧重试
+        }
         void* ptr = staging->map(device);
         memcpy(ptr, _uploadBuffer.data(), bufSize);
         staging->unmap(device);
@@ -168,13 +272,13 @@ namespace gui {
         std::vector<uint32_t> offsets;
         std::vector<ugi::image_region_t> regions;
         for (auto& up : _pendingUploads) {
-            auto& gi = up.glyph;
+            auto& rc = up.rect;
             ugi::image_region_t r;
             r.mipLevel    = 0;
-            r.arrayIndex  = gi.bitmapLayer;
+            r.arrayIndex  = rc.layer;
             r.arrayCount  = 1;
-            r.offset      = { gi.bitmapOffsetX, gi.bitmapOffsetY, 0 };
-            r.extent      = { gi.bitmapWidth, gi.bitmapHeight, 1 };
+            r.offset      = { (int32_t)rc.x, (int32_t)rc.y, 0 };
+            r.extent      = { rc.width, rc.height, 1 };
             regions.push_back(r);
             offsets.push_back(up.bufferOffset);
         }
@@ -190,13 +294,6 @@ namespace gui {
         }
         cb->endEncode();
 
-        auto fence = device->createFence();
-        {
-            ugi::QueueSubmitInfo si(&cb, 1, nullptr, 0, nullptr, 0);
-            ugi::QueueSubmitBatchInfo sb(&si, 1, fence);
-            queue->submitCommandBuffers(sb);
-        }
-
         auto onComplete = [](ugi::Device* dev, ugi::Buffer* stg, ugi::CommandBuffer* tcb,
                               ugi::CommandQueue* q) {
             q->destroyCommandBuffer(dev, tcb);
@@ -204,8 +301,12 @@ namespace gui {
         };
         using namespace std::placeholders;
         auto binder = std::bind(onComplete, device, staging, cb, queue);
-        ugi::GPUAsyncLoadItem item(device, fence, binder);
-        _asyncLoadMgr->registerAsyncLoad(std::move(item));
+        if (!_asyncLoadMgr->submitAsyncLoad(device, queue, cb, binder)) {
+            // 提交失败回调不会被调用，cb 和 staging 在这里归还，待上传的字形留到下一帧重试
+            queue->destroyCommandBuffer(device, cb);
+            device->destroyBuffer(staging);
+            return;
+        }
 
         _pendingUploads.clear();
         _uploadBuffer.clear();
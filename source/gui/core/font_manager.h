@@ -6,13 +6,17 @@
 #include <list>
 #include <string>
 #include <functional>
+#include <mutex>
 #include <stb_truetype.h>
 #include <utils/singleton.h>
+#include "glyph_atlas.h"
+#include "glyph_sdf.h"
 
 namespace ugi {
     class Device;
     class Texture;
     class GPUAsyncLoadManager;
+    class WorkerPool;
 }
 
 namespace gui {
@@ -20,8 +24,8 @@ namespace gui {
     /// SDF 字形图集单个 tile 的信息
     struct GlyphInfo {
         uint32_t glyphIndex = 0;
-        int32_t  bitmapOffsetX = 0;   // tile 在纹理层内的 X 偏移
-        int32_t  bitmapOffsetY = 0;   // tile 在纹理层内的 Y 偏移
+        int32_t  bitmapOffsetX = 0;   // 位图在纹理层内的 X 偏移
+        int32_t  bitmapOffsetY = 0;   // 位图在纹理层内的 Y 偏移
         uint32_t bitmapWidth  = 0;
         uint32_t bitmapHeight = 0;
         uint32_t bitmapLayer  = 0;    // 纹理数组层索引
@@ -31,7 +35,7 @@ namespace gui {
         float bitmapAdvance  = 0;     // 水平推进量
         float SDFScale       = 1.0f;  // 缩放系数
 
-        // UV 坐标 (归一化到 [0,1])
+        // UV 坐标 (归一化到 [0,1])，texU 的整数部分是纹理层号，shader 里拆出来
         float texU = 0, texV = 0, texW = 0, texH = 0;
     };
 
@@ -72,10 +76,11 @@ namespace gui {
             uint32_t sdfSourceSize   = 64;    // SDF 源字体大小 (px)
             uint32_t extraBorder     = 8;     // SDF 额外边距
             uint32_t searchDistance  = 8;     // SDF 搜索距离
-            uint32_t tileSize        = 64;    // 每 tile 像素尺寸
+            uint32_t tileSize        = 64;    // 单个字形 SDF 位图的最大边长，超过的按比例缩小
             uint32_t atlasSize       = 1024;  // 纹理层边长
             uint32_t maxLayers       = 4;     // 最大纹理数组层数
             float    dpi             = 96.0f; // DPI
+            uint32_t bakeThreads     = 1;     // 后台烘焙 SDF 的线程数，0 = 缺字时当场同步生成
         };
 
     private:
@@ -91,31 +96,53 @@ namespace gui {
         };
         std::vector<FontData>               _fonts;
 
-        // 字形缓存 (LRU, 最多 1024 个)
-        static constexpr size_t                kMaxCacheSize = 1024;
-        using LruEntry = std::pair<GlyphKey, GlyphInfo>;
+        // 字形缓存 (LRU)，数量不设上限，图集放不下了才从最久没用的开始淘汰
+        static constexpr uint32_t              kGlyphPadding = 1;       // 字形四周留的空白，上传时清零，线性采样不会串到邻居
+        static constexpr uint32_t              kMaxEvictPerGlyph = 32;  // 一个新字形最多挤掉几个旧的，还不够就整层回收
+        struct CachedGlyph {
+            GlyphInfo       info;
+            atlas_rect_t    rect;   // 含 padding 的整块区域
+            uint32_t        bakeSerial = 0; // 非 0 表示还在后台烘焙，图集里这块暂时是空的（透明）
+        };
+        using LruEntry = std::pair<GlyphKey, CachedGlyph>;
         using LruIter  = std::list<LruEntry>::iterator;
         std::list<LruEntry>                   _lruList;    // front = MRU, back = LRU
         std::unordered_map<GlyphKey, LruIter> _glyphCache; // key → 在 _lruList 中的位置
+        uint32_t                              _atlasGeneration = 0; // 有字形被淘汰就 +1，外面缓存的 UV 据此作废
 
-        // 图集 tile 分配
-        uint32_t _tilesPerRow = 0;
-        uint32_t _tilesPerLayer = 0;
-        uint32_t _nextTile = 0;     // 下一个可用 tile (0-based)
+        // 图集分配 (每层 shelf 装箱，淘汰时回收)
+        GlyphAtlas                            _atlas;
 
         // 待上传 CPU 缓冲
         std::vector<uint8_t>                 _uploadBuffer;
         struct UploadItem {
-            uint32_t  bufferOffset;
-            GlyphInfo glyph;  // 值语义，生命周期随 vector
+            uint32_t      bufferOffset;
+            atlas_rect_t  rect;
         };
         std::vector<UploadItem>              _pendingUploads;
 
-        // 字形 SDF 生成，成功返回 true 并填充 outInfo
-        bool generateGlyph(int fontID, uint32_t charCode, GlyphInfo& outInfo);
-        void signedDistanceField(uint8_t* src, int sw, int sh,
-                                 uint8_t* dst, int dw, int dh);
-        bool uploadPending(ugi::Device* device);
+        // 后台烘焙：缺字时主线程只算度量、分图集，SDF 交给工作线程，做完的在 tickUpload 里收
+        struct BakedGlyph {
+            GlyphKey              key;
+            uint32_t              serial;
+            atlas_rect_t          rect;
+            std::vector<uint8_t>  pixels;   // rect 大小，含 padding
+        };
+        ugi::WorkerPool*                     _bakeWorkers = nullptr;
+        std::mutex                           _bakeMutex;
+        std::vector<BakedGlyph>              _bakedGlyphs;  // 工作线程做完的，_bakeMutex 保护
+        uint32_t                             _bakeSerial = 0;
+        sdf_scratch_t                        _scratch;      // 同步生成时用
+
+        // 字形生成，成功返回 true 并填充 out；后台烘焙时 SDF 稍后才到，度量和 UV 是马上就定的
+        bool generateGlyph(int fontID, uint32_t charCode, CachedGlyph& out);
+        // 在上传缓冲里给 rect 占一块（清零），返回写入位置，下次 queueUpload 之前有效
+        uint8_t* queueUpload(atlas_rect_t const& rect);
+        void collectBakedGlyphs();
+        // 图集里分一块，不够就淘汰 LRU，再不够就把占用最低的一层整层回收（碎片整理）
+        bool allocateGlyphRect(uint32_t width, uint32_t height, atlas_rect_t& outRect);
+        void evictGlyph(LruIter it);
+        void evictLayer(uint32_t layer);
 
     private:
         FontManager() = default;
@@ -131,7 +158,7 @@ namespace gui {
         /// 获取字形信息 (首次请求时自动生成 SDF)，返回拷贝，调用方用完即弃
         GlyphInfo getGlyph(int fontID, uint32_t charCode);
 
-        /// 上传所有待处理字形到 GPU (每帧调用，无新数据则为空操作)
+        /// 收下后台烘焙好的字形，上传所有待处理字形到 GPU (每帧调用，无新数据则为空操作)
         void tickUpload(ugi::Device* device);
 
         /// 获取 SDF 纹理数组
@@ -140,6 +167,9 @@ namespace gui {
         /// 获取配置
         Config const& config() const { return _cfg; }
 
+        /// 字形被淘汰后会在别的位置重新生成，外部缓存字形 UV 的（排版缓存）比较这个值决定是否作废
+        uint32_t atlasGeneration() const { return _atlasGeneration; }
+
         /// 获取字体度量 (按指定字号)
         FontMetrics getMetrics(int fontID, float fontSize) const;
     };
@@ -0,0 +1,143 @@
+#include "glyph_atlas.h"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace gui {
+
+    void GlyphAtlas::initialize(uint32_t size, uint32_t layerCount) {
+        _size = size;
+        _layers.clear();
+        _layers.resize(layerCount);
+    }
+
+    bool GlyphAtlas::fits(shelf_t const& shelf, uint32_t width) const {
+        if (shelf.cursor + width <= _size) {
+            return true;
+        }
+        for (auto const& span : shelf.freeSpans) {
+            if (span.width >= width) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t GlyphAtlas::take(shelf_t& shelf, uint32_t width) {
+        ++shelf.glyphCount;
+        // 先用回收的区间（first-fit），最后才动 cursor
+        for (auto it = shelf.freeSpans.begin(); it != shelf.freeSpans.end(); ++it) {
+            if (it->width >= width) {
+                uint32_t x = it->x;
+                it->x += width;
+                it->width -= width;
+                if (!it->width) {
+                    shelf.freeSpans.erase(it);
+                }
+                return x;
+            }
+        }
+        uint32_t x = shelf.cursor;
+        shelf.cursor += width;
+        return x;
+    }
+
+    bool GlyphAtlas::allocate(uint32_t width, uint32_t height, atlas_rect_t& out) {
+        if (!width || !height || width > _size || height > _size) {
+            return false;
+        }
+        uint32_t shelfHeight = (height + ShelfAlign - 1) / ShelfAlign * ShelfAlign;
+        shelfHeight = std::min(shelfHeight, _size);
+        // 1. 已有的 shelf 里挑高度最接近的；有字形的 shelf 高出一半以上就不要了，太浪费，空 shelf 不限
+        shelf_t* best = nullptr;
+        uint32_t bestLayer = 0;
+        uint32_t bestHeight = std::numeric_limits<uint32_t>::max();
+        for (uint32_t layer = 0; layer < _layers.size(); ++layer) {
+            for (auto& shelf : _layers[layer].shelves) {
+                if (shelf.height < height || shelf.height >= bestHeight) {
+                    continue;
+                }
+                if (shelf.glyphCount && shelf.height > shelfHeight + shelfHeight / 2) {
+                    continue;
+                }
+                if (!fits(shelf, width)) {
+                    continue;
+                }
+                best = &shelf;
+                bestLayer = layer;
+                bestHeight = shelf.height;
+            }
+        }
+        // 2. 没有合适的就在还有剩余高度的层上开一条新的
+        if (!best) {
+            for (uint32_t layer = 0; layer < _layers.size(); ++layer) {
+                auto& l = _layers[layer];
+                if (l.nextY + shelfHeight <= _size) {
+                    l.shelves.push_back({ l.nextY, shelfHeight, 0, 0, {} });
+                    l.nextY += shelfHeight;
+                    best = &l.shelves.back();
+                    bestLayer = layer;
+                    break;
+                }
+            }
+        }
+        if (!best) {
+            return false;
+        }
+        out.layer = bestLayer;
+        out.x = take(*best, width);
+        out.y = best->y;
+        out.width = width;
+        out.height = height;
+        _layers[bestLayer].usedArea += (uint64_t)width * height;
+        return true;
+    }
+
+    void GlyphAtlas::free(atlas_rect_t const& rect) {
+        assert(rect.layer < _layers.size());
+        auto& l = _layers[rect.layer];
+        auto shelfIt = std::find_if(l.shelves.begin(), l.shelves.end(), [&](shelf_t const& s) { return s.y == rect.y; });
+        if (shelfIt == l.shelves.end()) { // 已经 resetLayer 过了
+            return;
+        }
+        auto& shelf = *shelfIt;
+        l.usedArea -= (uint64_t)rect.width * rect.height;
+        if (--shelf.glyphCount == 0) {
+            shelf.freeSpans.clear();
+            shelf.cursor = 0;
+            // 顶上的空 shelf 还给层，下次可以开不同高度的
+            while (l.shelves.size() && l.shelves.back().glyphCount == 0) {
+                l.nextY = l.shelves.back().y;
+                l.shelves.pop_back();
+            }
+            return;
+        }
+        // 插回去并和左右相邻的合并，挨着 cursor 的直接退给 cursor
+        auto& spans = shelf.freeSpans;
+        auto it = std::lower_bound(spans.begin(), spans.end(), rect.x, [](span_t const& s, uint32_t x) { return s.x < x; });
+        it = spans.insert(it, { rect.x, rect.width });
+        if (it + 1 != spans.end() && it->x + it->width == (it + 1)->x) {
+            it->width += (it + 1)->width;
+            spans.erase(it + 1);
+        }
+        if (it != spans.begin() && (it - 1)->x + (it - 1)->width == it->x) {
+            (it - 1)->width += it->width;
+            it = spans.erase(it) - 1;
+        }
+        if (it + 1 == spans.end() && it->x + it->width == shelf.cursor) {
+            shelf.cursor = it->x;
+            spans.erase(it);
+        }
+    }
+
+    void GlyphAtlas::resetLayer(uint32_t layer) {
+        assert(layer < _layers.size());
+        _layers[layer] = layer_t();
+    }
+
+    float GlyphAtlas::occupancy(uint32_t layer) const {
+        assert(layer < _layers.size());
+        return (float)((double)_layers[layer].usedArea / ((double)_size * _size));
+    }
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace gui {
+
+    /// 图集里的一块矩形区域
+    struct atlas_rect_t {
+        uint32_t layer  = 0;
+        uint32_t x      = 0;
+        uint32_t y      = 0;
+        uint32_t width  = 0;
+        uint32_t height = 0;
+    };
+
+    /*
+     *  字形图集分配器，每个纹理层按 shelf（横条）装箱
+     *  1. 按字形实际 SDF 尺寸分配，shelf 高度按 ShelfAlign 对齐，挑高度最接近的 shelf 放，减少浪费
+     *  2. free 把区间还给所在 shelf（相邻的合并），shelf 空了整条重置，顶上的空 shelf 直接退还给层
+     *  3. 只管坐标，不碰纹理，也不知道字形是谁，淘汰策略在 FontManager 里
+     * */
+    class GlyphAtlas {
+    public:
+        static constexpr uint32_t ShelfAlign = 8;
+    private:
+        struct span_t {
+            uint32_t x;
+            uint32_t width;
+        };
+        struct shelf_t {
+            uint32_t            y;
+            uint32_t            height;
+            uint32_t            cursor;         // 右边从来没分出去过的起点
+            uint32_t            glyphCount;
+            std::vector<span_t> freeSpans;      // cursor 左边回收回来的区间，按 x 排序
+        };
+        struct layer_t {
+            std::vector<shelf_t>    shelves;    // 按 y 递增
+            uint32_t                nextY = 0;
+            uint64_t                usedArea = 0;
+        };
+        uint32_t                _size = 0;
+        std::vector<layer_t>    _layers;
+    private:
+        bool fits(shelf_t const& shelf, uint32_t width) const;
+        uint32_t take(shelf_t& shelf, uint32_t width);
+    public:
+        void initialize(uint32_t size, uint32_t layerCount);
+        /// 分配失败返回 false（所有层都放不下），调用方决定淘汰谁再重试
+        bool allocate(uint32_t width, uint32_t height, atlas_rect_t& out);
+        void free(atlas_rect_t const& rect);
+        /// 整层清空，调用方负责把这层上的字形全部作废
+        void resetLayer(uint32_t layer);
+        /// 这一层实际被字形占用的面积比例
+        float occupancy(uint32_t layer) const;
+        uint32_t layerCount() const { return (uint32_t)_layers.size(); }
+        uint32_t size() const { return _size; }
+    };
+
+}
@@ -0,0 +1,139 @@
+#include "glyph_sdf.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GUI_SDF_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace gui {
+
+    namespace {
+
+        constexpr float SDFInf = 1e20f;
+
+        // 一维平方距离变换，grid 里按 stride 取 length 个，原地写回
+        void edt1d(float* grid, int stride, int length, float* f, float* z, int* v) {
+            v[0] = 0;
+            z[0] = -SDFInf;
+            z[1] = SDFInf;
+            f[0] = grid[0];
+            for (int q = 1, k = 0; q < length; ++q) {
+                f[q] = grid[q * stride];
+                float const q2 = (float)(q * q);
+                float s;
+                do {
+                    int const r = v[k];
+                    s = (f[q] - f[r] + q2 - (float)(r * r)) / (float)(q - r) * 0.5f;
+                } while (s <= z[k] && --k > -1);
+                ++k;
+                v[k] = q;
+                z[k] = s;
+                z[k + 1] = SDFInf;
+            }
+            for (int q = 0, k = 0; q < length; ++q) {
+                while (z[k + 1] < (float)q) {
+                    ++k;
+                }
+                int const r = v[k];
+                float const qr = (float)(q - r);
+                grid[q * stride] = f[r] + qr * qr;
+            }
+        }
+
+        void edt2d(float* grid, int width, int height, sdf_scratch_t& scratch) {
+            for (int x = 0; x < width; ++x) {
+                edt1d(grid + x, width, height, scratch.f.data(), scratch.z.data(), scratch.v.data());
+            }
+            for (int y = 0; y < height; ++y) {
+                edt1d(grid + y * width, 1, width, scratch.f.data(), scratch.z.data(), scratch.v.data());
+            }
+        }
+
+    }
+
+    bool GlyphSDFBox(stbtt_fontinfo const& font, uint32_t charCode, float scale, int border,
+                     int& width, int& height, int& offsetX, int& offsetY) {
+        int x0, y0, x1, y1;
+        stbtt_GetCodepointBitmapBox(&font, (int)charCode, scale, scale, &x0, &y0, &x1, &y1);
+        if (x0 == x1 || y0 == y1) {
+            return false;
+        }
+        width = x1 - x0 + border * 2;
+        height = y1 - y0 + border * 2;
+        offsetX = x0 - border;
+        offsetY = y0 - border;
+        return true;
+    }
+
+    void CoverageToSDF(uint8_t const* coverage, int width, int height, uint8_t onEdge, float distScale,
+                       uint8_t* dst, int dstStride, sdf_scratch_t& scratch) {
+        size_t const count = (size_t)width * height;
+        size_t const lineMax = (size_t)std::max(width, height);
+        scratch.outer.resize(count);
+        scratch.inner.resize(count);
+        scratch.f.resize(lineMax);
+        scratch.z.resize(lineMax + 1);
+        scratch.v.resize(lineMax);
+        float* outer = scratch.outer.data();
+        float* inner = scratch.inner.data();
+        // 1. 初始距离：全覆盖在里面，全空在外面，半覆盖的按 0.5 - a 估一个到边缘的距离
+        for (size_t i = 0; i < count; ++i) {
+            uint8_t const c = coverage[i];
+            if (c == 0) {
+                outer[i] = SDFInf;
+                inner[i] = 0.0f;
+            } else if (c == 255) {
+                outer[i] = 0.0f;
+                inner[i] = SDFInf;
+            } else {
+                float const d = 0.5f - c * (1.0f / 255.0f);
+                outer[i] = d > 0.0f ? d * d : 0.0f;
+                inner[i] = d < 0.0f ? d * d : 0.0f;
+            }
+        }
+        edt2d(outer, width, height, scratch);
+        edt2d(inner, width, height, scratch);
+        // 2. 有符号距离 = sqrt(inner) - sqrt(outer)，映射到 [0, 255]
+        for (int y = 0; y < height; ++y) {
+            float const* o = outer + (size_t)y * width;
+            float const* in = inner + (size_t)y * width;
+            uint8_t* out = dst + (size_t)y * dstStride;
+            int x = 0;
+#if GUI_SDF_SSE2
+            __m128 const edge = _mm_set1_ps((float)onEdge);
+            __m128 const scale = _mm_set1_ps(distScale);
+            __m128 const lo = _mm_setzero_ps();
+            __m128 const hi = _mm_set1_ps(255.0f);
+            for (; x + 4 <= width; x += 4) {
+                __m128 const sd = _mm_sub_ps(_mm_sqrt_ps(_mm_loadu_ps(in + x)), _mm_sqrt_ps(_mm_loadu_ps(o + x)));
+                __m128 const val = _mm_min_ps(_mm_max_ps(_mm_add_ps(edge, _mm_mul_ps(scale, sd)), lo), hi);
+                __m128i const i32 = _mm_cvttps_epi32(val);
+                __m128i const i16 = _mm_packs_epi32(i32, i32);
+                int const packed = _mm_cvtsi128_si32(_mm_packus_epi16(i16, i16));
+                memcpy(out + x, &packed, 4);
+            }
+#endif
+            for (; x < width; ++x) {
+                float const sd = std::sqrt(in[x]) - std::sqrt(o[x]);
+                out[x] = (uint8_t)std::clamp(onEdge + distScale * sd, 0.0f, 255.0f);
+            }
+        }
+    }
+
+    bool BakeGlyphSDF(stbtt_fontinfo const& font, uint32_t charCode, float scale, int border,
+                      uint8_t onEdge, float distScale, uint8_t* dst, int dstStride, sdf_scratch_t& scratch) {
+        int width, height, offsetX, offsetY;
+        if (!GlyphSDFBox(font, charCode, scale, border, width, height, offsetX, offsetY)) {
+            return false;
+        }
+        scratch.coverage.assign((size_t)width * height, 0);
+        stbtt_MakeCodepointBitmap(&font, scratch.coverage.data() + (size_t)border * width + border,
+                                  width - border * 2, height - border * 2, width, scale, scale, (int)charCode);
+        CoverageToSDF(scratch.coverage.data(), width, height, onEdge, distScale, dst, dstStride, scratch);
+        return true;
+    }
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <stb_truetype.h>
+
+namespace gui {
+
+    /// 每个线程一份，反复烘焙的时候不用重新分配
+    struct sdf_scratch_t {
+        std::vector<uint8_t>    coverage;
+        std::vector<float>      outer;      // 到字形里面的距离平方
+        std::vector<float>      inner;      // 到字形外面的距离平方
+        std::vector<float>      f;
+        std::vector<float>      z;
+        std::vector<int>        v;
+    };
+
+    /// 和 stbtt_GetCodepointSDF 一样的包围盒（含 border），空字形返回 false
+    bool GlyphSDFBox(stbtt_fontinfo const& font, uint32_t charCode, float scale, int border,
+                     int& width, int& height, int& offsetX, int& offsetY);
+
+    /*
+     *  覆盖率位图 → SDF，线性时间的欧氏距离变换 (Felzenszwalb-Huttenlocher，行列各做一遍一维变换)
+     *  边缘上半透明的像素按覆盖率给一个亚像素的初始距离，不用再做超采样
+     *  输出 dst = clamp(onEdge + distScale * 有符号距离)，里面为正，和 stbtt_GetCodepointSDF 的约定一致
+     * */
+    void CoverageToSDF(uint8_t const* coverage, int width, int height, uint8_t onEdge, float distScale,
+                       uint8_t* dst, int dstStride, sdf_scratch_t& scratch);
+
+    /// 光栅化 + CoverageToSDF，dst 至少 GlyphSDFBox 给出的大小；只读 font，可以在工作线程调用
+    bool BakeGlyphSDF(stbtt_fontinfo const& font, uint32_t charCode, float scale, int border,
+                      uint8_t onEdge, float distScale, uint8_t* dst, int dstStride, sdf_scratch_t& scratch);
+
+}
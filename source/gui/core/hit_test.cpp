@@ -1,6 +1,7 @@
 #include "hit_test.h"
 #include <utils/byte_buffer.h>
 #include <core/ui/object.h>
+#include <cmath>
 
 namespace gui {
 
@@ -10,6 +11,7 @@ namespace gui {
         , height(0)
         , scale(0)
         , pixels(nullptr)
+        , length(0)
     {
     }
 
@@ -26,6 +28,7 @@ namespace gui {
         scale = 1.0f / buffer.read<int8_t>();
         auto byteCount = buffer.read<int>();
         height =  byteCount / width;
+        length = byteCount;
         pixels = new uint8_t[byteCount];
         for(uint32_t i = 0; i<byteCount; ++i) {
             pixels[i] = buffer.read<uint8_t>();
@@ -43,21 +46,19 @@ namespace gui {
     }
 
     bool PixelHitTest::hitTest(Component* component, glm::vec2 localPoint) const {
-        return true;
-        // int x = floor((localPoint.x / scaleX - offsetX) * data_->scale);
-        // int y = floor(((component->height() - localPoint.y) / scaleY - offsetY) * _data->scale);
-        // if (x < 0 || y < 0 || x >= _data->pixelWidth)
-        //     return false;
-
-        // ssize_t pos = y * _data->pixelWidth + x;
-        // ssize_t pos2 = pos / 8;
-        // ssize_t pos3 = pos % 8;
-
-        // if (pos2 >= 0 && pos2 < (ssize_t)_data->pixelsLength)
-        //     return ((_data->pixels[pos2] >> pos3) & 0x1) > 0;
-        // else
-        //     return false;
-
+        // UI 坐标 y 向下，和 Unity 版一样不用翻转
+        int x = (int)std::floor((localPoint.x / scaleX - offsetX) * data_->scale);
+        int y = (int)std::floor((localPoint.y / scaleY - offsetY) * data_->scale);
+        if (x < 0 || y < 0 || x >= data_->width) {
+            return false;
+        }
+        int pos = y * data_->width + x;
+        int pos2 = pos / 8;
+        int pos3 = pos % 8;
+        if (pos2 < data_->length) {
+            return ((data_->pixels[pos2] >> pos3) & 0x1) > 0;
+        }
+        return false;
     }
 
 
@@ -15,7 +15,8 @@ namespace gui {
         int         width;
         int         height;
         float       scale;
-        uint8_t*    pixels;
+        uint8_t*    pixels;     // 1 bit 一个像素
+        int         length;     // pixels 的字节数
         //
         void load(ByteBuffer& buffer);
         PixelHitTestData() noexcept;
@@ -12,12 +12,14 @@
 #include <ugi/texture.h>
 #include <ugi/texture_util.h>
 #include <ugi/command_buffer.h>
+#include <ugi/multithread/worker_pool.h>
 //
 #include <io/archive.h>
 #include <log/client_log.h>
 //
 #include <core/package_item.h>
 #include <core/ui/object.h>
+#include <memory>
 
 namespace gui {
 
@@ -29,12 +31,56 @@ namespace gui {
     std::string                                     Package::branch_;
     Texture*                                        Package::emptyTexture_;
     uint32_t                                        Package::moduleInited_;
+    std::mutex                                      Package::archiveMutex_;
 
     namespace {
         uint32_t White2x2Data[] = {
             0xffffffff,0xffffffff,
             0xffffffff,0xffffffff,
         };
+
+        void OnAtlasUploaded(void* res, ugi::CommandBuffer* cmd) {
+            ugi::Texture* tex = (ugi::Texture*)res;
+            tex->generateMipmap(cmd);
+            auto resEnc = cmd->resourceCommandEncoder();
+            resEnc->imageTransitionBarrier(
+                tex, ugi::ResourceAccessType::ShaderRead, 
+                ugi::pipeline_stage_t::Bottom, ugi::StageAccess::Write,
+                ugi::pipeline_stage_t::FragmentShading, ugi::StageAccess::Read,
+                nullptr
+            );
+            resEnc->endEncode();
+        }
+
+        /*
+         *  异步加载的状态
+         *  1. 描述文件在工作线程解析，解析完先把结果交给主线程，再把 atlas 的解码任务投到线程池，
+         *     所以主线程拿到某个 atlas 的解码结果时，一定已经拿到（或者同一批拿到）它的解析结果
+         *  2. package 在主线程注册，纹理在主线程创建，工作线程只碰文件和像素
+         * */
+        struct async_package_load_t {
+            std::string                         assetPath;
+            std::vector<PackageLoadCallback>    callbacks;
+            Package*                            package = nullptr;  // 解析结果，交给主线程后工作线程不再碰
+            std::vector<PackageItem*>           atlases;            // 同上
+            uint32_t                            pendingAtlases = 0; // 主线程：还没回来的解码结果
+            bool                                parsed = false;     // 主线程：已经收到解析结果
+        };
+
+        struct decoded_atlas_t {
+            async_package_load_t*   load;
+            uint32_t                index;      // load->atlases 的下标
+            std::vector<uint8_t>    pixels;     // RGBA8
+            uint32_t                width;
+            uint32_t                height;
+            bool                    ok;
+        };
+
+        ugi::WorkerPool*                                    loadWorkers = nullptr;
+        std::vector<std::unique_ptr<async_package_load_t>>  asyncLoads;     // 主线程
+        std::mutex                                          asyncMutex;
+        std::vector<async_package_load_t*>                  parsedLoads;    // asyncMutex 保护
+        std::vector<decoded_atlas_t>                        decodedAtlases; // asyncMutex 保护
     }
 
 
@@ -71,11 +117,13 @@ namespace gui {
         buffer->seekToBlock(indexTablePos, PackageBlocks::StringTable); {
             count = buffer->read<int>();
             stringTable_.resize(count);
+            nameTable_.resize(count);
             for(int i = 0; i<count; ++i) {
                 stringTable_[i] = buffer->read<std::string>();
+                nameTable_[i] = InternName(stringTable_[i]);
             } 
         }
-        buffer->setStringTable(&stringTable_);
+        buffer->setStringTable(&stringTable_, &nameTable_);
         // read dependences
         buffer->seekToBlock(indexTablePos, PackageBlocks::Dependences); {
             count = buffer->read<int16_t>();
@@ -110,8 +158,8 @@ namespace gui {
             item = new PackageItem();
             item->owner_ = this;
             item->type_ = (PackageItemType)buffer->read<uint8_t>();
-            item->id_ = buffer->read<csref>();
-            item->name_ = buffer->read<csref>();
+            item->id_ = buffer->readName();
+            item->name_ = buffer->readName();
             buffer->skip(2); // ???? what's up!
             item->file_ = buffer->read<csref>();
             buffer->read<bool>(); // no use!
@@ -176,16 +224,15 @@ namespace gui {
             if(v2) { // v2 之后有更多的属于
                 std::string str = buffer->read<csref>(); // 这是分枝信息
                 if(!str.empty()) {
-                    item->name_ = str + "/" + item->name_;
+                    item->name_ = InternName(str + "/" + NameString(item->name_));
                 }
                 auto branchCount = buffer->read<uint8_t>();
                 if(branchCount) {
                     if(branchIncluded) {
-                        item->branches_ = new std::vector<std::string>();
-                        buffer->readRefStringArray(*item->branches_, branchCount);
+                        item->branches_ = new std::vector<name_t>();
+                        buffer->readNameArray(*item->branches_, branchCount);
                     } else {
-                        auto const& key = buffer->read<csref>();
-                        itemsByID_[key] = item;
+                        itemsByID_[buffer->readName()] = item;
                     }
                 }
                 auto highResCount = buffer->read<uint8_t>();
@@ -196,7 +243,7 @@ namespace gui {
             }
             packageItems_.push_back(item);
             itemsByID_[item->id_] = item;
-            if(!item->name_.empty()) {
+            if(item->name_ != EmptyName) {
                 itemsByName_[item->name_] = item;
             }
             buffer->setPos(nextPos);
@@ -207,8 +254,8 @@ namespace gui {
         for(int i = 0; i<count; ++i) {
             int nextPos = buffer->read<uint16_t>();
             nextPos += buffer->pos();
-            auto const& itemID = buffer->read<csref>();
-            item = itemsByID_[buffer->read<csref>()];
+            auto itemID = buffer->readName();
+            item = itemsByID_[buffer->readName()];
             //
             AtlasSprite sprite;
             sprite.item = item;
@@ -236,8 +283,7 @@ namespace gui {
                 int nextPos = buffer->read<int>();
                 nextPos += buffer->pos();
                 //
-                auto const& id = buffer->read<csref>();
-                auto iter = itemsByID_.find(id);
+                auto iter = itemsByID_.find(buffer->readName());
                 if(iter != itemsByID_.end()) {
                     item = iter->second;
                     if(item->type_ == PackageItemType::Image) {
@@ -251,22 +297,24 @@ namespace gui {
         return true;
     }
 
-    Package* Package::AddPackage(std::string const& assetPath) {
-        // if(!CheckModuleInitialized()) {
-        //     assert("not initialized yet!");
-        //     return nullptr;
-        // }
-        auto iter = packageInstByID.find(assetPath);
-        if(iter != packageInstByID.end()) {
-            return iter->second;
-        }
-        auto file = archive_->openIStream(assetPath + "_fui.bytes", {comm::ReadFlag::binary});
+    bool Package::ReadAssetFile(std::string const& path, std::vector<uint8_t>& data) {
+        std::lock_guard<std::mutex> lock(archiveMutex_);
+        auto file = archive_->openIStream(path, {comm::ReadFlag::binary});
         if(!file) {
+            return false;
+        }
+        data.resize(file->size());
+        file->read(data.data(), file->size());
+        return true;
+    }
+
+    Package* Package::LoadDescriptor(std::string const& assetPath) {
+        std::vector<uint8_t> data;
+        if(!ReadAssetFile(assetPath + "_fui.bytes", data)) {
             COMMLOGE("GUI: package not found [%s]", assetPath.c_str());
             return nullptr;
         }
-        ByteBuffer buff(file->size());
-        file->read(buff.ptr(), file->size());
+        ByteBuffer buff(data.data(), (int)data.size());
         // ready to read, create a package object
         Package* package = new Package();
         package->assetPath_ = assetPath;
@@ -275,13 +323,145 @@ namespace gui {
             delete package;
             return nullptr;
         }
+        return package;
+    }
+
+    void Package::RegisterPackage(Package* package, std::string const& assetPath) {
         packageInstByID[package->id_] = package;
         packageInstByID[assetPath] = package;
         packageInstByName[package->name_] = package;
         packageList_.push_back(package);
+    }
+
+    Package* Package::AddPackage(std::string const& assetPath) {
+        // if(!CheckModuleInitialized()) {
+        //     assert("not initialized yet!");
+        //     return nullptr;
+        // }
+        auto iter = packageInstByID.find(assetPath);
+        if(iter != packageInstByID.end()) {
+            return iter->second;
+        }
+        Package* package = LoadDescriptor(assetPath);
+        if(package) {
+            RegisterPackage(package, assetPath);
+        }
         return package;
     }
 
+    void Package::AddPackageAsync(std::string const& assetPath, PackageLoadCallback&& callback) {
+        auto iter = packageInstByID.find(assetPath);
+        if(iter != packageInstByID.end()) {
+            if(callback) {
+                callback(iter->second);
+            }
+            return;
+        }
+        for(auto& load: asyncLoads) { // 已经在加载了，等同一个结果
+            if(load->assetPath == assetPath) {
+                load->callbacks.push_back(std::move(callback));
+                return;
+            }
+        }
+        if(!loadWorkers) {
+            loadWorkers = new ugi::WorkerPool();
+            loadWorkers->initialize();
+        }
+        auto load = std::make_unique<async_package_load_t>();
+        load->assetPath = assetPath;
+        load->callbacks.push_back(std::move(callback));
+        loadWorkers->post([load = load.get()]() {
+            Package* package = LoadDescriptor(load->assetPath);
+            std::vector<std::string> files;
+            if(package) {
+                for(auto item: package->packageItems_) {
+                    if(item->type_ == PackageItemType::Atlas) {
+                        load->atlases.push_back(item);
+                        files.push_back(item->file_);
+                    }
+                }
+            }
+            load->package = package;
+            {
+                std::lock_guard<std::mutex> lock(asyncMutex);
+                parsedLoads.push_back(load);
+            }
+            // 之后只用自己的拷贝，load 归主线程了
+            for(uint32_t i = 0; i<files.size(); ++i) {
+                loadWorkers->post([load, i, file = std::move(files[i])]() {
+                    decoded_atlas_t atlas = { load, i, {}, 0, 0, false };
+                    std::vector<uint8_t> pngData;
+                    if(ReadAssetFile(file, pngData)) {
+                        atlas.ok = ugi::DecodePNG(pngData.data(), (uint32_t)pngData.size(), atlas.pixels, atlas.width, atlas.height);
+                    }
+                    std::lock_guard<std::mutex> lock(asyncMutex);
+                    decodedAtlases.push_back(std::move(atlas));
+                });
+            }
+        });
+        asyncLoads.push_back(std::move(load));
+    }
+
+    void Package::TickAsyncLoad() {
+        if(asyncLoads.empty()) {
+            return;
+        }
+        std::vector<async_package_load_t*> parsed;
+        std::vector<decoded_atlas_t> decoded;
+        {
+            std::lock_guard<std::mutex> lock(asyncMutex);
+            parsed.swap(parsedLoads);
+            decoded.swap(decodedAtlases);
+        }
+        for(auto load: parsed) {
+            load->parsed = true;
+            load->pendingAtlases = (uint32_t)load->atlases.size();
+            if(!load->package) {
+                continue;
+            }
+            auto iter = packageInstByID.find(load->assetPath);
+            if(iter != packageInstByID.end()) { // 等的过程中被同步加载了，用已有的，解码结果丢掉
+                delete load->package;
+                load->package = iter->second;
+                load->atlases.clear();
+            } else {
+                RegisterPackage(load->package, load->assetPath);
+            }
+        }
+        // 解码好一张就提交一张
+        auto rc = ugi::StandardRenderContext::Instance();
+        for(auto& atlas: decoded) {
+            auto load = atlas.load;
+            --load->pendingAtlases;
+            if(atlas.index >= load->atlases.size()) {
+                continue;
+            }
+            auto item = load->atlases[atlas.index];
+            if(item->rawTexture_) { // 注册之后已经被同步加载过了
+                continue;
+            }
+            ugi::Texture* tex = nullptr;
+            if(atlas.ok) {
+                tex = rc->createTextureRGBA8(atlas.pixels.data(), atlas.width, atlas.height, OnAtlasUploaded);
+            }
+            SetAtlasTexture(item, tex);
+        }
+        // 解析完、atlas 全部提交了的，回调；回调里可能再发起加载
+        for(size_t i = 0; i<asyncLoads.size();) {
+            if(!asyncLoads[i]->parsed || asyncLoads[i]->pendingAtlases) {
+                ++i;
+                continue;
+            }
+            auto load = std::move(asyncLoads[i]);
+            asyncLoads.erase(asyncLoads.begin() + i);
+            for(auto& callback: load->callbacks) {
+                if(callback) {
+                    callback(load->package);
+                }
+            }
+        }
+    }
+
     void Package::InitPackageModule(comm::IArchive* archive) {
         if(!archive) {
             return ;
@@ -326,8 +506,25 @@ namespace gui {
         }
     }
 
+    void Package::ReleasePackageModule() {
+        if(!loadWorkers) {
+            return;
+        }
+        loadWorkers->waitIdle();
+        loadWorkers->destroy();
+        delete loadWorkers;
+        loadWorkers = nullptr;
+        // 还没交给主线程注册的 package 没人要了
+        for(auto load: parsedLoads) {
+            delete load->package;
+        }
+        parsedLoads.clear();
+        decodedAtlases.clear();
+        asyncLoads.clear();
+    }
+
     Object* Package::createObject(std::string const& resName) {
-        auto iter = itemsByName_.find(resName);
+        auto iter = itemsByName_.find(GetNamePool().find(resName));
         if(iter == itemsByName_.end()) {
             return nullptr;
         }
@@ -342,6 +539,10 @@ namespace gui {
     }
 
     PackageItem* Package::itemByID(std::string const& id) {
+        return itemByID(GetNamePool().find(id));
+    }
+
+    PackageItem* Package::itemByID(name_t id) {
         auto iter = itemsByID_.find(id);
         if(iter != itemsByID_.end()) {
             return iter->second;
@@ -374,36 +575,20 @@ namespace gui {
         if(item->rawTexture_) { // 已经加载过了
             return;
         }
-        auto const& filepath = item->file_;
         auto rc = ugi::StandardRenderContext::Instance();
-        auto file = archive_->openIStream(filepath, {comm::ReadFlag::binary});
         ugi::Texture* tex = nullptr;
-        if(file) {
-            std::vector<uint8_t> pngData;
-            pngData.resize(file->size());
-            file->read(pngData.data(), file->size());
-            tex = rc->createTexturePNG(pngData.data(), pngData.size(), [](void* res, ugi::CommandBuffer* cmd) {
-                // async load
-                ugi::Texture* tex = (ugi::Texture*)res;
-                tex->generateMipmap(cmd);
-                auto resEnc = cmd->resourceCommandEncoder();
-                resEnc->imageTransitionBarrier(
-                    tex, ugi::ResourceAccessType::ShaderRead, 
-                    ugi::pipeline_stage_t::Bottom, ugi::StageAccess::Write,
-                    ugi::pipeline_stage_t::FragmentShading, ugi::StageAccess::Read,
-                    nullptr
-                );
-                resEnc->endEncode();
-            } );
+        std::vector<uint8_t> pngData;
+        if(ReadAssetFile(item->file_, pngData)) {
+            tex = rc->createTexturePNG(pngData.data(), pngData.size(), OnAtlasUploaded);
         }
+        SetAtlasTexture(item, tex);
+    }
+
+    void Package::SetAtlasTexture(PackageItem* item, ugi::Texture* tex) {
         if(!tex) {
             tex = emptyTexture_;
         }
-        if(item->rawTexture_ == nullptr) {
-            item->rawTexture_ = tex;
-        // } else {
-        //     assert(false); // 尚未处理
-        }
+        item->rawTexture_ = tex;
         if(item->rawTexture_) {
             item->texture_ = new NTexture(item->rawTexture_);
         }
@@ -442,7 +627,11 @@ namespace gui {
     }
 
     Package* LoadPackageFromAsset(std::string const& assetPath) {
-        return nullptr;
+        return Package::AddPackage(assetPath);
+    }
+
+    void LoadPackageFromAsset(std::string const& assetPath, PackageLoadCallback&& callback) {
+        Package::AddPackageAsync(assetPath, std::move(callback));
     }
 
     ugi::Texture* Package::EmptyTexture() {
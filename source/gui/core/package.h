@@ -2,6 +2,8 @@
 #include "render_context.h"
 #include "../utils/byte_buffer.h"
 #include <gui/core/declare.h>
+#include <functional>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -10,6 +12,8 @@
 
 namespace gui {
 
+    using PackageLoadCallback = std::function<void(Package*)>; ///> 总在主线程回调，失败时参数为 nullptr
+
     class Package {
         struct dependence_t {
             std::string id;
@@ -24,11 +28,12 @@ namespace gui {
         ByteBuffer                                                  packageBuffer_;
         std::vector<PackageItem*>                                   packageItems_;
 
-        std::unordered_map<std::string, PackageItem*>               itemsByID_;
-        std::unordered_map<std::string, PackageItem*>               itemsByName_;
-        std::unordered_map<std::string, AtlasSprite>                sprites_; 
+        std::unordered_map<name_t, PackageItem*>                    itemsByID_;
+        std::unordered_map<name_t, PackageItem*>                    itemsByName_;
+        std::unordered_map<name_t, AtlasSprite>                     sprites_; 
         std::string                                                 customID_;
         std::vector<std::string>                                    stringTable_;
+        std::vector<name_t>                                         nameTable_;     // stringTable_ 驻留后的 name_t
         std::vector<dependence_t>                                   dependencies_;
         std::vector<std::string>                                    branches_;
         int32_t                                                     branchIndex_;
@@ -41,6 +46,7 @@ namespace gui {
         static std::string                                          branch_;
         static Texture*                                             emptyTexture_;
         static uint32_t                                             moduleInited_;
+        static std::mutex                                           archiveMutex_;  // IArchive 不保证线程安全，读文件都串行
     public:
         static comm::IArchive*                                      archive_;
         //
@@ -56,6 +62,7 @@ namespace gui {
             return branchIndex_;
         }
         PackageItem* itemByID(std::string const& id);
+        PackageItem* itemByID(name_t id);
 
         void loadAllAssets();
 
@@ -64,15 +71,26 @@ namespace gui {
         void loadAtlasItem(PackageItem* item);
         void loadImageItem(PackageItem* item);
         static bool CheckModuleInitialized();
+        static bool ReadAssetFile(std::string const& path, std::vector<uint8_t>& data); // 可以在工作线程调用
+        static Package* LoadDescriptor(std::string const& assetPath);   // 读取并解析 _fui.bytes，不注册，可以在工作线程调用
+        static void RegisterPackage(Package* package, std::string const& assetPath);
+        static void SetAtlasTexture(PackageItem* item, ugi::Texture* tex);
     public:
         static Package* AddPackage(std::string const& assetPath);
+        /// 异步加载：工作线程解析描述文件，所有 atlas 的 PNG 在线程池里并行解码，
+        /// 解码好一张就在主线程创建纹理提交上传，全部提交后回调；已经加载过的直接回调
+        static void AddPackageAsync(std::string const& assetPath, PackageLoadCallback&& callback);
+        /// 主线程每帧调用（GuiTick 里），接收工作线程的结果、创建纹理、触发完成回调
+        static void TickAsyncLoad();
         static void InitPackageModule(comm::IArchive* archive);
+        static void ReleasePackageModule(); // 停掉加载线程，还没完成的异步加载直接丢弃
         static ugi::Texture* EmptyTexture();
     };
 
     Package* PackageForID(std::string const& id);
     Package* PackageForName(std::string const& name);
     Package* LoadPackageFromAsset(std::string const& assetPath);
+    void LoadPackageFromAsset(std::string const& assetPath, PackageLoadCallback&& callback);
 
 
 }
\ No newline at end of file
@@ -55,8 +55,8 @@ namespace gui {
             if(owner_->branchIndex() == -1) {
                 break;
             }
-            auto const& itemID = (*branches_)[owner_->branchIndex()];
-            if(!itemID.size()) {
+            auto itemID = (*branches_)[owner_->branchIndex()];
+            if(itemID == EmptyName) {
                 break;
             }
             return owner_->itemByID(itemID);
@@ -72,8 +72,8 @@ namespace gui {
             if(owner_->branchIndex() == -1) {
                 break;
             }
-            auto const& itemID = (*branches_)[owner_->branchIndex()];
-            if(!itemID.size()) {
+            auto itemID = (*branches_)[owner_->branchIndex()];
+            if(itemID == EmptyName) {
                 break;
             }
             return owner_->itemByID(itemID);
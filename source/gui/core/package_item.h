@@ -15,14 +15,14 @@ namespace gui {
         Package*                        owner_;
         PackageItemType                 type_;
         ObjectType                      objType_;
-        std::string                     id_;
-        std::string                     name_;
+        name_t                          id_;
+        name_t                          name_;
         std::string                     file_;
         int                             width_;
         int                             height_;
         ByteBuffer                      rawData_; // 有必要用指针？？？这个后续关注下！
 
-        std::vector<std::string>*       branches_;
+        std::vector<name_t>*            branches_;
         std::vector<std::string>*       highResolution_;
 
         // if is atlas
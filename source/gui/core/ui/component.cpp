@@ -10,6 +10,7 @@
 #include "utils/byte_buffer.h"
 #include "core/display_objects/display_object.h"
 #include "core/controller.h"
+#include "core/ui/hit_test_index.h"
 
 
 namespace gui {
@@ -79,11 +80,11 @@ namespace gui {
             auto childData = buff.readBufferBlock();
             childData.seekToBlock(0, ObjectBlocks::Props);
             auto type = childData.read<ObjectType>();
-            std::string itemID = childData.read<csref>();
+            name_t itemID = childData.readName();
             std::string pkgID = childData.read<csref>();
             PackageItem* pi = nullptr;
             Package* pkg = nullptr;
-            if(itemID.size()) {
+            if(itemID != EmptyName) {
                 pkg = PackageForID(pkgID);
                 if(!pkg) {
                     pkg = contentItem->owner_;
@@ -105,6 +106,8 @@ namespace gui {
             obj->internalSetParent(this);
             children_.push_back(obj);
         }
+        childIndexDirty_ = true;
+        MarkHitTestStructureDirty();
         // setup relations
         buff.seekToBlock(0, ComponentBlocks::Relations);
         relations_.setup(buff, true);
@@ -132,12 +135,12 @@ namespace gui {
             buff.read<bool>(); // mask 暂时不处理
         }
         {
-            auto hitTestID = buff.read<csref>();
+            auto hitTestID = buff.readName();
             int i1 = buff.read<int>(), i2 = buff.read<int>();
-            if(hitTestID.size()) {
+            if(hitTestID != EmptyName) {
                 auto hitItem = contentItem->owner_->itemByID(hitTestID);
                 if(hitItem && hitItem->pixelHitTestData_) {
-                    // root_.hitA
+                    hitArea_ = std::make_unique<PixelHitTest>(hitItem->pixelHitTestData_, i1, i2);
                 }
             }
         }
@@ -156,8 +159,8 @@ namespace gui {
         if(transitions_.size()) {
             std::function<void(EventContext*)> onAddedToStage = std::bind(&Component::onAddedToStage, this, std::placeholders::_1);
             std::function<void(EventContext*)> onRemoveFromStage = std::bind(&Component::onRemoveFromStage, this, std::placeholders::_1);
-            addEventListener("AddedToStage", onAddedToStage);
-            addEventListener("RemoveFromStage", onRemoveFromStage);
+            addEventListener(EventTypes::AddedToStage, onAddedToStage);
+            addEventListener(EventTypes::RemoveFromStage, onRemoveFromStage);
         }
         applyAllControllers();
 
@@ -208,22 +211,50 @@ namespace gui {
         controller->runActions();
     }
 
-    Object* Component::getChildByID(std::string const& id) const {
+    void Component::buildChildIndex() const {
+        childrenByName_.clear();
+        childrenByID_.clear();
         for (auto* child : children_) {
-            if (child->id_ == id) return child;
+            if (child->name_ != EmptyName) {
+                childrenByName_.try_emplace(child->name_, child);
+            }
+            if (child->id_ != EmptyName) {
+                childrenByID_.try_emplace(child->id_, child);
+            }
         }
-        return nullptr;
+        childIndexDirty_ = false;
+    }
+
+    Object* Component::getChildByID(std::string const& id) const {
+        return getChildByID(GetNamePool().find(id));
+    }
+
+    Object* Component::getChildByID(name_t id) const {
+        if (childIndexDirty_) {
+            buildChildIndex();
+        }
+        auto iter = childrenByID_.find(id);
+        return iter != childrenByID_.end() ? iter->second : nullptr;
     }
 
     Object* Component::getChild(std::string const& name) const {
-        for (auto* child : children_) {
-            if (child->name_ == name) return child;
+        return getChild(GetNamePool().find(name));
+    }
+
+    Object* Component::getChild(name_t name) const {
+        if (childIndexDirty_) {
+            buildChildIndex();
         }
-        return nullptr;
+        auto iter = childrenByName_.find(name);
+        return iter != childrenByName_.end() ? iter->second : nullptr;
     }
 
     Controller* Component::getController(std::string const& name) const {
-        for (auto* c : controllers_) {
+        return getController(GetNamePool().find(name));
+    }
+
+    Controller* Component::getController(name_t name) const {
+        for (auto* c : controllers_) { // 一般就几个，直接比整数
             if (c->name_ == name) return c;
         }
         return nullptr;
@@ -332,6 +363,8 @@ namespace gui {
             children_.insert(children_.begin() + index, child);
             syncDisplayList(child);
             setBoundsChangedFlag();
+            childIndexDirty_ = true;
+            MarkHitTestStructureDirty();
             //
             // reg.emplace_or_replace<dispcomp::visible_dirty>(child->getDisplayObject());
         }
@@ -471,6 +504,8 @@ namespace gui {
             return oldIdx;
         }
         children_.erase(children_.begin() + oldIdx);
+        childIndexDirty_ = true;
+        MarkHitTestStructureDirty();
         if(idx >= cnt) {
             children_.push_back(child);
         } else {
@@ -6,7 +6,10 @@
 #include "core/declare.h"
 #include "core/display_objects/display_object.h"
 #include "core/events/event_dispatcher.h"
+#include "core/hit_test.h"
 #include "utils/byte_buffer.h"
+#include <memory>
+#include <unordered_map>
 
 namespace gui {
 
@@ -33,6 +36,13 @@ namespace gui {
 
         uint32_t                    sortingChildCount_; // 自定义排序优先级的控件数量
 
+        std::unique_ptr<IHitTest>   hitArea_; // 像素级点击区域，没有就是整个矩形
+
+        // name/id → child，children_ 变了标脏，下次查的时候重建；重名的取最前面的
+        mutable std::unordered_map<name_t, Object*> childrenByName_;
+        mutable std::unordered_map<name_t, Object*> childrenByID_;
+        mutable bool                childIndexDirty_;
+
         //
         bool                        asBatchNode_;
     public: 
@@ -53,6 +63,10 @@ namespace gui {
             , clipSoftness_{}
             , applyingController_(nullptr)
             , sortingChildCount_(0)
+            , hitArea_()
+            , childrenByName_()
+            , childrenByID_()
+            , childIndexDirty_(true)
             , asBatchNode_(false)
         {
             this->type_ = ObjectType::Component;
@@ -82,6 +96,8 @@ namespace gui {
 
         void asBatchNode(bool batch);
 
+        IHitTest* hitArea() const { return hitArea_.get(); }
+
 
         int numChildren() const { return (int)children_.size(); }
 
@@ -89,9 +105,12 @@ namespace gui {
         Object* addChildAt(Object* child, uint32_t index);
         Object* getChildAt(int index) const;
         Object* getChildByID(std::string const& id) const;
+        Object* getChildByID(name_t id) const;
         Object* getChild(std::string const& name) const;
+        Object* getChild(name_t name) const;
 
         Controller* getController(std::string const& name) const;
+        Controller* getController(name_t name) const;
         Controller* getControllerAt(int index) const;
         Transition* getTransition(std::string const& name) const;
 
@@ -106,6 +125,7 @@ private:
         uint32_t getInsertPosForSortingOrder(Object* child);
 
         void syncDisplayList(Object* child);
+        void buildChildIndex() const;
     };
 
 }
\ No newline at end of file
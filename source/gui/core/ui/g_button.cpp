@@ -45,10 +45,10 @@ namespace gui {
             setState(UP);
 
         // 注册事件监听 (与 C# 对齐)
-        addEventListener("onTouchBegin", [this](EventContext*) { onTouchBegin(); });
-        addEventListener("onClick",      [this](EventContext*) { onTouchEnd(); });
-        addEventListener("onRollOver",   [this](EventContext*) { over_ = true;  updateState(); });
-        addEventListener("onRollOut",    [this](EventContext*) { over_ = false; updateState(); });
+        addEventListener(EventTypes::TouchBegin, [this](EventContext*) { onTouchBegin(); });
+        addEventListener(EventTypes::Click,      [this](EventContext*) { onTouchEnd(); });
+        addEventListener(EventTypes::RollOver,   [this](EventContext*) { over_ = true;  updateState(); });
+        addEventListener(EventTypes::RollOut,    [this](EventContext*) { over_ = false; updateState(); });
     }
 
     void GButton::setupAfterAdd(ByteBuffer& buffer, int startPos) {
@@ -0,0 +1,197 @@
+#include "hit_test_index.h"
+#include "core/ui/object.h"
+#include "core/ui/component.h"
+#include "core/hit_test.h"
+#include "core/display_objects/display_object_utility.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace gui {
+
+    static uint32_t hitTestStructureVersion = 0;
+
+    void MarkHitTestStructureDirty() {
+        ++hitTestStructureVersion;
+    }
+
+    void HitTestIndex::setRoot(Object* root) {
+        _root = root;
+        _structureVersion = hitTestStructureVersion - 1; // 下次 update 一定重建
+    }
+
+    void HitTestIndex::computeBounds(entry_t& entry) {
+        entry.worldInverse = entry.world.inverse();
+        float const w = entry.object->width();
+        float const h = entry.object->height();
+        glm::vec2 const corners[4] = {
+            entry.world.transformPoint({ 0.0f, 0.0f }),
+            entry.world.transformPoint({ w, 0.0f }),
+            entry.world.transformPoint({ w, h }),
+            entry.world.transformPoint({ 0.0f, h }),
+        };
+        entry.aabbMin = glm::min(glm::min(corners[0], corners[1]), glm::min(corners[2], corners[3]));
+        entry.aabbMax = glm::max(glm::max(corners[0], corners[1]), glm::max(corners[2], corners[3]));
+    }
+
+    void HitTestIndex::collect(Object* obj, uint32_t parent) {
+        if (!obj || !obj->visible() || !obj->touchable()) {
+            return;
+        }
+        auto dobj = obj->getDisplayObject();
+        uint32_t const index = (uint32_t)_entries.size();
+        entry_t entry = {};
+        entry.object = obj;
+        entry.entity = dobj ? dobj.entity() : entt::null;
+        entry.component = dynamic_cast<Component*>(obj);
+        entry.parent = parent;
+        affine2d const local = dobj ? buildLocalMatrix(entry.entity) : affine2d();
+        entry.world = parent == InvalidEntry ? local : _entries[parent].world * local;
+        computeBounds(entry);
+        _entries.push_back(entry);
+        if (entry.entity != entt::null) {
+            reg.emplace_or_replace<dispcomp::hit_entry>(entry.entity, index);
+        }
+        if (entry.component) {
+            for (int i = 0; i < entry.component->numChildren(); ++i) {
+                auto* child = entry.component->getChildAt(i);
+                if (child && child->visible()) {
+                    collect(child, index);
+                }
+            }
+        }
+        _entries[index].subtreeEnd = (uint32_t)_entries.size();
+    }
+
+    void HitTestIndex::insertCells(uint32_t index) {
+        auto& entry = _entries[index];
+        entry.cellMin[0] = entry.cellMin[1] = 0;
+        entry.cellMax[0] = entry.cellMax[1] = -1;
+        if (!_cols || entry.aabbMax.x <= entry.aabbMin.x || entry.aabbMax.y <= entry.aabbMin.y) {
+            return;
+        }
+        // 网格外面的夹到边上的格子里，查询时同样夹，AABB 判定保证正确
+        auto cellOf = [&](float v, float origin, int count) {
+            return std::clamp((int)std::floor((v - origin) / CellSize), 0, count - 1);
+        };
+        entry.cellMin[0] = cellOf(entry.aabbMin.x, _origin.x, _cols);
+        entry.cellMin[1] = cellOf(entry.aabbMin.y, _origin.y, _rows);
+        entry.cellMax[0] = cellOf(entry.aabbMax.x, _origin.x, _cols);
+        entry.cellMax[1] = cellOf(entry.aabbMax.y, _origin.y, _rows);
+        for (int y = entry.cellMin[1]; y <= entry.cellMax[1]; ++y) {
+            for (int x = entry.cellMin[0]; x <= entry.cellMax[0]; ++x) {
+                auto& cell = _cells[y * _cols + x];
+                cell.insert(std::lower_bound(cell.begin(), cell.end(), index, std::greater<uint32_t>()), index);
+            }
+        }
+    }
+
+    void HitTestIndex::removeCells(uint32_t index) {
+        auto const& entry = _entries[index];
+        for (int y = entry.cellMin[1]; y <= entry.cellMax[1]; ++y) {
+            for (int x = entry.cellMin[0]; x <= entry.cellMax[0]; ++x) {
+                auto& cell = _cells[y * _cols + x];
+                auto it = std::lower_bound(cell.begin(), cell.end(), index, std::greater<uint32_t>());
+                if (it != cell.end() && *it == index) {
+                    cell.erase(it);
+                }
+            }
+        }
+    }
+
+    void HitTestIndex::rebuild() {
+        reg.clear<dispcomp::hit_entry>();
+        reg.clear<dispcomp::hit_bounds_dirty>();
+        _entries.clear();
+        for (auto& cell : _cells) {
+            cell.clear();
+        }
+        _cols = _rows = 0;
+        collect(_root, InvalidEntry);
+        if (_entries.empty()) {
+            return;
+        }
+        // 网格铺满根节点（屏幕）的范围
+        auto const& root = _entries.front();
+        glm::vec2 const extent = glm::max(root.aabbMax - root.aabbMin, glm::vec2(CellSize));
+        _origin = root.aabbMin;
+        _cols = std::min((int)std::ceil(extent.x / CellSize), 256);
+        _rows = std::min((int)std::ceil(extent.y / CellSize), 256);
+        _cells.resize((size_t)_cols * _rows);
+        for (uint32_t i = (uint32_t)_entries.size(); i-- > 0;) { // 倒着插，每次都落在格子末尾
+            insertCells(i);
+        }
+    }
+
+    void HitTestIndex::update() {
+        if (!_root) {
+            return;
+        }
+        if (_structureVersion != hitTestStructureVersion) {
+            _structureVersion = hitTestStructureVersion;
+            rebuild();
+            return;
+        }
+        _dirty.clear();
+        reg.view<dispcomp::hit_bounds_dirty, dispcomp::hit_entry>().each([this](entt::entity, dispcomp::hit_entry const& hit) {
+            _dirty.push_back(hit.index);
+        });
+        reg.clear<dispcomp::hit_bounds_dirty>();
+        if (_dirty.empty()) {
+            return;
+        }
+        std::sort(_dirty.begin(), _dirty.end());
+        if (_dirty.front() == 0) { // 根变了（窗口大小、整体缩放），网格范围也跟着变
+            rebuild();
+            return;
+        }
+        // 子树是连续的一段，父条目一定在前面，顺序重算一遍就行；被祖先覆盖的脏节点跳过
+        uint32_t doneEnd = 0;
+        for (auto index : _dirty) {
+            if (index < doneEnd) {
+                continue;
+            }
+            uint32_t const end = _entries[index].subtreeEnd;
+            for (uint32_t i = index; i < end; ++i) {
+                auto& entry = _entries[i];
+                affine2d const local = entry.entity != entt::null ? buildLocalMatrix(entry.entity) : affine2d();
+                entry.world = entry.parent == InvalidEntry ? local : _entries[entry.parent].world * local;
+                removeCells(i);
+                computeBounds(entry);
+                insertCells(i);
+            }
+            doneEnd = end;
+        }
+    }
+
+    bool HitTestIndex::preciseTest(entry_t const& entry, glm::vec2 pt) const {
+        glm::vec2 const local = entry.worldInverse.transformPoint(pt);
+        if (local.x < 0 || local.y < 0 || local.x > entry.object->width() || local.y > entry.object->height()) {
+            return false;
+        }
+        if (entry.component && entry.component->hitArea()) {
+            return entry.component->hitArea()->hitTest(entry.component, local);
+        }
+        return true;
+    }
+
+    Object* HitTestIndex::hitTest(glm::vec2 pt) {
+        update();
+        if (!_cols) {
+            return nullptr;
+        }
+        int const cx = std::clamp((int)std::floor((pt.x - _origin.x) / CellSize), 0, _cols - 1);
+        int const cy = std::clamp((int)std::floor((pt.y - _origin.y) / CellSize), 0, _rows - 1);
+        for (auto index : _cells[cy * _cols + cx]) { // 从上往下，第一个命中的就是结果
+            auto const& entry = _entries[index];
+            if (pt.x < entry.aabbMin.x || pt.y < entry.aabbMin.y || pt.x > entry.aabbMax.x || pt.y > entry.aabbMax.y) {
+                continue;
+            }
+            if (preciseTest(entry, pt)) {
+                return entry.object;
+            }
+        }
+        return nullptr;
+    }
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <core/declare.h>
+#include <core/data_types/affine2d.h>
+#include <core/display_objects/display_components.h>
+#include <vector>
+#include <cstdint>
+
+namespace gui {
+
+    class Object;
+    class Component;
+    class IHitTest;
+
+    /// 增删子节点、调顺序、visible/touchable 变化时调用，下次查询前整棵重建
+    void MarkHitTestStructureDirty();
+
+    /*
+     *  Stage::hitTest 的加速结构：可见且可点击的对象按世界空间 AABB 放进均匀网格
+     *  1. 条目按先序遍历存放，下标就是渲染顺序（大的在上面），一棵子树是连续的一段
+     *  2. 结构变化整棵重建；只是变换变了的（hit_bounds_dirty），update 从脏节点把这一段的矩阵、AABB 重算，挪格子
+     *  3. 查询只看指针所在格子里的候选（格子里按顺序从大到小排），用缓存的逆矩阵做精确判定，命中第一个就返回
+     * */
+    class HitTestIndex {
+    public:
+        static constexpr float      CellSize = 128.0f;
+        static constexpr uint32_t   InvalidEntry = ~0u;
+    private:
+        struct entry_t {
+            Object*         object;
+            entt::entity    entity;         // object 的 display object
+            Component*      component;      // 是 Component 的话，精确判定要看它的 hitArea
+            affine2d        world;
+            affine2d        worldInverse;
+            glm::vec2       aabbMin;
+            glm::vec2       aabbMax;
+            uint32_t        parent;         // 父对象的条目，根是 InvalidEntry
+            uint32_t        subtreeEnd;     // 子树 [自己, subtreeEnd)
+            int             cellMin[2];     // 占了哪些格子，没有面积的不进格子（cellMin > cellMax）
+            int             cellMax[2];
+        };
+        Object*                             _root = nullptr;
+        std::vector<entry_t>                _entries;
+        std::vector<std::vector<uint32_t>>  _cells;         // 每个格子里的条目，下标从大到小
+        int                                 _cols = 0;
+        int                                 _rows = 0;
+        glm::vec2                           _origin = {};
+        uint32_t                            _structureVersion = ~0u;
+        std::vector<uint32_t>               _dirty;         // 每次 update 复用
+    private:
+        void rebuild();
+        void collect(Object* obj, uint32_t parent);
+        void computeBounds(entry_t& entry);
+        void insertCells(uint32_t index);
+        void removeCells(uint32_t index);
+        bool preciseTest(entry_t const& entry, glm::vec2 pt) const;
+    public:
+        void setRoot(Object* root);
+        /// 处理结构变化和 hit_bounds_dirty，GuiTick 里跟在变换更新后面调用，查询前也会补一次
+        void update();
+        Object* hitTest(glm::vec2 pt);
+    };
+
+}
@@ -5,6 +5,8 @@
 #include <core/gui_context.h>
 #include <core/controller.h>
 #include <core/ui/component.h>
+#include <core/ui/hit_test_index.h>
+#include <vector>
 
 namespace gui {
 
@@ -50,8 +52,8 @@ namespace gui {
         auto buffer = &bufRef;
         buffer->seekToBlock(startPos, ObjectBlocks::Props);
         buffer->skip(5);
-        id_ = buffer->read<csref>();
-        name_ = buffer->read<csref>();
+        id_ = buffer->readName();
+        name_ = buffer->readName();
         float f1, f2, f3;
         f1 = buffer->read<int>();
         f2 = buffer->read<int>();
@@ -184,6 +186,14 @@ namespace gui {
             reg.remove<dispcomp::visible>(dispobj_);
         }
         reg.emplace_or_replace<dispcomp::visible_dirty>(dispobj_);
+        MarkHitTestStructureDirty();
+    }
+
+    void Object::setTouchable(bool val) {
+        if(touchable_ != val) {
+            touchable_ = val;
+            MarkHitTestStructureDirty();
+        }
     }
 
     void Object::setPixelSnapping(bool val) {
@@ -204,29 +214,41 @@ namespace gui {
         }
     }
 
-    bool Object::bubbleEvent(std::string const& type, void* data) {
-        EventContext ctx(type, this, data);
-
-        // 收集父链 (this → root)
-        std::vector<Object*> chain;
-        Object* cur = this;
-        while (cur) {
-            chain.push_back(cur);
-            cur = cur->parent();
+    bool Object::bubbleEvent(EventType type, void* data) {
+        // 父链上只收集可能监听了这个事件的对象，一般一个都没有，几次位测试就返回
+        // 先放栈上，超过 InlineBubbleCount 个之后整体挪到堆上，不会丢掉上层的监听者
+        constexpr uint32_t InlineBubbleCount = 64;
+        Object* inlinePath[InlineBubbleCount];
+        std::vector<Object*> heapPath;
+        uint32_t count = 0;
+        for (Object* cur = this; cur; cur = cur->parent()) {
+            if (!cur->mayListen(type)) {
+                continue;
+            }
+            if (count < InlineBubbleCount) {
+                inlinePath[count] = cur;
+            } else {
+                if (heapPath.empty()) {
+                    heapPath.assign(inlinePath, inlinePath + InlineBubbleCount);
+                }
+                heapPath.push_back(cur);
+            }
+            ++count;
         }
-
+        if (!count) {
+            return false;
+        }
+        Object* const* path = heapPath.empty() ? inlinePath : heapPath.data();
+        EventContext ctx(type, this, data);
         // Capture: root → target
-        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        for (uint32_t i = count; i-- > 0;) {
             if (ctx.isStopped()) return true;
-            auto& bridge = (*it)->getBridge(type);
-            if (!bridge.isEmpty()) bridge.fire(&ctx, true);
+            path[i]->fireListeners(type, &ctx, true);
         }
-
         // Target & Bubble: target → root
-        for (auto* obj : chain) {
+        for (uint32_t i = 0; i < count; ++i) {
             if (ctx.isStopped()) return true;
-            auto& bridge = obj->getBridge(type);
-            if (!bridge.isEmpty()) bridge.fire(&ctx, false);
+            path[i]->fireListeners(type, &ctx, false);
         }
         return true;
     }
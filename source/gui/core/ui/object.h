@@ -9,6 +9,7 @@
 #include <core/data_types/relation.h>
 #include <core/data_types/gear.h>
 #include <utils/byte_buffer.h>
+#include <utils/name_pool.h>
 
 /**
  * @brief Anchor & Pivot
@@ -34,8 +35,8 @@ namespace gui {
         friend class RelationItem;
         friend class Relations;
     protected:
-        std::string     id_;
-        std::string     name_;
+        name_t          id_;
+        name_t          name_;
         ObjectType      type_;
         glm::vec3       position_;
         Size2D<float>   sourceSize_;    // = FairyGUI sourceWidth/sourceHeight，设计蓝图尺寸，永不变
@@ -78,6 +79,8 @@ namespace gui {
     public:
         Object()
             : EventDispatcher()
+            , id_(EmptyName)
+            , name_(EmptyName)
             , type_(ObjectType::Component)   // 默认 Component，子类各自覆盖
             , position_{}
             , sourceSize_{}
@@ -219,16 +222,19 @@ protected:
         bool visible() const { return visible_; }
 
         bool touchable() const { return touchable_; }
-        void setTouchable(bool val) { touchable_ = val; }
+        void setTouchable(bool val);
 
         Component* parent() const { return parent_; }
 
         /// 沿 Object 父链冒泡事件
-        bool bubbleEvent(std::string const& type, void* data = nullptr) override;
+        using EventDispatcher::bubbleEvent;
+        bool bubbleEvent(EventType type, void* data = nullptr) override;
 
         ObjectType objectType() const { return type_; }
-        std::string const& id() const { return id_; }
-        std::string const& name() const { return name_; }
+        std::string const& id() const { return NameString(id_); }
+        std::string const& name() const { return NameString(name_); }
+        name_t idAtom() const { return id_; }
+        name_t nameAtom() const { return name_; }
 
         Relations& relations() { return relations_; }
         Relations const& relations() const { return relations_; }
@@ -13,6 +13,7 @@ namespace gui {
     void Stage::initialize(float width, float height) {
         ui2dRoot_ = (Root*)ObjectFactory::CreateObject(ObjectType::Root);
         ui2dRoot_->setSize(gui::Size2D<float>(width, height));
+        hitIndex_.setRoot(ui2dRoot_);
     }
 
     void Stage::onResize(uint32_t width, uint32_t height) {
@@ -35,53 +36,23 @@ namespace gui {
         ui2dRoot_->setScale(sf, sf);
     }
 
-    /// 将父空间坐标转换到对象局部空间
-    static glm::vec2 pointToLocal(Object* obj, glm::vec2 parentPt) {
-        auto dobj = obj->getDisplayObject();
-        if (!dobj) return parentPt;
-        auto localMat = buildLocalMatrix(dobj.entity());
-        glm::mat4 inv = glm::inverse(localMat);
-        glm::vec4 p = inv * glm::vec4(parentPt.x, parentPt.y, 0, 1);
-        return {p.x, p.y};
-    }
-
-    static Object* hitTestRecursive(Object* obj, glm::vec2 parentPt) {
-        if (!obj || !obj->visible() || !obj->touchable()) return nullptr;
-        auto localPt = pointToLocal(obj, parentPt);
-        if (auto* comp = dynamic_cast<Component*>(obj)) {
-            // children 在 obj 的局部空间, 传 localPt
-            for (int i = comp->numChildren() - 1; i >= 0; --i) {
-                auto* child = comp->getChildAt(i);
-                if (!child || !child->visible()) continue;
-                auto* hit = hitTestRecursive(child, localPt);
-                if (hit) return hit;
-            }
-        }
-        if (localPt.x >= 0 && localPt.y >= 0 &&
-            localPt.x <= obj->width() && localPt.y <= obj->height())
-            return obj;
-        return nullptr;
-    }
-
     Object* Stage::hitTest(glm::vec2 screenPos) const {
         if (!ui2dRoot_) {
             return nullptr;
         }
-        // 屏幕坐标转 root 局部坐标
-        float sf = UIContentScaler::Instance()->scaleFactor;
-        // glm::vec2 localPt(screenPos.x / sf, screenPos.y / sf);
-        return hitTestRecursive(ui2dRoot_, screenPos);
+        // root 的局部矩阵里带了 scaleFactor，直接用屏幕坐标查
+        return hitIndex_.hitTest(screenPos);
     }
 
     void Stage::onMouseDown(glm::vec2 pos) {
         auto* hit = hitTest(pos);
         pressTarget_ = hit;
-        if (hit) hit->bubbleEvent("onTouchBegin");
+        if (hit) hit->bubbleEvent(EventTypes::TouchBegin);
     }
 
     void Stage::onMouseUp(glm::vec2 pos) {
         if (pressTarget_) {
-            pressTarget_->bubbleEvent("onClick");
+            pressTarget_->bubbleEvent(EventTypes::Click);
             pressTarget_ = nullptr;
         }
     }
@@ -89,9 +60,9 @@ namespace gui {
     void Stage::onMouseMove(glm::vec2 pos) {
         auto* hit = hitTest(pos);
         if (hit != hoverTarget_) {
-            if (hoverTarget_) hoverTarget_->bubbleEvent("onRollOut");
+            if (hoverTarget_) hoverTarget_->bubbleEvent(EventTypes::RollOut);
             hoverTarget_ = hit;
-            if (hit) hit->bubbleEvent("onRollOver");
+            if (hit) hit->bubbleEvent(EventTypes::RollOver);
         }
     }
 
@@ -3,6 +3,7 @@
 #include "utils/singleton.h"
 #include <core/ui/root.h>
 #include <core/ui/ui_content_scaler.h>
+#include <core/ui/hit_test_index.h>
 #include <set>
 
 namespace gui {
@@ -16,6 +17,7 @@ namespace gui {
         float                   screenHeight_ = 0;
         Object*                 hoverTarget_ = nullptr;
         Object*                 pressTarget_ = nullptr;
+        mutable HitTestIndex    hitIndex_;
         //
         Stage()
             : ui2dRoot_(nullptr)
@@ -29,6 +31,11 @@ namespace gui {
         void onMouseUp(glm::vec2 pos);
         void onMouseMove(glm::vec2 pos);
 
+        /// GuiTick 里变换更新完之后调用，把这一帧的变化同步到点击索引
+        void updateHitTestIndex() {
+            hitIndex_.update();
+        }
+
         Root* defaultRoot() const {
             return ui2dRoot_;
         }
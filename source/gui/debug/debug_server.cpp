@@ -762,6 +762,7 @@ namespace gui {
         if (reg.any_of<dispcomp::item_batch_info>(entity)) {
             auto& pb = reg.get<dispcomp::item_batch_info>(entity);
             ss << ",\"parentBatch\":\"" << entityIdStr(pb.batchEntity) << "\"";
+            ss << ",\"subIdx\":" << pb.subIdx;
             ss << ",\"instIndex\":" << pb.instIndex;
         }
 
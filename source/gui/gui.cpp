@@ -15,6 +15,7 @@
 
 #include <core/display_objects/display_object_utility.h>
 #include <core/data_types/tween_manager.h>
+#include <utils/frame_arena.h>
 
 /**
  * @brief 
@@ -71,8 +72,14 @@ namespace gui {
 
     void updateBatchNodeTree() {
         // Step 1: 有 batch_dirty 的非 batch_node → 找父 batch_node → 标记 batch_need_rebuild
+        // 已经在 batch 里、只是 mesh 变了的 item 先不重建，等 mesh 生成之后由 patchBatches 原地改写
         reg.view<dispcomp::batch_dirty, dispcomp::final_visible>(entt::exclude<dispcomp::batch_node>).each([&](entt::entity ett) {
-            markBatchNeedRebuild(ett);
+            auto info = reg.try_get<dispcomp::item_batch_info>(ett);
+            if (info && info->batchIdx >= 0 && reg.any_of<dispcomp::mesh_dirty>(ett)) {
+                reg.emplace_or_replace<dispcomp::mesh_need_patch>(ett);
+            } else {
+                markBatchNeedRebuild(ett);
+            }
             reg.remove<dispcomp::batch_dirty>(ett);
         });
 
@@ -86,12 +93,16 @@ namespace gui {
                     bn.batchNodes.push_back(child);
                 }
                 reg.emplace_or_replace<dispcomp::item_batch_info>(child, ett, -1);
-                // 结构变化 → 所有 item 标记需要重算 local-to-batch
-                if (reg.any_of<dispcomp::item_render_data>(child)) {
-                    auto& s = reg.get_or_emplace<dispcomp::args_need_sync>(child);
-                    s.mask |= dispcomp::Asm_Transform;
-                }
             });
+            // 结构变化 → 直接子节点标记需要重算 local-to-batch，updateItemTransforms 自顶向下覆盖整棵子树（含中间容器的缓存）
+            if (auto children = getChildren(ett)) {
+                for (auto child : children->val) {
+                    if (!isBatchNode(child)) {
+                        auto& s = reg.get_or_emplace<dispcomp::args_need_sync>(child);
+                        s.mask |= dispcomp::Asm_Transform;
+                    }
+                }
+            }
             reg.remove<dispcomp::batch_dirty>(ett);
             reg.emplace_or_replace<dispcomp::batch_need_rebuild>(ett);
         });
@@ -111,36 +122,147 @@ namespace gui {
         }
     }
 
+    // 贴图不同不用断，renderer 按自己的贴图槽位数切 sub-batch
     struct material_batch_desc_t {
         UIMeshType renderType = UIMeshType::None;
-        ugi::Texture* texture = nullptr; 
         //
-        bool compatible(UIMeshType type, ugi::Texture* tex) const {
-            return renderType == type && texture == tex;
+        bool compatible(UIMeshType type) const {
+            return renderType == type;
         }
     };
 
+    static ugi::Texture* itemTexture(dispcomp::item_render_data const* graphics) {
+        ugi::Texture* tex = nullptr;
+        auto ntex = graphics->texture.as<NTexture>();
+        if(ntex) {
+            tex = ntex->nativeTexture().as<ugi::Texture>();
+        }
+        if(!tex) {
+            tex = Package::EmptyTexture();
+        }
+        return tex;
+    }
+
+    // 按 sub-batch 原来的 item 顺序重新生成这一个 sub-batch（改写放不下的时候），其它 sub-batch 不动
+    static bool relayoutSubBatch(ui_render_batches_t& group, size_t subIdx) {
+        auto oldBatch = group.batches[subIdx];
+        frame_vector<image_render_data_t> datas(&GetFrameArena());
+        datas.reserve(oldBatch->spans.size());
+        for(auto const& span: oldBatch->spans) {
+            auto graphics = getRenderResource(span.item);
+            if(!graphics || !graphics->meshData.item) { // 有 item 没 mesh 了，instIndex 要变，只能整个重建
+                return false;
+            }
+            datas.push_back({(image_mesh_t const*)graphics->meshData.item, &graphics->args, span.item, itemTexture(graphics)});
+        }
+        ui_render_batches_t rebuilt = group.type == UIMeshType::Font
+            ? BuildTextRenderBatches(datas, true)
+            : BuildImageRenderBatches(datas, true); // 变过一次的大概率还会变，这次留余量
+        if(rebuilt.batches.size() != 1) {
+            DestroyRenderBatches(rebuilt);
+            return false;
+        }
+        ui_render_batches_t retired = group;
+        retired.batches = { oldBatch };
+        DestroyRenderBatches(retired);
+        group.batches[subIdx] = rebuilt.batches[0];
+        for(auto const& span: rebuilt.batches[0]->spans) { // cachedArgs 是刚从 registry 拷的
+            reg.remove<dispcomp::args_need_sync>(span.item);
+        }
+        return true;
+    }
+
+    static bool patchItem(entt::entity ett, dispcomp::item_batch_info const& info) {
+        auto batchData = getBatchData(info.batchEntity);
+        if(!batchData || info.batchIdx >= (int)batchData->batches.size()) {
+            return false;
+        }
+        auto& group = batchData->batches[info.batchIdx];
+        size_t subIdx = (size_t)info.subIdx;
+        uint32_t idxInSub = (uint32_t)info.instIndex;
+        if(subIdx >= group.batches.size()) {
+            return false;
+        }
+        auto batch = group.batches[subIdx];
+        if(idxInSub >= batch->spans.size() || batch->spans[idxInSub].item != ett) {
+            return false;
+        }
+        auto graphics = getRenderResource(ett);
+        if(!graphics) {
+            return false;
+        }
+        // 材质（类型 + 贴图）变了，batch 的切分和顺序都要变
+        uint32_t slot = batch->cachedArgs[idxInSub].textureSlot;
+        if(graphics->meshData.type != group.type || slot >= batch->textures.size() || itemTexture(graphics) != batch->textures[slot]) {
+            return false;
+        }
+        auto mesh = (image_mesh_t const*)graphics->meshData.item;
+        if(PatchRenderBatchItem(batch, idxInSub, mesh)) {
+            return true;
+        }
+        return relayoutSubBatch(group, subIdx);
+    }
+
+    void patchBatches() {
+        reg.view<dispcomp::mesh_need_patch>().each([](entt::entity ett) {
+            reg.remove<dispcomp::mesh_need_patch>(ett);
+            auto info = reg.try_get<dispcomp::item_batch_info>(ett);
+            if(!info || info->batchIdx < 0) {
+                markBatchNeedRebuild(ett);
+                return;
+            }
+            if(reg.any_of<dispcomp::batch_need_rebuild>(info->batchEntity)) { // 反正要重建
+                return;
+            }
+            if(!patchItem(ett, *info)) {
+                reg.emplace_or_replace<dispcomp::batch_need_rebuild>(info->batchEntity);
+            }
+        });
+    }
+
+    // sub-batch 在哪里切由 renderer 决定（实例上限、顶点上限），build 完按 span 回填每个 item 的位置
+    static void assignBatchIndices(ui_render_batches_t const& group, int batchIdx) {
+        for(size_t subIdx = 0; subIdx < group.batches.size(); ++subIdx) {
+            auto const& spans = group.batches[subIdx]->spans;
+            for(size_t i = 0; i < spans.size(); ++i) {
+                auto& info = reg.get<dispcomp::item_batch_info>(spans[i].item);
+                info.batchIdx = batchIdx;
+                info.subIdx = (int)subIdx;
+                info.instIndex = (int)i;
+            }
+        }
+    }
+
     void rebuildBatches() {
         reg.view<dispcomp::final_visible, dispcomp::batch_need_rebuild, dispcomp::batch_node>().each([](entt::entity ett, dispcomp::batch_node& batchNode) {
             material_batch_desc_t material;
+            // 旧的先回收，池子里的 batch 对象和外层数组的容量这次重建直接复用
             std::vector<ui_render_batches_t> batches;
+            if(auto oldBatches = getBatchData(ett)) {
+                for(auto const& batch: oldBatches->batches) {
+                    DestroyRenderBatches(batch);
+                }
+                batches.swap(oldBatches->batches);
+                batches.clear();
+            }
             //
-            std::vector<void*> renderItems;
-            std::vector<item_args_t*> args;
+            frame_vector<image_render_data_t> renderDatas(&GetFrameArena());
 
             auto breakBatchFn = [&]() {
-                if(renderItems.size()) {
+                if(renderDatas.size()) {
                     switch (material.renderType) {
                     case UIMeshType::None:
                     case UIMeshType::Image: {
-                        auto batch = BuildImageRenderBatches(renderItems, args, material.texture);
+                        auto batch = BuildImageRenderBatches(renderDatas);
                         batch.batchNode = ett;
+                        assignBatchIndices(batch, (int)batches.size());
                         batches.push_back(batch);
                         break;
                     }
                     case UIMeshType::Font: {
-                        auto batch = BuildTextRenderBatches(renderItems, args, material.texture);
+                        auto batch = BuildTextRenderBatches(renderDatas);
                         batch.batchNode = ett;
+                        assignBatchIndices(batch, (int)batches.size());
                         batches.push_back(batch);
                         break;
                     }
@@ -148,8 +270,7 @@ namespace gui {
                     break;
                     }
                 }
-                renderItems.clear();
-                args.clear();
+                renderDatas.clear();
             };
 
             for(auto child: batchNode.children) {
@@ -163,31 +284,21 @@ namespace gui {
                     if(!graphics) { // 没有渲染内容，跳过，像普通的component
                         continue;
                     }
-                    ugi::Texture* tex = nullptr;
-                    auto ntex = graphics->texture.as<NTexture>();
-                    if(ntex) {
-                        tex = ntex->nativeTexture().as<ugi::Texture>();
-                    }
-                    if(!tex) {
-                        tex = Package::EmptyTexture();
-                    }
-                    if(!material.compatible(graphics->meshData.type, tex) && renderItems.size()) {
+                    if(!material.compatible(graphics->meshData.type) && renderDatas.size()) {
                         breakBatchFn();
                     }
                     material.renderType = graphics->meshData.type;
-                    material.texture = tex;
-                    if(graphics->meshData.item) {
-                        renderItems.push_back((void*)graphics->meshData.item);
-                        args.push_back(&graphics->args);
-                    }
                     // rebuild 已同步全部 args，后续 syncDirtyArgs 可跳过此 item
                     reg.remove<dispcomp::args_need_sync>(child);
-                    parentBatch.instIndex = (int)args.size() - 1; // 更新索引
-                    parentBatch.batchIdx  = (int)batches.size();  // 当前所在 sub-batch
+                    if(!graphics->meshData.item) { // 没有 mesh 不进 batch，以后有了 mesh 要重建
+                        parentBatch.batchIdx = -1;
+                        continue;
+                    }
+                    renderDatas.push_back({(image_mesh_t const*)graphics->meshData.item, &graphics->args, child, itemTexture(graphics)});
+                    parentBatch.batchIdx = -1; // build 成功后由 assignBatchIndices 回填
                 } else {
                     breakBatchFn(); // 遇到batch_root也强行中断
                     material.renderType = UIMeshType::None;
-                    material.texture = nullptr;
                     //
                     ui_render_batches_t subBatch;
                     subBatch.type = UIMeshType::SubBatch;
@@ -197,12 +308,6 @@ namespace gui {
             }
             breakBatchFn();
             //
-            dispcomp::batch_data* oldBatches = getBatchData(ett);
-            if(oldBatches) {
-                for(auto const& batch: oldBatches->batches) {
-                    DestroyRenderBatches(batch);
-                }
-            }
             if(batches.size()) {
                 dispcomp::batch_data& batchData = reg.emplace_or_replace<dispcomp::batch_data>(ett);
                 batchData.batches = std::move(batches);
@@ -212,16 +317,15 @@ namespace gui {
         });
     }
 
-    void commitBatchNode(entt::entity ett, glm::mat4 const& parentWorld) {
+    void commitBatchNode(entt::entity ett, affine2d const& parentWorld) {
         auto batchData = getBatchData(ett);
         if(!batchData) {
             return;
         }
-        glm::mat4 localMat(1.0f);
-        if (reg.any_of<dispcomp::batch_local_matrix>(ett)) {
-            localMat = reg.get<dispcomp::batch_local_matrix>(ett).mat;
+        affine2d batchWorld = parentWorld;
+        if (auto cache = reg.try_get<dispcomp::batch_local_matrix>(ett)) {
+            batchWorld = parentWorld * cache->mat;
         }
-        glm::mat4 batchWorld = parentWorld * localMat;
         for(auto& batch: batchData->batches) {
             if(batch.type != UIMeshType::SubBatch) {
                 CommitRenderBatch(batch, batchWorld);
@@ -243,16 +347,20 @@ namespace gui {
         ClearFrameBatchCache();
         auto stage = Stage::Instance();
         auto root = stage->defaultRoot();
-        commitBatchNode(root->getDisplayObject(), glm::mat4(1.0f));
+        commitBatchNode(root->getDisplayObject(), affine2d());
     }
 
     void GuiTick() {
+        GetFrameArena().reset(); // 上一帧的临时内存整个回收
+        Package::TickAsyncLoad(); // 异步加载的包：提交解码好的 atlas，触发完成回调
         updateVisible(); // 更新可见性
         updateBatchNodeTree(); // 维护 batch_node 树结构，传播 dirty 标记
         updateImageMesh(); // 有必要就更新mesh
         updateTextAlignment(); // 根据 text_bounds 重新计算对齐偏移
         updateLocalMatrix(); // batch node 自身矩阵有变化时重算缓存
         updateItemTransforms(); // item 的 Asm_Transform → 重算 local-to-batch 矩阵
+        Stage::Instance()->updateHitTestIndex(); // 变换/结构变化同步到点击索引
+        patchBatches(); // 只有 mesh 变了的 item 原地改写所在 sub-batch，材质变了才标记重建
         rebuildBatches(); // 重建 batch → 新缓存 + 新索引
         syncDirtyArgs(); // 用新索引同步 args_dirty 到 batch cache（上一行才建好的）
         TweenManager::Instance()->update(); // 驱动所有活跃 Tween
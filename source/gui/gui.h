@@ -1,7 +1,15 @@
 #pragma once
+#include <cstdint>
 
 namespace gui {
 
     void GuiTick();
 
+    /*
+     *  image / shape 的 mesh 和文字的 quad 在工作线程里生成（文字的字形还是主线程查），threadCount 为 0 时用 hardware_concurrency - 1
+     *  不初始化就在主线程里串行生成
+     * */
+    void InitializeMeshWorkers(uint32_t threadCount = 0);
+    void DestroyMeshWorkers();
+
 }
\ No newline at end of file
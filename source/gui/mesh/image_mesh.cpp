@@ -6,9 +6,13 @@
 #include "core/font_manager.h"
 #include "render/render_data.h"
 #include "render/ui_render.h"
+#include "text_layout_cache.h"
 // #include "ui_image_render.h"
+#include <ugi/multithread/worker_pool.h>
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <vector>
 
 namespace gui {
 
@@ -64,9 +68,10 @@ static void addQuad(
 
 // ============= createImageMesh =============
 
-image_mesh_t createImageMesh(dispcomp::image_desc_t const& desc, dispcomp::basic_transform const& trans)
+void createImageMesh(dispcomp::image_desc_t const& desc, dispcomp::basic_transform const& trans, image_mesh_t& item)
 {
-    image_mesh_t item;
+    item.vertices.clear();
+    item.indices.clear();
 
     float ctrlW = trans.size.x;
     float ctrlH = trans.size.y;
@@ -90,7 +95,7 @@ image_mesh_t createImageMesh(dispcomp::image_desc_t const& desc, dispcomp::basic
                     uv0, { u1x, u1y }, color, flip, 0);
             }
         }
-        return item;
+        return;
     }
 
     // ---- case 2: 9-slice ----
@@ -142,149 +147,352 @@ image_mesh_t createImageMesh(dispcomp::image_desc_t const& desc, dispcomp::basic
                         color, flip, 0);
             }
         }
-        return item;
+        return;
     }
 
     // ---- case 3: plain image ----
     addQuad(item, { 0, 0 }, { ctrlW, ctrlH }, uv0, uv1, color, flip, 0);
-    return item;
 }
 
     // ============= createTextMesh =============
 
-    image_mesh_t createTextMesh(dispcomp::text_desc_t const& desc,
-                                 dispcomp::basic_transform const& trans,
-                                 float& outWidth, float& outHeight) {
-        image_mesh_t mesh;
+    static TextLayoutCache textLayouts;
+
+    namespace {
+
+        // 排版要的字体参数，主线程从 FontManager 取好
+        struct text_layout_param_t {
+            float   fontSize;
+            float   sdfSourceSize;
+            float   ascent;         // 第一行的基线，像素
+            float   lineHeight;
+        };
+
+        // 查好的字形，newline 为 true 时 info 没用
+        struct text_glyph_t {
+            GlyphInfo   info;
+            bool        newline;
+        };
+
+        text_layout_param_t textLayoutParam(FontManager* fm, dispcomp::text_desc_t const& desc) {
+            auto metrics = fm->getMetrics(desc.fontID, desc.fontSize);
+            text_layout_param_t param;
+            param.fontSize = desc.fontSize;
+            param.sdfSourceSize = (float)fm->config().sdfSourceSize;
+            param.ascent = (float)metrics.ascent * metrics.scale;
+            param.lineHeight = (float)(metrics.ascent - metrics.descent + metrics.lineGap) * metrics.scale;
+            return param;
+        }
+
+        // 解 UTF-8、逐字查 FontManager（会生成 SDF、改 LRU），只能在主线程调用
+        void resolveGlyphs(FontManager* fm, dispcomp::text_desc_t const& desc, std::vector<text_glyph_t>& glyphs) {
+            for (size_t i = 0; i < desc.text.size(); ++i) {
+                uint32_t ch = (uint8_t)desc.text[i];
+                if ((ch & 0x80u) && i + 1 < desc.text.size()) {
+                    uint32_t ch2 = (uint8_t)desc.text[i+1];
+                    if ((ch & 0xE0u) == 0xC0u) { ch = ((ch & 0x1Fu) << 6) | (ch2 & 0x3Fu); i++; }
+                    else if ((ch & 0xF0u) == 0xE0u && i + 2 < desc.text.size()) {
+                        uint32_t ch3 = (uint8_t)desc.text[i+2];
+                        ch = ((ch & 0x0Fu) << 12) | ((ch2 & 0x3Fu) << 6) | (ch3 & 0x3Fu); i += 2;
+                    }
+                }
+                if (ch == '\n') { glyphs.push_back({ {}, true }); continue; }
+                if (ch == '\r') continue;
+
+                auto gi = fm->getGlyph(desc.fontID, ch);
+                if (gi.bitmapWidth == 0) continue;
+                glyphs.push_back({ gi, false });
+            }
+        }
+
+        // 只用查好的字形拼 quad，不碰 FontManager，可以在工作线程调用
+        void emitTextQuads(text_layout_param_t const& param, text_glyph_t const* glyphs, size_t count,
+                           image_mesh_t& mesh, float& outWidth, float& outHeight) {
+            float penX = 0;
+            float penY = param.ascent;
+            uint32_t color = 0xffffffff;// desc.color;
+            float minX = 0, maxX = 0, minY = 0, maxY = 0;
+
+            for (size_t i = 0; i < count; ++i) {
+                if (glyphs[i].newline) { penX = 0; penY += param.lineHeight; continue; }
+                auto const& gi = glyphs[i].info;
+
+                float gScale = param.fontSize / (gi.SDFScale * param.sdfSourceSize);
+                float qx = penX + gi.bitmapBearingX * gScale;
+                float qy = penY + gi.bitmapBearingY * gScale;
+                float qw = (float)gi.bitmapWidth  * gScale;
+                float qh = (float)gi.bitmapHeight * gScale;
+
+                uint16_t base = (uint16_t)mesh.vertices.size();
+                mesh.vertices.push_back({{qx, qy, 0}, color, {gi.texU, gi.texV}, 0});
+                mesh.vertices.push_back({{qx+qw, qy, 0}, color, {gi.texU+gi.texW, gi.texV}, 0});
+                mesh.vertices.push_back({{qx+qw, qy+qh, 0}, color, {gi.texU+gi.texW, gi.texV+gi.texH}, 0});
+                mesh.vertices.push_back({{qx, qy+qh, 0}, color, {gi.texU, gi.texV+gi.texH}, 0});
+                mesh.indices.insert(mesh.indices.end(), {base, (uint16_t)(base+1), (uint16_t)(base+2),
+                                                          base, (uint16_t)(base+2), (uint16_t)(base+3)});
+                if (qx < minX) minX = qx;
+                if (qx+qw > maxX) maxX = qx+qw;
+                if (qy < minY) minY = qy;
+                if (qy+qh > maxY) maxY = qy+qh;
+                penX += gi.bitmapAdvance * gScale;
+            }
+            outWidth  = maxX - minX;
+            outHeight = maxY - minY;
+        }
+
+        std::vector<text_glyph_t>   singleTextGlyphs;  // createTextMesh 用，主线程
+
+    }
+
+    void createTextMesh(dispcomp::text_desc_t const& desc,
+                        dispcomp::basic_transform const& trans,
+                        image_mesh_t& out, float& outWidth, float& outHeight) {
+        out.vertices.clear();
+        out.indices.clear();
         outWidth = 0; outHeight = 0;
 
         auto* fm = FontManager::Instance();
-        if (!fm || desc.fontID < 0 || desc.text.empty()) return mesh;
-
-        auto metrics = fm->getMetrics(desc.fontID, desc.fontSize);
-        float sfScale = metrics.scale;
-        float sdfSrcSize = (float)fm->config().sdfSourceSize;
-
-        float penX = 0;
-        float penY = (float)metrics.ascent * sfScale;
-        float lineH = (float)(metrics.ascent - metrics.descent + metrics.lineGap) * sfScale;
-        uint32_t color = 0xffffffff;// desc.color;
-        float minX = 0, maxX = 0, minY = 0, maxY = 0;
-
-        for (size_t i = 0; i < desc.text.size(); ++i) {
-            uint32_t ch = (uint8_t)desc.text[i];
-            if ((ch & 0x80u) && i + 1 < desc.text.size()) {
-                uint32_t ch2 = (uint8_t)desc.text[i+1];
-                if ((ch & 0xE0u) == 0xC0u) { ch = ((ch & 0x1Fu) << 6) | (ch2 & 0x3Fu); i++; }
-                else if ((ch & 0xF0u) == 0xE0u && i + 2 < desc.text.size()) {
-                    uint32_t ch3 = (uint8_t)desc.text[i+2];
-                    ch = ((ch & 0x0Fu) << 12) | ((ch2 & 0x3Fu) << 6) | (ch3 & 0x3Fu); i += 2;
+        if (!fm || desc.fontID < 0 || desc.text.empty()) return;
+
+        uint32_t generation = fm->atlasGeneration();
+        if (auto layout = textLayouts.find(desc.text, desc.fontID, desc.fontSize, generation)) {
+            out.vertices.assign(layout->mesh.vertices.begin(), layout->mesh.vertices.end());
+            out.indices.assign(layout->mesh.indices.begin(), layout->mesh.indices.end());
+            outWidth = layout->width;
+            outHeight = layout->height;
+            return;
+        }
+        singleTextGlyphs.clear();
+        resolveGlyphs(fm, desc, singleTextGlyphs);
+        emitTextQuads(textLayoutParam(fm, desc), singleTextGlyphs.data(), singleTextGlyphs.size(), out, outWidth, outHeight);
+        if (fm->atlasGeneration() == generation) { // 排版过程中淘汰了字形的话，这份结果不进缓存
+            textLayouts.store(desc.text, desc.fontID, desc.fontSize, generation, out, outWidth, outHeight);
+        }
+    }
+
+    // ============= updateImageMesh =============
+
+    namespace {
+
+        // image / shape 的 mesh 只依赖 desc + basic_transform，可以放到工作线程里生成
+        struct mesh_job_t {
+            entt::entity                        ett;
+            dispcomp::image_desc_t const*       image;      // image 和 shape 二选一
+            dispcomp::shape_desc_t const*       shape;
+            dispcomp::basic_transform const*    trans;
+            image_mesh_t*                       mesh;       // item 自己的 mesh，原地重写，不再每次 new
+        };
+
+        // 文字：主线程查好字形（或者命中排版缓存直接拷），拼 quad 放到工作线程
+        struct text_job_t {
+            entt::entity                        ett;
+            dispcomp::text_desc_t const*        desc;
+            text_layout_param_t                 param;
+            uint32_t                            glyphBegin; // 在 textGlyphs 里的范围
+            uint32_t                            glyphEnd;
+            uint32_t                            generation; // 查字形之前的 atlasGeneration，没变才进排版缓存
+            bool                                cached;     // 命中排版缓存，mesh 已经拷好了
+            image_mesh_t*                       mesh;
+            float                               width;      // 工作线程写
+            float                               height;
+        };
+
+        constexpr size_t MinJobsPerTask = 64;   // 太少了不值得分发
+        constexpr size_t MinTextJobsPerTask = 16;
+
+        ugi::WorkerPool*            meshWorkers = nullptr;
+        std::vector<mesh_job_t>     meshJobs;   // 每帧复用
+        std::vector<text_job_t>     textJobs;
+        std::vector<text_glyph_t>   textGlyphs;
+        uint32_t                    textAtlasGeneration = 0;   // 上次全部文字 mesh 对齐时的 FontManager::atlasGeneration
+
+        image_mesh_t* acquireItemMesh(dispcomp::item_render_data& graphics) {
+            if (!graphics.meshData.item) {
+                graphics.meshData.item = new image_mesh_t();
+            }
+            return (image_mesh_t*)graphics.meshData.item;
+        }
+
+        void collectTextJobs() {
+            reg.view<dispcomp::mesh_dirty, dispcomp::final_visible, dispcomp::text_desc_t>().each([](entt::entity ett, dispcomp::text_desc_t& textDesc) {
+                dispcomp::item_render_data& graphics = reg.get_or_emplace<dispcomp::item_render_data>(ett);
+                graphics.meshData.type = UIMeshType::Font;
+                auto* fm = FontManager::Instance();
+                text_job_t job = {};
+                job.ett = ett;
+                job.desc = &textDesc;
+                job.mesh = acquireItemMesh(graphics);
+                job.mesh->vertices.clear();
+                job.mesh->indices.clear();
+                job.cached = true; // 没东西可排的也当作已经做完
+                if (fm) {
+                    graphics.texture = fm->sdfTexture()->handle();
+                    if (textDesc.fontID >= 0 && !textDesc.text.empty()) {
+                        job.generation = fm->atlasGeneration();
+                        if (auto layout = textLayouts.find(textDesc.text, textDesc.fontID, textDesc.fontSize, job.generation)) {
+                            job.mesh->vertices.assign(layout->mesh.vertices.begin(), layout->mesh.vertices.end());
+                            job.mesh->indices.assign(layout->mesh.indices.begin(), layout->mesh.indices.end());
+                            job.width = layout->width;
+                            job.height = layout->height;
+                        } else {
+                            job.cached = false;
+                            job.param = textLayoutParam(fm, textDesc);
+                            job.glyphBegin = (uint32_t)textGlyphs.size();
+                            resolveGlyphs(fm, textDesc, textGlyphs);
+                            job.glyphEnd = (uint32_t)textGlyphs.size();
+                        }
+                    }
+                }
+                textJobs.push_back(job);
+                reg.remove<dispcomp::mesh_dirty>(ett);
+            });
+        }
+
+        void runMeshJobs(size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                auto const& job = meshJobs[i];
+                if (job.image) {
+                    createImageMesh(*job.image, *job.trans, *job.mesh);
+                } else {
+                    createShapeMesh(*job.shape, *job.trans, *job.mesh);
+                }
+            }
+        }
+
+        void runTextJobs(size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                auto& job = textJobs[i];
+                if (!job.cached) {
+                    emitTextQuads(job.param, textGlyphs.data() + job.glyphBegin, job.glyphEnd - job.glyphBegin, *job.mesh, job.width, job.height);
                 }
             }
-            if (ch == '\n') { penX = 0; penY += lineH; continue; }
-            if (ch == '\r') continue;
-
-            auto gi = fm->getGlyph(desc.fontID, ch);
-            if (gi.bitmapWidth == 0) continue;
-
-            float gScale = desc.fontSize / (gi.SDFScale * sdfSrcSize);
-            float qx = penX + gi.bitmapBearingX * gScale;
-            float qy = penY + gi.bitmapBearingY * gScale;
-            float qw = (float)gi.bitmapWidth  * gScale;
-            float qh = (float)gi.bitmapHeight * gScale;
-
-            uint16_t base = (uint16_t)mesh.vertices.size();
-            mesh.vertices.push_back({{qx, qy, 0}, color, {gi.texU, gi.texV}, 0});
-            mesh.vertices.push_back({{qx+qw, qy, 0}, color, {gi.texU+gi.texW, gi.texV}, 0});
-            mesh.vertices.push_back({{qx+qw, qy+qh, 0}, color, {gi.texU+gi.texW, gi.texV+gi.texH}, 0});
-            mesh.vertices.push_back({{qx, qy+qh, 0}, color, {gi.texU, gi.texV+gi.texH}, 0});
-            mesh.indices.insert(mesh.indices.end(), {base, (uint16_t)(base+1), (uint16_t)(base+2),
-                                                      base, (uint16_t)(base+2), (uint16_t)(base+3)});
-            if (qx < minX) minX = qx;
-            if (qx+qw > maxX) maxX = qx+qw;
-            if (qy < minY) minY = qy;
-            if (qy+qh > maxY) maxY = qy+qh;
-            penX += gi.bitmapAdvance * gScale;
         }
-        outWidth  = maxX - minX;
-        outHeight = maxY - minY;
-        return mesh;
+
+        // 分段丢给工作线程，返回投递了几个任务，0 表示已经在当前线程做完
+        template<class Run>
+        uint32_t dispatchJobs(size_t jobCount, size_t minJobsPerTask, Run run) {
+            uint32_t taskCount = 0;
+            if (meshWorkers) {
+                taskCount = (uint32_t)std::min<size_t>(meshWorkers->threadCount(), jobCount / minJobsPerTask);
+            }
+            if (taskCount > 1) {
+                size_t step = (jobCount + taskCount - 1) / taskCount;
+                for (size_t begin = 0; begin < jobCount; begin += step) {
+                    size_t end = std::min(begin + step, jobCount);
+                    meshWorkers->post([run, begin, end]() {
+                        run(begin, end);
+                    });
+                }
+                return taskCount;
+            }
+            run(0, jobCount);
+            return 0;
+        }
+
     }
 
-    // ============= updateImageMesh =============
+    void InitializeMeshWorkers(uint32_t threadCount) {
+        if (meshWorkers) {
+            return;
+        }
+        meshWorkers = new ugi::WorkerPool();
+        meshWorkers->initialize(threadCount);
+    }
+
+    void DestroyMeshWorkers() {
+        if (!meshWorkers) {
+            return;
+        }
+        meshWorkers->destroy();
+        delete meshWorkers;
+        meshWorkers = nullptr;
+    }
 
     void updateImageMesh()
     {
-        // Image
+        // 1. 主线程收集 image / shape 任务，registry 只在主线程改
+        meshJobs.clear();
         reg.view<dispcomp::mesh_dirty, dispcomp::final_visible, dispcomp::image_desc_t>().each([](entt::entity ett, dispcomp::image_desc_t& imageDesc) {
             dispcomp::item_render_data& graphics = reg.get_or_emplace<dispcomp::item_render_data>(ett);
             graphics.meshData.type = UIMeshType::Image;
-            if (graphics.meshData.item) {
-                delete (image_mesh_t*)graphics.meshData.item;
-            }
-            auto& trans = reg.get<dispcomp::basic_transform>(ett);
-            auto* mesh = new image_mesh_t(std::move(createImageMesh(imageDesc, trans)));
-            graphics.meshData.item = mesh;
-            graphics.args.transfrom = glm::mat4(1.0f);
+            meshJobs.push_back({ett, &imageDesc, nullptr, &reg.get<dispcomp::basic_transform>(ett), acquireItemMesh(graphics)});
+            graphics.args.transfrom = affine2d();
             auto& sync = reg.get_or_emplace<dispcomp::args_need_sync>(ett);
             sync.mask |= dispcomp::Asm_Transform;
             reg.remove<dispcomp::mesh_dirty>(ett);
         });
-
-        // Text
-        reg.view<dispcomp::mesh_dirty, dispcomp::final_visible, dispcomp::text_desc_t>().each([](entt::entity ett, dispcomp::text_desc_t& textDesc) {
+        // Shape (GGraph)
+        reg.view<dispcomp::mesh_dirty, dispcomp::final_visible, dispcomp::shape_desc_t>().each([](entt::entity ett, dispcomp::shape_desc_t& shapeDesc) {
             dispcomp::item_render_data& graphics = reg.get_or_emplace<dispcomp::item_render_data>(ett);
-            graphics.meshData.type = UIMeshType::Font;
-            if (graphics.meshData.item) {
+            graphics.meshData.type = UIMeshType::Image;
+            meshJobs.push_back({ett, nullptr, &shapeDesc, &reg.get<dispcomp::basic_transform>(ett), acquireItemMesh(graphics)});
+            graphics.args.transfrom = affine2d();
+            auto& sync = reg.get_or_emplace<dispcomp::args_need_sync>(ett);
+            sync.mask |= dispcomp::Asm_Transform;
+            reg.remove<dispcomp::mesh_dirty>(ett);
+        });
+
+        // 2. 分段丢给工作线程，每个任务只写自己 item 的 mesh
+        uint32_t taskCount = dispatchJobs(meshJobs.size(), MinJobsPerTask, runMeshJobs);
+
+        // 3. Text 的字形要查 FontManager（会生成 SDF、改 LRU），不是线程安全的，在主线程查好，和上面的任务并行
+        auto* fm = FontManager::Instance();
+        textJobs.clear();
+        textGlyphs.clear();
+        collectTextJobs();
+        // 字形被淘汰（图集放不下了挤掉的、整层回收的）之后，已经生成的文字 mesh 里的 UV 可能已经分给别的字了
+        // 全部重新生成一遍，用到的字形会重新进图集；这一轮又有淘汰的话留到下一帧
+        if (fm && fm->atlasGeneration() != textAtlasGeneration) {
+            textAtlasGeneration = fm->atlasGeneration();
+            reg.view<dispcomp::text_desc_t>().each([](entt::entity ett, dispcomp::text_desc_t&) {
+                reg.emplace_or_replace<dispcomp::mesh_dirty>(ett);
+                if (reg.all_of<dispcomp::final_visible, dispcomp::item_render_data>(ett)) {
+                    reg.emplace_or_replace<dispcomp::mesh_need_patch>(ett); // updateBatchNodeTree 已经跑过了，直接交给 patchBatches
+                }
+            });
+            textJobs.clear();
+            textGlyphs.clear();
+            collectTextJobs();
+        }
+        // 拼 quad 只读 textGlyphs，也交给工作线程
+        taskCount += dispatchJobs(textJobs.size(), MinTextJobsPerTask, runTextJobs);
+
+        // 4. 等工作线程做完，主线程提交结果
+        if (taskCount) {
+            meshWorkers->waitIdle();
+        }
+        for (auto const& job : meshJobs) {
+            if (job.shape && job.mesh->vertices.empty()) { // 空的 shape 不进 batch
+                auto& graphics = reg.get<dispcomp::item_render_data>(job.ett);
                 delete (image_mesh_t*)graphics.meshData.item;
                 graphics.meshData.item = nullptr;
             }
-            auto* fm = FontManager::Instance();
-            float sdfSrcSize = fm ? (float)fm->config().sdfSourceSize : 64.0f;
-            if (fm) {
-                graphics.texture = fm->sdfTexture()->handle();
-            }
-            auto& textTrans = reg.get<dispcomp::basic_transform>(ett);
-            float textW, textH;
-            image_mesh_t mesh = createTextMesh(textDesc, textTrans, textW, textH);
-            if(mesh.vertices.size()) {
-                auto* meshItem = new image_mesh_t(std::move(mesh));
-                graphics.meshData.item = meshItem;
+        }
+        for (auto const& job : textJobs) {
+            if (job.mesh->vertices.size()) {
                 // TODO: SDF smoothing params (baseSmoothing, sizeScale) need a proper packing location;
                 // currently vertex shader hardcodes props to (0,0,0,0), so smoothing defaults to 0.03.
-                auto& bounds = reg.get_or_emplace<dispcomp::text_bounds>(ett);
-                bounds.width  = textW;
-                bounds.height = textH;
-            }
-            reg.remove<dispcomp::mesh_dirty>(ett);
-        });
-
-        // Shape (GGraph)
-        reg.view<dispcomp::mesh_dirty, dispcomp::final_visible, dispcomp::shape_desc_t>().each([](entt::entity ett, dispcomp::shape_desc_t& shapeDesc) {
-            dispcomp::item_render_data& graphics = reg.get_or_emplace<dispcomp::item_render_data>(ett);
-            graphics.meshData.type = UIMeshType::Image;
-            if (graphics.meshData.item) {
+                auto& bounds = reg.get_or_emplace<dispcomp::text_bounds>(job.ett);
+                bounds.width  = job.width;
+                bounds.height = job.height;
+                if (!job.cached && fm->atlasGeneration() == job.generation) { // 排版过程中淘汰了字形的话，这份结果不进缓存
+                    textLayouts.store(job.desc->text, job.desc->fontID, job.desc->fontSize, job.generation, *job.mesh, job.width, job.height);
+                }
+            } else {
+                auto& graphics = reg.get<dispcomp::item_render_data>(job.ett);
                 delete (image_mesh_t*)graphics.meshData.item;
                 graphics.meshData.item = nullptr;
             }
-            auto& trans = reg.get<dispcomp::basic_transform>(ett);
-            auto mesh = createShapeMesh(shapeDesc, trans);
-            if (mesh.vertices.size()) {
-                graphics.meshData.item = new image_mesh_t(std::move(mesh));
-            }
-            graphics.args.transfrom = glm::mat4(1.0f);
-            auto& sync = reg.get_or_emplace<dispcomp::args_need_sync>(ett);
-            sync.mask |= dispcomp::Asm_Transform;
-            reg.remove<dispcomp::mesh_dirty>(ett);
-        });
+        }
     }
 
     // ============= createShapeMesh =============
 
-    image_mesh_t createShapeMesh(dispcomp::shape_desc_t const& desc, dispcomp::basic_transform const& trans) {
-        image_mesh_t m;
+    void createShapeMesh(dispcomp::shape_desc_t const& desc, dispcomp::basic_transform const& trans, image_mesh_t& m) {
+        m.vertices.clear();
+        m.indices.clear();
         float w = trans.size.x, h = trans.size.y;
-        if (w <= 0 || h <= 0) return m;
+        if (w <= 0 || h <= 0) return;
         uint32_t fillC = desc.fillColor;
         uint32_t lineC = desc.lineColor;
         float    ls    = desc.lineSize;
@@ -485,7 +693,6 @@ image_mesh_t createImageMesh(dispcomp::image_desc_t const& desc, dispcomp::basic
             break;
         }
         }
-        return m;
     }
 
     // ============= updateTextAlignment =============
@@ -7,12 +7,14 @@ namespace gui {
     /// <summary>
     /// 根据 image_desc 和控件变换信息生成 mesh 数据
     /// 支持普通/九宫/平铺三种模式，flip UV 已内置
+    /// out 会先清空，保留原来的容量；只读 desc 和 trans，可以在工作线程调用
     /// </summary>
-    image_mesh_t createImageMesh(dispcomp::image_desc_t const& desc, dispcomp::basic_transform const& trans);
-    image_mesh_t createTextMesh(dispcomp::text_desc_t const& desc,
-                                 dispcomp::basic_transform const& trans,
-                                 float& outWidth, float& outHeight);
-    image_mesh_t createShapeMesh(dispcomp::shape_desc_t const& desc, dispcomp::basic_transform const& trans);
+    void createImageMesh(dispcomp::image_desc_t const& desc, dispcomp::basic_transform const& trans, image_mesh_t& out);
+    /// 同样的文本/字体/字号走 TextLayoutCache，只拷顶点；要查 FontManager，只能在主线程调用
+    void createTextMesh(dispcomp::text_desc_t const& desc,
+                        dispcomp::basic_transform const& trans,
+                        image_mesh_t& out, float& outWidth, float& outHeight);
+    void createShapeMesh(dispcomp::shape_desc_t const& desc, dispcomp::basic_transform const& trans, image_mesh_t& out); // 同 createImageMesh
 
     void updateImageMesh();
     void updateTextAlignment();
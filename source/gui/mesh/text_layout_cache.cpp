@@ -0,0 +1,59 @@
+#include "text_layout_cache.h"
+#include <functional>
+#include <cstring>
+
+namespace gui {
+
+    uint64_t TextLayoutCache::hashKey(std::string_view text, int fontID, float fontSize) {
+        uint32_t sizeBits;
+        memcpy(&sizeBits, &fontSize, sizeof(sizeBits));
+        uint64_t h = std::hash<std::string_view>{}(text);
+        h ^= ((uint64_t)(uint32_t)fontID << 32 | sizeBits) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        return h;
+    }
+
+    void TextLayoutCache::validate(uint32_t atlasGeneration) {
+        if (atlasGeneration != _generation) {
+            clear();
+            _generation = atlasGeneration;
+        }
+    }
+
+    TextLayoutCache::layout_t const* TextLayoutCache::find(std::string_view text, int fontID, float fontSize, uint32_t atlasGeneration) {
+        validate(atlasGeneration);
+        auto it = _entries.find(hashKey(text, fontID, fontSize));
+        if (it != _entries.end()) {
+            auto const& layout = it->second->second;
+            // hash 撞了就当没命中，store 的时候会覆盖
+            if (layout.fontID == fontID && layout.fontSize == fontSize && layout.text == text) {
+                _lruList.splice(_lruList.begin(), _lruList, it->second);
+                ++_hits;
+                return &layout;
+            }
+        }
+        ++_misses;
+        return nullptr;
+    }
+
+    void TextLayoutCache::store(std::string_view text, int fontID, float fontSize, uint32_t atlasGeneration,
+                                image_mesh_t const& mesh, float width, float height) {
+        validate(atlasGeneration);
+        uint64_t key = hashKey(text, fontID, fontSize);
+        auto it = _entries.find(key);
+        if (it != _entries.end()) {
+            _lruList.erase(it->second);
+            _entries.erase(it);
+        } else if (_entries.size() >= MaxEntries) {
+            _entries.erase(_lruList.back().first);
+            _lruList.pop_back();
+        }
+        _lruList.emplace_front(key, layout_t{ std::string(text), fontID, fontSize, mesh, width, height });
+        _entries[key] = _lruList.begin();
+    }
+
+    void TextLayoutCache::clear() {
+        _lruList.clear();
+        _entries.clear();
+    }
+
+}
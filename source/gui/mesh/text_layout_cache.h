@@ -0,0 +1,53 @@
+#pragma once
+#include "render/render_data.h"
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace gui {
+
+    /*
+     *  文本排版缓存：同样的 (文本, fontID, fontSize) 排出来的字形 quad 完全一样
+     *  mesh 是控件局部空间的，位置/颜色走 args，所以只改颜色、位置、对齐的时候直接拷一份缓存的顶点就行，
+     *  不用再解 UTF-8、逐字查 FontManager、算换行
+     *  1. 对齐不影响 mesh（updateTextAlignment 挪的是 position），目前也没有按宽度自动换行，所以不进 key
+     *  2. FontManager 的 atlasGeneration 变了（有字形被淘汰）就整个作废，缓存里的 UV 可能已经不对了
+     *  3. LRU，和 FontManager 的字形缓存一个套路
+     * */
+    class TextLayoutCache {
+    public:
+        static constexpr size_t MaxEntries = 256;
+
+        struct layout_t {
+            std::string     text;
+            int             fontID;
+            float           fontSize;
+            image_mesh_t    mesh;
+            float           width;
+            float           height;
+        };
+    private:
+        using LruIter = std::list<std::pair<uint64_t, layout_t>>::iterator;
+        std::list<std::pair<uint64_t, layout_t>>    _lruList;   // front = MRU
+        std::unordered_map<uint64_t, LruIter>       _entries;   // key hash → 在 _lruList 中的位置
+        uint32_t                                    _generation = 0;
+        uint32_t                                    _hits = 0;
+        uint32_t                                    _misses = 0;
+
+        static uint64_t hashKey(std::string_view text, int fontID, float fontSize);
+        void validate(uint32_t atlasGeneration);
+    public:
+        /// 命中返回缓存的排版并移到最前，没有返回 nullptr
+        layout_t const* find(std::string_view text, int fontID, float fontSize, uint32_t atlasGeneration);
+        /// 存一份排版结果，满了淘汰最久没用的
+        void store(std::string_view text, int fontID, float fontSize, uint32_t atlasGeneration,
+                   image_mesh_t const& mesh, float width, float height);
+        void clear();
+
+        uint32_t hits() const { return _hits; }
+        uint32_t misses() const { return _misses; }
+    };
+
+}
@@ -2,13 +2,16 @@
 #include <gui/core/declare.h>
 #include <LightWeightCommon/utils/handle.h>
 #include <core/data_types/ui_types.h>
+#include <core/data_types/affine2d.h>
 #include <core/n_texture.h>
 #include "ugi_declare.h"
 #include "ugi_types.h"
 #include <glm/glm.hpp>
 #include <algorithm>
 #include <vector>
+#include <span>
 #include <entt/entt.hpp>
+#include <utils/frame_arena.h>
 
 namespace gui {
 
@@ -67,13 +70,16 @@ namespace gui {
     }
 
     // shader uniform buffer desc
+    // std140 下结构体数组步长按 16 字节对齐：24 (affine) + 16 (packed) + 8 (padding) = 48 字节
     struct item_args_t {
-        glm::mat4   transfrom;
+        affine2d    transfrom;  // 相对所属 batch 节点的 2D 仿射变换
         uint32_t    colorPacked = 0xFFFFFFFF; // packed RGBA 8-bit per channel (white/opaque default)
         uint32_t    packedProps = 0; // low 8 bits: gray (0..255), next 8 bits: hdr (0..255), rest reserved
         // packed outline / shadow / effect params — placed here so image items can ignore them
         uint32_t    outlineColorPacked = 0; // packed RGBA 8-bit per channel
         uint32_t    packedParamSDF = 0; // low 8 bits: outlineWidth, next 8 bits: shadowOffsetX, next 8 bits: shadowOffsetY, top 8 bits: effectType
+        uint32_t    textureSlot = 0; // batch 内的贴图槽位，build 时由 renderer 填，registry 里的不用管
+        uint32_t    _padding = 0;
 
         void setGray(float gray) {
             packedProps = (packedProps & 0xFFFFFF00u) | (uint32_t)(std::clamp(int(std::round(gray * 255.0f)), 0, 255));
@@ -85,20 +91,73 @@ namespace gui {
             packedParamSDF = (packedParamSDF & 0x00FFFFFFu) | ((uint32_t)(effect & 0xFFu) << 24);
         }
     };
+    static_assert(sizeof(item_args_t) == 48, "item_args_t must match InstanceData in fgui_image/fgui_text shaders");
 
     struct image_render_data_t {
         image_mesh_t const*         item;
         item_args_t const*          args;
+        entt::entity                ett;
+        ugi::Texture*               texture;
     };
 
+    // sub-batch 里一个 item 占的顶点/索引区间（相对 sub-batch 的 mesh），下标就是 instIndex
+    // capacity 比实际多留一些，mesh 变了还放得下就原地改写这一段，多出来的索引填退化三角形
+    struct item_span_t {
+        entt::entity    item;
+        uint32_t        vertexOffset;
+        uint32_t        vertexCapacity;
+        uint32_t        indexOffset;
+        uint32_t        indexCapacity;     // 偶数，改写时 vkCmdUpdateBuffer 要求 4 字节对齐
+    };
+
+    // 经常变的 mesh（文字）多留一半空间，至少留 4 个字
+    constexpr uint32_t SpanMinGrowVertices = 16;
+    constexpr uint32_t SpanMinGrowIndices = 24;
+    constexpr uint32_t MaxBatchVertexCount = 65536; // 16 位索引
+    constexpr uint32_t UBOInstanceCapacity = 512;   // UBO 版本 shader 里 imageDatas[512]
+    constexpr uint32_t MaxBatchTextureSlots = 6;    // 多贴图版本 set 0 里 args、sampler 之后剩下的 binding
+
+    inline uint32_t spanVertexCapacity(image_mesh_t const& mesh, bool growable) {
+        uint32_t count = (uint32_t)mesh.vertices.size();
+        return growable ? count + std::max(count / 2, SpanMinGrowVertices) : count;
+    }
+
+    inline uint32_t spanIndexCapacity(image_mesh_t const& mesh, bool growable) {
+        uint32_t count = (uint32_t)mesh.indices.size();
+        count = growable ? count + std::max(count / 2, SpanMinGrowIndices) : count;
+        return (count + 1) & ~1u;
+    }
+
+    // 把 item 的 mesh 按 capacity 追加到 sub-batch 的顶点/索引数组里
+    inline item_span_t appendItemSpan(frame_vector<image_vertex_t>& vertices, frame_vector<uint16_t>& indices, image_render_data_t const& data, uint32_t instIndex, bool growable) {
+        auto const& mesh = *data.item;
+        item_span_t span; {
+            span.item = data.ett;
+            span.vertexOffset = (uint32_t)vertices.size();
+            span.vertexCapacity = spanVertexCapacity(mesh, growable);
+            span.indexOffset = (uint32_t)indices.size();
+            span.indexCapacity = spanIndexCapacity(mesh, growable);
+        }
+        vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+        vertices.resize(span.vertexOffset + span.vertexCapacity, mesh.vertices.size() ? mesh.vertices.front() : image_vertex_t{});
+        for(auto i = span.vertexOffset; i < vertices.size(); ++i) {
+            vertices[i].instIndex = instIndex;
+        }
+        for(auto index : mesh.indices) {
+            indices.push_back((uint16_t)(index + span.vertexOffset));
+        }
+        indices.resize(span.indexOffset + span.indexCapacity, (uint16_t)span.vertexOffset);
+        return span;
+    }
+
     struct ui_render_batch_t {
         ugi::Renderable*                renderable;
         ugi::res_descriptor_t           argsDetor;
         ugi::res_descriptor_t           samplerDetor;
-        ugi::res_descriptor_t           textureDetor;
         std::vector<item_args_t>        cachedArgs;   // args 缓存，build 时从 registry 拷贝，draw 时直接 memcpy
         ugi::sampler_state_t            sampler;
-        Handle                          texture; // 是 raw texture，原生的，不是NTexture
+        std::vector<ugi::Texture*>      textures;     // 贴图槽位表，下标就是 item_args_t::textureSlot，是 raw texture，不是NTexture
+        std::vector<item_span_t>        spans;
     };
 
     enum class UIMeshType {
@@ -1,5 +1,6 @@
 #include "text_sdf_render.h"
 #include "render_data.h"
+#include "ui_render.h"
 #include "ugi_types.h"
 #include <ugi/device.h>
 #include <ugi/command_buffer.h>
@@ -10,6 +11,7 @@
 #include <ugi/render_components/mesh.h>
 #include <ugi/render_components/renderable.h>
 #include <ugi/render_components/pipeline_material.h>
+#include <ugi/gpu_retire_manager.h>
 #include <cstring>
 
 namespace gui {
@@ -36,12 +38,15 @@ namespace gui {
 
     void TextSDFRender::initialize(ugi::Device* device, ugi::GraphicsPipeline* pipeline,
                                    ugi::MeshBufferAllocator* msalloc, ugi::UniformAllocator* uniformAllocator,
-                                   ugi::GPUAsyncLoadManager* asyncLoaderManager) {
+                                   ugi::GPUAsyncLoadManager* asyncLoaderManager, ugi::UniformAllocator* storageAllocator) {
         _pipeline = pipeline;
+        _pipeline->setCompileMode(ugi::pipeline_compile_mode_t::AsyncFallback);
         _bufferAllocator = msalloc;
         _uniformAllocator = uniformAllocator;
         _device = device;
         _asyncLoadManager = asyncLoaderManager;
+        _argsAllocator = ArgsAllocatorFor(_pipeline, uniformAllocator, storageAllocator);
+        _maxInstancesPerBatch = ItemArgsCapacity(device, _pipeline, _argsAllocator);
         initialize_();
     }
 
@@ -55,10 +60,23 @@ namespace gui {
 
     void TextSDFRender::tick() {
         _pipeline->resetMaterials();
+        _bufferAllocator->onFrameTick();
     }
 
-    void TextSDFRender::bind(ugi::RenderCommandEncoder* encoder) {
-        encoder->bindPipeline(_pipeline);
+    void TextSDFRender::releasePool() {
+        for(auto renderable: _renderablePool) {
+            delete renderable; // mesh 已经释放，这里连同 Material 一起删
+        }
+        _renderablePool.clear();
+        _renderablePool.shrink_to_fit();
+    }
+
+    void TextSDFRender::compactMeshBuffer(ugi::ResourceCommandEncoder* encoder) {
+        _bufferAllocator->defragment(encoder);
+    }
+
+    bool TextSDFRender::bind(ugi::RenderCommandEncoder* encoder) {
+        return encoder->bindPipeline(_pipeline);
     }
 
     void TextSDFRender::draw(ugi::RenderCommandEncoder* enc, ugi::Renderable* renderable) {
@@ -67,6 +85,14 @@ namespace gui {
         enc->draw(renderable->mesh(), renderable->mesh()->indexCount());
     }
 
+    VkPipeline TextSDFRender::resolvePipeline(ugi::RenderCommandEncoder const* encoder) {
+        return _pipeline->resolvePipeline(encoder);
+    }
+
+    ugi::DescriptorBinder* TextSDFRender::createDescriptorBinder() const {
+        return _pipeline->createArgumentGroup();
+    }
+
     ugi::Renderable* TextSDFRender::createRenderable(uint8_t const* vd, uint32_t vdsize,
                                                       uint16_t const* id, uint32_t indexCount) {
         auto mesh = ugi::Mesh::CreateMesh(
@@ -78,32 +104,31 @@ namespace gui {
             [](void*, ugi::CommandBuffer* cb){}
         );
         if (!mesh) return nullptr;
+        if (_renderablePool.size()) { // 同 UIImageRender，Material 直接复用
+            auto renderable = _renderablePool.back();
+            _renderablePool.pop_back();
+            renderable->resetMesh(mesh);
+            return renderable;
+        }
         auto material = _pipeline->createMaterial({"args", "image_sampler", "image_tex"}, {});
         auto renderable = new ugi::Renderable(mesh, material, _pipeline, ugi::raster_state_t());
         return renderable;
     }
 
-    ui_render_batches_t TextSDFRender::buildRenderBatch(std::vector<image_render_data_t> const& renderDatas,
-                                                         ugi::Texture* texture) {
-        std::vector<image_vertex_t> vertices;
-        std::vector<uint16_t> indices;
-        std::vector<item_args_t> cachedArgs;
+    ui_render_batches_t TextSDFRender::buildRenderBatch(std::span<image_render_data_t const> renderDatas,
+                                                         bool growable) {
+        ugi::Texture* texture = renderDatas.size() ? renderDatas.front().texture : nullptr;
+        auto& arena = GetFrameArena();
+        frame_vector<image_vertex_t> vertices(&arena);
+        frame_vector<uint16_t> indices(&arena);
+        frame_vector<item_args_t> cachedArgs(&arena);
+        frame_vector<item_span_t> spans(&arena);
         ui_render_batches_t batches;
 
-        for (auto const& renderData : renderDatas) {
-            auto indicesPos = indices.size();
-            auto indexBase = vertices.size();
-            vertices.insert(vertices.end(), renderData.item->vertices.begin(), renderData.item->vertices.end());
-            indices.insert(indices.end(), renderData.item->indices.begin(), renderData.item->indices.end());
-            for (auto i = indicesPos; i < indices.size(); ++i)
-                indices[i] += indexBase;
-            for (auto i = indexBase; i < vertices.size(); ++i)
-                vertices[i].instIndex = (uint32_t)cachedArgs.size();
-            cachedArgs.push_back(*renderData.args);
-            if (cachedArgs.size() >= 512) {
-                auto renderable = createRenderable((const uint8_t*)vertices.data(),
-                    vertices.size() * sizeof(image_vertex_t), indices.data(), indices.size());
-                if (!renderable) { cachedArgs.clear(); indices.clear(); vertices.clear(); continue; }
+        auto breakBatchFn = [&]() {
+            auto renderable = createRenderable((const uint8_t*)vertices.data(),
+                vertices.size() * sizeof(image_vertex_t), indices.data(), indices.size());
+            if (renderable) {
                 auto ubo = renderable->material()->descriptors()[0];
                 auto sampler = renderable->material()->descriptors()[1];
                 auto tex = renderable->material()->descriptors()[2];
@@ -111,30 +136,36 @@ namespace gui {
                 sampler.res.samplerState = ugi::sampler_state_t{ .min = ugi::TextureFilter::Linear, .mag = ugi::TextureFilter::Linear };
                 renderable->material()->updateDescriptor(tex);
                 renderable->material()->updateDescriptor(sampler);
-                ui_render_batch_t* batch = new ui_render_batch_t {
-                    renderable, ubo, sampler, tex, std::move(cachedArgs),
-                    ugi::sampler_state_t{ .min = ugi::TextureFilter::Linear, .mag = ugi::TextureFilter::Linear }, texture
-                };
+                ui_render_batch_t* batch = AcquireRenderBatch();
+                batch->renderable = renderable;
+                batch->argsDetor = ubo;
+                batch->samplerDetor = sampler;
+                batch->cachedArgs.assign(cachedArgs.begin(), cachedArgs.end());
+                batch->sampler = ugi::sampler_state_t{ .min = ugi::TextureFilter::Linear, .mag = ugi::TextureFilter::Linear };
+                batch->textures.assign(1, texture);
+                batch->spans.assign(spans.begin(), spans.end());
                 batches.batches.push_back(batch);
-                cachedArgs.clear(); indices.clear(); vertices.clear();
+            }
+            cachedArgs.clear(); spans.clear(); indices.clear(); vertices.clear();
+        };
+
+        for (auto const& renderData : renderDatas) {
+            // 文字只有一个贴图槽位，换 atlas 就切
+            if (cachedArgs.size() && (renderData.texture != texture ||
+                vertices.size() + spanVertexCapacity(*renderData.item, false) > MaxBatchVertexCount)) {
+                breakBatchFn();
+            }
+            texture = renderData.texture;
+            bool grow = growable && vertices.size() + spanVertexCapacity(*renderData.item, true) <= MaxBatchVertexCount;
+            spans.push_back(appendItemSpan(vertices, indices, renderData, (uint32_t)cachedArgs.size(), grow));
+            cachedArgs.push_back(*renderData.args);
+            cachedArgs.back().textureSlot = 0;
+            if (cachedArgs.size() >= _maxInstancesPerBatch) {
+                breakBatchFn();
             }
         }
         if (cachedArgs.size()) {
-            auto renderable = createRenderable((const uint8_t*)vertices.data(),
-                vertices.size() * sizeof(image_vertex_t), indices.data(), indices.size());
-            if (!renderable) return batches;
-            auto ubo = renderable->material()->descriptors()[0];
-            auto sampler = renderable->material()->descriptors()[1];
-            auto tex = renderable->material()->descriptors()[2];
-            tex.res.imageView = texture->defaultView().handle;
-            sampler.res.samplerState = ugi::sampler_state_t{ .min = ugi::TextureFilter::Linear, .mag = ugi::TextureFilter::Linear };
-            renderable->material()->updateDescriptor(tex);
-            renderable->material()->updateDescriptor(sampler);
-            ui_render_batch_t* batch = new ui_render_batch_t {
-                renderable, ubo, sampler, tex, std::move(cachedArgs),
-                ugi::sampler_state_t{ .min = ugi::TextureFilter::Linear, .mag = ugi::TextureFilter::Linear }, texture
-            };
-            batches.batches.push_back(batch);
+            breakBatchFn();
         }
         batches.type = UIMeshType::Font;
         return batches;
@@ -142,13 +173,17 @@ namespace gui {
 
     void TextSDFRender::destroyRenderBatch(ui_render_batches_t batches) {
         for (auto batch : batches.batches) {
-            batch->renderable->release();
-            delete batch;
+            auto renderable = batch->renderable;
+            ugi::GPURetireManager::Instance()->retire([this, renderable] {
+                renderable->resetMesh(nullptr);
+                _renderablePool.push_back(renderable);
+            });
+            RecycleRenderBatch(batch);
         }
         batches.batches.clear();
     }
 
-    void TextSDFRender::drawBatch(ui_render_batches_t batches, glm::mat4 const& batchWorld,
+    void TextSDFRender::drawBatch(ui_render_batches_t batches, affine2d const& batchWorld,
                                    ugi::RenderCommandEncoder* encoder) {
         if (batches.type != UIMeshType::Font) return;
 
@@ -157,7 +192,7 @@ namespace gui {
             auto ubo = _uniformAllocator->allocate(sizeof(GlobalUBO_SDF));
             auto* g = (GlobalUBO_SDF*)ubo.ptr;
             g->vp = _vp;
-            g->batchWorld = batchWorld;
+            g->batchWorld = batchWorld.toMat4();
             _globalMat.res.buffer.buffer = ubo.buffer;
             _globalMat.res.buffer.offset = ubo.offset;
             _globalMat.res.buffer.size = ubo.size;
@@ -166,7 +201,7 @@ namespace gui {
         }
 
         for (auto batch : batches.batches) {
-            auto ubo = _uniformAllocator->allocate(batch->cachedArgs.size() * sizeof(item_args_t));
+            auto ubo = _argsAllocator->allocate(batch->cachedArgs.size() * sizeof(item_args_t));
             memcpy(ubo.ptr, batch->cachedArgs.data(), ubo.size);
             batch->argsDetor.res.buffer.buffer = ubo.buffer;
             batch->argsDetor.res.buffer.offset = ubo.offset;
@@ -176,4 +211,37 @@ namespace gui {
         }
     }
 
+    void TextSDFRender::drawBatch(ui_render_batches_t const& batches, affine2d const& batchWorld,
+                                   ugi::RenderCommandEncoder* encoder, ugi::DescriptorBinder* binder) {
+        if (batches.type != UIMeshType::Font) return;
+
+        // 本地的 global descriptor，不写共享的 _globalMat
+        ugi::res_descriptor_t globalMat = _globalMat;
+        {
+            auto ubo = _uniformAllocator->allocate(sizeof(GlobalUBO_SDF));
+            auto* g = (GlobalUBO_SDF*)ubo.ptr;
+            g->vp = _vp;
+            g->batchWorld = batchWorld.toMat4();
+            globalMat.res.buffer.buffer = ubo.buffer;
+            globalMat.res.buffer.offset = ubo.offset;
+            globalMat.res.buffer.size = ubo.size;
+            binder->updateDescriptor(globalMat);
+        }
+
+        for (auto batch : batches.batches) {
+            auto ubo = _argsAllocator->allocate(batch->cachedArgs.size() * sizeof(item_args_t));
+            memcpy(ubo.ptr, batch->cachedArgs.data(), ubo.size);
+            batch->argsDetor.res.buffer.buffer = ubo.buffer;
+            batch->argsDetor.res.buffer.offset = ubo.offset;
+            batch->argsDetor.res.buffer.size = ubo.size;
+            auto material = batch->renderable->material();
+            material->updateDescriptor(batch->argsDetor);
+            for (auto const& item : material->descriptors()) {
+                binder->updateDescriptor(item);
+            }
+            binder->bind(encoder->commandBuffer());
+            encoder->draw(batch->renderable->mesh(), batch->renderable->mesh()->indexCount());
+        }
+    }
+
 }
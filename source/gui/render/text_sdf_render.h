@@ -14,6 +14,7 @@ namespace gui {
         ugi::GraphicsPipeline*          _pipeline           = nullptr;
         ugi::MeshBufferAllocator*       _bufferAllocator    = nullptr;
         ugi::UniformAllocator*          _uniformAllocator   = nullptr;
+        ugi::UniformAllocator*          _argsAllocator      = nullptr;  // 同 UIImageRender
         ugi::Device*                    _device             = nullptr;
         ugi::GPUAsyncLoadManager*       _asyncLoadManager   = nullptr;
         ugi::res_descriptor_t           _uboptor;
@@ -22,6 +23,8 @@ namespace gui {
         ugi::Material*                  _globalMtl          = nullptr;
         ugi::res_descriptor_t           _globalMat;
         glm::mat4                       _vp;
+        uint32_t                        _maxInstancesPerBatch = UBOInstanceCapacity;
+        std::vector<ugi::Renderable*>   _renderablePool;    // 退役回来的 Renderable（连同 Material），mesh 已经释放
 
         bool initialize_();
 
@@ -30,26 +33,36 @@ namespace gui {
 
         void initialize(ugi::Device* device, ugi::GraphicsPipeline* pipeline,
                         ugi::MeshBufferAllocator* msalloc, ugi::UniformAllocator* uniformAllocator,
-                        ugi::GPUAsyncLoadManager* asyncLoaderManager);
+                        ugi::GPUAsyncLoadManager* asyncLoaderManager, ugi::UniformAllocator* storageAllocator = nullptr);
 
         ugi::Renderable* createRenderable(uint8_t const* vd, uint32_t vdsize,
                                           uint16_t const* id, uint32_t indexCount);
 
-        ui_render_batches_t buildRenderBatch(std::vector<image_render_data_t> const& renderDatas,
-                                             ugi::Texture* texture);
+        // growable: 文字 batch 默认给每个 item 多留空间，输入时可以原地改写
+        ui_render_batches_t buildRenderBatch(std::span<image_render_data_t const> renderDatas,
+                                             bool growable = true);
 
         void destroyRenderBatch(ui_render_batches_t batches);
 
-        void drawBatch(ui_render_batches_t batches, glm::mat4 const& batchWorld,
+        void drawBatch(ui_render_batches_t batches, affine2d const& batchWorld,
                        ugi::RenderCommandEncoder* encoder);
+        // 并行录制用，同 UIImageRender
+        VkPipeline resolvePipeline(ugi::RenderCommandEncoder const* encoder);
+        ugi::DescriptorBinder* createDescriptorBinder() const;
+        void drawBatch(ui_render_batches_t const& batches, affine2d const& batchWorld,
+                       ugi::RenderCommandEncoder* encoder, ugi::DescriptorBinder* binder);
 
         void setVP(glm::mat4 const& vp);
         void setRasterization(ugi::raster_state_t rasterState);
 
-        void bind(ugi::RenderCommandEncoder* encoder);
+        bool bind(ugi::RenderCommandEncoder* encoder); // false : pipeline variant still compiling, skip drawing
         void draw(ugi::RenderCommandEncoder* enc, ugi::Renderable* renderable);
 
+        uint32_t maxInstancesPerBatch() const { return _maxInstancesPerBatch; }
+
         void tick();
+        void releasePool(); // 同 UIImageRender
+        void compactMeshBuffer(ugi::ResourceCommandEncoder* encoder); // 增量整理 mesh buffer，在 draw 之前录制
     };
 
 }
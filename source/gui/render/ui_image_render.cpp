@@ -18,26 +18,29 @@
 #include <ugi/asyncload/gpu_asyncload_manager.h>
 #include <ugi/render_components/pipeline_material.h>
 #include <ugi/render_components/renderable.h>
+#include <ugi/gpu_retire_manager.h>
 #include <ugi/render_context.h>
 #include <ugi/texture_util.h>
 #include <ugi/helper/pipeline_helper.h>
+#include "ui_render.h"
 
 // #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
+#include <algorithm>
 #include <cstring>
+#include <string>
 
 namespace gui {
 
-    void UIImageRender::initialize(ugi::Device* device, comm::IArchive* archive, ugi::MeshBufferAllocator* msalloc, ugi::UniformAllocator* uniformAllocator, ugi::GPUAsyncLoadManager* asyncLoaderManager, const char* pipelinePath) {
+    void UIImageRender::initialize(ugi::Device* device, comm::IArchive* archive, ugi::MeshBufferAllocator* msalloc, ugi::UniformAllocator* uniformAllocator, ugi::GPUAsyncLoadManager* asyncLoaderManager, const char* pipelineName, ugi::UniformAllocator* storageAllocator) {
         _device = device;
         _bufferAllocator = msalloc;
         _uniformAllocator = uniformAllocator;
         _asyncLoadManager = asyncLoaderManager;
 
-        // Read and create pipeline internally
-        auto pipelineFile = archive->openIStream(pipelinePath, {comm::ReadFlag::binary});
-        auto ppl = ugi::PipelineHelper::FromIStream(pipelineFile);
-        pipelineFile->close();
+        // Read and create pipeline internally，优先用多贴图版本，设备支持的话用 ssbo 版本
+        auto ppl = LoadItemPipeline(device, archive, {"fgui_image_mt", pipelineName});
+        assert(ppl.valid());
         auto ppldesc = ppl.desc();
         ppldesc.topologyMode = ugi::topology_mode_t::TriangleList;
         ppldesc.renderState.cullMode = ugi::cull_mode_t::None;
@@ -45,6 +48,20 @@ namespace gui {
         ppldesc.renderState.blendState.srcAlphaFactor = ugi::blend_factor_t::SourceAlpha;
         ppldesc.renderState.blendState.dstAlphaFactor = ugi::blend_factor_t::DestinationAlpha;
         _pipeline = device->createGraphicsPipeline(ppldesc);
+        // 切换 line/fill 或 cull mode 时新变体放后台编译，编译期间用已有的 pipeline 顶替
+        _pipeline->setCompileMode(ugi::pipeline_compile_mode_t::AsyncFallback);
+        _argsAllocator = ArgsAllocatorFor(_pipeline, uniformAllocator, storageAllocator);
+        _maxInstancesPerBatch = ItemArgsCapacity(device, _pipeline, _argsAllocator);
+        // 多贴图版本的贴图叫 image_tex, image_tex1, image_tex2 ...，有几个就是几个槽位
+        _materialParams = {"args", "image_sampler", "image_tex"};
+        for(uint32_t slot = 1; slot < MaxBatchTextureSlots; ++slot) {
+            auto name = "image_tex" + std::to_string(slot);
+            if(_pipeline->getDescriptorHandle(name.c_str()) == ~0u) {
+                break;
+            }
+            _materialParams.push_back(name);
+        }
+        _textureSlotCount = (uint32_t)_materialParams.size() - 2;
 
         initialize_();
     }
@@ -53,7 +70,7 @@ namespace gui {
         _globalMtl = _pipeline->createMaterial({"global"}, {});
         _globalMat = _globalMtl->descriptors()[0];
         //
-        auto material = _pipeline->createMaterial({"args", "image_sampler", "image_tex"}, {});
+        auto material = _pipeline->createMaterial(_materialParams, {});
         _uboptor = material->descriptors()[0];
         _samptor = material->descriptors()[1];
         _texptor = material->descriptors()[2];
@@ -69,10 +86,23 @@ namespace gui {
 
     void UIImageRender::tick() {
         _pipeline->resetMaterials();
+        _bufferAllocator->onFrameTick();
+    }
+
+    void UIImageRender::releasePool() {
+        for(auto renderable: _renderablePool) {
+            delete renderable; // mesh 已经释放，这里连同 Material 一起删
+        }
+        _renderablePool.clear();
+        _renderablePool.shrink_to_fit();
     }
 
-    void UIImageRender::bind(ugi::RenderCommandEncoder* encoder) {
-        encoder->bindPipeline(_pipeline);
+    void UIImageRender::compactMeshBuffer(ugi::ResourceCommandEncoder* encoder) {
+        _bufferAllocator->defragment(encoder);
+    }
+
+    bool UIImageRender::bind(ugi::RenderCommandEncoder* encoder) {
+        return encoder->bindPipeline(_pipeline);
     }
 
     void UIImageRender::draw(ugi::RenderCommandEncoder* enc, ugi::Renderable* renderable) {
@@ -91,7 +121,7 @@ namespace gui {
         _vp = vp;  // 只缓存，draw 时才分配 UBO
     }
 
-    void UIImageRender::drawBatch(ui_render_batches_t batches, glm::mat4 const& batchWorld, ugi::RenderCommandEncoder* encoder) {
+    void UIImageRender::drawBatch(ui_render_batches_t batches, affine2d const& batchWorld, ugi::RenderCommandEncoder* encoder) {
         if(batches.type != UIMeshType::Image) {
             assert(false);
             return;
@@ -101,7 +131,7 @@ namespace gui {
             auto ubo = _uniformAllocator->allocate(sizeof(GlobalUBO));
             auto* g = (GlobalUBO*)ubo.ptr;
             g->vp = _vp;
-            g->batchWorld = batchWorld;
+            g->batchWorld = batchWorld.toMat4();
             _globalMat.res.buffer.buffer = ubo.buffer;
             _globalMat.res.buffer.offset = ubo.offset;
             _globalMat.res.buffer.size = ubo.size;
@@ -109,7 +139,7 @@ namespace gui {
             _pipeline->applyMaterial(_globalMtl);
         }
         for(auto batch: batches.batches) {
-            auto ubo = _uniformAllocator->allocate(batch->cachedArgs.size() * sizeof(item_args_t));
+            auto ubo = _argsAllocator->allocate(batch->cachedArgs.size() * sizeof(item_args_t));
             memcpy(ubo.ptr, batch->cachedArgs.data(), ubo.size);
             batch->argsDetor.res.buffer.buffer = ubo.buffer;
             batch->argsDetor.res.buffer.offset = ubo.offset;
@@ -119,6 +149,47 @@ namespace gui {
         }
     }
 
+    VkPipeline UIImageRender::resolvePipeline(ugi::RenderCommandEncoder const* encoder) {
+        return _pipeline->resolvePipeline(encoder);
+    }
+
+    ugi::DescriptorBinder* UIImageRender::createDescriptorBinder() const {
+        return _pipeline->createArgumentGroup();
+    }
+
+    void UIImageRender::drawBatch(ui_render_batches_t const& batches, affine2d const& batchWorld, ugi::RenderCommandEncoder* encoder, ugi::DescriptorBinder* binder) {
+        if(batches.type != UIMeshType::Image) {
+            assert(false);
+            return;
+        }
+        // 不写 _globalMat / pipeline 的 binder，这两个是所有线程共享的
+        ugi::res_descriptor_t globalMat = _globalMat;
+        {
+            auto ubo = _uniformAllocator->allocate(sizeof(GlobalUBO));
+            auto* g = (GlobalUBO*)ubo.ptr;
+            g->vp = _vp;
+            g->batchWorld = batchWorld.toMat4();
+            globalMat.res.buffer.buffer = ubo.buffer;
+            globalMat.res.buffer.offset = ubo.offset;
+            globalMat.res.buffer.size = ubo.size;
+            binder->updateDescriptor(globalMat);
+        }
+        for(auto batch: batches.batches) {
+            auto ubo = _argsAllocator->allocate(batch->cachedArgs.size() * sizeof(item_args_t));
+            memcpy(ubo.ptr, batch->cachedArgs.data(), ubo.size);
+            batch->argsDetor.res.buffer.buffer = ubo.buffer;
+            batch->argsDetor.res.buffer.offset = ubo.offset;
+            batch->argsDetor.res.buffer.size = ubo.size;
+            auto material = batch->renderable->material();
+            material->updateDescriptor(batch->argsDetor);
+            for(auto const& item: material->descriptors()) {
+                binder->updateDescriptor(item);
+            }
+            binder->bind(encoder->commandBuffer());
+            encoder->draw(batch->renderable->mesh(), batch->renderable->mesh()->indexCount());
+        }
+    }
+
     void UIImageRender::setUBO(ugi::Renderable* renderable, uint8_t* data) {
         auto mtl = renderable->material();
         _uniformAllocator->allocateForDescriptor(_uboptor, data);
@@ -150,66 +221,88 @@ namespace gui {
         if (!mesh) {
             return nullptr;
         }
-        auto material = _pipeline->createMaterial({"args", "image_sampler", "image_tex"}, {});
+        if (_renderablePool.size()) { // descriptor 在 breakBatchFn / draw 里都会重写，Material 直接复用
+            auto renderable = _renderablePool.back();
+            _renderablePool.pop_back();
+            renderable->resetMesh(mesh);
+            return renderable;
+        }
+        auto material = _pipeline->createMaterial(_materialParams, {});
         auto renderable = new ugi::Renderable(mesh, material, _pipeline, ugi::raster_state_t());
         return renderable;
     }
 
 
-    gui::ui_render_batches_t UIImageRender::buildImageRenderBatch(std::vector<image_render_data_t> const& renderDatas, ugi::Texture* texture) {
-        std::vector<image_vertex_t> vertices;
-        std::vector<uint16_t> indices;
-        std::vector<item_args_t> cachedArgs;
+    gui::ui_render_batches_t UIImageRender::buildImageRenderBatch(std::span<image_render_data_t const> renderDatas, bool growable) {
+        // 临时数据都从帧内存上分配，batch 自己留的那几份拷到池子里的对象上（保留容量）
+        auto& arena = GetFrameArena();
+        frame_vector<image_vertex_t> vertices(&arena);
+        frame_vector<uint16_t> indices(&arena);
+        frame_vector<item_args_t> cachedArgs(&arena);
+        frame_vector<item_span_t> spans(&arena);
+        frame_vector<ugi::Texture*> textures(&arena);
         ui_render_batches_t batches;
 
-        for(auto const& renderData : renderDatas) {
-            auto indicesPos = indices.size();
-            auto indexBase = vertices.size();
-            vertices.insert(vertices.end(), renderData.item->vertices.begin(), renderData.item->vertices.end());
-            indices.insert(indices.end(), renderData.item->indices.begin(), renderData.item->indices.end());
-            for(auto i = indicesPos; i < indices.size(); ++i) {
-                indices[i] += indexBase;
-            }
-            for(auto i = indexBase; i < vertices.size(); ++i) {
-                vertices[i].instIndex = (uint32_t)cachedArgs.size();
-            }
-            cachedArgs.push_back(*renderData.args);
-            if(cachedArgs.size() >= 512) {
-                auto renderable = createRenderable((const uint8_t*)vertices.data(), vertices.size() * sizeof(image_vertex_t), indices.data(), indices.size());
-                if (!renderable) { cachedArgs.clear(); indices.clear(); vertices.clear(); continue; }
-                auto ubo = renderable->material()->descriptors()[0];
-                auto sampler = renderable->material()->descriptors()[1];
-                auto tex = renderable->material()->descriptors()[2];
-                tex.res.imageView = texture->defaultView().handle;
+        auto breakBatchFn = [&]() {
+            auto renderable = createRenderable((const uint8_t*)vertices.data(), vertices.size() * sizeof(image_vertex_t), indices.data(), indices.size());
+            if (renderable) {
+                auto material = renderable->material();
+                auto ubo = material->descriptors()[0];
+                auto sampler = material->descriptors()[1];
                 constexpr ugi::sampler_state_t kLinearSampler = {
                     .min = ugi::TextureFilter::Linear,
                     .mag = ugi::TextureFilter::Linear
                 };
                 sampler.res.samplerState = kLinearSampler;
-                renderable->material()->updateDescriptor(tex);
-                renderable->material()->updateDescriptor(sampler);
-                ui_render_batch_t* batch = new ui_render_batch_t { renderable, ubo, sampler, tex, std::move(cachedArgs), kLinearSampler, texture};
+                material->updateDescriptor(sampler);
+                for(uint32_t slot = 0; slot < _textureSlotCount; ++slot) {
+                    auto tex = material->descriptors()[2 + slot];
+                    // 没用到的槽位也得绑一张有效的贴图
+                    tex.res.imageView = textures[slot < textures.size() ? slot : 0]->defaultView().handle;
+                    material->updateDescriptor(tex);
+                }
+                ui_render_batch_t* batch = AcquireRenderBatch();
+                batch->renderable = renderable;
+                batch->argsDetor = ubo;
+                batch->samplerDetor = sampler;
+                batch->cachedArgs.assign(cachedArgs.begin(), cachedArgs.end());
+                batch->sampler = kLinearSampler;
+                batch->textures.assign(textures.begin(), textures.end());
+                batch->spans.assign(spans.begin(), spans.end());
                 batches.batches.push_back(batch);
-                cachedArgs.clear();
-                indices.clear();
-                vertices.clear();
+            }
+            cachedArgs.clear();
+            spans.clear();
+            textures.clear();
+            indices.clear();
+            vertices.clear();
+        };
+
+        for(auto const& renderData : renderDatas) {
+            // 16 位索引，顶点放不下就先切一个 sub-batch
+            if(cachedArgs.size() && vertices.size() + spanVertexCapacity(*renderData.item, false) > MaxBatchVertexCount) {
+                breakBatchFn();
+            }
+            // 贴图槽位满了也要切
+            uint32_t slot = (uint32_t)(std::find(textures.begin(), textures.end(), renderData.texture) - textures.begin());
+            if(slot == textures.size() && slot >= _textureSlotCount) {
+                breakBatchFn();
+                slot = 0;
+            }
+            if(slot == textures.size()) {
+                textures.push_back(renderData.texture);
+            }
+            // 预留空间不能让 16 位索引溢出
+            bool grow = growable && vertices.size() + spanVertexCapacity(*renderData.item, true) <= MaxBatchVertexCount;
+            spans.push_back(appendItemSpan(vertices, indices, renderData, (uint32_t)cachedArgs.size(), grow));
+            cachedArgs.push_back(*renderData.args);
+            cachedArgs.back().textureSlot = slot;
+            if(cachedArgs.size() >= _maxInstancesPerBatch) {
+                breakBatchFn();
             }
         }
         if(cachedArgs.size()) {
-            auto renderable = createRenderable((const uint8_t*)vertices.data(), vertices.size() * sizeof(image_vertex_t), indices.data(), indices.size());
-            if (!renderable) return batches;
-            auto ubo = renderable->material()->descriptors()[0];
-            auto sampler = renderable->material()->descriptors()[1];
-            auto tex = renderable->material()->descriptors()[2];
-            tex.res.imageView = texture->defaultView().handle;
-            constexpr ugi::sampler_state_t kLinearSampler = {
-                .min = ugi::TextureFilter::Linear, .mag = ugi::TextureFilter::Linear
-            };
-            sampler.res.samplerState = kLinearSampler;
-            renderable->material()->updateDescriptor(tex);
-            renderable->material()->updateDescriptor(sampler);
-            ui_render_batch_t* batch = new ui_render_batch_t { renderable, ubo, sampler, tex, std::move(cachedArgs), kLinearSampler, texture};
-            batches.batches.push_back(batch);
+            breakBatchFn();
         }
         batches.type = UIMeshType::Image;
         return batches;
@@ -217,8 +310,12 @@ namespace gui {
 
     void UIImageRender::destroyRenderBatch(gui::ui_render_batches_t batches) {
         for(auto batch: batches.batches) {
-            batch->renderable->release();
-            delete batch;
+            auto renderable = batch->renderable;
+            ugi::GPURetireManager::Instance()->retire([this, renderable] { // GPU 用完了再回池子
+                renderable->resetMesh(nullptr);
+                _renderablePool.push_back(renderable);
+            });
+            RecycleRenderBatch(batch);
         }
         batches.batches.clear();
     }
@@ -11,6 +11,8 @@
 #include "render_data.h"
 #include "texture.h"
 #include "utils/singleton.h"
+#include <string>
+#include <vector>
 
 namespace gui {
 
@@ -19,6 +21,7 @@ namespace gui {
         ugi::GraphicsPipeline*          _pipeline;
         ugi::MeshBufferAllocator*       _bufferAllocator;
         ugi::UniformAllocator*          _uniformAllocator;
+        ugi::UniformAllocator*          _argsAllocator;                                 // 实例参数从这里分配，ssbo 版本用 storage allocator，没给就和 _uniformAllocator 一样
         ugi::Device*                    _device;
         ugi::res_descriptor_t           _uboptor;                                       // matrices
         ugi::res_descriptor_t           _texptor;
@@ -26,6 +29,10 @@ namespace gui {
         ugi::Material*                  _globalMtl;
         ugi::res_descriptor_t           _globalMat;
         ugi::GPUAsyncLoadManager*       _asyncLoadManager;
+        uint32_t                        _maxInstancesPerBatch;                          // 一个 sub-batch 最多几个 item，看 args 是 UBO 还是 SSBO
+        uint32_t                        _textureSlotCount;                              // 一次 draw 能绑几张贴图，单贴图 pipeline 是 1
+        std::vector<std::string>        _materialParams;                                // args, image_sampler, image_tex[, image_tex1 ...]
+        std::vector<ugi::Renderable*>   _renderablePool;                                // 退役回来的 Renderable（连同 Material），mesh 已经释放
         //
         glm::mat4                       _vp;
     private:
@@ -35,11 +42,14 @@ namespace gui {
             : _pipeline(nullptr)
             , _bufferAllocator(nullptr)
             , _uniformAllocator(nullptr)
+            , _argsAllocator(nullptr)
             , _device(nullptr)
             , _asyncLoadManager(nullptr)
+            , _maxInstancesPerBatch(UBOInstanceCapacity)
+            , _textureSlotCount(1)
         {}
 
-        void initialize(ugi::Device* device, comm::IArchive* archive, ugi::MeshBufferAllocator* msalloc, ugi::UniformAllocator* uniformAllocator, ugi::GPUAsyncLoadManager* asyncLoaderManager, const char* pipelinePath = "/shaders/fgui_image/pipeline.bin");
+        void initialize(ugi::Device* device, comm::IArchive* archive, ugi::MeshBufferAllocator* msalloc, ugi::UniformAllocator* uniformAllocator, ugi::GPUAsyncLoadManager* asyncLoaderManager, const char* pipelineName = "fgui_image", ugi::UniformAllocator* storageAllocator = nullptr);
         ugi::Material* createMaterial(std::vector<std::string>const & params);
 
         ugi::Renderable* createRenderable(uint8_t const* vd, uint32_t vdsize, uint16_t const* id, uint32_t indexCount);
@@ -50,16 +60,27 @@ namespace gui {
         void setSampler(ugi::Renderable* renderable, ugi::sampler_state_t sampler);
         void setTexture(ugi::Renderable* renderable, ugi::image_view_t imageView);
         void setRasterization(ugi::raster_state_t rasterState);
-        void bind(ugi::RenderCommandEncoder* encoder);
+        bool bind(ugi::RenderCommandEncoder* encoder); // false : pipeline variant still compiling, skip drawing
         void draw(ugi::RenderCommandEncoder* enc, ugi::Renderable* renderable);
 
-        gui::ui_render_batches_t buildImageRenderBatch(std::vector<image_render_data_t> const& renderDatas, ugi::Texture* textur);
+        // growable: 给每个 item 多留一些顶点/索引空间，mesh 变大时可以原地改写
+        // 不同贴图的 item 合进同一个 sub-batch，槽位表满了才切
+        gui::ui_render_batches_t buildImageRenderBatch(std::span<image_render_data_t const> renderDatas, bool growable = false);
 
         void destroyRenderBatch(gui::ui_render_batches_t batches);
 
-        void drawBatch(ui_render_batches_t batches, glm::mat4 const& batchWorld, ugi::RenderCommandEncoder* encoder);
+        void drawBatch(ui_render_batches_t batches, affine2d const& batchWorld, ugi::RenderCommandEncoder* encoder);
+        // 并行录制用：pipeline 在主线程取好，descriptor 写到调用线程自己的 binder 上，可以在工作线程调用
+        VkPipeline resolvePipeline(ugi::RenderCommandEncoder const* encoder);
+        ugi::DescriptorBinder* createDescriptorBinder() const;
+        void drawBatch(ui_render_batches_t const& batches, affine2d const& batchWorld, ugi::RenderCommandEncoder* encoder, ugi::DescriptorBinder* binder);
+
+        uint32_t maxInstancesPerBatch() const { return _maxInstancesPerBatch; }
+        uint32_t textureSlotCount() const { return _textureSlotCount; }
 
         void tick();
+        void releasePool(); // 退出时调用，GPURetireManager 的回调都执行完之后
+        void compactMeshBuffer(ugi::ResourceCommandEncoder* encoder); // 增量整理 mesh buffer，在 draw 之前录制
     };
 
 }
\ No newline at end of file
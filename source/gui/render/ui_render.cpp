@@ -3,25 +3,107 @@
 #include "ugi_types.h"
 #include "ui_image_render.h"
 #include "text_sdf_render.h"
+#include <ugi/command_queue.h>
+#include <ugi/command_buffer.h>
+#include <ugi/descriptor_binder.h>
+#include <ugi/command_encoder/resource_cmd_encoder.h>
+#include <ugi/render_components/mesh.h>
+#include <ugi/render_components/renderable.h>
+#include <ugi/multithread/worker_pool.h>
+#include <ugi/device.h>
+#include <ugi/pipeline.h>
+#include <ugi/uniform_buffer_allocator.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <cassert>
 
 namespace gui {
 
-    ui_render_batches_t BuildImageRenderBatches(std::vector<void*> const& items, std::vector<item_args_t*> const& args, ugi::Texture* texture) {
-        auto render = UIImageRender::Instance();
-        std::vector<image_render_data_t> datas;
-        for(size_t i = 0; i<items.size(); ++i) {
-            datas.push_back({(image_mesh_t*)items[i], args[i]});
+    ugi::PipelineHelper LoadItemPipeline(ugi::Device* device, comm::IArchive* archive, std::initializer_list<char const*> names) {
+        auto const& limits = device->descriptor().properties.limits;
+        bool const ssbo = limits.maxStorageBufferRange / sizeof(item_args_t) > UBOInstanceCapacity;
+        comm::IStream* stream = nullptr;
+        for(auto name: names) {
+            if(ssbo) {
+                stream = archive->openIStream(std::string("/shaders/") + name + "_ssbo/pipeline.bin", {comm::ReadFlag::binary});
+            }
+            if(!stream) {
+                stream = archive->openIStream(std::string("/shaders/") + name + "/pipeline.bin", {comm::ReadFlag::binary});
+            }
+            if(stream) {
+                break;
+            }
+        }
+        if(!stream) {
+            return ugi::PipelineHelper();
+        }
+        auto ppl = ugi::PipelineHelper::FromIStream(stream);
+        stream->close();
+        return ppl;
+    }
+
+    uint32_t ItemArgsCapacity(ugi::Device* device, ugi::GraphicsPipeline const* pipeline, ugi::UniformAllocator const* argsAllocator) {
+        auto const& limits = device->descriptor().properties.limits;
+        ugi::res_descriptor_info_t info;
+        pipeline->getDescriptorHandle("args", &info);
+        if(info.type == ugi::res_descriptor_type::DynamicStorageBuffer) {
+            // 一个实例至少 4 个顶点，16 位索引下再多也放不进一个 sub-batch，剩下的限制只有这个
+            // args 每帧从 storage allocator 上分配，它的 block 跟着用量长，单次上限就是 maxStorageBufferRange
+            uint64_t capacity = std::min<uint64_t>(limits.maxStorageBufferRange, argsAllocator->maxAllocationSize()) / sizeof(item_args_t);
+            return (uint32_t)std::min<uint64_t>(capacity, MaxBatchVertexCount / 4);
         }
-        return render->buildImageRenderBatch(datas, texture);
+        return (uint32_t)std::min<uint64_t>(UBOInstanceCapacity, limits.maxUniformBufferRange / sizeof(item_args_t));
     }
 
-    ui_render_batches_t BuildTextRenderBatches(std::vector<void*> const& items, std::vector<item_args_t*> const& args, ugi::Texture* texture) {
+    ugi::UniformAllocator* ArgsAllocatorFor(ugi::GraphicsPipeline const* pipeline, ugi::UniformAllocator* uniformAllocator, ugi::UniformAllocator* storageAllocator) {
+        ugi::res_descriptor_info_t info;
+        pipeline->getDescriptorHandle("args", &info);
+        if(storageAllocator && info.type == ugi::res_descriptor_type::DynamicStorageBuffer) {
+            return storageAllocator;
+        }
+        return uniformAllocator;
+    }
+
+    ui_render_batches_t BuildImageRenderBatches(std::span<image_render_data_t const> datas, bool growable) {
+        auto render = UIImageRender::Instance();
+        return render->buildImageRenderBatch(datas, growable);
+    }
+
+    ui_render_batches_t BuildTextRenderBatches(std::span<image_render_data_t const> datas, bool growable) {
         auto render = TextSDFRender::Instance();
-        std::vector<image_render_data_t> datas;
-        for(size_t i = 0; i<items.size(); ++i) {
-            datas.push_back({(image_mesh_t*)items[i], args[i]});
+        return render->buildRenderBatch(datas, growable);
+    }
+
+    static std::vector<ui_render_batch_t*> batchPool;
+
+    ui_render_batch_t* AcquireRenderBatch() {
+        if(batchPool.empty()) {
+            return new ui_render_batch_t();
         }
-        return render->buildRenderBatch(datas, texture);
+        auto batch = batchPool.back();
+        batchPool.pop_back();
+        return batch;
+    }
+
+    void RecycleRenderBatch(ui_render_batch_t* batch) {
+        batch->renderable = nullptr;
+        batch->cachedArgs.clear();
+        batch->textures.clear();
+        batch->spans.clear();
+        batchPool.push_back(batch);
+    }
+
+    void ReleaseRenderPools() {
+        for(auto batch: batchPool) {
+            delete batch;
+        }
+        batchPool.clear();
+        batchPool.shrink_to_fit();
+        UIImageRender::Instance()->releasePool();
+        TextSDFRender::Instance()->releasePool();
+        ugi::Mesh::ReleasePool();
     }
 
     void DestroyRenderBatches(ui_render_batches_t const& batch) {
@@ -42,13 +124,91 @@ namespace gui {
             }
     }
 
+    struct batch_patch_t {
+        ugi::Mesh const*    mesh;
+        uint32_t            offset;     // 相对 mesh allocation 起始位置
+        uint32_t            size;
+        uint32_t            dataOffset; // 在 patchData 里的位置
+    };
+    std::vector<batch_patch_t> batchPatches;
+    std::vector<uint8_t> patchData;
+
+    bool PatchRenderBatchItem(ui_render_batch_t* batch, uint32_t spanIndex, image_mesh_t const* mesh) {
+        if(spanIndex >= batch->spans.size()) {
+            return false;
+        }
+        auto const& span = batch->spans[spanIndex];
+        uint32_t vertexCount = mesh ? (uint32_t)mesh->vertices.size() : 0;
+        uint32_t indexCount = mesh ? (uint32_t)mesh->indices.size() : 0;
+        if(vertexCount > span.vertexCapacity || indexCount > span.indexCapacity) {
+            return false;
+        }
+        auto gpuMesh = batch->renderable->mesh();
+        if(!gpuMesh->prepared()) { // 还在上传，改了也会被覆盖
+            return false;
+        }
+        if(vertexCount) {
+            batch_patch_t patch = {
+                gpuMesh,
+                span.vertexOffset * (uint32_t)sizeof(image_vertex_t),
+                vertexCount * (uint32_t)sizeof(image_vertex_t),
+                (uint32_t)patchData.size()
+            };
+            patchData.resize(patch.dataOffset + patch.size);
+            auto vertices = (image_vertex_t*)(patchData.data() + patch.dataOffset);
+            memcpy(vertices, mesh->vertices.data(), patch.size);
+            for(uint32_t i = 0; i<vertexCount; ++i) {
+                vertices[i].instIndex = spanIndex;
+            }
+            batchPatches.push_back(patch);
+        }
+        // 索引整段重写，没用到的部分填退化三角形
+        if(span.indexCapacity) {
+            batch_patch_t patch = {
+                gpuMesh,
+                gpuMesh->iboffset() + span.indexOffset * (uint32_t)sizeof(uint16_t),
+                span.indexCapacity * (uint32_t)sizeof(uint16_t),
+                (uint32_t)patchData.size()
+            };
+            patchData.resize(patch.dataOffset + patch.size);
+            auto indices = (uint16_t*)(patchData.data() + patch.dataOffset);
+            for(uint32_t i = 0; i<span.indexCapacity; ++i) {
+                indices[i] = (uint16_t)(span.vertexOffset + (i < indexCount ? mesh->indices[i] : 0));
+            }
+            batchPatches.push_back(patch);
+        }
+        // args 的数量和顺序没变，cachedArgs 交给 syncDirtyArgs
+        return true;
+    }
+
+    void FlushRenderBatchPatches(ugi::ResourceCommandEncoder* encoder) {
+        if(batchPatches.empty()) {
+            return;
+        }
+        // 之前的帧还可能在读这些顶点（WAR），整理搬迁的 copy 也可能写同一段（WAW）
+        encoder->memoryBarrier(
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT
+        );
+        for(auto const& patch: batchPatches) {
+            patch.mesh->update(encoder, patch.offset, patchData.data() + patch.dataOffset, patch.size);
+        }
+        encoder->memoryBarrier(
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT
+        );
+        batchPatches.clear();
+        patchData.clear();
+    }
+
     std::vector<FrameBatch> frameBatches;
 
     void ClearFrameBatchCache() {
         frameBatches.clear();
     }
 
-    void CommitRenderBatch(ui_render_batches_t const& batch, glm::mat4 const& batchWorld) {
+    void CommitRenderBatch(ui_render_batches_t const& batch, affine2d const& batchWorld) {
         frameBatches.push_back({batch, batchWorld});
     }
 
@@ -60,16 +220,18 @@ namespace gui {
             switch(fb.batch.type) {
                 case gui::UIMeshType::Image: {
                     auto render = UIImageRender::Instance();
-                    render->bind(encoder);
                     render->setRasterization(rasterizationState);
-                    render->drawBatch(fb.batch, fb.batchWorld, encoder);
+                    if(render->bind(encoder)) {
+                        render->drawBatch(fb.batch, fb.batchWorld, encoder);
+                    }
                     break;
                 }
                 case gui::UIMeshType::Font: {
                     auto render = TextSDFRender::Instance();
-                    render->bind(encoder);
                     render->setRasterization(rasterizationState);
-                    render->drawBatch(fb.batch, fb.batchWorld, encoder);
+                    if(render->bind(encoder)) {
+                        render->drawBatch(fb.batch, fb.batchWorld, encoder);
+                    }
                     break;
                 }
                 default: {
@@ -78,6 +240,150 @@ namespace gui {
         }
     }
 
+    struct parallel_recorder_t {
+        static constexpr uint32_t MaxSegmentCount = 8;
+        static constexpr uint32_t MinDrawsPerSegment = 16;     ///> draw 太少时分段不划算
+        ugi::Device*                        device = nullptr;
+        ugi::CommandQueue*                  queue = nullptr;
+        ugi::WorkerPool                     workers;
+        uint32_t                            segmentCount = 0;
+        std::vector<ugi::CommandBuffer*>    commandBuffers[ugi::MaxFlightCount];   ///> [flight][segment]，segment i 从 queue 的第 i 个 secondary pool 分配
+        std::vector<ugi::DescriptorBinder*> imageBinders;                       ///> 每段一个，不和 pipeline 自己的 binder 共享
+        std::vector<ugi::DescriptorBinder*> textBinders;
+        uint32_t                            frame = 0;
+    };
+
+    parallel_recorder_t* parallelRecorder = nullptr;
+
+    void InitializeParallelRecording(ugi::Device* device, ugi::CommandQueue* queue, uint32_t segmentCount) {
+        if(parallelRecorder) {
+            return;
+        }
+        if(!segmentCount) {
+            uint32_t hw = std::thread::hardware_concurrency();
+            segmentCount = hw > 1 ? hw - 1 : 1;
+        }
+        segmentCount = std::min(segmentCount, parallel_recorder_t::MaxSegmentCount);
+        parallelRecorder = new parallel_recorder_t();
+        parallelRecorder->device = device;
+        parallelRecorder->queue = queue;
+        parallelRecorder->segmentCount = segmentCount;
+        parallelRecorder->workers.initialize(segmentCount);
+    }
+
+    void DestroyParallelRecording() {
+        if(!parallelRecorder) {
+            return;
+        }
+        parallelRecorder->workers.destroy();
+        for(auto& cbs: parallelRecorder->commandBuffers) {
+            for(auto cb: cbs) {
+                parallelRecorder->queue->destroyCommandBuffer(parallelRecorder->device, cb);
+            }
+        }
+        for(auto binder: parallelRecorder->imageBinders) {
+            delete binder;
+        }
+        for(auto binder: parallelRecorder->textBinders) {
+            delete binder;
+        }
+        delete parallelRecorder;
+        parallelRecorder = nullptr;
+    }
+
+    void DrawRenderBatchesParallel(ugi::RenderCommandEncoder* encoder) {
+        if(encoder->contents() == ugi::RenderCommandEncoder::Contents::Inline) {
+            DrawRenderBatches(encoder);
+            return;
+        }
+        assert(parallelRecorder);
+        if(!parallelRecorder) {
+            return;
+        }
+        auto recorder = parallelRecorder;
+        auto imageRender = UIImageRender::Instance();
+        auto textRender = TextSDFRender::Instance();
+        // pipeline 变体的查找/编译不是线程安全的，在这里一次取好
+        ugi::raster_state_t rasterizationState;
+        rasterizationState.polygonMode = ugi::polygon_mode_t::Fill;
+        imageRender->setRasterization(rasterizationState);
+        textRender->setRasterization(rasterizationState);
+        VkPipeline imagePipeline = imageRender->resolvePipeline(encoder);
+        VkPipeline textPipeline = textRender->resolvePipeline(encoder);
+        // 按 draw 数量切成连续的几段，保持绘制顺序
+        size_t drawCount = 0;
+        for(auto const& fb: frameBatches) {
+            drawCount += fb.batch.batches.size();
+        }
+        if(!drawCount) {
+            return;
+        }
+        uint32_t segmentCount = (uint32_t)std::min<size_t>(recorder->segmentCount, std::max<size_t>(1, drawCount / parallel_recorder_t::MinDrawsPerSegment));
+        size_t segmentRanges[parallel_recorder_t::MaxSegmentCount+1] = {};
+        {
+            size_t target = (drawCount + segmentCount - 1) / segmentCount;
+            size_t accumulated = 0;
+            uint32_t segment = 1;
+            for(size_t i = 0; i<frameBatches.size() && segment<segmentCount; ++i) {
+                accumulated += frameBatches[i].batch.batches.size();
+                if(accumulated >= target * segment) {
+                    segmentRanges[segment++] = i + 1;
+                }
+            }
+            while(segment <= segmentCount) {
+                segmentRanges[segment++] = frameBatches.size();
+            }
+        }
+        // 这一帧用的 secondary command buffer 和 binder
+        auto& commandBuffers = recorder->commandBuffers[recorder->frame % ugi::MaxFlightCount];
+        ++recorder->frame;
+        while(commandBuffers.size() < segmentCount) {
+            commandBuffers.push_back(recorder->queue->createSecondaryCommandBuffer(recorder->device, (uint32_t)commandBuffers.size()));
+        }
+        while(recorder->imageBinders.size() < segmentCount) {
+            recorder->imageBinders.push_back(imageRender->createDescriptorBinder());
+            recorder->textBinders.push_back(textRender->createDescriptorBinder());
+        }
+        for(uint32_t segment = 0; segment<segmentCount; ++segment) {
+            size_t begin = segmentRanges[segment];
+            size_t end = segmentRanges[segment+1];
+            ugi::CommandBuffer* cb = commandBuffers[segment];
+            ugi::DescriptorBinder* imageBinder = recorder->imageBinders[segment];
+            ugi::DescriptorBinder* textBinder = recorder->textBinders[segment];
+            recorder->workers.post([=]() {
+                imageBinder->reset();
+                textBinder->reset();
+                cb->beginEncode(encoder);
+                auto enc = cb->inheritedRenderCommandEncoder(encoder);
+                for(size_t i = begin; i<end; ++i) {
+                    auto const& fb = frameBatches[i];
+                    switch(fb.batch.type) {
+                        case gui::UIMeshType::Image: {
+                            if(imagePipeline) {
+                                enc->bindPipelineObject(imagePipeline);
+                                imageRender->drawBatch(fb.batch, fb.batchWorld, enc, imageBinder);
+                            }
+                            break;
+                        }
+                        case gui::UIMeshType::Font: {
+                            if(textPipeline) {
+                                enc->bindPipelineObject(textPipeline);
+                                textRender->drawBatch(fb.batch, fb.batchWorld, enc, textBinder);
+                            }
+                            break;
+                        }
+                        default: {
+                        }
+                    }
+                }
+                enc->endEncode();
+                cb->endEncode();
+            });
+        }
+        recorder->workers.waitIdle();
+        encoder->executeCommands(commandBuffers.data(), segmentCount);
+    }
+
     void SetVPMat(glm::mat4 const& vp) {
         auto imageRender = UIImageRender::Instance();
         imageRender->setVP(vp);
@@ -1,23 +1,62 @@
 #pragma once
 #include "command_encoder/render_cmd_encoder.h"
 #include <core/display_objects/display_components.h>
+#include <ugi/helper/pipeline_helper.h>
+#include <io/archive.h>
 
 namespace gui {
 
-    ui_render_batches_t BuildImageRenderBatches(std::vector<void*> const& items, std::vector<item_args_t*> const& args, ugi::Texture* texture);
-    ui_render_batches_t BuildTextRenderBatches(std::vector<void*> const& items, std::vector<item_args_t*> const& args, ugi::Texture* texture);
+    /*
+     *  item 的 args 有两种 pipeline：
+     *  <name>_ssbo 用 storage buffer 存实例数组，一个材质连续段一般一次 draw 画完
+     *  <name> 用 UBO，一个 sub-batch 最多 512 个实例，设备不够或者没有 ssbo 版本时退回这个
+     *  names 按优先级排，第一个能读到的胜出（比如先试多贴图版本），都没有返回 !valid() 的 helper
+     * */
+    ugi::PipelineHelper LoadItemPipeline(ugi::Device* device, comm::IArchive* archive, std::initializer_list<char const*> names);
+    // 按 pipeline 里 args 的类型、设备限制和 args 从哪个 allocator 分配，算一个 sub-batch 最多放多少个实例
+    uint32_t ItemArgsCapacity(ugi::Device* device, ugi::GraphicsPipeline const* pipeline, ugi::UniformAllocator const* argsAllocator);
+    // args 是 DynamicStorageBuffer 并且给了 storage allocator 就用它，否则和其它 uniform 一样从 uniformAllocator 分配
+    ugi::UniformAllocator* ArgsAllocatorFor(ugi::GraphicsPipeline const* pipeline, ugi::UniformAllocator* uniformAllocator, ugi::UniformAllocator* storageAllocator);
+
+    // 贴图在 image_render_data_t 里，renderer 按自己的贴图槽位数切 sub-batch
+    ui_render_batches_t BuildImageRenderBatches(std::span<image_render_data_t const> datas, bool growable = false);
+    ui_render_batches_t BuildTextRenderBatches(std::span<image_render_data_t const> datas, bool growable = true);
+    // ui_render_batch_t 对象池，回收时保留 vector 的容量，重建 batch 时不用每次 new（只在主线程用）
+    ui_render_batch_t* AcquireRenderBatch();
+    void RecycleRenderBatch(ui_render_batch_t* batch);
+    // 退出时调用（device idle、GPURetireManager::flush 之后），释放 batch / Renderable / Mesh 对象池
+    void ReleaseRenderPools();
     //
     void DestroyRenderBatches(ui_render_batches_t const& batch);
 
+    /*
+     *  原地改写 sub-batch 里一个 item 的顶点/索引
+     *  放不下（超出 span 的 capacity）或者 mesh 还没上传完返回 false，由调用方决定重排
+     *  数据先存起来，FlushRenderBatchPatches 时在渲染队列的 command buffer 里用 vkCmdUpdateBuffer 写进去
+     * */
+    bool PatchRenderBatchItem(ui_render_batch_t* batch, uint32_t spanIndex, image_mesh_t const* mesh);
+    // 在 render pass 之前调用，每帧一次
+    void FlushRenderBatchPatches(ugi::ResourceCommandEncoder* encoder);
+
     struct FrameBatch {
         ui_render_batches_t batch;
-        glm::mat4           batchWorld;
+        affine2d            batchWorld;
     };
 
     void ClearFrameBatchCache();
-    void CommitRenderBatch(ui_render_batches_t const& batch, glm::mat4 const& batchWorld);
+    void CommitRenderBatch(ui_render_batches_t const& batch, affine2d const& batchWorld);
 
     void SetVPMat(glm::mat4 const& vp);
 
     void DrawRenderBatches(ugi::RenderCommandEncoder* encoder);
+
+    /*
+     *  并行录制 UI batch
+     *  frameBatches 按 draw 数量切成连续的几段，每段在工作线程里录到一个 secondary command buffer，最后在 primary 里按顺序 execute
+     *  encoder 需要以 VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS 开启 render pass，每帧调用一次（secondary command buffer 按 flight 轮换）
+     *  没有初始化或者 encoder 是 inline 的时候退回 DrawRenderBatches
+     * */
+    void InitializeParallelRecording(ugi::Device* device, ugi::CommandQueue* queue, uint32_t segmentCount = 0);
+    void DrawRenderBatchesParallel(ugi::RenderCommandEncoder* encoder);
+    void DestroyParallelRecording();
 }
\ No newline at end of file
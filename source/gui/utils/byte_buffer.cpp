@@ -8,6 +8,7 @@ namespace gui {
         int count = read<uint16_t>();
         ByteBuffer buffer(ptr() + position_, count);
         buffer.stringTable_ = this->stringTable_;
+        buffer.nameTable_ = this->nameTable_;
         buffer.version = this->version;
         position_ += count;
         return buffer;
@@ -6,6 +6,7 @@
 #include <vector>
 #include <gui/compiler_def.h>
 #include <gui/core/declare.h>
+#include <gui/utils/name_pool.h>
 
 namespace gui {
 
@@ -56,6 +57,7 @@ namespace gui {
         int                         position_;
         uint8_t                     ownBuffer_ : 1;
         std::vector<std::string>*   stringTable_;
+        std::vector<name_t>*        nameTable_;     // 和 stringTable_ 一一对应，加载时已经驻留好
     public:
         ByteBuffer() 
             : ptr_(nullptr)
@@ -63,6 +65,7 @@ namespace gui {
             , position_(0)
             , ownBuffer_(0)
             , stringTable_(nullptr)
+            , nameTable_(nullptr)
         {
         }
         ByteBuffer(ByteBuffer const& buffer) {
@@ -94,6 +97,8 @@ namespace gui {
             , length_(len)
             , position_(0)
             , ownBuffer_(0)
+            , stringTable_(nullptr)
+            , nameTable_(nullptr)
         {}
 
         ByteBuffer(int len)
@@ -101,17 +106,21 @@ namespace gui {
             , length_(ptr_?len:0)
             , position_(0)
             , ownBuffer_(1)
+            , stringTable_(nullptr)
+            , nameTable_(nullptr)
         {
         }
 
-        void setStringTable(std::vector<std::string>* table) {
+        void setStringTable(std::vector<std::string>* table, std::vector<name_t>* names) {
             stringTable_ = table;
+            nameTable_ = names;
         }
 
         ByteBuffer clone() const {
             auto buff = ByteBuffer(length_);
             memcpy(buff.ptr_, ptr(), length_);
             buff.stringTable_ = stringTable_;
+            buff.nameTable_ = nameTable_;
             buff.version = version;
             return buff;
         }
@@ -216,6 +225,7 @@ namespace gui {
             int count = read<int>();
             ByteBuffer buffer(ptr() + position_, count);
             buffer.stringTable_ = this->stringTable_;
+            buffer.nameTable_ = this->nameTable_;
             buffer.version = this->version;
             position_ += count;
             return buffer;
@@ -225,6 +235,7 @@ namespace gui {
             auto index = this->read<uint16_t>();
             if(stringTable_->size() > index) {
                 stringTable_->at(index) = str;
+                nameTable_->at(index) = InternName(str);
             }
         }
 
@@ -233,6 +244,21 @@ namespace gui {
                 vec.push_back(read<csref>());
             }
         }
+
+        /// 和 read<csref> 读同一个索引，直接拿驻留好的 name_t，不用再查字符串
+        name_t readName() {
+            uint16_t index = this->read<uint16_t>();
+            if(nameTable_ && nameTable_->size() > index) {
+                return (*nameTable_)[index];
+            }
+            return EmptyName;
+        }
+
+        void readNameArray(std::vector<name_t>& vec, uint32_t count) {
+            for(uint32_t i = 0; i<count; ++i) {
+                vec.push_back(readName());
+            }
+        }
         template<class BlockType>
         requires std::is_enum_v<BlockType>
         bool seekToBlock(int indexTablePos, BlockType blockIndex) {
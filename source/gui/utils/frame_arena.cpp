@@ -0,0 +1,72 @@
+#include "frame_arena.h"
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+namespace gui {
+
+    FrameArena::FrameArena()
+        : _blocks()
+        , _cursor(0)
+        , _usedBytes(0)
+        , _stat{}
+    {
+        _blocks.reserve(8);
+        _pushBlock(InitialBlockSize);
+        _stat.capacity = InitialBlockSize;
+    }
+
+    FrameArena::~FrameArena() {
+        _freeBlocks();
+    }
+
+    void FrameArena::_pushBlock(size_t size) {
+        block_t block;
+        block.data = (std::byte*)::operator new(size, std::align_val_t(alignof(std::max_align_t)));
+        block.size = size;
+        _blocks.push_back(block);
+    }
+
+    void FrameArena::_freeBlocks() {
+        for(auto const& block: _blocks) {
+            ::operator delete(block.data, std::align_val_t(alignof(std::max_align_t)));
+        }
+        _blocks.clear();
+    }
+
+    void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+        auto& block = _blocks.back();
+        size_t offset = (_cursor + alignment - 1) & ~(alignment - 1);
+        if(offset + bytes <= block.size) {
+            _cursor = offset + bytes;
+            return block.data + offset;
+        }
+        // 溢出了，串一个新 block，这一帧剩下的都从新 block 上切
+        _usedBytes += _cursor;
+        _pushBlock(std::max(block.size, bytes + alignment));
+        ++_stat.overflowBlocks;
+        _cursor = 0;
+        return do_allocate(bytes, alignment);
+    }
+
+    void FrameArena::reset() {
+        size_t used = _usedBytes + _cursor;
+        _stat.lastFrameBytes = used;
+        _stat.highWaterBytes = std::max(_stat.highWaterBytes, used);
+        if(_blocks.size() > 1) { // 按峰值留 25% 余量合成一个
+            size_t capacity = std::max(InitialBlockSize, _stat.highWaterBytes + _stat.highWaterBytes / 4);
+            capacity = (capacity + InitialBlockSize - 1) & ~(InitialBlockSize - 1);
+            _freeBlocks();
+            _pushBlock(capacity);
+            _stat.capacity = capacity;
+        }
+        _cursor = 0;
+        _usedBytes = 0;
+    }
+
+    FrameArena& GetFrameArena() {
+        static FrameArena arena;
+        return arena;
+    }
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <memory_resource>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace gui {
+
+    struct frame_arena_stat_t {
+        size_t      capacity;           ///> 主 block 的大小
+        size_t      lastFrameBytes;     ///> 上一帧用掉的字节数
+        size_t      highWaterBytes;     ///> 历史峰值
+        uint32_t    overflowBlocks;     ///> 累计因为不够用临时串上的 block 数，稳定之后不应该再涨
+    };
+
+    /*
+     *  GuiTick 里的临时内存（重建 batch 时的顶点/索引/args、收集 render data 之类）
+     *  1. 线性分配，deallocate 什么都不做，GuiTick 开始时 reset 整个回收
+     *  2. 不够用就临时串一个 block，reset 时按峰值合成一个，之后不再向系统要内存
+     *  3. 只能在主线程用，不要把从这里分配的容器存到帧外
+     * */
+    class FrameArena : public std::pmr::memory_resource {
+    public:
+        static constexpr size_t InitialBlockSize = 0x10000;
+    private:
+        struct block_t {
+            std::byte*  data;
+            size_t      size;
+        };
+        std::vector<block_t>    _blocks;            ///> [0] 是主 block，后面的是这一帧溢出串上的
+        size_t                  _cursor;            ///> 最后一个 block 里的偏移
+        size_t                  _usedBytes;         ///> 这一帧已经用完的 block 里的字节数
+        frame_arena_stat_t      _stat;
+    private:
+        void _pushBlock(size_t size);
+        void _freeBlocks();
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void*, size_t, size_t) override {}
+        bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+            return this == &other;
+        }
+    public:
+        FrameArena();
+        ~FrameArena();
+        void reset();
+        frame_arena_stat_t stat() const {
+            return _stat;
+        }
+    };
+
+    FrameArena& GetFrameArena();
+
+    template<class T>
+    using frame_vector = std::pmr::vector<T>;
+
+}
@@ -0,0 +1,64 @@
+#include "name_pool.h"
+#include <cassert>
+#include <cstdio>
+#include <mutex>
+
+namespace gui {
+
+    NamePool::NamePool()
+        : _chunks{}
+        , _names()
+        , _count(0)
+        , _mutex()
+    {
+        _names.reserve(ChunkSize);
+        intern({}); // EmptyName
+    }
+
+    name_t NamePool::intern(std::string_view str) {
+        {
+            std::shared_lock lock(_mutex);
+            auto iter = _names.find(str);
+            if(iter != _names.end()) {
+                return iter->second;
+            }
+        }
+        std::unique_lock lock(_mutex);
+        auto iter = _names.find(str); // 等锁的时候可能别人已经插进来了
+        if(iter != _names.end()) {
+            return iter->second;
+        }
+        name_t name = _count;
+        if((name >> ChunkShift) >= MaxChunks) { // 满了，先检查再取 chunk
+            assert(false && "name pool is full");
+            printf("[NamePool] pool is full (%u names), can not intern \"%.*s\"\n", _count, (int)str.size(), str.data());
+            return InvalidName;
+        }
+        auto& chunk = _chunks[name >> ChunkShift];
+        if(!chunk) {
+            chunk = std::make_unique<std::string[]>(ChunkSize);
+        }
+        auto& slot = chunk[name & (ChunkSize - 1)];
+        slot.assign(str.data(), str.size());
+        _names.emplace(std::string_view(slot), name);
+        ++_count;
+        return name;
+    }
+
+    name_t NamePool::find(std::string_view str) const {
+        std::shared_lock lock(_mutex);
+        auto iter = _names.find(str);
+        return iter != _names.end() ? iter->second : InvalidName;
+    }
+
+    uint32_t NamePool::size() const {
+        std::shared_lock lock(_mutex);
+        return _count;
+    }
+
+    NamePool& GetNamePool() {
+        static NamePool pool;
+        return pool;
+    }
+
+}
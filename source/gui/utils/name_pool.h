@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace gui {
+
+    using name_t = uint32_t;
+
+    constexpr name_t EmptyName = 0;         ///> 空串固定是 0
+    constexpr name_t InvalidName = ~0u;     ///> find 没找到，或者池子满了 intern 失败
+
+    /*
+     *  全局字符串驻留池：id、name、控制器页面这些字符串换成 32 位的 name_t，比较和做 key 都只是整数
+     *  1. 同一个字符串永远拿到同一个 name_t，不回收
+     *  2. intern/find 加锁（加载包可能不在主线程）；str 不加锁，字符串按 chunk 存，地址不会变
+     * */
+    class NamePool {
+    public:
+        static constexpr uint32_t ChunkShift = 10;
+        static constexpr uint32_t ChunkSize = 1u << ChunkShift;
+        static constexpr uint32_t MaxChunks = 4096;
+    private:
+        std::unique_ptr<std::string[]>                  _chunks[MaxChunks];
+        std::unordered_map<std::string_view, name_t>    _names;     ///> key 指向 chunk 里的字符串
+        uint32_t                                        _count;
+        mutable std::shared_mutex                       _mutex;
+    public:
+        NamePool();
+        name_t intern(std::string_view str);
+        /// 只查不插，用字符串查表的接口先走这里，没有就说明肯定没有这个名字
+        name_t find(std::string_view str) const;
+        /// InvalidName 返回空串
+        std::string const& str(name_t name) const {
+            if((name >> ChunkShift) >= MaxChunks) {
+                return _chunks[0][EmptyName];
+            }
+            return _chunks[name >> ChunkShift][name & (ChunkSize - 1)];
+        }
+        uint32_t size() const;
+    };
+
+    NamePool& GetNamePool();
+
+    inline name_t InternName(std::string_view str) {
+        return GetNamePool().intern(str);
+    }
+
+    inline std::string const& NameString(name_t name) {
+        return GetNamePool().str(name);
+    }
+
+}
@@ -0,0 +1,183 @@
+/*
+ *  batch_rebuild_bench [items] [frames]
+ *  模拟 GuiTick 里重建 batch 时的内存使用，替换全局 operator new 统计堆分配次数：
+ *  旧：顶点/索引/args 用 std::vector 临时拼，每个 sub-batch new 一个对象、delete 回堆
+ *  新：临时数据从 FrameArena 上切，sub-batch 对象走池子，回收时保留 vector 的容量
+ *  预热几帧之后新路径每帧的堆分配次数必须是 0，否则返回非 0
+ *  ugi 的 Renderable / Mesh 池需要 device，这里只覆盖 CPU 端的部分
+ * */
+#include <utils/frame_arena.h>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace {
+
+    std::atomic<uint64_t> heapAllocations(0);
+
+}
+
+void* operator new(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if(void* ptr = malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+namespace {
+
+    // 尺寸和 image_vertex_t / item_args_t / item_span_t 一致就行，内容无所谓
+    struct vertex_t { float position[2]; float uv[2]; uint32_t inst; };
+    struct args_t { float transform[6]; float color[4]; float gray; uint32_t textureSlot; };
+    struct span_t { uint32_t vertexOffset, vertexCapacity, indexOffset, indexCapacity; };
+
+    struct batch_t {
+        std::vector<args_t>     cachedArgs;
+        std::vector<span_t>     spans;
+    };
+
+    constexpr uint32_t MaxInstancesPerBatch = 512;
+    constexpr uint32_t WarmupFrames = 4;
+
+    template<class VertexVec, class IndexVec, class ArgsVec, class SpanVec>
+    void appendItem(VertexVec& vertices, IndexVec& indices, ArgsVec& args, SpanVec& spans, uint32_t item) {
+        uint32_t const base = (uint32_t)vertices.size();
+        spans.push_back({ base, 4, (uint32_t)indices.size(), 6 });
+        for(uint32_t v = 0; v<4; ++v) {
+            vertices.push_back({ { (float)item, (float)v }, { 0.0f, 0.0f }, (uint32_t)args.size() });
+        }
+        uint16_t const quad[] = { 0, 1, 2, 0, 2, 3 };
+        for(auto i: quad) {
+            indices.push_back((uint16_t)(base + i));
+        }
+        args.push_back({ { 1, 0, 0, 1, (float)item, 0 }, { 1, 1, 1, 1 }, 0.0f, 0 });
+    }
+
+    // 改动之前：临时 vector + 每个 sub-batch 一次 new
+    void legacyRebuild(uint32_t items, std::vector<batch_t*>& live) {
+        for(auto batch: live) {
+            delete batch;
+        }
+        live.clear();
+        std::vector<vertex_t> vertices;
+        std::vector<uint16_t> indices;
+        std::vector<args_t> args;
+        std::vector<span_t> spans;
+        auto breakBatch = [&]() {
+            auto batch = new batch_t();
+            batch->cachedArgs.assign(args.begin(), args.end());
+            batch->spans.assign(spans.begin(), spans.end());
+            live.push_back(batch);
+            vertices.clear(); indices.clear(); args.clear(); spans.clear();
+        };
+        for(uint32_t i = 0; i<items; ++i) {
+            appendItem(vertices, indices, args, spans, i);
+            if(args.size() >= MaxInstancesPerBatch) {
+                breakBatch();
+            }
+        }
+        if(args.size()) {
+            breakBatch();
+        }
+    }
+
+    // 现在的做法，和 buildImageRenderBatch + AcquireRenderBatch/RecycleRenderBatch 一致
+    void pooledRebuild(uint32_t items, std::vector<batch_t*>& live, std::vector<batch_t*>& pool) {
+        for(auto batch: live) {
+            batch->cachedArgs.clear();
+            batch->spans.clear();
+            pool.push_back(batch);
+        }
+        live.clear();
+        auto& arena = gui::GetFrameArena();
+        arena.reset();
+        gui::frame_vector<vertex_t> vertices(&arena);
+        gui::frame_vector<uint16_t> indices(&arena);
+        gui::frame_vector<args_t> args(&arena);
+        gui::frame_vector<span_t> spans(&arena);
+        auto breakBatch = [&]() {
+            batch_t* batch;
+            if(pool.empty()) {
+                batch = new batch_t();
+            } else {
+                batch = pool.back();
+                pool.pop_back();
+            }
+            batch->cachedArgs.assign(args.begin(), args.end());
+            batch->spans.assign(spans.begin(), spans.end());
+            live.push_back(batch);
+            vertices.clear(); indices.clear(); args.clear(); spans.clear();
+        };
+        for(uint32_t i = 0; i<items; ++i) {
+            appendItem(vertices, indices, args, spans, i);
+            if(args.size() >= MaxInstancesPerBatch) {
+                breakBatch();
+            }
+        }
+        if(args.size()) {
+            breakBatch();
+        }
+    }
+
+    struct result_t {
+        double      msPerFrame;
+        double      allocationsPerFrame;    ///> 预热之后
+    };
+
+    template<class Rebuild>
+    result_t run(uint32_t frames, Rebuild&& rebuild) {
+        for(uint32_t frame = 0; frame<WarmupFrames; ++frame) {
+            rebuild();
+        }
+        uint64_t const allocations = heapAllocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        for(uint32_t frame = 0; frame<frames; ++frame) {
+            rebuild();
+        }
+        double const ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return { ms / frames, (double)(heapAllocations.load(std::memory_order_relaxed) - allocations) / frames };
+    }
+
+}
+
+int main(int argc, char** argv) {
+    uint32_t const items = argc > 1 ? (uint32_t)atoi(argv[1]) : 20000;
+    uint32_t const frames = argc > 2 ? (uint32_t)atoi(argv[2]) : 200;
+    if(!items || !frames) {
+        printf("usage: %s [items=20000] [frames=200]\n", argv[0]);
+        return 1;
+    }
+    std::vector<batch_t*> legacyLive;
+    std::vector<batch_t*> pooledLive, pool;
+    legacyLive.reserve(items / MaxInstancesPerBatch + 1);
+    pooledLive.reserve(items / MaxInstancesPerBatch + 1);
+    pool.reserve(items / MaxInstancesPerBatch + 1);
+    result_t const legacy = run(frames, [&]() { legacyRebuild(items, legacyLive); });
+    result_t const pooled = run(frames, [&]() { pooledRebuild(items, pooledLive, pool); });
+    auto const arenaStat = gui::GetFrameArena().stat();
+
+    printf("items          : %u (%u per sub-batch), frames %u\n", items, MaxInstancesPerBatch, frames);
+    printf("vector + new   : %8.3f ms/frame, %8.1f heap allocations/frame\n", legacy.msPerFrame, legacy.allocationsPerFrame);
+    printf("arena + pool   : %8.3f ms/frame, %8.1f heap allocations/frame\n", pooled.msPerFrame, pooled.allocationsPerFrame);
+    printf("frame arena    : capacity %zu, last frame %zu bytes, overflow blocks %u\n", arenaStat.capacity, arenaStat.lastFrameBytes, arenaStat.overflowBlocks);
+    assert(pooled.allocationsPerFrame == 0.0);
+    if(pooled.allocationsPerFrame != 0.0) {
+        printf("[batch rebuild bench] steady state still hits the heap\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ *  glyph_sdf_bench <font.ttf> [sdfSourceSize] [rounds]
+ *  对比 stbtt_GetCodepointSDF（旧的同步路径）和 gui::BakeGlyphSDF（光栅化 + EDT）每秒能烘焙多少字形
+ *  参数和 FontManager::generateGlyph 的默认 Config 一致，同时给出两者输出的平均差
+ * */
+#include <core/glyph_sdf.h>
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <stb_truetype.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+    constexpr int ExtraBorder = 8;
+    constexpr int SearchDistance = 8;
+    constexpr int TileSize = 64;
+    constexpr float DPI = 96.0f;
+
+    struct glyph_param_t {
+        uint32_t    charCode;
+        float       scale;
+        float       distScale;
+    };
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printf("usage: %s <font.ttf> [sdfSourceSize=64] [rounds=4]\n", argv[0]);
+        return 1;
+    }
+    uint32_t const sourceSize = argc > 2 ? (uint32_t)atoi(argv[2]) : 64;
+    int const rounds = argc > 3 ? atoi(argv[3]) : 4;
+
+    FILE* file = fopen(argv[1], "rb");
+    if (!file) {
+        printf("[glyph sdf bench] can not open %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> ttf;
+    fseek(file, 0, SEEK_END);
+    ttf.resize((size_t)ftell(file));
+    fseek(file, 0, SEEK_SET);
+    size_t const readBytes = fread(ttf.data(), 1, ttf.size(), file);
+    fclose(file);
+    stbtt_fontinfo font;
+    if (readBytes != ttf.size() || !stbtt_InitFont(&font, ttf.data(), stbtt_GetFontOffsetForIndex(ttf.data(), 0))) {
+        printf("[glyph sdf bench] invalid font %s\n", argv[1]);
+        return 1;
+    }
+    // 可见 ASCII，缩放规则照抄 FontManager::generateGlyph
+    float const scale = stbtt_ScaleForMappingEmToPixels(&font, sourceSize * DPI / 72.0f);
+    std::vector<glyph_param_t> glyphs;
+    for (uint32_t c = 33; c < 127; ++c) {
+        int x0, y0, x1, y1;
+        stbtt_GetCodepointBitmapBox(&font, (int)c, scale, scale, &x0, &y0, &x1, &y1);
+        int const maxDim = std::max(x1 - x0, y1 - y0);
+        if (!maxDim) {
+            continue;
+        }
+        float rs = 1.0f;
+        int const cellInner = TileSize - ExtraBorder * 2;
+        if (cellInner < maxDim) {
+            rs = (float)cellInner / maxDim;
+        }
+        glyphs.push_back({ c, scale * rs, (float)SearchDistance / rs });
+    }
+    if (glyphs.empty()) {
+        printf("[glyph sdf bench] no glyph in font\n");
+        return 1;
+    }
+    uint32_t const bakeCount = (uint32_t)glyphs.size() * (uint32_t)rounds;
+
+    // stb 暴力搜索
+    std::vector<std::vector<uint8_t>> reference(glyphs.size());
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < glyphs.size(); ++i) {
+            auto const& g = glyphs[i];
+            int w, h, ox, oy;
+            uint8_t* sdf = stbtt_GetCodepointSDF(&font, g.scale, (int)g.charCode, ExtraBorder, 128, g.distScale, &w, &h, &ox, &oy);
+            if (sdf && r == 0) {
+                reference[i].assign(sdf, sdf + (size_t)w * h);
+            }
+            stbtt_FreeSDF(sdf, nullptr);
+        }
+    }
+    double const stbSeconds = secondsSince(start);
+
+    // 光栅化 + EDT
+    gui::sdf_scratch_t scratch;
+    std::vector<uint8_t> dst;
+    uint64_t diffSum = 0, diffCount = 0;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < glyphs.size(); ++i) {
+            auto const& g = glyphs[i];
+            int w, h, ox, oy;
+            if (!gui::GlyphSDFBox(font, g.charCode, g.scale, ExtraBorder, w, h, ox, oy)) {
+                continue;
+            }
+            dst.resize((size_t)w * h);
+            gui::BakeGlyphSDF(font, g.charCode, g.scale, ExtraBorder, 128, g.distScale, dst.data(), w, scratch);
+            if (r == 0 && reference[i].size() == dst.size()) {
+                for (size_t p = 0; p < dst.size(); ++p) {
+                    diffSum += (uint64_t)std::abs((int)dst[p] - (int)reference[i][p]);
+                }
+                diffCount += dst.size();
+            }
+        }
+    }
+    double const edtSeconds = secondsSince(start);
+
+    printf("glyphs         : %u (%zu x %d rounds, source size %u px)\n", bakeCount, glyphs.size(), rounds, sourceSize);
+    printf("stb sdf        : %10.1f glyphs/s\n", bakeCount / stbSeconds);
+    printf("coverage + edt : %10.1f glyphs/s\n", bakeCount / edtSeconds);
+    printf("mean abs diff  : %.2f / 255\n", diffCount ? (double)diffSum / diffCount : 0.0);
+    return 0;
+}
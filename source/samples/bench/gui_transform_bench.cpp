@@ -0,0 +1,163 @@
+/*
+ *  gui_transform_bench [depth] [fanout] [frames] [result.csv]
+ *  在 Stage 的 root 下面合成一棵容器树（默认 7 层、每层 6 个子节点，约 5.6 万个节点，叶子是 item）
+ *  每帧移动一个容器，先单独跑变换阶段对比：
+ *  旧：args_need_sync 灌满子树，每个 item 沿父链 accumulateLocalToBatch
+ *  新：updateItemTransforms，缓存 local-to-batch，一次自顶向下每个节点乘一次
+ *  再跑整个 GuiTick（可见性、batch 树、点击索引、提交都算在里面）
+ *  item 没有 mesh，不进 batch，不需要 device；帧末直接清掉 args_need_sync（相当于 syncDirtyArgs 全部同步完）
+ *  结果追加写到 result.csv（默认 gui_transform_bench.csv），方便前后对比
+ * */
+#include <gui.h>
+#include <core/display_objects/display_object.h>
+#include <core/display_objects/display_object_utility.h>
+#include <core/ui/stage.h>
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+using namespace gui;
+
+namespace {
+
+    struct synthetic_tree_t {
+        DisplayObject               root;
+        DisplayObject               top;            // 根下面唯一的容器，移动它整棵树都要重算
+        std::vector<DisplayObject>  deepest;        // 最底层容器，移动它只影响 fanout 个 item
+        uint32_t                    nodeCount = 0;
+        uint32_t                    itemCount = 0;
+    };
+
+    void buildLevel(synthetic_tree_t& tree, DisplayObject parent, uint32_t level, uint32_t depth, uint32_t fanout) {
+        for(uint32_t i = 0; i<fanout; ++i) {
+            DisplayObject child = DisplayObject::createDisplayObject();
+            child.setPosition(glm::vec2((float)i * 3.0f, (float)level));
+            child.setSize(glm::vec2(16.0f, 16.0f));
+            parent.addChild(child);
+            ++tree.nodeCount;
+            if(level + 1 < depth) {
+                buildLevel(tree, child, level + 1, depth, fanout);
+                if(level + 2 == depth) {
+                    tree.deepest.push_back(child);
+                }
+            } else { // 叶子当 item 用，batch 信息只是占位
+                reg.emplace<dispcomp::item_render_data>(child);
+                reg.emplace<dispcomp::item_batch_info>(child, dispcomp::item_batch_info{ tree.root, -1, 0, 0 });
+                ++tree.itemCount;
+            }
+        }
+    }
+
+    // 渲染端的桩：这一帧的同步标记全部视为已经写进 batch cache
+    void stubSyncArgs() {
+        reg.clear<dispcomp::args_need_sync>();
+        reg.clear<dispcomp::transform_dirty>();
+    }
+
+    // 改动之前的 updateItemTransforms
+    void legacyUpdateItemTransforms() {
+        reg.view<dispcomp::args_need_sync, dispcomp::children>(entt::exclude_t<dispcomp::batch_node>()).each([](entt::entity ett, dispcomp::args_need_sync& sync, dispcomp::children& children) {
+            if (!(sync.mask & dispcomp::Asm_Transform)) {
+                return;
+            }
+            std::vector<entt::entity> objects = children.val;
+            while(!objects.empty()) {
+                auto child = objects.back();
+                objects.pop_back();
+                auto & args_sync = reg.get_or_emplace<dispcomp::args_need_sync>(child);
+                if(args_sync.mask & dispcomp::Asm_Transform) {
+                    continue;
+                }
+                args_sync.mask |= sync.mask;
+                if (reg.any_of<dispcomp::children>(child) && !reg.any_of<dispcomp::batch_node>(child)) {
+                    objects.insert(objects.end(), reg.get<dispcomp::children>(child).val.begin(), reg.get<dispcomp::children>(child).val.end());
+                }
+            }
+        });
+        reg.view<dispcomp::args_need_sync, dispcomp::item_batch_info, dispcomp::item_render_data>().each([](entt::entity ett, dispcomp::args_need_sync& sync, dispcomp::item_batch_info& info, dispcomp::item_render_data& gfx) {
+            if (!(sync.mask & dispcomp::Asm_Transform)) {
+                return;
+            }
+            gfx.args.transfrom = accumulateLocalToBatch(ett, info.batchEntity);
+            sync.mask &= ~dispcomp::Asm_Transform;
+        });
+    }
+
+    struct result_t {
+        char const*     stage;
+        char const*     move;
+        double          ms;
+    };
+
+    double msPerFrame(uint32_t frames, std::function<void(uint32_t)> const& move, void(*update)()) {
+        auto start = std::chrono::steady_clock::now();
+        for(uint32_t frame = 0; frame<frames; ++frame) {
+            move(frame);
+            update();
+            stubSyncArgs();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    uint32_t const depth = argc > 1 ? (uint32_t)atoi(argv[1]) : 7;
+    uint32_t const fanout = argc > 2 ? (uint32_t)atoi(argv[2]) : 6;
+    uint32_t const frames = argc > 3 ? (uint32_t)atoi(argv[3]) : 60;
+    char const* resultPath = argc > 4 ? argv[4] : "gui_transform_bench.csv";
+    if(depth < 3 || !fanout || !frames) {
+        printf("usage: %s [depth=7 (>=3)] [fanout=6] [frames=60] [result.csv]\n", argv[0]);
+        return 1;
+    }
+    // root 是 Stage 的根（batch 节点 + is_root），GuiTick 从它开始遍历
+    Stage::Instance()->initialize(1920.0f, 1080.0f);
+    synthetic_tree_t tree;
+    tree.root = Stage::Instance()->defaultRoot()->getDisplayObject();
+    tree.top = DisplayObject::createDisplayObject();
+    tree.root.addChild(tree.top);
+    tree.nodeCount = 2;
+    buildLevel(tree, tree.top, 1, depth, fanout);
+    // 第一次全量计算，之后各种路径都从干净的状态开始
+    GuiTick();
+    stubSyncArgs();
+
+    auto moveTop = [&](uint32_t frame) {
+        tree.top.setPosition(glm::vec2((float)(frame & 63), 0.0f));
+    };
+    auto moveDeep = [&](uint32_t frame) {
+        tree.deepest[(frame * 7919u) % tree.deepest.size()].setPosition(glm::vec2((float)(frame & 63), 1.0f));
+    };
+    result_t const results[] = {
+        { "transform parent chain", "top", msPerFrame(frames, moveTop, legacyUpdateItemTransforms) },
+        { "transform top-down", "top", msPerFrame(frames, moveTop, updateItemTransforms) },
+        { "GuiTick", "top", msPerFrame(frames, moveTop, GuiTick) },
+        { "transform parent chain", "deepest", msPerFrame(frames, moveDeep, legacyUpdateItemTransforms) },
+        { "transform top-down", "deepest", msPerFrame(frames, moveDeep, updateItemTransforms) },
+        { "GuiTick", "deepest", msPerFrame(frames, moveDeep, GuiTick) },
+    };
+
+    printf("nodes          : %u (items %u, depth %u, fanout %u), frames %u\n", tree.nodeCount, tree.itemCount, depth, fanout, frames);
+    for(auto const& r: results) {
+        printf("move %-9s : %-22s %8.3f ms/frame\n", r.move, r.stage, r.ms);
+    }
+    FILE* file = fopen(resultPath, "a");
+    if(!file) {
+        printf("[gui transform bench] can not open %s\n", resultPath);
+        return 1;
+    }
+    fseek(file, 0, SEEK_END);
+    if(ftell(file) == 0) {
+        fprintf(file, "nodes,items,depth,fanout,frames,move,stage,ms_per_frame\n");
+    }
+    for(auto const& r: results) {
+        fprintf(file, "%u,%u,%u,%u,%u,%s,%s,%.4f\n", tree.nodeCount, tree.itemCount, depth, fanout, frames, r.move, r.stage, r.ms);
+    }
+    fclose(file);
+    printf("results        : appended to %s\n", resultPath);
+    return 0;
+}
@@ -0,0 +1,152 @@
+/*
+ *  pipeline_state_bench [binds] [variants]
+ *  不需要 device：用假的 VkPipeline 句柄模拟 GraphicsPipeline::bind 里找 pipeline 的那一段
+ *  旧：每次 bind 用 UGIHash<APHash> 哈希 raster state + subpass hash，再查 unordered_map
+ *  新：raster state 的 key 在 setRasterizationState 时打包一次，bind 只填 subpassHash，
+ *      和上一次比较，不同才去 PipelineStateTable 探测一次
+ *  vkCmdBindPipeline 本身不计入
+ * */
+#include <pipeline_state_table.h>
+#include <ugi_utility.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+    struct variant_t {
+        VkPipelineRasterizationStateCreateInfo  rasterState;
+        uint64_t                                subpassHash;
+    };
+
+    VkPipeline fakePipeline(uint32_t index) {
+        return reinterpret_cast<VkPipeline>((uintptr_t)(index + 1) * 16);
+    }
+
+    // 旧的 bind 路径
+    class HashedLookup {
+    private:
+        std::unordered_map<uint64_t, VkPipeline> _table;
+    public:
+        static uint64_t hashState(variant_t const& v) {
+            ugi::UGIHash<ugi::APHash> hasher;
+            auto const& rs = v.rasterState;
+            hasher.hashPOD(rs.polygonMode);
+            hasher.hashPOD(rs.cullMode);
+            hasher.hashPOD(rs.frontFace);
+            hasher.hashPOD(rs.depthClampEnable);
+            hasher.hashPOD(rs.depthBiasEnable);
+            if(rs.depthBiasEnable) {
+                hasher.hashPOD(rs.depthBiasConstantFactor);
+                hasher.hashPOD(rs.depthBiasClamp);
+                hasher.hashPOD(rs.depthBiasSlopeFactor);
+            }
+            hasher.hashPOD(v.subpassHash);
+            return hasher;
+        }
+        void insert(variant_t const& v, VkPipeline pipeline) {
+            _table[hashState(v)] = pipeline;
+        }
+        VkPipeline bind(variant_t const& v) {
+            auto iter = _table.find(hashState(v));
+            return iter != _table.end() ? iter->second : VK_NULL_HANDLE;
+        }
+    };
+
+    // 新的 bind 路径，和 GraphicsPipeline::setRasterizationState / resolvePipeline 一致
+    class KeyedLookup {
+    private:
+        ugi::PipelineStateTable     _table;
+        ugi::pipeline_state_key_t   _rasterKey = {};
+        ugi::pipeline_state_key_t   _lastKey = {};
+        VkPipeline                  _lastPipeline = VK_NULL_HANDLE;
+        variant_t const*            _rasterVariant = nullptr;    // 当前 raster state 来自哪个变体
+    public:
+        void setRasterizationState(VkPipelineRasterizationStateCreateInfo const& rs) {
+            _rasterKey.setRasterState(rs);
+        }
+        void insert(variant_t const& v, VkPipeline pipeline) {
+            ugi::pipeline_state_key_t key;
+            key.setRasterState(v.rasterState);
+            key.subpassHash = v.subpassHash;
+            _table.insert(key, pipeline);
+        }
+        VkPipeline bind(variant_t const& v) {
+            if(_rasterVariant != &v) { // 调用方只在状态变了的时候 set 一次
+                setRasterizationState(v.rasterState);
+                _rasterVariant = &v;
+            }
+            auto key = _rasterKey;
+            key.subpassHash = v.subpassHash;
+            if(_lastPipeline && key == _lastKey) {
+                return _lastPipeline;
+            }
+            VkPipeline pipeline = _table.find(key);
+            if(pipeline) {
+                _lastKey = key;
+                _lastPipeline = pipeline;
+            }
+            return pipeline;
+        }
+    };
+
+    template<class Lookup>
+    double bindsPerSecond(Lookup& lookup, std::vector<variant_t> const& variants, std::vector<uint32_t> const& sequence, uint32_t binds, uintptr_t& sink) {
+        auto start = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i<binds; ++i) {
+            sink += (uintptr_t)lookup.bind(variants[sequence[i % sequence.size()]]);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return binds / seconds;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    uint32_t const binds = argc > 1 ? (uint32_t)atoi(argv[1]) : 20000000;
+    uint32_t const variantCount = argc > 2 ? (uint32_t)atoi(argv[2]) : 8;
+    if(!binds || !variantCount) {
+        printf("usage: %s [binds=20000000] [variants=8]\n", argv[0]);
+        return 1;
+    }
+    // 变体：cull mode / depth bias / subpass 组合
+    std::vector<variant_t> variants(variantCount);
+    for(uint32_t i = 0; i<variantCount; ++i) {
+        VkPipelineRasterizationStateCreateInfo rs = {};
+        rs.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rs.polygonMode = VK_POLYGON_MODE_FILL;
+        rs.cullMode = (VkCullModeFlags)(i & 0x3);
+        rs.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        rs.depthBiasEnable = (i >> 2) & 1;
+        rs.depthBiasConstantFactor = rs.depthBiasEnable ? 1.25f : 0.0f;
+        rs.depthBiasSlopeFactor = rs.depthBiasEnable ? 1.75f : 0.0f;
+        rs.lineWidth = 1.0f;
+        variants[i] = { rs, 0x51F15EEDull + (i >> 3) };
+    }
+    HashedLookup hashed;
+    KeyedLookup keyed;
+    for(uint32_t i = 0; i<variantCount; ++i) {
+        hashed.insert(variants[i], fakePipeline(i));
+        keyed.insert(variants[i], fakePipeline(i));
+    }
+    // 1. 同一个 pipeline 反复 bind（UI 批次的常见情况）
+    std::vector<uint32_t> same = { 0 };
+    // 2. 每次 bind 都切换到另一个已知变体
+    std::vector<uint32_t> alternate;
+    for(uint32_t i = 0; i<variantCount; ++i) {
+        alternate.push_back(i);
+    }
+    uintptr_t sink = 0;
+    double const hashedSame = bindsPerSecond(hashed, variants, same, binds, sink);
+    double const keyedSame = bindsPerSecond(keyed, variants, same, binds, sink);
+    double const hashedSwitch = bindsPerSecond(hashed, variants, alternate, binds, sink);
+    double const keyedSwitch = bindsPerSecond(keyed, variants, alternate, binds, sink);
+    printf("binds          : %u, variants : %u\n", binds, variantCount);
+    printf("rebind same    : aphash + map %8.1f M/s, key + table %8.1f M/s\n", hashedSame / 1e6, keyedSame / 1e6);
+    printf("switch variant : aphash + map %8.1f M/s, key + table %8.1f M/s\n", hashedSwitch / 1e6, keyedSwitch / 1e6);
+    printf("checksum       : %llu\n", (unsigned long long)sink); // 防止查找被优化掉
+    return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ *  tween_bench [tweens] [frames]
+ *  同时跑几千个 Tween（float/vec2/vec4，几种 ease 轮着用，时长足够长不会中途结束），对比 TweenManager::update：
+ *  旧：每个 Tween 都走 Tweener::_update，逐个推进时间、算 ease、插值
+ *  新：快速路径，时间/ease/起止值都在 SoA lanes 上算，没有回调的不经过 Tweener
+ *  三分之一的 Tween 挂 update 回调，顺便算校验和，两种路径的结果应该一致
+ * */
+#include <core/data_types/tween_manager.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace gui;
+
+namespace {
+
+    constexpr float FrameTime = 1.0f / 60.0f;
+    constexpr uint32_t WarmupFrames = 4;
+
+    EaseType const Eases[] = {
+        EaseType::Linear, EaseType::QuadOut, EaseType::CubicInOut, EaseType::SineOut, EaseType::BackOut, EaseType::ElasticOut,
+    };
+
+    struct result_t {
+        double      msPerFrame;
+        double      checksum;
+    };
+
+    result_t run(uint32_t tweens, uint32_t frames, bool fastPath) {
+        auto* manager = TweenManager::Instance();
+        manager->setFastPath(fastPath);
+        double checksum = 0;
+        for (uint32_t i = 0; i < tweens; ++i) {
+            float const duration = 1000.0f + (float)(i & 15);
+            Tweener* t;
+            switch (i % 3) {
+            case 0: t = GTween::To((float)i, (float)i + 100.0f, duration); break;
+            case 1: t = GTween::To(glm::vec2((float)i, 0.0f), glm::vec2(0.0f, (float)i), duration); break;
+            default: t = GTween::To(glm::vec4(0.0f), glm::vec4(1.0f, 2.0f, 3.0f, 4.0f), duration); break;
+            }
+            t->setEase(Eases[i % (sizeof(Eases) / sizeof(Eases[0]))]);
+            if (i % 3 == 2) {
+                t->setUpdateCallback([&checksum](Tweener* tweener) {
+                    checksum += tweener->val.val.x + tweener->val.val.w;
+                });
+            }
+        }
+        // 第一帧走完整的 update 才会判定能不能走快速路径
+        for (uint32_t frame = 0; frame < WarmupFrames; ++frame) {
+            manager->update(FrameTime);
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t frame = 0; frame < frames; ++frame) {
+            manager->update(FrameTime);
+        }
+        double const ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        // 下一轮从空的活跃列表开始
+        manager->setFastPath(true);
+        while (manager->activeCount()) {
+            manager->update(2000.0f);
+        }
+        return { ms / frames, checksum };
+    }
+
+}
+
+int main(int argc, char** argv) {
+    uint32_t const tweens = argc > 1 ? (uint32_t)atoi(argv[1]) : 5000;
+    uint32_t const frames = argc > 2 ? (uint32_t)atoi(argv[2]) : 600;
+    if (!tweens || !frames) {
+        printf("usage: %s [tweens=5000] [frames=600]\n", argv[0]);
+        return 1;
+    }
+    result_t const legacy = run(tweens, frames, false);
+    result_t const lanes = run(tweens, frames, true);
+    TweenManager::Instance()->clean();
+
+    printf("tweens         : %u (1/3 with update callback), frames %u\n", tweens, frames);
+    printf("per tweener    : %8.3f ms/frame, checksum %.3f\n", legacy.msPerFrame, legacy.checksum);
+    printf("soa lanes      : %8.3f ms/frame, checksum %.3f\n", lanes.msPerFrame, lanes.checksum);
+    return 0;
+}
@@ -65,13 +65,11 @@ namespace ugi {
 
         auto device = _renderContext->device();
         _render = gui::UIImageRender::Instance();
-        _render->initialize(device, arch, bufferAllocator, _renderContext->uniformAllocator(), _renderContext->asyncLoadManager());
+        _render->initialize(device, arch, bufferAllocator, _renderContext->uniformAllocator(), _renderContext->asyncLoadManager(), "fgui_image", _renderContext->storageAllocator());
 
         // Text SDF pipeline
         {
-            auto textPipelineFile = arch->openIStream("/shaders/fgui_text/pipeline.bin", {comm::ReadFlag::binary});
-            PipelineHelper textPpl = PipelineHelper::FromIStream(textPipelineFile);
-            textPipelineFile->close();
+            PipelineHelper textPpl = gui::LoadItemPipeline(device, arch, {"fgui_text"}); // 有 ssbo 版本优先用
             auto textDesc = textPpl.desc();
             textDesc.topologyMode = topology_mode_t::TriangleList;
             textDesc.renderState.cullMode = cull_mode_t::None;
@@ -82,8 +80,12 @@ namespace ugi {
             auto textBufferAllocator = new MeshBufferAllocator();
             textBufferAllocator->initialize(device, 1024);
             gui::TextSDFRender::Instance()->initialize(device, textPipeline,
-                textBufferAllocator, _renderContext->uniformAllocator(), _renderContext->asyncLoadManager());
+                textBufferAllocator, _renderContext->uniformAllocator(), _renderContext->asyncLoadManager(), _renderContext->storageAllocator());
         }
+        // UI batch 分段并行录制到 secondary command buffer
+        gui::InitializeParallelRecording(device, _renderContext->primaryQueue());
+        // 大量 item 同时变脏（切界面）时 mesh 分到工作线程生成
+        gui::InitializeMeshWorkers();
 
         // FontManager 初始化 + 加载字体
         {
@@ -163,7 +165,14 @@ namespace ugi {
 
             gui::GuiTick();
 
-            auto renderEnc = cmdbuf->renderCommandEncoder(mainRenderPass); {
+            auto resEnc = cmdbuf->resourceCommandEncoder(); {
+                _render->compactMeshBuffer(resEnc);
+                gui::TextSDFRender::Instance()->compactMeshBuffer(resEnc);
+                gui::FlushRenderBatchPatches(resEnc);
+            }
+            resEnc->endEncode();
+
+            auto renderEnc = cmdbuf->renderCommandEncoder(mainRenderPass, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS); {
                 static ugi::raster_state_t rasterizationState;
                 rasterizationState.polygonMode = polygon_mode_t::Fill;
                 renderEnc->setLineWidth(1.0f);
@@ -174,7 +183,7 @@ namespace ugi {
                 // _render->drawBatch(_imageBatches, renderEnc);
                 //
                 gui::SetVPMat(gui::FairyGUIContext::Instance()->vp());
-                gui::DrawRenderBatches(renderEnc);
+                gui::DrawRenderBatchesParallel(renderEnc);
             }
             renderEnc->endEncode();
         }
@@ -218,6 +227,11 @@ namespace ugi {
 
     void FGUIDemo::release() {
         gui::DebugServer::Instance().stop();
+        gui::Package::ReleasePackageModule(); // 先停加载线程
+        _renderContext->release();
+        gui::DestroyParallelRecording(); // device idle 之后才能释放 secondary command buffer
+        gui::DestroyMeshWorkers();
+        gui::ReleaseRenderPools(); // retire 回调在 render context release 里都执行完了
     }
 
     const char * FGUIDemo::title() {
@@ -428,6 +428,7 @@ namespace ugi {
         UniformBuffer           = 4,
         UniformTexelBuffer      = 5,
         InputAttachment         = 6,
+        DynamicStorageBuffer    = 7,
     };
 
     struct ArgumentDescriptorInfo {
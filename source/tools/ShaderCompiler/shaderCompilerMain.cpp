@@ -108,6 +108,7 @@ static bool RunSlangC(const std::string& sourceFile,
 // Slang 编译入口: 自动发现依赖 → 先编库 → 再编主 shader
 static bool CompileSlangShader(const std::string& mainFile,
                                const std::vector<std::string>& importPaths,
+                               const std::vector<std::string>& defines,
                                const std::string& entryPoint,
                                const std::string& profile,
                                std::vector<uint32_t>& outSpv)
@@ -153,6 +154,7 @@ static bool CompileSlangShader(const std::string& mainFile,
             std::ostringstream cmd;
             cmd << SLANGC_PATH " \"" << found << "\" -target none -o \"" << found << ".slang-module\"";
             for (auto& p : importPaths) cmd << " -I \"" << p << "\"";
+            for (auto& d : defines) cmd << " -D" << d;
             cmd << " 2>&1";
             printf("  [slangc:lib] %s\n", cmd.str().c_str());
             int ret = system(cmd.str().c_str());
@@ -173,6 +175,7 @@ static bool CompileSlangShader(const std::string& mainFile,
     std::ostringstream cmd;
     cmd << SLANGC_PATH " \"" << mainFile << "\"";
     for (auto& p : importPaths) cmd << " -I \"" << p << "\"";
+    for (auto& d : defines) cmd << " -D" << d;
     cmd << " -target spirv";
     if (!profile.empty()) cmd << " -profile " << profile;
     cmd << " -entry " << entryPoint;
@@ -447,6 +450,28 @@ int main( int argc, char** argv ) {
         slangProfile = js["slangProfile"].get<std::string>();
     }
 
+    // ---- 读取 defines (可选) ----
+    //   同一份 shader 源码编不同的变体，比如 "defines": ["FGUI_INSTANCE_SSBO"] 或 ["NAME=VALUE"]
+    std::vector<std::string> defines;
+    if (js.contains("defines") && js["defines"].is_array()) {
+        for (auto& d : js["defines"]) {
+            if (d.is_string()) {
+                defines.push_back(d.get<std::string>());
+            }
+        }
+    }
+
+    // ---- 读取 dynamicStorageBuffers (可选) ----
+    //   按名字指定哪些 storage buffer 用 dynamic offset 绑定（每帧从 UniformAllocator 分配），比如 ["args"]
+    std::set<std::string> dynamicStorageBuffers;
+    if (js.contains("dynamicStorageBuffers") && js["dynamicStorageBuffers"].is_array()) {
+        for (auto& name : js["dynamicStorageBuffers"]) {
+            if (name.is_string()) {
+                dynamicStorageBuffers.insert(name.get<std::string>());
+            }
+        }
+    }
+
     std::set<uint32_t> slangCompiledStages;  // 记录哪些 stage 走的是 Slang 路径
 
     std::string shaderFile;
@@ -489,7 +514,7 @@ int main( int argc, char** argv ) {
                     allImportPaths.push_back(shaderDir);
 
                     std::vector<uint32_t> compiledSPV;
-                    bool ok = CompileSlangShader(fullPath, allImportPaths, entryPoint, slangProfile, compiledSPV);
+                    bool ok = CompileSlangShader(fullPath, allImportPaths, defines, entryPoint, slangProfile, compiledSPV);
                     if (!ok) {
                         printf("[FAIL] Slang compile: %s\n", shaderFile.c_str());
                         return -1;
@@ -556,6 +581,15 @@ int main( int argc, char** argv ) {
         }
     }
 
+    // ---- dynamic storage buffer ----
+    for (uint32_t i = 0; i < ugi::MaxArgumentCount; ++i) {
+        for (auto& d : pipelineDescription.argumentLayouts[i].descriptors) {
+            if (d.binding != 0xff && d.type == ugi::ArgumentDescriptorType::StorageBuffer && dynamicStorageBuffers.count(d.name)) {
+                d.type = ugi::ArgumentDescriptorType::DynamicStorageBuffer;
+            }
+        }
+    }
+
     // ---- 汇总: 打印最终 argumentLayouts ----
     printf("=== Final argumentLayouts ===\n");
     for (uint32_t i = 0; i < ugi::MaxArgumentCount; ++i) {
@@ -565,10 +599,10 @@ int main( int argc, char** argv ) {
             for (uint32_t j = 0; j < ugi::MaxDescriptorCount; ++j) {
                 auto& d = layout.descriptors[j];
                 if (d.binding != 0xff) {
-                    const char* typeNames[] = {"Sampler","Image","StorageImage","StorageBuffer","UniformBuffer","UniformTexelBuffer","InputAttachment"};
+                    const char* typeNames[] = {"Sampler","Image","StorageImage","StorageBuffer","UniformBuffer","UniformTexelBuffer","InputAttachment","DynamicStorageBuffer"};
                     printf("    binding=%u  type=%s  name='%s'  dataSize=%u\n",
                         (unsigned)d.binding,
-                        (unsigned)d.type < 7 ? typeNames[(unsigned)d.type] : "???",
+                        (unsigned)d.type < 8 ? typeNames[(unsigned)d.type] : "???",
                         d.name, (unsigned)d.dataSize);
                 }
             }
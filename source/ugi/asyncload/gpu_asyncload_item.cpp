@@ -15,6 +15,9 @@ namespace ugi {
             }
             return rst;
         }
+        if(queue_) {
+            return queue_->completedTimelineValue() >= timelineValue_;
+        }
         return true;
     }
 
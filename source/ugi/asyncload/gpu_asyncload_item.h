@@ -2,6 +2,7 @@
 #include <ugi_types.h>
 #include <vector>
 #include <functional>
+#include <cstdint>
 
 namespace ugi {
 
@@ -11,15 +12,32 @@ namespace ugi {
     protected:
         Device* device_;
         Fence* fence_;
+        CommandQueue* queue_;           ///> 走 timeline 时提交的队列，fence_ 为空
+        uint64_t timelineValue_;        ///> 队列的 timeline 到达这个值即完成
         std::function<void(CommandBuffer*)> onComplete_;
     public:
         GPUAsyncLoadItem(Device* device, Fence* fence, std::function<void(CommandBuffer*)>&& onComplete) 
             : device_(device)
             , fence_(fence)
+            , queue_(nullptr)
+            , timelineValue_(0)
             , onComplete_(std::move(onComplete))
         {}
+        GPUAsyncLoadItem(Device* device, CommandQueue* queue, uint64_t timelineValue, std::function<void(CommandBuffer*)>&& onComplete)
+            : device_(device)
+            , fence_(nullptr)
+            , queue_(queue)
+            , timelineValue_(timelineValue)
+            , onComplete_(std::move(onComplete))
+        {}
+        CommandQueue* timelineQueue() const {
+            return queue_;
+        }
+        uint64_t timelineValue() const {
+            return timelineValue_;
+        }
         bool isComplete();
         void onLoadComplete(CommandBuffer* cb);
     };
 
-}
\ No newline at end of file
+}
@@ -1,33 +1,147 @@
 #include "gpu_asyncload_manager.h"
 #include "gpu_asyncload_item.h"
+#include "staging_upload_ring.h"
+#include <device.h>
+#include <semaphore.h>
+#include <command_queue.h>
+#include <algorithm>
+#include <cassert>
 
 namespace ugi {
 
-    void GPUAsyncLoadManager::tick(CommandBuffer* cb) {
-        std::unique_lock<std::mutex> lock(mutex_[workindex_]);
-        for(auto iter = worklist_[workindex_].begin(); iter != worklist_[workindex_].end(); ++iter) {
-            auto& item = *iter;
-            if(item.isComplete()) {
-                item.onLoadComplete(cb);
+    void GPUAsyncLoadManager::collectPending_() {
+        pending_node_t* node = pendingHead_.exchange(nullptr, std::memory_order_acquire);
+        // 栈是后进先出，翻转回登记顺序
+        pending_node_t* ordered = nullptr;
+        while(node) {
+            pending_node_t* next = node->next;
+            node->next = ordered;
+            ordered = node;
+            node = next;
+        }
+        while(ordered) {
+            pending_node_t* next = ordered->next;
+            if(ordered->item.timelineQueue()) {
+                insertTimelineItem_(std::move(ordered->item));
             } else {
-                workSwapbuffer_.push_back(item);
+                fenceItems_.push_back(std::move(ordered->item));
             }
+            delete ordered;
+            ordered = next;
         }
-        worklist_[workindex_].swap(workSwapbuffer_);
-        workSwapbuffer_.clear();
-        workindex_ = workindex_^0x1;
     }
 
-    void GPUAsyncLoadManager::registerAsyncLoad(GPUAsyncLoadItem&& item) {
-        unsigned int index = 0;
-        while(true) {
-            if(mutex_[index].try_lock()) {
-                worklist_[index].push_back(std::move(item));
-                mutex_[index].unlock();
+    void GPUAsyncLoadManager::insertTimelineItem_(GPUAsyncLoadItem&& item) {
+        CommandQueue* queue = item.timelineQueue();
+        timeline_list_t* list = nullptr;
+        for(auto& timeline: timelines_) { // 队列就一两个，线性找
+            if(timeline.queue == queue) {
+                list = &timeline;
                 break;
-            } else {
-                index = index ^ 0x1;
             }
         }
+        if(!list) {
+            timelines_.push_back({ queue, {} });
+            list = &timelines_.back();
+        }
+        auto& items = list->items;
+        // 多线程提交时登记顺序和 timeline 值的顺序可能不一致，基本都是追加到尾部
+        if(items.empty() || items.back().timelineValue() <= item.timelineValue()) {
+            items.push_back(std::move(item));
+        } else {
+            auto pos = std::upper_bound(items.begin(), items.end(), item.timelineValue(), [](uint64_t value, GPUAsyncLoadItem const& other) {
+                return value < other.timelineValue();
+            });
+            items.insert(pos, std::move(item));
+        }
+    }
+
+    void GPUAsyncLoadManager::tick(CommandBuffer* cb) {
+        collectPending_();
+        for(auto& timeline: timelines_) {
+            auto& items = timeline.items;
+            if(items.empty()) {
+                continue;
+            }
+            uint64_t completed = timeline.queue->completedTimelineValue();
+            while(!items.empty() && items.front().timelineValue() <= completed) {
+                items.front().onLoadComplete(cb);
+                items.pop_front();
+            }
+        }
+        if(fenceItems_.size()) {
+            for(auto& item: fenceItems_) {
+                if(item.isComplete()) {
+                    item.onLoadComplete(cb);
+                } else {
+                    workSwapbuffer_.push_back(std::move(item));
+                }
+            }
+            fenceItems_.swap(workSwapbuffer_);
+            workSwapbuffer_.clear();
+        }
+    }
+
+    bool GPUAsyncLoadManager::submitAsyncLoad(Device* device, CommandQueue* queue, CommandBuffer* cb, std::function<void(CommandBuffer*)>&& onComplete) {
+        QueueSubmitInfo submitInfo(&cb, 1, nullptr, 0, nullptr, 0);
+        if(queue->timelineSupported()) {
+            QueueSubmitBatchInfo submitBatch(&submitInfo, 1, nullptr);
+            uint64_t value = queue->submitCommandBuffersTracked(submitBatch);
+            if(!value) {
+                return false;
+            }
+            registerAsyncLoad(GPUAsyncLoadItem(device, queue, value, std::move(onComplete)));
+            return true;
+        }
+        auto fence = device->createFence();
+        if(!fence) {
+            return false;
+        }
+        QueueSubmitBatchInfo submitBatch(&submitInfo, 1, fence);
+        if(!queue->submitCommandBuffers(submitBatch)) {
+            device->destroyFence(fence);
+            return false;
+        }
+        registerAsyncLoad(GPUAsyncLoadItem(device, fence, std::move(onComplete)));
+        return true;
+    }
+
+    bool GPUAsyncLoadManager::initializeUploadRing(Device* device, CommandQueue* queue, uint32_t ringSize) {
+        if(uploadRing_) {
+            return false;
+        }
+        auto ring = new StagingUploadRing();
+        if(!ring->initialize(device, queue, this, ringSize)) {
+            ring->destroy();
+            delete ring;
+            return false;
+        }
+        uploadRing_ = ring;
+        return true;
+    }
+
+    void GPUAsyncLoadManager::flushUploads() {
+        if(uploadRing_) {
+            uploadRing_->flush();
+        }
+    }
+
+    void GPUAsyncLoadManager::destroy(CommandBuffer* cb) {
+        // 设备已经空闲，所有提交过的 item 都能完成，回调归还 staging buffer 和 ring 空间
+        tick(cb);
+        assert(fenceItems_.empty());
+        if(uploadRing_) {
+            uploadRing_->destroy();
+            delete uploadRing_;
+            uploadRing_ = nullptr;
+        }
+    }
+
+    void GPUAsyncLoadManager::registerAsyncLoad(GPUAsyncLoadItem&& item) {
+        pending_node_t* node = new pending_node_t{ std::move(item), nullptr };
+        pending_node_t* head = pendingHead_.load(std::memory_order_relaxed);
+        do {
+            node->next = head;
+        } while(!pendingHead_.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
     }
-}
\ No newline at end of file
+}
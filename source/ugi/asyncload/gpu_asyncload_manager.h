@@ -1,27 +1,58 @@
 #pragma once
 #include <vector>
-#include <mutex>
+#include <deque>
 #include <atomic>
+#include <functional>
 #include <ugi_declare.h>
 #include <asyncload/gpu_asyncload_item.h>
 
 namespace ugi {
 
+    /*
+     *  异步加载完成检测
+     *  1. 支持 timeline semaphore 时每个队列一个 timeline，提交时 signal 单调递增的值，不再为每次上传创建 fence
+     *     tick 时每个队列只查询一次 counter，按值排好序的队列从头部退休，开销只和完成的数量有关
+     *  2. 不支持时退回到原来的 fence 轮询
+     *  registerAsyncLoad 可以在任意线程调用（无锁的 MPSC 链表），tick 在渲染线程调用
+     * */
     class GPUAsyncLoadManager {
     private:
-        std::vector<GPUAsyncLoadItem>       worklist_[2];
+        struct pending_node_t {
+            GPUAsyncLoadItem    item;
+            pending_node_t*     next;
+        };
+        struct timeline_list_t {
+            CommandQueue*                   queue;
+            std::deque<GPUAsyncLoadItem>    items;      ///> 按 timeline 值升序
+        };
+        std::atomic<pending_node_t*>        pendingHead_;   ///> 生产者 CAS 压栈，tick 一次性全部取走
+        std::vector<timeline_list_t>        timelines_;
+        std::vector<GPUAsyncLoadItem>       fenceItems_;
         std::vector<GPUAsyncLoadItem>       workSwapbuffer_;
-        std::mutex                          mutex_[2];
-        std::atomic<unsigned int>           workindex_;
+        StagingUploadRing*                  uploadRing_;
+    private:
+        void collectPending_();
+        void insertTimelineItem_(GPUAsyncLoadItem&& item);
     public:
         GPUAsyncLoadManager()
-            : worklist_{}
+            : pendingHead_(nullptr)
+            , timelines_{}
+            , fenceItems_{}
             , workSwapbuffer_{}
-            , mutex_{}
-            , workindex_(0)
+            , uploadRing_(nullptr)
         {}
         void tick(CommandBuffer* cb);
         void registerAsyncLoad(GPUAsyncLoadItem&& item);
+        // 提交 cb 并登记完成回调，队列支持 timeline 时不创建 fence
+        bool submitAsyncLoad(Device* device, CommandQueue* queue, CommandBuffer* cb, std::function<void(CommandBuffer*)>&& onComplete);
+        // 小块的 buffer 上传走 staging ring 合批，没有初始化时调用方走原来的单独提交
+        bool initializeUploadRing(Device* device, CommandQueue* queue, uint32_t ringSize = 4 * 1024 * 1024);
+        StagingUploadRing* uploadRing() const {
+            return uploadRing_;
+        }
+        void flushUploads(); // 一帧一次，把这一帧的上传一次提交
+        // 设备空闲之后调用：cb 用来执行剩下的完成回调，然后销毁 staging ring
+        void destroy(CommandBuffer* cb);
     };
 
-}
\ No newline at end of file
+}
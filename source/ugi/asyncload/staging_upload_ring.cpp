@@ -0,0 +1,196 @@
+#include "staging_upload_ring.h"
+#include "gpu_asyncload_manager.h"
+#include "gpu_asyncload_item.h"
+#include <device.h>
+#include <buffer.h>
+#include <command_queue.h>
+#include <command_buffer.h>
+#include <algorithm>
+#include <iterator>
+#include <cstring>
+#include <cassert>
+#include <cstdio>
+
+namespace ugi {
+
+    StagingUploadRing::StagingUploadRing()
+        : device_(nullptr)
+        , queue_(nullptr)
+        , manager_(nullptr)
+        , ringBuffer_(nullptr)
+        , ringPtr_(nullptr)
+        , ringSize_(0)
+        , head_(0)
+        , usedBytes_(0)
+        , recording_{}
+        , mutex_()
+        , uploads_(0)
+        , submits_(0)
+        , overflowUploads_(0)
+    {}
+
+    bool StagingUploadRing::initialize(Device* device, CommandQueue* queue, GPUAsyncLoadManager* manager, uint32_t ringSize) {
+        device_ = device;
+        queue_ = queue;
+        manager_ = manager;
+        ringSize_ = (ringSize + Alignment - 1) & ~(Alignment - 1);
+        ringBuffer_ = device->createBuffer(BufferType::StagingBuffer, ringSize_);
+        if(!ringBuffer_) {
+            return false;
+        }
+        ringPtr_ = (uint8_t*)ringBuffer_->map(device); // 常驻映射，销毁时 release 会 unmap
+        head_ = 0;
+        usedBytes_ = 0;
+        recording_.ringSpan = 0;
+        return ringPtr_ != nullptr;
+    }
+
+    bool StagingUploadRing::allocRing_(uint32_t size, uint32_t& offset) {
+        uint32_t waste = 0;
+        if(head_ + size > ringSize_) { // 尾部放不下，回绕到开头，尾部剩下的算作浪费
+            waste = ringSize_ - head_;
+        }
+        if(usedBytes_ + waste + size > ringSize_) {
+            return false;
+        }
+        offset = waste ? 0 : head_;
+        head_ = offset + size;
+        if(head_ == ringSize_) {
+            head_ = 0;
+        }
+        usedBytes_ += waste + size;
+        recording_.ringSpan += waste + size;
+        return true;
+    }
+
+    bool StagingUploadRing::upload(VkBuffer dst, uint32_t dstOffset, upload_piece_t const* pieces, uint32_t pieceCount, std::function<void(CommandBuffer*)>&& onComplete) {
+        uint32_t size = 0;
+        for(uint32_t i = 0; i<pieceCount; ++i) {
+            size += pieces[i].size;
+        }
+        uint32_t alignedSize = (size + Alignment - 1) & ~(Alignment - 1);
+        std::unique_lock<std::mutex> lock(mutex_);
+        copy_t copy = {};
+        copy.dst = dst;
+        copy.dstOffset = dstOffset;
+        copy.size = size;
+        uint8_t* ptr = nullptr;
+        uint32_t offset = 0;
+        if(allocRing_(alignedSize, offset)) {
+            copy.src = nullptr;
+            copy.srcOffset = offset;
+            ptr = ringPtr_ + offset;
+        } else { // ring 满了（或者数据太大），单独一个 staging buffer
+            Buffer* staging = device_->createBuffer(BufferType::StagingBuffer, size);
+            if(!staging) {
+                return false;
+            }
+            ptr = (uint8_t*)staging->map(device_);
+            copy.src = staging;
+            copy.srcOffset = 0;
+            recording_.overflowBuffers.push_back(staging);
+            ++overflowUploads_;
+        }
+        for(uint32_t i = 0; i<pieceCount; ++i) {
+            memcpy(ptr, pieces[i].data, pieces[i].size);
+            ptr += pieces[i].size;
+        }
+        recording_.copies.push_back(copy);
+        recording_.callbacks.push_back(std::move(onComplete));
+        ++uploads_;
+        return true;
+    }
+
+    void StagingUploadRing::flush() {
+        batch_t batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if(recording_.copies.empty()) {
+                return;
+            }
+            batch = std::move(recording_);
+            recording_ = {};
+            recording_.ringSpan = 0;
+            ++submits_;
+        }
+        // 同一对 src/dst 的 copy 合成一个 region list
+        std::sort(batch.copies.begin(), batch.copies.end(), [](copy_t const& a, copy_t const& b) {
+            if(a.src != b.src) {
+                return a.src < b.src;
+            }
+            return a.dst < b.dst;
+        });
+        auto cb = queue_->createCommandBuffer(device_, CmdbufType::Transient);
+        cb->beginEncode(); {
+            auto encoder = cb->resourceCommandEncoder();
+            std::vector<VkBufferCopy> regions;
+            for(size_t i = 0; i<batch.copies.size();) {
+                auto const& first = batch.copies[i];
+                regions.clear();
+                size_t j = i;
+                for(; j<batch.copies.size() && batch.copies[j].src == first.src && batch.copies[j].dst == first.dst; ++j) {
+                    regions.push_back({ batch.copies[j].srcOffset, batch.copies[j].dstOffset, batch.copies[j].size });
+                }
+                VkBuffer src = first.src ? first.src->buffer() : ringBuffer_->buffer();
+                encoder->copyBufferRegions(first.dst, src, regions.data(), (uint32_t)regions.size());
+                i = j;
+            }
+            encoder->endEncode();
+        }
+        cb->endEncode();
+        auto releaseBatch = [this, cb](batch_t const& batch) {
+            queue_->destroyCommandBuffer(device_, cb);
+            for(auto buffer: batch.overflowBuffers) {
+                buffer->unmap(device_);
+                device_->destroyBuffer(buffer);
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            usedBytes_ -= batch.ringSpan; // 同一个队列上按提交顺序完成，直接归还
+        };
+        auto onComplete = [releaseBatch, batch](CommandBuffer* logicCB) {
+            releaseBatch(batch);
+            for(auto const& callback: batch.callbacks) {
+                callback(logicCB);
+            }
+        };
+        if(!manager_->submitAsyncLoad(device_, queue_, cb, onComplete)) {
+            // 提交失败，只归还 cb，这一批放回录制中的 batch 下一次 flush 重新提交
+            // ring 空间和 overflow buffer 继续占着，回调等真正传输完成再调用
+            printf("[staging upload] submit failed, %u copies requeued\n", (uint32_t)batch.copies.size());
+            queue_->destroyCommandBuffer(device_, cb);
+            std::unique_lock<std::mutex> lock(mutex_);
+            recording_.copies.insert(recording_.copies.begin(), batch.copies.begin(), batch.copies.end());
+            recording_.callbacks.insert(recording_.callbacks.begin(), std::make_move_iterator(batch.callbacks.begin()), std::make_move_iterator(batch.callbacks.end()));
+            recording_.overflowBuffers.insert(recording_.overflowBuffers.end(), batch.overflowBuffers.begin(), batch.overflowBuffers.end());
+            recording_.ringSpan += batch.ringSpan;
+            --submits_;
+        }
+    }
+
+    staging_upload_stat_t StagingUploadRing::stat() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        staging_upload_stat_t rst; {
+            rst.uploads = uploads_;
+            rst.submits = submits_;
+            rst.overflowUploads = overflowUploads_;
+            rst.ringUsedBytes = usedBytes_;
+        }
+        return rst;
+    }
+
+    void StagingUploadRing::destroy() {
+        // 还没 flush 的上传直接丢掉，回调不再调用
+        for(auto buffer: recording_.overflowBuffers) {
+            buffer->unmap(device_);
+            device_->destroyBuffer(buffer);
+        }
+        recording_ = {};
+        recording_.ringSpan = 0;
+        if(ringBuffer_) {
+            device_->destroyBuffer(ringBuffer_);
+            ringBuffer_ = nullptr;
+            ringPtr_ = nullptr;
+        }
+    }
+
+}
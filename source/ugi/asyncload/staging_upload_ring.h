@@ -0,0 +1,75 @@
+#pragma once
+#include <ugi_declare.h>
+#include <vulkan_declare.h>
+#include <vector>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+
+namespace ugi {
+
+    struct upload_piece_t {
+        void const*     data;
+        uint32_t        size;
+    };
+
+    struct staging_upload_stat_t {
+        uint64_t    uploads;            ///> 累计 upload 次数
+        uint64_t    submits;            ///> 累计提交次数（每次 flush 一次）
+        uint64_t    overflowUploads;    ///> ring 放不下，单独创建 staging buffer 的次数
+        uint32_t    ringUsedBytes;      ///> 正在录制/传输中的 ring 字节数
+    };
+
+    /*
+     *  常驻的 staging ring
+     *  1. upload 把数据拷到 ring 里并记录一个 buffer copy，不提交
+     *  2. flush 把期间所有的 copy 按目标 buffer 合并成若干个 region list，一个 command buffer 提交到传输队列
+     *  3. 传输完成之后（GPUAsyncLoadManager tick 时）回调所有 upload 的完成函数，并归还 ring 空间
+     *  ring 放不下的数据单独创建 staging buffer，跟随这一批一起提交、一起释放
+     *  upload 可以在任意线程调用，flush 在渲染线程调用
+     * */
+    class StagingUploadRing {
+    public:
+        static constexpr uint32_t DefaultRingSize = 4 * 1024 * 1024;
+        static constexpr uint32_t Alignment = 16;
+    private:
+        struct copy_t {
+            VkBuffer    dst;
+            Buffer*     src;        ///> 为空表示 ring buffer
+            uint32_t    srcOffset;
+            uint32_t    dstOffset;
+            uint32_t    size;
+        };
+        struct batch_t {
+            std::vector<copy_t>                                 copies;
+            std::vector<std::function<void(CommandBuffer*)>>    callbacks;
+            std::vector<Buffer*>                                overflowBuffers;
+            uint32_t                                            ringSpan;       ///> 这一批在 ring 上占用的字节数（含回绕浪费的部分）
+        };
+        Device*                         device_;
+        CommandQueue*                   queue_;
+        GPUAsyncLoadManager*            manager_;
+        Buffer*                         ringBuffer_;
+        uint8_t*                        ringPtr_;
+        uint32_t                        ringSize_;
+        uint32_t                        head_;
+        uint32_t                        usedBytes_;         ///> 从 tail 到 head 的字节数，tail = head - used
+        batch_t                         recording_;
+        std::mutex                      mutex_;
+        //
+        uint64_t                        uploads_;
+        uint64_t                        submits_;
+        uint64_t                        overflowUploads_;
+    private:
+        bool allocRing_(uint32_t size, uint32_t& offset);
+    public:
+        StagingUploadRing();
+        bool initialize(Device* device, CommandQueue* queue, GPUAsyncLoadManager* manager, uint32_t ringSize = DefaultRingSize);
+        // pieces 在目标 buffer 里从 dstOffset 开始连续存放
+        bool upload(VkBuffer dst, uint32_t dstOffset, upload_piece_t const* pieces, uint32_t pieceCount, std::function<void(CommandBuffer*)>&& onComplete);
+        void flush();
+        staging_upload_stat_t stat();
+        void destroy();
+    };
+
+}
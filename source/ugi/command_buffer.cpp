@@ -74,10 +74,12 @@ namespace ugi {
         return 0;
     }
 
-    CommandBuffer::CommandBuffer( VkDevice device, VkCommandBuffer cb, CmdbufType type) 
+    CommandBuffer::CommandBuffer( VkDevice device, VkCommandBuffer cb, CmdbufType type, VkCommandPool pool, bool secondary) 
         : _cmdbuff( cb )
         , _type(type)
         , _device(device)
+        , _pool(pool)
+        , _secondary(secondary)
         , _encodeState(0)
     {
     }
@@ -98,12 +100,33 @@ namespace ugi {
         return &_resourceEncoder;
     }
 
-    RenderCommandEncoder* CommandBuffer::renderCommandEncoder( IRenderPass* renderPass ) {
+    RenderCommandEncoder* CommandBuffer::renderCommandEncoder( IRenderPass* renderPass, VkSubpassContents contents ) {
         if( _encodeState ) {
             return nullptr;
         }
-        new(&_renderEncoder) RenderCommandEncoder(this, renderPass);
-        renderPass->begin(&_renderEncoder);
+        auto mode = contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS ? RenderCommandEncoder::Contents::SecondaryCommandBuffers : RenderCommandEncoder::Contents::Inline;
+        new(&_renderEncoder) RenderCommandEncoder(this, renderPass, 0, mode);
+        renderPass->begin(&_renderEncoder, contents);
+        return &_renderEncoder;
+    }
+
+    RenderCommandEncoder* CommandBuffer::inheritedRenderCommandEncoder( RenderCommandEncoder const* primary ) {
+        if( _encodeState || !_secondary ) {
+            return nullptr;
+        }
+        new(&_renderEncoder) RenderCommandEncoder(this, const_cast<IRenderPass*>(primary->renderPass()), primary->subpass(), RenderCommandEncoder::Contents::Inherited);
+        // dynamic state 不会从 primary 继承
+        if( primary->viewport().width != 0.0f ) {
+            VkViewport const& vp = primary->viewport();
+            _renderEncoder.setViewport( vp.x, vp.y, vp.width, vp.height, vp.minDepth, vp.maxDepth );
+        }
+        if( primary->scissor().extent.width ) {
+            VkRect2D const& sc = primary->scissor();
+            _renderEncoder.setScissor( sc.offset.x, sc.offset.y, (int)sc.extent.width, (int)sc.extent.height );
+        }
+        if( primary->lineWidth() != 0.0f ) {
+            _renderEncoder.setLineWidth( primary->lineWidth() );
+        }
         return &_renderEncoder;
     }
 
@@ -129,6 +152,28 @@ namespace ugi {
         vkBeginCommandBuffer(_cmdbuff, &beginInfo);
     }
 
+    void CommandBuffer::beginEncode( RenderCommandEncoder const* primary ) {
+        assert( _secondary );
+        IRenderPass const* renderPass = primary->renderPass();
+        VkCommandBufferInheritanceInfo inheritanceInfo = {}; {
+            inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+            inheritanceInfo.pNext = nullptr;
+            inheritanceInfo.renderPass = renderPass->renderPass();
+            inheritanceInfo.subpass = primary->subpass();
+            inheritanceInfo.framebuffer = renderPass->framebuffer();
+            inheritanceInfo.occlusionQueryEnable = VK_FALSE;
+            inheritanceInfo.queryFlags = 0;
+            inheritanceInfo.pipelineStatistics = 0;
+        }
+        VkCommandBufferBeginInfo beginInfo = {}; {
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.pNext = nullptr;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+            beginInfo.pInheritanceInfo = &inheritanceInfo;
+        }
+        vkBeginCommandBuffer(_cmdbuff, &beginInfo);
+    }
+
     void CommandBuffer::endEncode() {
         vkEndCommandBuffer(_cmdbuff);
     }
@@ -19,6 +19,8 @@ namespace ugi {
       VkCommandBuffer   _cmdbuff;
       CmdbufType        _type;
       VkDevice          _device;
+      VkCommandPool     _pool;          ///> 分配自哪个 pool，释放时用
+      bool              _secondary;
       union {
           uint32_t _encodeState;
           ResourceCommandEncoder _resourceEncoder;
@@ -31,20 +33,26 @@ namespace ugi {
       }
 
   public:
-      CommandBuffer(VkDevice device, VkCommandBuffer cb, CmdbufType type);
+      CommandBuffer(VkDevice device, VkCommandBuffer cb, CmdbufType type, VkCommandPool pool = VK_NULL_HANDLE, bool secondary = false);
       //
       operator VkCommandBuffer() const;
       VkDevice device() const;
       CmdbufType type() const {
           return _type;
       }
+      bool secondary() const {
+          return _secondary;
+      }
 
       ResourceCommandEncoder* resourceCommandEncoder();
-      RenderCommandEncoder* renderCommandEncoder(IRenderPass* renderPass);
+      RenderCommandEncoder* renderCommandEncoder(IRenderPass* renderPass, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+      // secondary command buffer 专用，继承 primary encoder 的 render pass/subpass，并重新设置 viewport/scissor
+      RenderCommandEncoder* inheritedRenderCommandEncoder(RenderCommandEncoder const* primary);
       ComputeCommandEncoder* computeCommandEncoder();
       //
       void reset();
       void beginEncode();
+      void beginEncode(RenderCommandEncoder const* primary); // secondary command buffer，在 primary 的 render pass 内执行
       void endEncode();
   };
 
@@ -38,8 +38,16 @@ namespace ugi {
         // vkCmdDrawIndirect()
     }
 
-    void RenderCommandEncoder::bindPipeline(GraphicsPipeline* pipeline) {
-        pipeline->bind(this);
+    bool RenderCommandEncoder::bindPipeline(GraphicsPipeline* pipeline) {
+        return pipeline->bind(this);
+    }
+
+    void RenderCommandEncoder::bindPipelineObject(VkPipeline pipeline) {
+        if(_boundPipeline == pipeline) {
+            return;
+        }
+        vkCmdBindPipeline(*_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        _boundPipeline = pipeline;
     }
 
     void RenderCommandEncoder::setViewport( float x, float y, float width, float height, float depthMin, float depthMax ) {
@@ -49,14 +57,17 @@ namespace ugi {
         _viewport.height = height;
         _viewport.minDepth = depthMin;
         _viewport.maxDepth = depthMax;
-        vkCmdSetViewport( *_commandBuffer, 0, 1, &_viewport );
+        if(_contents != Contents::SecondaryCommandBuffers) {
+            vkCmdSetViewport( *_commandBuffer, 0, 1, &_viewport );
+        }
     }
 
     void RenderCommandEncoder::setScissor( int x, int y, int width, int height ) {
-        VkRect2D scissor;
-        scissor.offset = { x, y };
-        scissor.extent = { (uint32_t)width, (uint32_t)height };
-        vkCmdSetScissor( *_commandBuffer, 0, 1, &scissor );
+        _scissor.offset = { x, y };
+        _scissor.extent = { (uint32_t)width, (uint32_t)height };
+        if(_contents != Contents::SecondaryCommandBuffers) {
+            vkCmdSetScissor( *_commandBuffer, 0, 1, &_scissor );
+        }
     }
 
     void RenderCommandEncoder::bindArgumentGroup( DescriptorBinder* argGroup ) {
@@ -64,11 +75,31 @@ namespace ugi {
     }
 
     void RenderCommandEncoder::setLineWidth( float lineWidth ) {
-        vkCmdSetLineWidth( *_commandBuffer, lineWidth );
+        _lineWidth = lineWidth;
+        if(_contents != Contents::SecondaryCommandBuffers) {
+            vkCmdSetLineWidth( *_commandBuffer, lineWidth );
+        }
+    }
+
+    void RenderCommandEncoder::executeCommands(CommandBuffer* const* commandBuffers, uint32_t count) {
+        constexpr uint32_t MaxExecuteBatch = 32;
+        VkCommandBuffer cmds[MaxExecuteBatch];
+        while(count) {
+            uint32_t n = count < MaxExecuteBatch ? count : MaxExecuteBatch;
+            for(uint32_t i = 0; i<n; ++i) {
+                cmds[i] = *commandBuffers[i];
+            }
+            vkCmdExecuteCommands(*_commandBuffer, n, cmds);
+            commandBuffers += n;
+            count -= n;
+        }
+        _boundPipeline = VK_NULL_HANDLE; // execute 之后 primary 的绑定状态是未定义的
     }
 
     void RenderCommandEncoder::endEncode() {
-        _renderPass->end(this);
+        if(_contents != Contents::Inherited) {
+            _renderPass->end(this);
+        }
         _commandBuffer = nullptr;
     }
 
@@ -7,21 +7,37 @@
 namespace ugi {
 
     class RenderCommandEncoder {
+    public:
+        enum class Contents : uint8_t {
+            Inline,                     ///> 普通的 primary encoder
+            SecondaryCommandBuffers,    ///> primary 里只 execute secondary，dynamic state 只记录下来给 secondary 继承
+            Inherited,                  ///> secondary command buffer 里的 encoder，render pass 由 primary 开启/结束
+        };
     private:
         CommandBuffer*                                  _commandBuffer;
         IRenderPass*                                    _renderPass;         ///> renderpass
         uint32_t                                        _subpass;            ///> subpass 的索引
         VkViewport                                      _viewport;
         VkRect2D                                        _scissor;
+        float                                           _lineWidth;          ///> 0 表示没有设置过
         GraphicsPipeline*                               _pipeline;
+        VkPipeline                                      _boundPipeline;      ///> 当前已绑定的 VkPipeline，相同的就不再重复 bind
+        Contents                                        _contents;
     public:
-        RenderCommandEncoder(CommandBuffer* commandBuffer = nullptr, IRenderPass* renderPass  = nullptr ) 
+        RenderCommandEncoder(CommandBuffer* commandBuffer = nullptr, IRenderPass* renderPass  = nullptr, uint32_t subpass = 0, Contents contents = Contents::Inline ) 
             : _commandBuffer( commandBuffer )
             , _renderPass( renderPass )
-            , _subpass( 0 )
+            , _subpass( subpass )
+            , _viewport{}
+            , _scissor{}
+            , _lineWidth( 0.0f )
+            , _pipeline( nullptr )
+            , _boundPipeline( VK_NULL_HANDLE )
+            , _contents( contents )
         {
         }
-        void bindPipeline( GraphicsPipeline* pipeline );
+        bool bindPipeline( GraphicsPipeline* pipeline ); // false : pipeline variant not ready, skip the draw
+        void bindPipelineObject( VkPipeline pipeline );
         void bindArgumentGroup( DescriptorBinder* argumentGroup );
         void setViewport( float x, float y, float width ,float height, float minDepth, float maxDepth );
         void setScissor( int x, int y, int width, int height );
@@ -29,6 +45,7 @@ namespace ugi {
         void draw(Mesh const* mesh, uint32_t instanceCount);
         void drawIndirect(Mesh const* meshes, uint32_t count);
         // void drawIndexed( Drawable* drawable, uint32_t offset, uint32_t indexCount, uint32_t vertexOffset = 0, uint32_t instanceCount = 1);
+        void executeCommands(CommandBuffer* const* commandBuffers, uint32_t count); // render pass 以 secondary contents 开启时使用
         void nextSubpass();
         void endEncode();
         //
@@ -38,6 +55,18 @@ namespace ugi {
         uint32_t subpass() const {
             return _subpass;
         }
+        VkViewport const& viewport() const {
+            return _viewport;
+        }
+        VkRect2D const& scissor() const {
+            return _scissor;
+        }
+        float lineWidth() const {
+            return _lineWidth;
+        }
+        Contents contents() const {
+            return _contents;
+        }
         const CommandBuffer* commandBuffer() const {
             return _commandBuffer;
         }
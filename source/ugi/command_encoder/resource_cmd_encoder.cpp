@@ -32,6 +32,24 @@ namespace ugi {
 
 
 
+    void ResourceCommandEncoder::memoryBarrier(VkPipelineStageFlags srcStages, VkAccessFlags srcAccess, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess) {
+        VkMemoryBarrier barrier = {}; {
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.pNext = nullptr;
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstAccessMask = dstAccess;
+        }
+        vkCmdPipelineBarrier(
+            *_commandBuffer,
+            srcStages,
+            dstStages,
+            0,
+            1, &barrier,
+            0, nullptr,
+            0, nullptr
+        );
+    }
+
       //  Top                     = 1<<0,
       //  DrawIndirect            = 1<<1,
       //  VertexInput             = 1<<2,
@@ -257,6 +275,23 @@ namespace ugi {
         vkCmdCopyBuffer(*_commandBuffer, src, dst, 1, &copy);
     }
 
+    void ResourceCommandEncoder::copyBufferRegions(VkBuffer dst, VkBuffer src, VkBufferCopy const* regions, uint32_t regionCount) {
+        vkCmdCopyBuffer(*_commandBuffer, src, dst, regionCount, regions);
+    }
+
+    void ResourceCommandEncoder::updateBufferInline(VkBuffer dst, uint64_t dstOffset, void const* data, uint32_t size) {
+        constexpr uint32_t MaxUpdateSize = 65536; // vkCmdUpdateBuffer 单次上限
+        assert((dstOffset & 3) == 0 && (size & 3) == 0);
+        auto ptr = (uint8_t const*)data;
+        while(size) {
+            uint32_t piece = size < MaxUpdateSize ? size : MaxUpdateSize;
+            vkCmdUpdateBuffer(*_commandBuffer, dst, dstOffset, piece, ptr);
+            dstOffset += piece;
+            ptr += piece;
+            size -= piece;
+        }
+    }
+
     /**
      * @brief 把 buffer 里的数据更新到 image 上
      * 
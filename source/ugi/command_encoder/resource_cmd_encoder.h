@@ -17,6 +17,8 @@ namespace ugi {
         }
         
         void executionBarrier(pipeline_stage_t srcStage, pipeline_stage_t dstStage);
+        // 全局内存屏障，stage / access 可以组合，用于一批 buffer 写入前后
+        void memoryBarrier(VkPipelineStageFlags srcStages, VkAccessFlags srcAccess, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess);
         //// 队列里有很多指令，我目前想等待这些指令（部分执行）完，让其它阶段的的命令去处理
         //// 那么我需要尽量不干预无关的阶段执行，还要禁止在数据生产阶段没执行完就去执行处理的阶段
         void bufferBarrier(VkBuffer buff, ResourceAccessType dstAccessType, pipeline_stage_t srcStage, StageAccess srcStageMask, pipeline_stage_t dstStage, StageAccess dstStageMask, const buffer_subres_t& subResource );
@@ -33,6 +35,10 @@ namespace ugi {
 
         // latest interface
         void copyBuffer(VkBuffer dst, VkBuffer src, buffer_subres_t dstRange, buffer_subres_t srcRange);
+        void copyBufferRegions(VkBuffer dst, VkBuffer src, VkBufferCopy const* regions, uint32_t regionCount);
+        // vkCmdUpdateBuffer，数据直接写在 command buffer 里，不需要 staging buffer，适合小块的更新
+        // dstOffset 和 size 必须是 4 的倍数，超过 65536 字节的自动拆开
+        void updateBufferInline(VkBuffer dst, uint64_t dstOffset, void const* data, uint32_t size);
         void copyBufferToImage(VkImage dst, VkImageAspectFlags aspectFlags, VkBuffer src, const image_region_t* regions, const uint64_t* offsets, uint32_t regionCount);
         //
         void endEncode();
@@ -6,6 +6,24 @@
 namespace ugi {
 
     bool CommandQueue::submitCommandBuffers( const QueueSubmitBatchInfo& batch ) const {
+        std::unique_lock<std::mutex> lock(_submitMutex);
+        return _submit(batch, 0);
+    }
+
+    uint64_t CommandQueue::submitCommandBuffersTracked( const QueueSubmitBatchInfo& batch ) {
+        if( !_timeline || !batch.submitInfoCount ) {
+            return 0;
+        }
+        std::unique_lock<std::mutex> lock(_submitMutex);
+        uint64_t value = _timelineValue + 1;
+        if( !_submit(batch, value) ) {
+            return 0;
+        }
+        _timelineValue = value;
+        return value;
+    }
+
+    bool CommandQueue::_submit( const QueueSubmitBatchInfo& batch, uint64_t timelineValue ) const {
         //
         constexpr uint32_t MaxSubmitInfoSupport = 8;
         constexpr uint32_t MaxCommandBufferPerSubmit = 8;
@@ -18,7 +36,9 @@ namespace ugi {
         VkCommandBuffer commandBuffers[MaxCommandBufferPerSubmit][MaxSubmitInfoSupport];
         VkSemaphore semaphoresToWait[MaxSemWaitPerSubmit][MaxSubmitInfoSupport];
         VkPipelineStageFlags semaphoreToWaitStageFlags[MaxSemWaitPerSubmit][MaxSubmitInfoSupport];
-        VkSemaphore semaphoresToSignal[MaxSemSignalPerSubmit][MaxSubmitInfoSupport];
+        VkSemaphore semaphoresToSignal[MaxSubmitInfoSupport][MaxSemSignalPerSubmit+1]; // 多留一个给 timeline
+        uint64_t signalValues[MaxSemSignalPerSubmit+1] = {}; // binary semaphore 的值会被忽略
+        VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {};
 
         for( uint32_t submitInfoIndex = 0; submitInfoIndex < batch.submitInfoCount; ++submitInfoIndex) {
 
@@ -48,6 +68,21 @@ namespace ugi {
             submitInfo[submitInfoIndex].pCommandBuffers = commandBuffers[submitInfoIndex];
             submitInfo[submitInfoIndex].commandBufferCount = batch.submitInfos[submitInfoIndex].commandCount;
             submitInfo[submitInfoIndex].pWaitDstStageMask = semaphoreToWaitStageFlags[submitInfoIndex]; // 这个以后得改，因为以后不止做渲染队列使用
+        }
+        if( timelineValue ) { // 挂在最后一个 submit 上，同一队列上 signal 发生在前面所有 submit 完成之后
+            auto& last = submitInfo[batch.submitInfoCount-1];
+            uint32_t signalCount = last.signalSemaphoreCount;
+            semaphoresToSignal[batch.submitInfoCount-1][signalCount] = _timeline;
+            signalValues[signalCount] = timelineValue;
+            last.signalSemaphoreCount = signalCount + 1;
+            last.pSignalSemaphores = semaphoresToSignal[batch.submitInfoCount-1];
+            timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+            timelineSubmitInfo.pNext = nullptr;
+            timelineSubmitInfo.waitSemaphoreValueCount = 0;
+            timelineSubmitInfo.pWaitSemaphoreValues = nullptr;
+            timelineSubmitInfo.signalSemaphoreValueCount = last.signalSemaphoreCount;
+            timelineSubmitInfo.pSignalSemaphoreValues = signalValues;
+            last.pNext = &timelineSubmitInfo;
         }
 		VkFence fence = VK_NULL_HANDLE;
 		if (batch.fenceToSignal) {
@@ -65,6 +100,46 @@ namespace ugi {
         vkQueueWaitIdle( _queue );
     }
 
+    bool CommandQueue::initializeTimeline( VkDevice device ) {
+        if( _timeline ) {
+            return true;
+        }
+        VkSemaphoreTypeCreateInfo typeInfo = {}; {
+            typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+            typeInfo.pNext = nullptr;
+            typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+            typeInfo.initialValue = 0;
+        }
+        VkSemaphoreCreateInfo semaphoreInfo = {}; {
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            semaphoreInfo.pNext = &typeInfo;
+            semaphoreInfo.flags = 0;
+        }
+        VkResult rst = vkCreateSemaphore( device, &semaphoreInfo, nullptr, &_timeline );
+        if( VK_SUCCESS != rst ) {
+            _timeline = VK_NULL_HANDLE;
+            return false;
+        }
+        _device = device;
+        _timelineValue = 0;
+        return true;
+    }
+
+    void CommandQueue::destroyTimeline() {
+        if( _timeline ) {
+            vkDestroySemaphore( _device, _timeline, nullptr );
+            _timeline = VK_NULL_HANDLE;
+        }
+    }
+
+    uint64_t CommandQueue::completedTimelineValue() const {
+        uint64_t value = 0;
+        if( _timeline ) {
+            vkGetSemaphoreCounterValue( _device, _timeline, &value );
+        }
+        return value;
+    }
+
     CommandBuffer* CommandQueue::createCommandBuffer( Device* device, CmdbufType type) {
         VkCommandPool pool = VK_NULL_HANDLE;
         if(type == CmdbufType::Resetable) {
@@ -108,13 +183,50 @@ namespace ugi {
         if( VK_SUCCESS != rst ) {
             return nullptr;
         }
-        CommandBuffer* cb = new CommandBuffer(device->device(), cmdbuff, type);
+        CommandBuffer* cb = new CommandBuffer(device->device(), cmdbuff, type, pool);
         return cb;
     }
 
+    CommandBuffer* CommandQueue::createSecondaryCommandBuffer( Device* device, uint32_t poolIndex ) {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        {
+            std::unique_lock<std::mutex> lock(_poolMutex);
+            if( poolIndex >= _secondaryPools.size() ) {
+                _secondaryPools.resize(poolIndex + 1, VK_NULL_HANDLE);
+            }
+            if( VK_NULL_HANDLE == _secondaryPools[poolIndex] ) {
+                VkCommandPoolCreateInfo commandPoolInfo = {};{
+                    commandPoolInfo.pNext = nullptr;
+                    commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+                    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+                    commandPoolInfo.queueFamilyIndex =  _queueFamilyIndex;
+                }
+                VkResult rst = vkCreateCommandPool( device->device(), &commandPoolInfo, nullptr, &_secondaryPools[poolIndex] );
+                if( VK_SUCCESS!=rst) {
+                    _secondaryPools[poolIndex] = VK_NULL_HANDLE;
+                    return nullptr;
+                }
+            }
+            pool = _secondaryPools[poolIndex];
+        }
+        VkCommandBufferAllocateInfo cmdbuffAllocateInfo = {};{
+            cmdbuffAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            cmdbuffAllocateInfo.pNext = nullptr;
+            cmdbuffAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            cmdbuffAllocateInfo.commandPool = pool;
+            cmdbuffAllocateInfo.commandBufferCount = 1;
+        }
+        VkCommandBuffer cmdbuff;
+        VkResult rst = vkAllocateCommandBuffers( device->device(), &cmdbuffAllocateInfo,&cmdbuff);
+        if( VK_SUCCESS != rst ) {
+            return nullptr;
+        }
+        return new CommandBuffer(device->device(), cmdbuff, CmdbufType::Resetable, pool, true);
+    }
+
     void CommandQueue::destroyCommandBuffer( Device* device, CommandBuffer* commandBuffer ) {
         VkCommandBuffer cmd = *commandBuffer;
-        VkCommandPool pool = (commandBuffer->type() == CmdbufType::Resetable) ? _resetablePool : _transientPool;
+        VkCommandPool pool = commandBuffer->_pool;
         if (pool != VK_NULL_HANDLE) {
             vkFreeCommandBuffers(device->device(), pool, 1, &cmd);
         }
@@ -5,6 +5,8 @@
 #include "vulkan_declare.h"
 #include "flight_cycle_invoker.h"
 #include <cstdint>
+#include <mutex>
+#include <vector>
 
 namespace ugi {
 
@@ -48,24 +50,56 @@ namespace ugi {
         //
         VkCommandPool   _resetablePool;
         VkCommandPool   _transientPool;
+        std::vector<VkCommandPool>  _secondaryPools;   ///> secondary command buffer 的 pool，每个录制线程一个（pool 需要外部同步）
+        std::mutex      _poolMutex;
         //
+        VkDevice        _device;
+        VkSemaphore     _timeline;          ///> 每个队列一个 timeline semaphore，值单调递增
+        uint64_t        _timelineValue;     ///> 最后一次提交 signal 的值
+        mutable std::mutex  _submitMutex;   ///> vkQueueSubmit 要求外部同步，timeline 的值也必须按提交顺序递增
+        //
+        bool _submit( const QueueSubmitBatchInfo& batch, uint64_t timelineValue ) const;
     public:
         /* ============================================
             method : submitCommandBuffers
         / ============================================*/
         bool submitCommandBuffers( const QueueSubmitBatchInfo& batch ) const;
+        /* ============================================
+            method : submitCommandBuffersTracked
+            在最后一个 submit 上额外 signal timeline，返回 signal 的值，失败返回 0
+        / ============================================*/
+        uint64_t submitCommandBuffersTracked( const QueueSubmitBatchInfo& batch );
         void waitIdle() const;
         //
+        bool initializeTimeline( VkDevice device );
+        void destroyTimeline();
+        bool timelineSupported() const {
+            return _timeline != VK_NULL_HANDLE;
+        }
+        uint64_t completedTimelineValue() const;
+        //
         CommandQueue( VkQueue queue, uint32_t queueFamilyIndex, uint32_t queueIndex ) 
             : _queue( queue )
             , _queueFamilyIndex( queueFamilyIndex )
             , _queueIndex( queueIndex )
             , _resetablePool(VK_NULL_HANDLE)
             , _transientPool(VK_NULL_HANDLE)
+            , _secondaryPools{}
+            , _poolMutex()
+            , _device(VK_NULL_HANDLE)
+            , _timeline(VK_NULL_HANDLE)
+            , _timelineValue(0)
+            , _submitMutex()
         {
         }
         //
         CommandBuffer* createCommandBuffer(Device* device, CmdbufType type = CmdbufType::Resetable);
+        /* ============================================
+            method : createSecondaryCommandBuffer
+            poolIndex 对应一个录制线程，同一个 poolIndex 分配的 command buffer 同一时间只能在一个线程里录制
+            command buffer 可以 reset，每帧 beginEncode 重新录制即可
+        / ============================================*/
+        CommandBuffer* createSecondaryCommandBuffer(Device* device, uint32_t poolIndex);
         void destroyCommandBuffer( Device* device, CommandBuffer* commandBuffer );
         //
         operator VkQueue() const {
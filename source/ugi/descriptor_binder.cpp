@@ -5,6 +5,7 @@
 #include "device.h"
 #include "command_buffer.h"
 #include "material_layout.inl"
+#include "ugi_utility.h"
 #include <cstring>
 #include <cstdint>
 
@@ -29,7 +30,8 @@ namespace ugi {
         //
         switch (resource.type)
         {
-        case res_descriptor_type::UniformBuffer: {
+        case res_descriptor_type::UniformBuffer:
+        case res_descriptor_type::DynamicStorageBuffer: { // 和 uniform buffer 一样走 dynamic offset
             VkDescriptorBufferInfo* pBufferInfo = (VkDescriptorBufferInfo*)&mixedDescriptor;
             if( pBufferInfo->buffer != (VkBuffer)resource.res.buffer.buffer) {
                 pBufferInfo->buffer = (VkBuffer)resource.res.buffer.buffer;
@@ -124,10 +126,19 @@ namespace ugi {
         // 有必要就更新set
         for( uint32_t setID = 0; setID<_groupLayout->_descriptorSetCount; ++setID) {
             if( _reallocBitMask.test(setID) ) {
-                _descriptorSets[setID] = _descriptorSetAllocator->allocate(_groupLayout->descriptorSetLayout(setID));
-                VkDevice device = _groupLayout->device()->device();
+                VkDescriptorSetLayout setLayout = _groupLayout->descriptorSetLayout(setID);
                 uint32_t descriptorCount = _groupLayout->descriptorCount(setID);
                 uint32_t descriptorWriteBaseIndex = _groupLayout->descriptorWriteBaseIndex(setID);
+                // 同样的资源组合这一帧已经写过了，直接用那个 set，dynamic offset 在 bind 的时候单独给
+                uint64_t contentHash = _hashDescriptorSetContent(setLayout, descriptorWriteBaseIndex, descriptorCount);
+                VkDescriptorSet cachedSet = _descriptorSetAllocator->findCachedSet(contentHash);
+                if(cachedSet) {
+                    _descriptorSets[setID] = cachedSet;
+                    _reallocBitMask.flip(setID);
+                    continue;
+                }
+                _descriptorSets[setID] = _descriptorSetAllocator->allocate(setLayout);
+                VkDevice device = _groupLayout->device()->device();
                 // 别忘了更新write里的set
                 for( uint32_t i = descriptorWriteBaseIndex; i < (descriptorWriteBaseIndex + descriptorCount); ++i) {
                     _descriptorWrites[i].dstSet = _descriptorSets[setID];
@@ -139,12 +150,41 @@ namespace ugi {
                     0,      // 不复制
                     nullptr
                 );
+                _descriptorSetAllocator->cacheSet(contentHash, _descriptorSets[setID]);
                 _reallocBitMask.flip(setID);
             }
         }
         return true;
     }
 
+    uint64_t DescriptorBinder::_hashDescriptorSetContent(VkDescriptorSetLayout setLayout, uint32_t baseIndex, uint32_t count) const {
+        UGIHash<APHash> hasher;
+        hasher.hashPOD(setLayout);
+        for(uint32_t i = baseIndex; i<baseIndex + count; ++i) {
+            auto const& write = _descriptorWrites[i];
+            auto const& mixedDescriptor = _vecMixedDesciptorInfo[i];
+            hasher.hashPOD(write.dstBinding);
+            hasher.hashPOD(write.descriptorType);
+            switch(write.descriptorType) {
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC: { // offset 是动态的，不参与 hash
+                hasher.hashPOD(mixedDescriptor.bufferInfo.buffer);
+                hasher.hashPOD(mixedDescriptor.bufferInfo.range);
+                break;
+            }
+            default: {
+                hasher.hashPOD(mixedDescriptor.imageInfo.sampler);
+                hasher.hashPOD(mixedDescriptor.imageInfo.imageView);
+                hasher.hashPOD(mixedDescriptor.imageInfo.imageLayout);
+                break;
+            }
+            }
+        }
+        return hasher;
+    }
+
     void DescriptorBinder::bind( CommandBuffer const* commandBuffer ) {
         if(!validateDescriptorSets()) { // update descriptor set binding
             assert(false);
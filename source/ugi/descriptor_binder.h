@@ -52,6 +52,7 @@ namespace ugi {
         // 看 descriptor set 需要不需要重建，如果需要就重建 descriptor set，回收旧的
         bool validateIntegrility();
         bool validateDescriptorSets();
+        uint64_t _hashDescriptorSetContent(VkDescriptorSetLayout setLayout, uint32_t baseIndex, uint32_t count) const;
     public:
         DescriptorBinder(const MaterialLayout* groupLayout, DescriptorSetAllocator* setAllocator, VkPipelineBindPoint bindPoint = VkPipelineBindPoint::VK_PIPELINE_BIND_POINT_GRAPHICS );
         void reset();
@@ -1,5 +1,6 @@
 ﻿#include "descriptor_set_allocator.h"
 #include "vulkan_function_declare.h"
+#include <algorithm>
 namespace ugi {
 
     constexpr VkDescriptorPoolSize DescriptorPoolSizeTemplate[] = {
@@ -18,21 +19,29 @@ namespace ugi {
 
     DescriptorSetAllocator::DescriptorSetAllocator()
         : _device( nullptr )
-        , _activePool(0)
         , _flight(0)         
-        , _descriptorPools {}
-        , _allocationFlights{}
+        , _layoutCaches {}
+        , _allocations(0)
+        , _recycleHits(0)
+        , _contentCacheHits(0)
+        , _contentCaches {}
+        , _mutex()
     {}
 
-    VkDescriptorPool DescriptorSetAllocator::_createDescriporPool() 
+    VkDescriptorPool DescriptorSetAllocator::_createDescriporPool(layout_cache_t const& cache, uint32_t maxSets) 
     {
+        VkDescriptorPoolSize poolSizes[MaxDescriptorTypeCount];
+        for(uint32_t i = 0; i<cache.descriptorTypeCount; ++i) {
+            poolSizes[i].type = cache.descriptorCounts[i].type;
+            poolSizes[i].descriptorCount = cache.descriptorCounts[i].descriptorCount * maxSets;
+        }
         VkDescriptorPoolCreateInfo descriptorPoolInfo = {}; {
             descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
             descriptorPoolInfo.pNext = nullptr;
-            descriptorPoolInfo.poolSizeCount = (uint32_t) sizeof(DescriptorPoolSizeTemplate)/sizeof(VkDescriptorPoolSize);
-            descriptorPoolInfo.pPoolSizes = DescriptorPoolSizeTemplate;
-            descriptorPoolInfo.maxSets = 2048;
-            descriptorPoolInfo.flags = VkDescriptorPoolCreateFlagBits::VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+            descriptorPoolInfo.poolSizeCount = cache.descriptorTypeCount;
+            descriptorPoolInfo.pPoolSizes = poolSizes;
+            descriptorPoolInfo.maxSets = maxSets;
+            descriptorPoolInfo.flags = 0; // set 不还给 pool，不需要 FREE_DESCRIPTOR_SET_BIT
         }
         VkDescriptorPool pool;
         VkResult rst = vkCreateDescriptorPool( _device, &descriptorPoolInfo, nullptr, &pool);
@@ -42,81 +51,156 @@ namespace ugi {
         return VK_NULL_HANDLE;
     }
 
+    void DescriptorSetAllocator::registerLayout(VkDescriptorSetLayout setLayout, VkDescriptorSetLayoutBinding const* bindings, uint32_t bindingCount) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if(_layoutCaches.find(setLayout) != _layoutCaches.end()) {
+            return; // 已经登记过，不能把 liveSets/pool 统计清掉
+        }
+        auto& cache = _layoutCaches[setLayout];
+        cache.descriptorTypeCount = 0;
+        for(uint32_t i = 0; i<bindingCount; ++i) {
+            if(!bindings[i].descriptorCount) {
+                continue; // 0 个 descriptor 的 binding 不占 pool，也不能生成 0 大小的 VkDescriptorPoolSize
+            }
+            uint32_t typeIndex = 0;
+            for(; typeIndex<cache.descriptorTypeCount; ++typeIndex) {
+                if(cache.descriptorCounts[typeIndex].type == bindings[i].descriptorType) {
+                    break;
+                }
+            }
+            if(typeIndex == cache.descriptorTypeCount) {
+                assert(typeIndex < MaxDescriptorTypeCount);
+                cache.descriptorCounts[typeIndex] = { bindings[i].descriptorType, 0 };
+                ++cache.descriptorTypeCount;
+            }
+            cache.descriptorCounts[typeIndex].descriptorCount += bindings[i].descriptorCount;
+        }
+        cache.liveSets = 0;
+    }
+
+    DescriptorSetAllocator::layout_cache_t& DescriptorSetAllocator::_layoutCache(VkDescriptorSetLayout setLayout) {
+        auto iter = _layoutCaches.find(setLayout);
+        if(iter != _layoutCaches.end()) {
+            return iter->second;
+        }
+        // 没有登记过的 layout，只能按模板给每种类型都留一个
+        auto& cache = _layoutCaches[setLayout];
+        cache.descriptorTypeCount = (uint32_t)(sizeof(DescriptorPoolSizeTemplate)/sizeof(VkDescriptorPoolSize));
+        for(uint32_t i = 0; i<cache.descriptorTypeCount; ++i) {
+            cache.descriptorCounts[i] = { DescriptorPoolSizeTemplate[i].type, 1 };
+        }
+        cache.liveSets = 0;
+        return cache;
+    }
+
     VkDescriptorSet DescriptorSetAllocator::allocate(VkDescriptorSetLayout setLayout) 
     {
-        auto& allocationFlight = _allocationFlights[_flight];
+        std::unique_lock<std::mutex> lock(_mutex);
+        ++_allocations;
+        layout_cache_t& cache = _layoutCache(setLayout);
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        if(cache.freeSets.size()) { // 复用已经退役的 set，不走驱动
+            descriptorSet = cache.freeSets.back();
+            cache.freeSets.pop_back();
+            cache.flightSets[_flight].push_back(descriptorSet);
+            ++_recycleHits;
+            return descriptorSet;
+        }
         VkDescriptorSetAllocateInfo inf = {}; {
             inf.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
             inf.pNext = nullptr;
             inf.descriptorSetCount = 1;
             inf.pSetLayouts = &setLayout;
         }
-        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
-        // 遍历现有pool，去试着分配
-        for(auto startIndex = _activePool; startIndex < _activePool+_descriptorPools.size(); ++startIndex) {
-            auto realIndex = startIndex % _descriptorPools.size();
-            auto pool = _descriptorPools[realIndex];
-            inf.descriptorPool = pool;
-            auto rst = vkAllocateDescriptorSets(_device, &inf, &descriptorSet);
-            if(rst == VK_SUCCESS) {
-                _activePool = realIndex;
+        // set 从不还给 pool，前面的 pool 都是满的，只需要试最后一个
+        if(cache.pools.size()) {
+            inf.descriptorPool = cache.pools.back();
+            if(VK_SUCCESS != vkAllocateDescriptorSets(_device, &inf, &descriptorSet)) {
+                descriptorSet = VK_NULL_HANDLE;
             }
         }
-        if(!descriptorSet) { // pool 不够了，新pool!
-            auto pool = _createDescriporPool();
-            _descriptorPools.push_back(pool);
+        if(!descriptorSet) { // pool 不够了，新pool! 每次翻倍
+            uint32_t maxSets = InitialSetsPerPool << (uint32_t)std::min<size_t>(cache.pools.size(), 4);
+            maxSets = std::min(maxSets, MaxSetsPerPool);
+            auto pool = _createDescriporPool(cache, maxSets);
+            assert(pool);
+            if(!pool) {
+                return VK_NULL_HANDLE;
+            }
+            cache.pools.push_back(pool);
             inf.descriptorPool = pool;
-            _activePool = _descriptorPools.size() - 1;
             auto rst = vkAllocateDescriptorSets(_device, &inf, &descriptorSet);
             assert(rst == VK_SUCCESS);
             if( VK_SUCCESS != rst ) {
                 return VK_NULL_HANDLE;
             }
         }
-        // locate or create AllocationInfo for this descriptor set
-        AllocationInfo* info = nullptr;
-        if(_allocationFlights[_flight].size()) {
-            if(_allocationFlights[_flight].back().pool == _descriptorPools[_activePool]) {
-                info = &_allocationFlights[_flight].back();
-            }
-        }
-        if(!info) {
-            _allocationFlights[_flight].emplace_back();
-            info = &_allocationFlights[_flight].back();
-            info->pool = _descriptorPools[_activePool];
-        }
-        info->sets.push_back(descriptorSet);
-        ++info->count;
+        ++cache.liveSets;
+        cache.flightSets[_flight].push_back(descriptorSet);
         return descriptorSet;
     }
 
+    VkDescriptorSet DescriptorSetAllocator::findCachedSet(uint64_t contentHash) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto const& contentCache = _contentCaches[_flight];
+        auto iter = contentCache.find(contentHash);
+        if(iter == contentCache.end()) {
+            return VK_NULL_HANDLE;
+        }
+        ++_contentCacheHits;
+        return iter->second;
+    }
+
+    void DescriptorSetAllocator::cacheSet(uint64_t contentHash, VkDescriptorSet descriptorSet) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _contentCaches[_flight][contentHash] = descriptorSet;
+    }
+
     bool DescriptorSetAllocator::initialize( VkDevice device ) 
     {
         _device = device;
-        auto pool = _createDescriporPool();
-        if( !pool ) {
-            return false;
-        }
-        _descriptorPools.push_back(pool);
-        _activePool = 0;
         _flight = 0;
         return true;
     }
 
     void DescriptorSetAllocator::tick() {
+        std::unique_lock<std::mutex> lock(_mutex);
         _flight++;
         _flight %= MaxFlightCount;
-        auto& allocations = _allocationFlights[_flight];
-        for(auto allocation: allocations) {
-            vkFreeDescriptorSets(_device, allocation.pool, allocation.count, allocation.sets.data());
+        // 这个 flight 上一轮分配的 set GPU 已经用完了，回到空闲列表
+        _contentCaches[_flight].clear();
+        for(auto& item: _layoutCaches) {
+            auto& cache = item.second;
+            auto& retired = cache.flightSets[_flight];
+            cache.freeSets.insert(cache.freeSets.end(), retired.begin(), retired.end());
+            retired.clear();
+        }
+    }
+
+    descriptor_set_allocator_stat_t DescriptorSetAllocator::stat() const {
+        std::unique_lock<std::mutex> lock(_mutex);
+        descriptor_set_allocator_stat_t rst = {}; {
+            for(auto const& item: _layoutCaches) {
+                rst.poolCount += (uint32_t)item.second.pools.size();
+                rst.liveSets += item.second.liveSets;
+                rst.freeSets += (uint32_t)item.second.freeSets.size();
+            }
+            rst.allocations = _allocations;
+            rst.recycleHits = _recycleHits;
+            rst.recycleHitRate = _allocations ? (float)((double)_recycleHits / _allocations) : 0.0f;
+            rst.contentCacheHits = _contentCacheHits;
         }
-        allocations.clear();
+        return rst;
     }
 
     void DescriptorSetAllocator::destroy() {
-        for( auto pool : _descriptorPools ) {
-            vkDestroyDescriptorPool(_device, pool, nullptr);
+        std::unique_lock<std::mutex> lock(_mutex);
+        for(auto& item: _layoutCaches) {
+            for( auto pool : item.second.pools ) {
+                vkDestroyDescriptorPool(_device, pool, nullptr);
+            }
         }
+        _layoutCaches.clear();
     }
 
 }
\ No newline at end of file
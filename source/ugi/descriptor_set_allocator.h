@@ -7,6 +7,8 @@
 #include <list>
 #include <cassert>
 #include <array>
+#include <unordered_map>
+#include <mutex>
 
 namespace ugi {
 
@@ -16,31 +18,60 @@ namespace ugi {
         在 vk 里 argument 对应一个 descriptor set
     =================================================================*/
 
+    struct descriptor_set_allocator_stat_t {
+        uint32_t    poolCount;          ///> 所有 layout 的 VkDescriptorPool 总数
+        uint32_t    liveSets;           ///> 已经从 pool 里分配出来的 set（含空闲列表里的）
+        uint32_t    freeSets;           ///> 空闲列表里可以直接复用的 set
+        uint64_t    allocations;        ///> allocate 调用次数
+        uint64_t    recycleHits;        ///> 其中直接从空闲列表拿到的次数
+        float       recycleHitRate;
+        uint64_t    contentCacheHits;   ///> 资源组合相同，直接复用本帧已写好的 set（不分配也不 update）
+    };
+
     /*****************************************************************************************************************
     *  类描述 ：descriptor set allocator
     *  这个类负责分配descriptor set，原则上只分配不回收，即只从 VkDescriptorPool 中分配，不回收到VkDescriptorPool中
-    *  但我们会提供一个缓存机制代替回收功能
-    *  所以 m_vecDescriptorPool 的内容只会增加不会减少，这一点务必注意
+    *  我们提供一个缓存机制代替回收功能：
+    *  1. 每个 VkDescriptorSetLayout 有自己的 pool 列表和空闲列表，pool 按 layout 实际的 descriptor 数量创建
+    *  2. 一帧里分配的 set 在 MaxFlightCount 帧之后（GPU 已经不再使用）回到该 layout 的空闲列表，下次分配直接复用，不走驱动
+    *  所以 pool 的数量只会增加不会减少，这一点务必注意
+    *  UI 并行录制时多个线程会同时分配，公开接口都在 _mutex 下执行
     *******************************************************************************************************************/
     class DescriptorSetAllocator {
-        struct AllocationInfo { // 记录一个pool里有多个set，分别是什么，方便以后回收
-            VkDescriptorPool                pool;
-            uint32_t                        count;
-            std::vector<VkDescriptorSet>    sets;
+        static constexpr uint32_t MaxDescriptorTypeCount = 11;
+        static constexpr uint32_t InitialSetsPerPool = 64;
+        static constexpr uint32_t MaxSetsPerPool = 1024;
+        struct layout_cache_t {
+            VkDescriptorPoolSize                                        descriptorCounts[MaxDescriptorTypeCount];  ///> 单个 set 每种 descriptor 的数量
+            uint32_t                                                    descriptorTypeCount;
+            std::vector<VkDescriptorPool>                               pools;                      ///> 只有最后一个 pool 可能还有空间
+            std::vector<VkDescriptorSet>                                freeSets;
+            std::array<std::vector<VkDescriptorSet>, MaxFlightCount>    flightSets;                 ///> 每个 flight 分配出去的 set
+            uint32_t                                                    liveSets;
         };
     private:
         VkDevice                                                        _device;
-        uint32_t                                                        _activePool;
         uint32_t                                                        _flight;         
-        std::vector<VkDescriptorPool>                                   _descriptorPools;
-        std::array<std::vector<AllocationInfo>, MaxFlightCount>         _allocationFlights;
+        std::unordered_map<VkDescriptorSetLayout, layout_cache_t>       _layoutCaches;
+        uint64_t                                                        _allocations;
+        uint64_t                                                        _recycleHits;
+        uint64_t                                                        _contentCacheHits;
+        std::array<std::unordered_map<uint64_t, VkDescriptorSet>, MaxFlightCount> _contentCaches;   ///> 每个 flight：layout + 资源 hash -> 已写好的 set
+        mutable std::mutex                                              _mutex;
     private:
-        VkDescriptorPool _createDescriporPool();
+        VkDescriptorPool _createDescriporPool(layout_cache_t const& cache, uint32_t maxSets);
+        layout_cache_t& _layoutCache(VkDescriptorSetLayout setLayout);
     public:        
         DescriptorSetAllocator();
         bool initialize( VkDevice device );
+        // 创建 set layout 时登记每种 descriptor 的数量，没登记过的 layout 按 DescriptorPoolSizeTemplate 分配
+        void registerLayout(VkDescriptorSetLayout setLayout, VkDescriptorSetLayoutBinding const* bindings, uint32_t bindingCount);
         void tick();
         VkDescriptorSet allocate(VkDescriptorSetLayout setLayout);
+        // 本帧内按内容去重，set 跟着 flight 一起退役，所以只查当前 flight
+        VkDescriptorSet findCachedSet(uint64_t contentHash);
+        void cacheSet(uint64_t contentHash, VkDescriptorSet descriptorSet);
+        descriptor_set_allocator_stat_t stat() const;
         void destroy();
     };
 
@@ -8,6 +8,7 @@
 #include <map>
 #include <cstdint>
 #include <cassert>
+#include <cstring>
 #include <utility>
 #include <algorithm>
 
@@ -22,6 +23,8 @@
 #include "ugi_type_mapping.h"
 #include "descriptor_binder.h"
 #include "pipeline.h"
+#include "pipeline_cache.h"
+#include "multithread/worker_pool.h"
 #include "descriptor_set_allocator.h"
 #include "uniform_buffer_allocator.h"
 #include "flight_cycle_invoker.h"
@@ -144,12 +147,19 @@ namespace ugi {
     void RenderSystem::createVulkanInstance(bool validation) {
         const char APPLICATION_NAME[] = "UGI - VULKAN";
         const char ENGINE_NAME[] = "UGI - VULKAN ENGINE";
+        // timeline semaphore 是 1.2 的核心功能，loader 支持的话就按 1.2 创建
+        uint32_t apiVersion = VK_MAKE_VERSION(1, 0, 0);
+        if(vkEnumerateInstanceVersion) {
+            vkEnumerateInstanceVersion(&apiVersion);
+            apiVersion = std::min<uint32_t>(apiVersion, VK_MAKE_VERSION(1, 2, 0));
+        }
+        m_deviceDescriptorVk.instanceApiVersion = apiVersion;
         VkApplicationInfo applicationInfo; {
             applicationInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
             applicationInfo.pNext = nullptr;
             applicationInfo.pApplicationName = APPLICATION_NAME;
             applicationInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
-            applicationInfo.apiVersion = VK_MAKE_VERSION(1, 0, 0);
+            applicationInfo.apiVersion = apiVersion;
             applicationInfo.pEngineName = ENGINE_NAME;
             applicationInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
         }
@@ -361,22 +371,44 @@ namespace ugi {
         }
         VkPhysicalDeviceFeatures features;
         vkGetPhysicalDeviceFeatures( physicalDevice, &features);
+        // 异步上传的完成检测用 timeline semaphore，不支持的话退回 fence
+        VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {}; {
+            timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+            timelineFeatures.pNext = nullptr;
+            timelineFeatures.timelineSemaphore = VK_FALSE;
+        }
+        uint32_t const deviceApiVersion = std::min(m_deviceDescriptorVk.instanceApiVersion, m_deviceDescriptorVk.properties.apiVersion);
+        if( deviceApiVersion >= VK_MAKE_VERSION(1, 2, 0) && vkGetPhysicalDeviceFeatures2 && vkGetSemaphoreCounterValue ) {
+            VkPhysicalDeviceFeatures2 features2 = {}; {
+                features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+                features2.pNext = &timelineFeatures;
+            }
+            vkGetPhysicalDeviceFeatures2( physicalDevice, &features2);
+        }
+        m_deviceDescriptorVk.timelineSemaphore = timelineFeatures.timelineSemaphore == VK_TRUE;
 
-        const char * deviceExts[] = {
+        std::vector<const char*> deviceExts = {
             VK_KHR_SWAPCHAIN_EXTENSION_NAME,
             VK_KHR_SHADER_DRAW_PARAMETERS_EXTENSION_NAME
         };
+        // pipeline cache 命中统计用，可选
+        m_deviceDescriptorVk.pipelineCreationFeedback = std::find_if(exts.begin(), exts.end(), [](const char* ext) {
+            return strcmp(ext, VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME) == 0;
+        }) != exts.end();
+        if( m_deviceDescriptorVk.pipelineCreationFeedback ) {
+            deviceExts.push_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+        }
         //
         VkDeviceCreateInfo deviceCreateInfo = {
             VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO, // VkStructureType sType
-            nullptr, // const void *pNext
+            m_deviceDescriptorVk.timelineSemaphore ? &timelineFeatures : nullptr, // const void *pNext
             0, // VkDeviceCreateFlags flags
             static_cast<uint32_t>( deviceQueueCreateInfos.size()), // uint32_t queueCreateInfoCount
             deviceQueueCreateInfos.data(), // const VkDeviceQueueCreateInfo     *pQueueCreateInfos
             0,//1,// deviceLayers.size(),//0,
             nullptr,//&mgdLayer,//deviceLayers.data(),// nullptr,
-            2, // uint32_t enabledExtensionCount
-            &deviceExts[0], // const char * const *ppEnabledExtensionNames
+            static_cast<uint32_t>(deviceExts.size()), // uint32_t enabledExtensionCount
+            deviceExts.data(), // const char * const *ppEnabledExtensionNames
             &features
         };
         //
@@ -421,12 +453,28 @@ namespace ugi {
             auto device = new Device( m_deviceDescriptorVk, deviceVK, vmaAllocator );
             device->_graphicsCommandQueues = std::move(graphicsCommandQueues);
             device->_transferCommandQueues = std::move(transferCommandQueues);
+            if( m_deviceDescriptorVk.timelineSemaphore ) {
+                for( auto queue : device->_graphicsCommandQueues ) {
+                    queue->initializeTimeline(deviceVK);
+                }
+                for( auto queue : device->_transferCommandQueues ) {
+                    queue->initializeTimeline(deviceVK);
+                }
+            }
             // create render pass object manager
             device->_renderPassObjectManager = new RenderPassObjectManager();
             // create descriptor set allocator
             auto descriptorSetAllocator = new DescriptorSetAllocator();
             descriptorSetAllocator->initialize(deviceVK);
             device->_descriptorSetAllocator = descriptorSetAllocator;
+            // create pipeline cache, load the blob saved by last run
+            auto pipelineCache = new PipelineCache();
+            pipelineCache->initialize(deviceVK, m_deviceDescriptorVk.properties, m_deviceDescriptorVk.archive, m_deviceDescriptorVk.pipelineCreationFeedback);
+            device->_pipelineCache = pipelineCache;
+            // variant compilation is sporadic, a couple of threads is enough
+            auto compileWorkers = new WorkerPool();
+            compileWorkers->initialize(2);
+            device->_pipelineCompileWorkers = compileWorkers;
             return device;
         }
         throw DeviceCreationException( DeviceCreationException::EXCEPTION_CREATE_DEVICE_FAILED);
@@ -574,8 +622,8 @@ namespace ugi {
         return RenderPass::CreateRenderPass( this, rpdesc, colors, ds, colorViews, dsView);
     }
 
-    UniformAllocator* Device::createUniformAllocator() {
-        auto allocator = UniformAllocator::createUniformAllocator(this);
+    UniformAllocator* Device::createUniformAllocator(uint32_t maxAllocationSize) {
+        auto allocator = UniformAllocator::createUniformAllocator(this, maxAllocationSize);
         return allocator;
     }
 
@@ -594,4 +642,35 @@ namespace ugi {
     void Device::destroyFence( Fence* fence ) {
     }
 
+    bool Device::savePipelineCache() {
+        if(!_pipelineCache) {
+            return false;
+        }
+        if(_pipelineCompileWorkers) { // 合并 worker cache 之前编译线程要停下来
+            _pipelineCompileWorkers->waitIdle();
+        }
+        return _pipelineCache->save();
+    }
+
+    void Device::release() {
+        // 排队中的变体编译捕获了 pipeline 和 device，先让它们跑完再停线程，之后才能销毁 cache
+        if(_pipelineCompileWorkers) {
+            _pipelineCompileWorkers->destroy();
+            delete _pipelineCompileWorkers;
+            _pipelineCompileWorkers = nullptr;
+        }
+        if(_pipelineCache) {
+            _pipelineCache->destroy();
+            delete _pipelineCache;
+            _pipelineCache = nullptr;
+        }
+        // 异步加载的 item 已经在 render context release 里全部退休，timeline 不会再被查询
+        for(auto queue: _graphicsCommandQueues) {
+            queue->destroyTimeline();
+        }
+        for(auto queue: _transferCommandQueues) {
+            queue->destroyTimeline();
+        }
+    }
+
 }
\ No newline at end of file
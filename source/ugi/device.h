@@ -24,7 +24,9 @@ namespace ugi {
         VkPhysicalDevice                        physicalDevice;
         VkSurfaceKHR                            surface;
         comm::IArchive*                         archive;
-        //
+        uint32_t                                instanceApiVersion;     ///> 创建 instance 时实际使用的版本
+        bool                                    timelineSemaphore;      ///> 设备是否开启了 timeline semaphore
+        bool                                    pipelineCreationFeedback;   ///> 设备是否开启了 VK_EXT_pipeline_creation_feedback
         //
         uint32_t                                queueFamilyCount;
         uint32_t                                queueFamilyIndices[MaxQueueCountSupport];
@@ -34,7 +36,10 @@ namespace ugi {
             , properties({})
             , physicalDevice(nullptr)
             , surface (0)
-            , archive(nullptr) {
+            , archive(nullptr)
+            , instanceApiVersion(VK_MAKE_VERSION(1, 0, 0))
+            , timelineSemaphore(false)
+            , pipelineCreationFeedback(false) {
         }
         
         DeviceDescriptorVulkan( const device_descriptor_t& _baseDesc )
@@ -44,6 +49,9 @@ namespace ugi {
             , physicalDevice(nullptr)
             , surface(0)
             , archive(nullptr)
+            , instanceApiVersion(VK_MAKE_VERSION(1, 0, 0))
+            , timelineSemaphore(false)
+            , pipelineCreationFeedback(false)
             , queueFamilyCount(0)
             , queueFamilyIndices{}
         {
@@ -62,6 +70,8 @@ namespace ugi {
         
         RenderPassObjectManager*            _renderPassObjectManager;
         DescriptorSetAllocator*             _descriptorSetAllocator;
+        PipelineCache*                      _pipelineCache;
+        WorkerPool*                         _pipelineCompileWorkers;            ///> pipeline 变体后台编译线程
         FlightCycleInvoker                  _cycleInvoker;
         //
         Device() {
@@ -77,6 +87,9 @@ namespace ugi {
             , _device( _device )
             , _vmaAllocator( _vmaAllocator ) 
             , _renderPassObjectManager( nullptr ) 
+            , _descriptorSetAllocator( nullptr )
+            , _pipelineCache( nullptr )
+            , _pipelineCompileWorkers( nullptr )
         {
         }
 
@@ -121,7 +134,7 @@ namespace ugi {
         Swapchain* createSwapchain( void* wnd, AttachmentLoadAction loadAction = AttachmentLoadAction::Clear );
         GraphicsPipeline* createGraphicsPipeline( const pipeline_desc_t& pipelineDescription );
         ComputePipeline* createComputePipeline( const pipeline_desc_t& pipelineDescription );
-        UniformAllocator* createUniformAllocator();
+        UniformAllocator* createUniformAllocator(uint32_t maxAllocationSize = 0x10000); // 0x10000 = UniformAllocator::MaxAllocationSize
         // DescriptorSetAllocator* createDescriptorSetAllocator() const;
 
         void destroyRenderPass( IRenderPass* renderPass );
@@ -134,6 +147,14 @@ namespace ugi {
         DescriptorSetAllocator* descriptorSetAllocator() const {
             return _descriptorSetAllocator;
         }
+        PipelineCache* pipelineCache() const {
+            return _pipelineCache;
+        }
+        bool savePipelineCache();
+        void release(); // device idle 之后调用，释放 device 自己持有的对象（pipeline cache 等）
+        WorkerPool* pipelineCompileWorkers() const {
+            return _pipelineCompileWorkers;
+        }
         ///> --------------- Hash Function For Graphics Objects ------------------
         template< class T >
         uint64_t hashObject();
@@ -46,6 +46,20 @@ namespace ugi {
             }
             tasks.clear();
         }
+
+        /// <summary>
+        /// 退出时在 device idle 之后调用，不等帧数，执行所有还没到期的回调
+        /// </summary>
+        void flush() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (int i = 1; i <= kMaxFlightCount; ++i) {
+                auto& tasks = ring_[(writeIndex_ + i) % kMaxFlightCount];
+                for (auto& task : tasks) {
+                    task();
+                }
+                tasks.clear();
+            }
+        }
     };
 
 }
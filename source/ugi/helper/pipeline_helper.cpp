@@ -1,5 +1,7 @@
 #include "pipeline_helper.h"
 #include <LightWeightCommon/io/archive.h>
+#include <json.hpp>
+#include <string>
 
 namespace ugi {
 
@@ -20,6 +22,55 @@ namespace ugi {
         return rst;
     }
 
+    std::vector<raster_state_t> PipelineHelper::LoadRasterStateManifest(comm::IStream* stream) {
+        std::vector<raster_state_t> states;
+        if(!stream) {
+            return states;
+        }
+        std::string text;
+        text.resize(stream->size());
+        stream->read(text.data(), stream->size());
+        nlohmann::json js = nlohmann::json::parse(text, nullptr, false);
+        if(js.is_discarded() || !js.is_object() || !js.contains("variants") || !js["variants"].is_array()) {
+            return states;
+        }
+        // 解析用的是不抛异常的版本，字段类型不对也不能抛，当作没写
+        auto readString = [](nlohmann::json const& item, char const* key, std::string& out) {
+            auto iter = item.find(key);
+            if(iter == item.end() || !iter->is_string()) {
+                return false;
+            }
+            out = iter->get<std::string>();
+            return true;
+        };
+        for(auto const& item: js["variants"]) {
+            if(!item.is_object()) {
+                continue;
+            }
+            raster_state_t state;
+            std::string mode;
+            if(readString(item, "polygonMode", mode)) {
+                state.polygonMode = mode == "Line" ? polygon_mode_t::Line : (mode == "Point" ? polygon_mode_t::Point : polygon_mode_t::Fill);
+            }
+            if(readString(item, "cullMode", mode)) {
+                state.cullMode = mode == "Front" ? cull_mode_t::Front : (mode == "Back" ? cull_mode_t::Back : cull_mode_t::None);
+            }
+            if(readString(item, "frontFace", mode)) {
+                state.frontFace = mode == "CounterClockWise" ? front_face_t::CounterClockWise : front_face_t::ClockWise;
+            }
+            auto bias = item.find("depthBias");
+            if(bias != item.end() && bias->is_array() && bias->size() == 3
+                && (*bias)[0].is_number() && (*bias)[1].is_number() && (*bias)[2].is_number()) {
+                state.depthBiasEnabled = 1;
+                state.depthBiasConstantFactor = (*bias)[0].get<float>();
+                state.depthBiasSlopeFactor = (*bias)[1].get<float>();
+                state.depthBiasClamp = (*bias)[2].get<float>();
+            }
+            states.push_back(state);
+        }
+        return states;
+    }
+
     PipelineHelper::PipelineHelper(PipelineHelper && other) {
         desc_ = other.desc_;
         data_ = other.data_;
@@ -17,7 +17,14 @@ namespace ugi {
             , data_(nullptr)
         {}
         pipeline_desc_t const& desc() const { return desc_; }
+        bool valid() const { return data_ != nullptr; }
         static PipelineHelper FromIStream(comm::IStream* stream);
+        /**
+         * @brief 读取 raster state 变体清单，用于 GraphicsPipeline::prewarm
+         *  { "variants": [ { "polygonMode": "Line", "cullMode": "Back", "frontFace": "CounterClockWise", "depthBias": [constant, slope, clamp] } ] }
+         *  缺省字段取 raster_state_t 的默认值
+         */
+        static std::vector<raster_state_t> LoadRasterStateManifest(comm::IStream* stream);
         ~PipelineHelper() {
             if(data_) {
                 free(data_);
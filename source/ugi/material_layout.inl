@@ -4,7 +4,7 @@
 namespace ugi {
 
     static inline bool isDynamicBufferType( res_descriptor_type type ) {
-        if( type == res_descriptor_type::UniformBuffer ) {
+        if( type == res_descriptor_type::UniformBuffer || type == res_descriptor_type::DynamicStorageBuffer ) {
             return true;
         }
         return false;
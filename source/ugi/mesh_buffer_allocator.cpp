@@ -1,6 +1,7 @@
 #include "mesh_buffer_allocator.h"
 #include <device.h>
 #include <command_buffer.h>
+#include <gpu_retire_manager.h>
 #include <cassert>
 
 namespace ugi {
@@ -51,40 +52,55 @@ namespace ugi {
         }
         poolSize_ = poolSize;
         device_ = device;
-        rearrangeCounter_ = 0;
         auto rst = createNewBufferBlock_(poolSize);
         return rst;
     }
 
-    std::pair<mesh_buffer_handle_t, mesh_buffer_alloc_t> MeshBufferAllocator::alloc(uint32_t size) {
-        // TODO: 添加处理重排时的逻辑
-        std::unique_lock<std::mutex> lock(mutex_);
-        uint16_t blockIndex = 0;
-        if(rearrangeCounter_) {
-            blockIndex = 1; // 跳过第一个block，因这重排之后，第一个block就是重排之后的，它现在还不能立即使用。
-        }
+    mesh_buffer_alloc_t MeshBufferAllocator::allocInBlocks_(uint32_t size) {
         mesh_buffer_alloc_t alloc = {};
-        for(blockIndex = 0; blockIndex<bufferBlocks_.size(); ++blockIndex) {
+        for(uint32_t blockIndex = 0; blockIndex<bufferBlocks_.size(); ++blockIndex) {
             auto& block = bufferBlocks_[blockIndex];
+            if(blockIndex == evacuatingBlock_ || !block.buffer) { // 正在搬空的和已经退役的不能再往里分配
+                continue;
+            }
             auto offset = block.scheduler.alloc(size);
             if(offset == ~0) {
                 // alloc failed, try next pool
                 continue;
-            } else {
-                alloc.buffer = bufferBlocks_[blockIndex].buffer;
-                alloc.length = size;
-                alloc.offset = offset;
-                alloc.blockIndex = blockIndex;
-                break;
             }
+            alloc.buffer = block.buffer;
+            alloc.length = size;
+            alloc.offset = offset;
+            alloc.blockIndex = blockIndex;
+            block.usedBytes += size;
+            ++block.allocCount;
+            break;
+        }
+        return alloc;
+    }
+
+    void MeshBufferAllocator::freeInBlock_(mesh_buffer_alloc_t const& alloc) {
+        auto& block = bufferBlocks_[alloc.blockIndex];
+        bool rst = block.scheduler.free(alloc.offset);
+        assert(rst);
+        if(rst) {
+            block.usedBytes -= alloc.length;
+            --block.allocCount;
         }
+    }
+
+    std::pair<mesh_buffer_handle_t, mesh_buffer_alloc_t> MeshBufferAllocator::alloc(uint32_t size) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        mesh_buffer_alloc_t alloc = allocInBlocks_(size);
         if(!alloc.buffer) { // alloc failed, need a new pool
             bool rst = createNewBufferBlock_(size);
             if(!rst) {
                 return { mesh_buffer_handle_invalid, {} };
             }
-            auto offset = bufferBlocks_.back().scheduler.alloc(size);
-            alloc =  {bufferBlocks_.back().buffer, offset, size, (uint32_t)(bufferBlocks_.size() - 1)};
+            alloc = allocInBlocks_(size);
+            if(!alloc.buffer) {
+                return { mesh_buffer_handle_invalid, {} };
+            }
         }
         mesh_buffer_handle_t id = allocID_();
         bufferAllocs_[id] = alloc;
@@ -92,7 +108,7 @@ namespace ugi {
     }
 
     uint32_t MeshBufferAllocator::allocID_() {
-        if (0 == rearrangeCounter_ && freeIDs_.size()) {
+        if (freeIDs_.size()) {
             auto rst = freeIDs_.back();
             freeIDs_.pop_back();
             return rst;
@@ -103,28 +119,108 @@ namespace ugi {
     }
 
     mesh_buffer_alloc_t MeshBufferAllocator::deref(mesh_buffer_handle_t id) const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return deref_(id);
+    }
+
+    mesh_buffer_alloc_t MeshBufferAllocator::deref_(mesh_buffer_handle_t id) const {
         if(id < bufferAllocs_.size()) {
             return bufferAllocs_[id];
         }
         return {};
     }
 
+    uint32_t MeshBufferAllocator::writeTargets(mesh_buffer_handle_t id, mesh_buffer_alloc_t (&targets)[2]) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if(id >= bufferAllocs_.size() || !bufferAllocs_[id].buffer) {
+            return 0;
+        }
+        uint32_t count = 0;
+        targets[count++] = bufferAllocs_[id];
+        if(bufferAllocs_[id].moving) {
+            for(auto const& move: pendingMoves_) {
+                if(move.handle == id && !move.cancelled) {
+                    targets[count++] = move.dst;
+                    break;
+                }
+            }
+        }
+        return count;
+    }
+
+    void MeshBufferAllocator::markUploaded(mesh_buffer_handle_t id) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if(id < bufferAllocs_.size() && bufferAllocs_[id].buffer) {
+            bufferAllocs_[id].uploaded = 1;
+        }
+    }
+
     bool MeshBufferAllocator::free(mesh_buffer_handle_t id) {
-        if(0 == rearrangeCounter_) {
-            std::unique_lock<std::mutex> lock(mutex_);
-            auto alloc = deref(id);
-            if(alloc.buffer && bufferBlocks_[alloc.blockIndex].scheduler.free(alloc.offset)) {
-                freeIDs_.push_back(id);
-                bufferAllocs_[id] = {};
-                return true;
-            } else {
-                assert(false);
-                return false; // alloc is invalid
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto alloc = deref_(id);
+        if(!alloc.buffer) {
+            assert(false);
+            return false; // alloc is invalid
+        }
+        if(alloc.moving) { // 正在搬，新旧两份都可能还在被 GPU 访问，等切换的时候一起释放，id 也那时再回收
+            for(auto& move: pendingMoves_) {
+                if(move.handle == id) {
+                    move.cancelled = true;
+                    break;
+                }
             }
-        } else { // 重分配状态下不能立即回收，需要等待整理完再回收
-            destroyRecords_.push_back(id);
+            bufferAllocs_[id] = {};
             return true;
         }
+        freeInBlock_(alloc);
+        freeIDs_.push_back(id);
+        bufferAllocs_[id] = {};
+        return true;
+    }
+
+    uint16_t MeshBufferAllocator::pickEvacuateBlock_() const {
+        uint32_t liveBlockCount = 0;
+        size_t freeBytesTotal = 0;
+        for(auto const& block: bufferBlocks_) {
+            if(block.buffer) {
+                ++liveBlockCount;
+                freeBytesTotal += block.bufferSize - block.usedBytes;
+            }
+        }
+        if(liveBlockCount < 2) {
+            return InvalidBlockIndex;
+        }
+        uint16_t candidate = InvalidBlockIndex;
+        double minOccupancy = 1.0 / DefragmentOccupancyDivisor;
+        for(uint32_t i = 0; i<bufferBlocks_.size(); ++i) {
+            auto const& block = bufferBlocks_[i];
+            if(!block.buffer) {
+                continue;
+            }
+            double occupancy = (double)block.usedBytes / block.bufferSize;
+            size_t otherFreeBytes = freeBytesTotal - (block.bufferSize - block.usedBytes);
+            // 其它 block 的空闲空间要足够宽裕，否则 tlsf 碎片会让搬迁半途而废
+            if(occupancy < minOccupancy && otherFreeBytes >= block.usedBytes * 2) {
+                minOccupancy = occupancy;
+                candidate = (uint16_t)i;
+            }
+        }
+        return candidate;
+    }
+
+    void MeshBufferAllocator::retireBlock_(uint16_t blockIndex) {
+        auto& block = bufferBlocks_[blockIndex];
+        VmaAllocator vma = device_->vmaAllocator();
+        VkBuffer buffer = block.buffer;
+        VmaAllocation allocation = block.allocation;
+        // 前几帧的 draw 可能还在读这个 buffer
+        GPURetireManager::Instance()->retire([vma, buffer, allocation]() {
+            vmaDestroyBuffer(vma, buffer, allocation);
+        });
+        totalSize_ -= (uint32_t)block.bufferSize;
+        block.buffer = VK_NULL_HANDLE;
+        block.allocation = VK_NULL_HANDLE;
+        ++retiredBlocks_;
     }
 
     struct buffer_cpy_t {
@@ -135,90 +231,115 @@ namespace ugi {
     };
     static_assert(std::is_pod_v<buffer_cpy_t>, "");
 
-    void MeshBufferAllocator::rearrangeBufferAlloc(ResourceCommandEncoder* encoder) {
-        if(rearrangeCounter_) {
-            return;
-        }
-        /**
-         * @brief 先把原来所有的block备份到一个临时数组里，虽然接下来一帧或者两帧会用到，没有关系，我们暂时不删除它，比如，三缓冲模式，我们在两帧之后再删除，一定没问题。
-         * 而我们合成后的buffer也是不能立即使用的！但是可以直接放`bufferBlocks_`里，没关系的。
-         * 因为buffer更新在多队列里搞的话，需要非常严格的同步，所以这件事我们还是放渲染线程的queue里去做。
-         * 这里会产生一些多重缓冲数据同步/有效性问题，所以这里的逻辑需要特别注意。
-         */
+    void MeshBufferAllocator::defragment(ResourceCommandEncoder* encoder, uint32_t maxBytes) {
         std::unique_lock<std::mutex> lock(mutex_);
-        assert(rearrangingBlocks_.empty() && "must be empty");
-        assert(rearrangingAllocs_.empty() && "must be empty");
-        rearrangeCounter_ = MaxFlightCount;
-        rearrangingBlocks_ = std::move(bufferBlocks_); // move blocks to temp vector
+        if(evacuatingBlock_ == InvalidBlockIndex) {
+            evacuatingBlock_ = pickEvacuateBlock_();
+            evacuateCursor_ = 0;
+            if(evacuatingBlock_ == InvalidBlockIndex) {
+                return;
+            }
+        }
         std::vector<buffer_cpy_t> copies;
-        uint32_t totalSize = 0;
-        for(auto& alloc_t: bufferAllocs_) { // 原来的alloc保持不变
-            if(alloc_t.buffer) {
-                buffer_cpy_t cpy = { VK_NULL_HANDLE,alloc_t.buffer, buffer_subres_t{totalSize, alloc_t.length}, buffer_subres_t{alloc_t.offset, alloc_t.length} };
-                copies.push_back(cpy); // buffer 后续再更新
-                totalSize += alloc_t.length;
-                mesh_buffer_alloc_t alloc = {VK_NULL_HANDLE, totalSize, alloc_t.length, 0, 1};
-                rearrangingAllocs_.push_back(alloc); // buffer 后续更新
-                totalSize = (totalSize+15)&(~15);
-            } else {
-                rearrangingAllocs_.emplace_back(); // 这里的alloc是空的
+        uint32_t movedBytes = 0;
+        for(; evacuateCursor_<bufferAllocs_.size(); ++evacuateCursor_) {
+            auto& alloc = bufferAllocs_[evacuateCursor_];
+            // 还没上传完的不能搬，下一轮扫描再说
+            if(!alloc.buffer || alloc.blockIndex != evacuatingBlock_ || !alloc.uploaded || alloc.moving) {
+                continue;
             }
+            if(movedBytes && movedBytes + alloc.length > maxBytes) {
+                break;
+            }
+            mesh_buffer_alloc_t dst = allocInBlocks_(alloc.length);
+            if(!dst.buffer) { // 其它 block 放不下了，放弃这个 block，已经搬走的照常切换
+                evacuatingBlock_ = InvalidBlockIndex;
+                break;
+            }
+            dst.uploaded = 1;
+            copies.push_back({ dst.buffer, alloc.buffer, buffer_subres_t{dst.offset, dst.length}, buffer_subres_t{alloc.offset, alloc.length} });
+            pendingMoves_.push_back({ (mesh_buffer_handle_t)evacuateCursor_, alloc, dst, MaxFlightCount, false });
+            alloc.moving = 1;
+            movedBytes += alloc.length;
         }
-        auto rst = createNewBufferBlock_(totalSize);
-        assert(rst);
-        auto& newBlock = bufferBlocks_.back();
-        // buffer barrier，因为buffer不会再使用了，所以不需要在传输完再加barrier了
-        // 同理，新的buffer也不用加barrier同步，因为不需要，传输前传输后都不需要！想明白了吗?
-        for(auto const& block: rearrangingBlocks_) {
+        if(evacuateCursor_ >= bufferAllocs_.size()) { // 扫描一遍了，剩下的（没上传完的）下一帧从头再扫
+            evacuateCursor_ = 0;
+        }
+        if(copies.empty()) {
+            return;
+        }
+        // 旧位置在 fence 之前还会被读，源数据只读不需要 barrier；目标区域写完之后要对顶点读取可见
+        for(auto const& copy: copies) {
+            encoder->copyBuffer(copy.dst, copy.src, copy.dstRes, copy.srcRes);
+        }
+        for(auto const& copy: copies) {
             encoder->bufferBarrier(
-                block.buffer, 
-                ResourceAccessType::TransferSource, 
+                copy.dst,
+                ResourceAccessType::VertexAttributeRead,
+                pipeline_stage_t::Transfer, StageAccess::Write,
                 pipeline_stage_t::VertexShading, StageAccess::Read,
-                pipeline_stage_t::Transfer, StageAccess::Read,
-                buffer_subres_t{0, (uint32_t)block.bufferSize}
+                copy.dstRes
             );
         }
-        // 更新相关数据
-        for(auto& alloc: rearrangingAllocs_) { // allocation info
-            if(alloc.length) {
-                alloc.buffer = newBlock.buffer;
+    }
+
+    mesh_buffer_stat_t MeshBufferAllocator::stat() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        mesh_buffer_stat_t rst = {}; {
+            for(auto const& block: bufferBlocks_) {
+                if(block.buffer) {
+                    ++rst.blockCount;
+                    rst.totalBytes += block.bufferSize;
+                    rst.usedBytes += block.usedBytes;
+                }
             }
+            for(auto const& move: pendingMoves_) {
+                rst.movingBytes += move.dst.length;
+            }
+            rst.retiredBlocks = retiredBlocks_;
         }
-        // 写入复制指令等待送到队列执行
-        for(auto& copy: copies) { // copy operation info
-            copy.dst = newBlock.buffer;
-            encoder->copyBuffer(copy.dst, copy.src, copy.dstRes, copy.srcRes);
-        }
+        return rst;
     }
 
     /**
-     * @brief 主要是要处理 rearrange 的问题，期间删除buffer的时候，在onFrameTick里需要特别处理一些东西
+     * @brief 处理整理的收尾：copy 所在 flight 的 fence 过了之后切换 handle，
+     *  旧位置再等 MaxFlightCount 帧（切换前提交的 draw 都结束了）才释放，搬空的 block 退役
      * 
      */
     void MeshBufferAllocator::onFrameTick() {
-        if(rearrangeCounter_) { // deal rearrange stuffs
-            --rearrangeCounter_;
-            if(0 == rearrangeCounter_) {
-                // 处理所有整理后的allocs
-                for(size_t i = 0; i<rearrangingAllocs_.size(); ++i) {
-                    auto& alloc = rearrangingAllocs_[i];
-                    // 重新整理blockIndex
-                    for(size_t blockIdx = 0; blockIdx<bufferBlocks_.size(); ++blockIdx) {
-                        if(alloc.buffer && alloc.buffer == bufferBlocks_[blockIdx].buffer) {
-                            alloc.blockIndex = blockIdx;
-                        }
-                    }
-                }
-                rearrangingAllocs_.clear();
-                // 销毁所有 被排列过的 buffer
-                for(auto const& block: rearrangingBlocks_) {
-                    vkDestroyBuffer(device_->device(), block.buffer, nullptr); // destroy them
-                }
-                rearrangingBlocks_.clear();
-                // 回收所有期间删除的buffer
-                for(auto const& handle: destroyRecords_) {
-                    this->free(handle);// destroy them
-                }
+        std::unique_lock<std::mutex> lock(mutex_);
+        size_t writeIndex = 0;
+        for(size_t i = 0; i<retiringAllocs_.size(); ++i) {
+            auto& retiring = retiringAllocs_[i];
+            if(--retiring.frames) {
+                retiringAllocs_[writeIndex++] = retiring;
+                continue;
+            }
+            freeInBlock_(retiring.alloc);
+        }
+        retiringAllocs_.resize(writeIndex);
+        writeIndex = 0;
+        for(size_t i = 0; i<pendingMoves_.size(); ++i) {
+            auto& move = pendingMoves_[i];
+            if(--move.frames) {
+                pendingMoves_[writeIndex++] = move;
+                continue;
+            }
+            // copy 已经完成；新位置从没被 draw 读过，旧位置还可能被前几帧读
+            if(move.cancelled) {
+                freeInBlock_(move.dst);
+                freeIDs_.push_back(move.handle);
+            } else {
+                bufferAllocs_[move.handle] = move.dst;
+            }
+            retiringAllocs_.push_back({ move.src, MaxFlightCount });
+        }
+        pendingMoves_.resize(writeIndex);
+        if(evacuatingBlock_ != InvalidBlockIndex && pendingMoves_.empty() && retiringAllocs_.empty()) {
+            auto const& block = bufferBlocks_[evacuatingBlock_];
+            if(!block.allocCount) {
+                retireBlock_(evacuatingBlock_);
+                evacuatingBlock_ = InvalidBlockIndex;
             }
         }
     }
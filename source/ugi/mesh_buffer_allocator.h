@@ -28,7 +28,16 @@ namespace ugi {
         uint32_t offset;
         uint32_t length;
         uint32_t blockIndex:16;
-        uint32_t uploaded:1;
+        uint32_t uploaded:1;        ///> 数据已经传到 GPU 上了，整理时才能搬
+        uint32_t moving:1;          ///> 正在被整理搬到别的 block，等 fence 之后才切过去
+    };
+
+    struct mesh_buffer_stat_t {
+        uint32_t    blockCount;     ///> 存活的 block 数
+        uint64_t    totalBytes;
+        uint64_t    usedBytes;
+        uint64_t    movingBytes;    ///> 已经复制、等待 fence 切换的字节数
+        uint32_t    retiredBlocks;  ///> 累计整理空后退役的 block 数
     };
 
     using mesh_buffer_handle_t = uint32_t;
@@ -40,18 +49,24 @@ namespace ugi {
         VmaAllocation           allocation;     // vma allocation
         size_t                  bufferSize;     // size of buffer block
         comm::tlsf::Pool        scheduler;      // tlsf scheduler
+        size_t                  usedBytes;      // 存活 allocation 的字节数，用来衡量碎片/占用率
+        uint32_t                allocCount;
         //
         buffer_block_t(VkBuffer buf, VmaAllocation alloc, size_t size)
             : buffer(buf)
             , allocation(alloc)
             , bufferSize(size)
             , scheduler(size)
+            , usedBytes(0)
+            , allocCount(0)
         {}
         buffer_block_t(buffer_block_t && block)
             : buffer(block.buffer)
             , allocation(block.allocation)
             , bufferSize(block.bufferSize)
             , scheduler(std::move(block.scheduler))
+            , usedBytes(block.usedBytes)
+            , allocCount(block.allocCount)
         {}
     };
 
@@ -59,9 +74,28 @@ namespace ugi {
     // handle -> alloc -> block
 
     // allocator 可以以主线程里用，也可以在子线程里用，都不影响GPU数据上传的状态在渲染线程同步
+    // 整理是增量的：每帧挑一个占用率很低的 block，把里面的 allocation 搬一部分到其它 block，
+    // 复制指令和渲染在同一个队列里，等这一帧的 fence 过了再把 handle 切到新位置，
+    // 切换之前提交的帧还可能在读旧位置，旧位置再等 MaxFlightCount 帧才释放，
+    // block 搬空之后交给 GPURetireManager 延迟销毁
     class MeshBufferAllocator {
+    public:
+        static constexpr uint32_t DefragmentBytesPerFrame = 256 * 1024;
+        static constexpr uint32_t DefragmentOccupancyDivisor = 4;  // 占用率低于 1/4 的 block 才会被整理
+        static constexpr uint16_t InvalidBlockIndex = 0xffff;
     private:
-        std::vector<buffer_block_t>                     bufferBlocks_;     // buffer pools 
+        struct pending_move_t {
+            mesh_buffer_handle_t    handle;
+            mesh_buffer_alloc_t     src;
+            mesh_buffer_alloc_t     dst;
+            uint32_t                frames;     // 还要等几帧，copy 所在的 flight fence 过了才能切
+            bool                    cancelled;  // 等待期间被 free 了
+        };
+        struct retiring_alloc_t {
+            mesh_buffer_alloc_t     alloc;      // 切换前的旧位置，切换前提交的帧可能还在读
+            uint32_t                frames;     // 再等 MaxFlightCount 帧才能还给 block
+        };
+        std::vector<buffer_block_t>                     bufferBlocks_;     // buffer pools，退役的 block buffer 为空，位置保留（blockIndex 不变）
         std::vector<mesh_buffer_alloc_t>                bufferAllocs_;
         std::vector<uint32_t>                           freeIDs_;
         size_t                                          allocationCount_;  // 
@@ -69,15 +103,21 @@ namespace ugi {
         uint32_t                                        poolSize_;
         uint32_t                                        totalSize_;
         //
-        std::atomic<uint8_t>                            rearrangeCounter_;
-        std::mutex                                      mutex_; // 这个allocator应用场景应该也只限于单线程，所以这里没啥用
-        // rearrange old buffer blocks
-        std::vector<buffer_block_t>                     rearrangingBlocks_;
-        std::vector<mesh_buffer_alloc_t>                rearrangingAllocs_;
-        std::vector<mesh_buffer_handle_t>               destroyRecords_;
+        mutable std::mutex                              mutex_;    // deref 也要加锁，Mesh::bind 可能和整理不在同一个线程
+        // incremental defragment
+        uint16_t                                        evacuatingBlock_;  // 正在被搬空的 block，分配时跳过它
+        uint32_t                                        evacuateCursor_;   // 扫描 bufferAllocs_ 的位置
+        std::vector<pending_move_t>                     pendingMoves_;
+        std::vector<retiring_alloc_t>                   retiringAllocs_;
+        uint32_t                                        retiredBlocks_;
     private:
         bool createNewBufferBlock_(uint32_t size);
         uint32_t allocID_();
+        mesh_buffer_alloc_t allocInBlocks_(uint32_t size);
+        void freeInBlock_(mesh_buffer_alloc_t const& alloc);
+        mesh_buffer_alloc_t deref_(mesh_buffer_handle_t handle) const; // 调用方持有 mutex_
+        uint16_t pickEvacuateBlock_() const;
+        void retireBlock_(uint16_t blockIndex);
     public:
         MeshBufferAllocator()
             : bufferBlocks_{}
@@ -85,14 +125,25 @@ namespace ugi {
             , freeIDs_{}
             , allocationCount_(0)
             , device_(nullptr)
-            , rearrangeCounter_(false)
+            , poolSize_(0)
+            , totalSize_(0)
+            , evacuatingBlock_(InvalidBlockIndex)
+            , evacuateCursor_(0)
+            , pendingMoves_{}
+            , retiringAllocs_{}
+            , retiredBlocks_(0)
         {}
         bool initialize(Device* device, uint32_t poolSize);
-        void rearrangeBufferAlloc(ResourceCommandEncoder* encoder); // 应该在每帧结束，要提交之前执行
+        // 应该在每帧开始、onFrameTick 之后，在渲染队列的 command buffer 里执行，每帧最多搬 maxBytes
+        void defragment(ResourceCommandEncoder* encoder, uint32_t maxBytes = DefragmentBytesPerFrame);
         std::pair<mesh_buffer_handle_t, mesh_buffer_alloc_t> alloc(uint32_t size);
         bool free(mesh_buffer_handle_t buf);
+        void markUploaded(mesh_buffer_handle_t handle);
         mesh_buffer_alloc_t deref(mesh_buffer_handle_t handle) const;
-        void onFrameTick(); // 应该在每帧开始时调用
+        // 原地改写数据时要写的位置：当前位置，正在整理搬迁的还有新位置（切换之后新位置才生效），返回个数
+        uint32_t writeTargets(mesh_buffer_handle_t handle, mesh_buffer_alloc_t (&targets)[2]);
+        mesh_buffer_stat_t stat();
+        void onFrameTick(); // 应该在每帧开始时调用（等待 flight fence 之后）
     }; // end class MeshBufferAllocator
 
 }
\ No newline at end of file
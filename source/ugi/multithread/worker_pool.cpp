@@ -0,0 +1,86 @@
+#include "worker_pool.h"
+
+namespace ugi {
+
+    WorkerPool::WorkerPool()
+        : _threads{}
+        , _tasks{}
+        , _runningCount(0)
+        , _exit(false)
+    {}
+
+    bool WorkerPool::initialize(uint32_t threadCount) {
+        if(_threads.size()) {
+            return false;
+        }
+        if(!threadCount) {
+            uint32_t hw = std::thread::hardware_concurrency();
+            threadCount = hw > 1 ? hw - 1 : 1;
+        }
+        _exit = false;
+        for(uint32_t i = 0; i<threadCount; ++i) {
+            _threads.emplace_back(&WorkerPool::_workerLoop, this);
+        }
+        return true;
+    }
+
+    void WorkerPool::_workerLoop() {
+        while(true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _taskCond.wait(lock, [this](){ return _exit || !_tasks.empty(); });
+                if(_tasks.empty()) { // _exit
+                    return;
+                }
+                task = std::move(_tasks.front());
+                _tasks.pop_front();
+                ++_runningCount;
+            }
+            task();
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                --_runningCount;
+                if(!_runningCount && _tasks.empty()) {
+                    _idleCond.notify_all();
+                }
+            }
+        }
+    }
+
+    void WorkerPool::post(std::function<void()>&& task) {
+        if(_threads.empty()) { // 没有工作线程就地执行
+            task();
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _tasks.push_back(std::move(task));
+        }
+        _taskCond.notify_one();
+    }
+
+    void WorkerPool::waitIdle() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _idleCond.wait(lock, [this](){ return _tasks.empty() && !_runningCount; });
+    }
+
+    void WorkerPool::destroy() {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _exit = true;
+        }
+        _taskCond.notify_all();
+        for(auto& thread: _threads) {
+            if(thread.joinable()) {
+                thread.join();
+            }
+        }
+        _threads.clear();
+    }
+
+    WorkerPool::~WorkerPool() {
+        destroy();
+    }
+
+}
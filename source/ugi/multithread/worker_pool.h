@@ -0,0 +1,41 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+namespace ugi {
+
+    /**
+     * @brief 固定线程数的工作线程池
+     *  任务是 `std::function<void()>`，先进先出，不保证跨线程的执行顺序
+     *  用于 pipeline 变体编译这类和渲染线程无强同步关系的后台任务
+     */
+    class WorkerPool {
+    private:
+        std::vector<std::thread>                _threads;
+        std::deque<std::function<void()>>       _tasks;
+        std::mutex                              _mutex;
+        std::condition_variable                 _taskCond;
+        std::condition_variable                 _idleCond;
+        uint32_t                                _runningCount;
+        bool                                    _exit;
+    private:
+        void _workerLoop();
+    public:
+        WorkerPool();
+        bool initialize(uint32_t threadCount = 0); // 0 : hardware_concurrency - 1
+        void post(std::function<void()>&& task);
+        void waitIdle();
+        uint32_t threadCount() const {
+            return (uint32_t)_threads.size();
+        }
+        void destroy();
+        ~WorkerPool();
+    };
+
+}
@@ -5,10 +5,13 @@
 #include <ugi_utility.h>
 #include <render_pass.h>
 #include <device.h>
+#include <pipeline_cache.h>
+#include <multithread/worker_pool.h>
 #include <descriptor_binder.h>
 #include <command_buffer.h>
 #include <render_components/pipeline_material.h>
 #include <material_layout.inl>
+#include <chrono>
 
 namespace ugi {
 
@@ -37,7 +40,14 @@ namespace ugi {
     }
 
     GraphicsPipeline::GraphicsPipeline() 
-        : _IAStateCreateInfo {}
+        : _pipelineTable {}
+        , _rasterKey {}
+        , _lastKey {}
+        , _lastPipeline(VK_NULL_HANDLE)
+        , _compileMode(pipeline_compile_mode_t::Synchronous)
+        , _compileWorkers(nullptr)
+        , _completedCount(0)
+        , _IAStateCreateInfo {}
         , _attachmnetBlendState {}
         , _renderTargetBlendStateCreateInfo {}
         , _multisampleStateCreateInfo {}
@@ -61,6 +71,7 @@ namespace ugi {
         _RSStateCreateInfo.depthBiasClamp = 0;
         _RSStateCreateInfo.depthBiasSlopeFactor = 0; 
         _RSStateCreateInfo.lineWidth = 1.0f;
+        _rasterKey.setRasterState(_RSStateCreateInfo);
     }
 
     VkPipelineLayout GetPipelineLayout(const MaterialLayout* argGroupLayout);
@@ -219,63 +230,189 @@ namespace ugi {
         return pipelinePtr;
     }
 
-    VkPipeline GraphicsPipeline::preparePipelineStateObject( UGIHash<APHash>& hasher, const RenderCommandEncoder* encoder ) 
+    VkPipeline GraphicsPipeline::_createVariant(variant_job_t const& job, bool onWorker) const {
+        // create info 拷贝一份，只替换与变体相关的部分，工作线程不会碰到渲染线程正在修改的成员
+        VkPipelineColorBlendStateCreateInfo blendState = _renderTargetBlendStateCreateInfo;
+        blendState.attachmentCount = job.colorAttachmentCount;
+        VkGraphicsPipelineCreateInfo createInfo = _pipelineCreateInfo;
+        createInfo.pColorBlendState = &blendState;
+        createInfo.pRasterizationState = &job.rasterState;
+        createInfo.renderPass = job.renderPass;
+        createInfo.subpass = job.subpass;
+        //
+        PipelineCache* cache = _device->pipelineCache();
+        VkPipelineCache vkCache = VK_NULL_HANDLE;
+        pipeline_creation_feedback_t feedback;
+        if(cache) {
+            vkCache = onWorker ? cache->workerCache() : (VkPipelineCache)*cache;
+            if(cache->creationFeedback()) {
+                createInfo.pNext = feedback.chain(createInfo.pNext, createInfo.stageCount);
+            }
+        }
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        auto start = std::chrono::steady_clock::now();
+        auto rst = vkCreateGraphicsPipelines( _device->device(), vkCache, 1, &createInfo, nullptr, &pipeline );
+        if( rst != VK_SUCCESS ) {
+            return VK_NULL_HANDLE;
+        }
+        if(cache) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            cache->recordCreation(feedback, (uint64_t)elapsed.count());
+        }
+        return pipeline;
+    }
+
+    void GraphicsPipeline::_registerVariant(pipeline_state_key_t const& key, VkPipeline pipeline) {
+        if(_pipelineTable.find(key)) { // 同步路径抢先创建过了
+            vkDestroyPipeline(_device->device(), pipeline, nullptr);
+            return;
+        }
+        _pipelineTable.insert(key, pipeline);
+        if(_fallbackTable.find(key.subpassHash) == _fallbackTable.end()) {
+            _fallbackTable[key.subpassHash] = pipeline;
+        }
+    }
+
+    void GraphicsPipeline::_postVariant(variant_job_t const& job) {
+        uint64_t hash = job.key.hash();
+        if(_pendingVariants.find(hash) != _pendingVariants.end()) {
+            return;
+        }
+        _pendingVariants.insert(hash);
+        _compileWorkers->post([this, job]() {
+            VkPipeline pipeline = _createVariant(job, true);
+            std::unique_lock<std::mutex> lock(_completedMutex);
+            _completedVariants.push_back({job.key, pipeline});
+            _completedCount.store((uint32_t)_completedVariants.size(), std::memory_order_release);
+        });
+    }
+
+    void GraphicsPipeline::_collectCompletedVariants() {
+        std::vector<variant_result_t> completed;
+        {
+            std::unique_lock<std::mutex> lock(_completedMutex);
+            completed.swap(_completedVariants);
+            _completedCount.store(0, std::memory_order_release);
+        }
+        for(auto const& result: completed) {
+            _pendingVariants.erase(result.key.hash());
+            if(result.pipeline) { // 编译失败的不登记，下次 bind 会重新投递
+                _registerVariant(result.key, result.pipeline);
+            }
+        }
+    }
+
+    VkPipeline GraphicsPipeline::preparePipelineStateObject( pipeline_state_key_t const& key, const RenderCommandEncoder* encoder ) 
     {
+        if(_completedCount.load(std::memory_order_acquire)) {
+            _collectCompletedVariants();
+        }
+        VkPipeline pipeline = _pipelineTable.find(key);
+        if(pipeline) {
+            _lastKey = key;
+            _lastPipeline = pipeline;
+            return pipeline;
+        }
         const IRenderPass* renderPass = encoder->renderPass();
         uint32_t currentSubpass = encoder->subpass();
-        uint64_t subpassHash = renderPass->subpassHash(currentSubpass);
-        //
-        hasher.hashPOD(subpassHash);
-        uint64_t hashValue = hasher;
-        // 
-        auto iter = this->_pipelineTable.find( hashValue );
-        if( iter != _pipelineTable.end()) {
-            return iter->second;
+        variant_job_t job; {
+            job.key = key;
+            job.renderPass = renderPass->renderPass();
+            job.subpass = currentSubpass;
+            job.colorAttachmentCount = renderPass->subpassColorAttachmentCount(currentSubpass);
+            job.rasterState = _RSStateCreateInfo;
+        }
+        if(_compileMode != pipeline_compile_mode_t::Synchronous && _compileWorkers) {
+            auto fallback = _fallbackTable.find(key.subpassHash);
+            bool hasFallback = fallback != _fallbackTable.end();
+            if(_compileMode == pipeline_compile_mode_t::AsyncSkipDraw) {
+                _postVariant(job);
+                return VK_NULL_HANDLE;
+            }
+            if(hasFallback) { // 替代的 pipeline 不记入 _lastKey，变体编译好之后才能切换过去
+                _postVariant(job);
+                return fallback->second;
+            }
+            // 这个 subpass 下还没有任何可以顶替的 pipeline，只能同步创建
         }
-        VkPipeline pipeline;
-        // 配置 pipeline create info
-        _renderTargetBlendStateCreateInfo.attachmentCount = renderPass->subpassColorAttachmentCount(currentSubpass);
-        _pipelineCreateInfo.renderPass = renderPass->renderPass();
-        _pipelineCreateInfo.subpass = currentSubpass;
         // 创建 pipeline
-        auto rst = vkCreateGraphicsPipelines( encoder->commandBuffer()->device(), VK_NULL_HANDLE, 1, &_pipelineCreateInfo, nullptr, &pipeline );
-        if( rst != VK_SUCCESS ) {
+        pipeline = _createVariant(job, false);
+        if( pipeline == VK_NULL_HANDLE ) {
             return VK_NULL_HANDLE;
         }
-        _pipelineTable[hashValue] = pipeline;
+        _registerVariant(key, pipeline);
+        _lastKey = key;
+        _lastPipeline = pipeline;
         return pipeline;
     }
 
+    void GraphicsPipeline::_fillRasterizationState( VkPipelineRasterizationStateCreateInfo& info, const raster_state_t& _state ) {
+        info.polygonMode = polygonModeToVk(_state.polygonMode); 
+        info.cullMode = cullModeToVk(_state.cullMode); 
+        info.frontFace = frontFaceToVk(_state.frontFace); 
+        info.depthClampEnable = _state.depthBiasEnabled; 
+        info.depthBiasEnable= _state.depthBiasEnabled; 
+        info.depthBiasConstantFactor = _state.depthBiasConstantFactor;
+        info.depthBiasClamp = _state.depthBiasClamp;
+        info.depthBiasSlopeFactor = _state.depthBiasSlopeFactor;
+    }
+
     void GraphicsPipeline::setRasterizationState( const raster_state_t& _state ) {
-        _RSStateCreateInfo.polygonMode = polygonModeToVk(_state.polygonMode); 
-        _RSStateCreateInfo.cullMode = cullModeToVk(_state.cullMode); 
-        _RSStateCreateInfo.frontFace = frontFaceToVk(_state.frontFace); 
-        _RSStateCreateInfo.depthClampEnable = _state.depthBiasEnabled; 
-        _RSStateCreateInfo.depthBiasEnable= _state.depthBiasEnabled; 
-        _RSStateCreateInfo.depthBiasConstantFactor = _state.depthBiasConstantFactor;
-        _RSStateCreateInfo.depthBiasClamp = _state.depthBiasClamp;
-        _RSStateCreateInfo.depthBiasSlopeFactor = _state.depthBiasSlopeFactor;
+        _fillRasterizationState(_RSStateCreateInfo, _state);
+        _rasterKey.setRasterState(_RSStateCreateInfo); // 只在状态改变时打包一次，bind 时不再重新 hash
     }
 
-    void GraphicsPipeline::_hashRasterizationState( UGIHash<APHash>& hasher ) {
-        hasher.hashPOD(_RSStateCreateInfo.polygonMode);
-        hasher.hashPOD(_RSStateCreateInfo.cullMode);
-        hasher.hashPOD(_RSStateCreateInfo.frontFace);
-        hasher.hashPOD(_RSStateCreateInfo.depthClampEnable);
-        hasher.hashPOD(_RSStateCreateInfo.depthBiasEnable);
-        // 
-        if(_RSStateCreateInfo.depthBiasEnable) {
-            hasher.hashPOD(_RSStateCreateInfo.depthBiasConstantFactor);
-            hasher.hashPOD(_RSStateCreateInfo.depthBiasClamp);
-            hasher.hashPOD(_RSStateCreateInfo.depthBiasSlopeFactor);
+    void GraphicsPipeline::setCompileMode(pipeline_compile_mode_t mode, WorkerPool* workers) {
+        _compileMode = mode;
+        _compileWorkers = workers ? workers : _device->pipelineCompileWorkers();
+    }
+
+    void GraphicsPipeline::prewarm(const IRenderPass* renderPass, uint32_t subpass, const raster_state_t* states, uint32_t count) {
+        uint64_t subpassHash = renderPass->subpassHash(subpass);
+        bool async = _compileMode != pipeline_compile_mode_t::Synchronous && _compileWorkers;
+        for(uint32_t i = 0; i<count; ++i) {
+            variant_job_t job; {
+                job.renderPass = renderPass->renderPass();
+                job.subpass = subpass;
+                job.colorAttachmentCount = renderPass->subpassColorAttachmentCount(subpass);
+                job.rasterState = _RSStateCreateInfo;
+                _fillRasterizationState(job.rasterState, states[i]);
+                job.key.subpassHash = subpassHash;
+                job.key.setRasterState(job.rasterState);
+            }
+            if(_pipelineTable.find(job.key)) {
+                continue;
+            }
+            if(async) {
+                _postVariant(job);
+            } else {
+                VkPipeline pipeline = _createVariant(job, false);
+                if(pipeline) {
+                    _registerVariant(job.key, pipeline);
+                }
+            }
         }
     }
 
-    void GraphicsPipeline::bind(RenderCommandEncoder* encoder) {
-        UGIHash<APHash> hasher;
-        _hashRasterizationState(hasher);
-        VkPipeline pipeline = preparePipelineStateObject( hasher,  encoder );
-        vkCmdBindPipeline(*encoder->commandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    bool GraphicsPipeline::bind(RenderCommandEncoder* encoder) {
+        VkPipeline pipeline = resolvePipeline(encoder);
+        if(pipeline == VK_NULL_HANDLE) {
+            return false;
+        }
+        encoder->bindPipelineObject(pipeline);
+        return true;
+    }
+
+    VkPipeline GraphicsPipeline::resolvePipeline(const RenderCommandEncoder* encoder) {
+        pipeline_state_key_t key = _rasterKey;
+        key.subpassHash = encoder->renderPass()->subpassHash(encoder->subpass());
+        VkPipeline pipeline;
+        if(_lastPipeline && key == _lastKey) { // 绝大多数 bind 都和上一次相同
+            pipeline = _lastPipeline;
+        } else {
+            pipeline = preparePipelineStateObject( key,  encoder );
+        }
+        return pipeline;
     }
 
     DescriptorBinder* GraphicsPipeline::createArgumentGroup() const {
@@ -348,12 +485,12 @@ namespace ugi {
                 res_descriptor_t descriptor;
                 descriptor.handle = handle;
                 descriptor.type = descInfo.type;
-                if(descriptor.type == res_descriptor_type::UniformBuffer) {
+                if(isDynamicBufferType(descriptor.type)) {
                     descriptor.res.buffer.size = descInfo.dataSize;
                     descriptor.res.buffer.size = descInfo.dataSize;
                 }
                 if(resources.size()) {
-                    if(descriptor.type == res_descriptor_type::UniformBuffer) {
+                    if(isDynamicBufferType(descriptor.type)) {
                         descriptor.res.buffer.buffer = resources[i].buffer.buffer;
                         descriptor.res.buffer.offset = resources[i].buffer.offset;
                     } else {
@@ -403,8 +540,20 @@ namespace ugi {
         }
         createInfo.stage = stageInfo;
         VkPipeline pipeline;
-        VkResult rst = vkCreateComputePipelines( device->device(), VK_NULL_HANDLE, 1, &createInfo, nullptr, &pipeline);
+        PipelineCache* cache = device->pipelineCache();
+        VkPipelineCache vkCache = cache ? (VkPipelineCache)*cache : VK_NULL_HANDLE;
+        pipeline_creation_feedback_t feedback;
+        if(cache && cache->creationFeedback()) {
+            createInfo.pNext = feedback.chain(nullptr, 1);
+        }
+        auto start = std::chrono::steady_clock::now();
+        VkResult rst = vkCreateComputePipelines( device->device(), vkCache, 1, &createInfo, nullptr, &pipeline);
+        createInfo.pNext = nullptr; // feedback 在栈上，createInfo 下面会存起来
         if( rst == VK_SUCCESS ) {
+            if(cache) {
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                cache->recordCreation(feedback, (uint64_t)elapsed.count());
+            }
             ComputePipeline* computePipeline = new ComputePipeline();
             computePipeline->_device = device;
             computePipeline->_pipeline = pipeline;
@@ -442,12 +591,12 @@ namespace ugi {
                 res_descriptor_t descriptor;
                 descriptor.handle = handle;
                 descriptor.type = descInfo.type;
-                if(descriptor.type == res_descriptor_type::UniformBuffer) {
+                if(isDynamicBufferType(descriptor.type)) {
                     descriptor.res.buffer.size = descInfo.dataSize;
                     descriptor.res.buffer.size = descInfo.dataSize;
                 }
                 if(resources.size()) {
-                    if(descriptor.type == res_descriptor_type::UniformBuffer) {
+                    if(isDynamicBufferType(descriptor.type)) {
                         descriptor.res.buffer.buffer = resources[i].buffer.buffer;
                         descriptor.res.buffer.offset = resources[i].buffer.offset;
                     } else {
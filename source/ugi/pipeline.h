@@ -8,15 +8,43 @@
 #include <array>
 #include <cstdint>
 #include <string>
+#include <mutex>
+#include <atomic>
+#include <unordered_set>
 #include "ugi_utility.h"
+#include "pipeline_state_table.h"
 
 namespace ugi {
 
     class GraphicsPipeline {
+    private:
+        // 后台编译一个变体所需的全部可变状态，其余的 create info 在 pipeline 创建后就不再改变
+        struct variant_job_t {
+            pipeline_state_key_t                            key;
+            VkRenderPass                                    renderPass;
+            uint32_t                                        subpass;
+            uint32_t                                        colorAttachmentCount;
+            VkPipelineRasterizationStateCreateInfo          rasterState;
+        };
+        struct variant_result_t {
+            pipeline_state_key_t                            key;
+            VkPipeline                                      pipeline;
+        };
     private:
         Device*                                             _device;
         pipeline_desc_t                                     _pipelineDesc;
-        std::unordered_map<uint64_t, VkPipeline>            _pipelineTable;
+        PipelineStateTable                                  _pipelineTable;
+        pipeline_state_key_t                                _rasterKey;                             ///> 当前 raster state 打包后的 key（subpassHash 不使用）
+        pipeline_state_key_t                                _lastKey;                               ///> 上一次 bind 的 key，重复 bind 只需一次比较
+        VkPipeline                                          _lastPipeline;
+        std::unordered_map<uint64_t, VkPipeline>            _fallbackTable;                         ///> subpass hash -> 该 subpass 下第一个可用的 pipeline
+        // async variant compilation
+        pipeline_compile_mode_t                             _compileMode;
+        WorkerPool*                                         _compileWorkers;
+        std::unordered_set<uint64_t>                        _pendingVariants;                       ///> 已投递还没回来的变体 key hash（仅渲染线程访问）
+        std::mutex                                          _completedMutex;
+        std::vector<variant_result_t>                       _completedVariants;                     ///> 工作线程编译完成的变体，渲染线程 bind 时收取
+        std::atomic<uint32_t>                               _completedCount;
         //
         std::vector<VkPipelineShaderStageCreateInfo>        _shaderStages;
         VkPipelineInputAssemblyStateCreateInfo              _IAStateCreateInfo;
@@ -38,9 +66,12 @@ namespace ugi {
         MaterialLayout*                                     _materialLayout;
         DescriptorBinder*                                   _descriptorBinder;
     private:
-        VkPipeline preparePipelineStateObject(UGIHash<APHash>& hasher, const RenderCommandEncoder* encoder);
-        void _hashRasterizationState(UGIHash<APHash>& hasher);
-        DescriptorBinder* createArgumentGroup() const;
+        VkPipeline preparePipelineStateObject(pipeline_state_key_t const& key, const RenderCommandEncoder* encoder);
+        VkPipeline _createVariant(variant_job_t const& job, bool onWorker) const;
+        void _postVariant(variant_job_t const& job);
+        void _collectCompletedVariants();
+        void _registerVariant(pipeline_state_key_t const& key, VkPipeline pipeline);
+        static void _fillRasterizationState(VkPipelineRasterizationStateCreateInfo& info, const raster_state_t& state);
     public:
         static GraphicsPipeline* CreatePipeline(Device* device, const pipeline_desc_t& pipelineDescription);
 
@@ -48,8 +79,26 @@ namespace ugi {
 
         void setRasterizationState(const raster_state_t& _state);
         void setDepthStencilState();
-        void bind(RenderCommandEncoder* encoder);
+        /**
+         * @brief 设置新变体的创建方式，异步模式需要提供工作线程池
+         */
+        void setCompileMode(pipeline_compile_mode_t mode, WorkerPool* workers = nullptr); // workers 为空时使用 device 的编译线程池
+        /**
+         * @brief 预热：把一组 raster state 变体提前投递到后台编译（同步模式下就地编译）
+         */
+        void prewarm(const IRenderPass* renderPass, uint32_t subpass, const raster_state_t* states, uint32_t count);
+        /**
+         * @brief 返回 false 表示当前变体还没编译好且没有可用的替代 pipeline，调用方应跳过这次 draw
+         */
+        bool bind(RenderCommandEncoder* encoder);
         void bind(ComputeCommandEncoder* encoder);
+        /**
+         * @brief 只取当前 raster state 在 encoder 所在 subpass 下的 VkPipeline，不录制命令（仅渲染线程调用）
+         * 并行录制时在主线程取好，各线程的 secondary command buffer 里直接 bindPipelineObject
+         */
+        VkPipeline resolvePipeline(const RenderCommandEncoder* encoder);
+        // 独立的 descriptor binder，多线程录制时每个线程一个，不和 pipeline 自己的 binder 共享状态
+        DescriptorBinder* createArgumentGroup() const;
         void applyMaterial(Material const* material);
         void flushMaterials(CommandBuffer const* cmd);
         void resetMaterials();
@@ -0,0 +1,236 @@
+#include "pipeline_cache.h"
+#include "vulkan_function_declare.h"
+#include "ugi_utility.h"
+#include <LightWeightCommon/io/archive.h>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+
+namespace ugi {
+
+    PipelineCache::PipelineCache()
+        : _device(VK_NULL_HANDLE)
+        , _cache(VK_NULL_HANDLE)
+        , _properties{}
+        , _archive(nullptr)
+        , _initialData()
+        , _workerMutex()
+        , _workerCaches()
+        , _creationFeedback(false)
+        , _hits(0)
+        , _misses(0)
+        , _compileMicroseconds(0)
+        , _loadedBytes(0)
+        , _savedBytes(0)
+        , _blobRejected(false)
+    {}
+
+    void const* pipeline_creation_feedback_t::chain(void const* next, uint32_t stageCount) {
+        pipeline = {};
+        stages.assign(stageCount, VkPipelineCreationFeedbackEXT{});
+        info.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+        info.pNext = next;
+        info.pPipelineCreationFeedback = &pipeline;
+        info.pipelineStageCreationFeedbackCount = stageCount;
+        info.pPipelineStageCreationFeedbacks = stages.data();
+        return &info;
+    }
+
+    bool PipelineCache::_validateHeader(blob_header_t const& header, uint8_t const* data) const {
+        if(header.magic != Magic || header.version != Version) {
+            return false;
+        }
+        if(header.vendorID != _properties.vendorID || header.deviceID != _properties.deviceID || header.driverVersion != _properties.driverVersion) {
+            return false;
+        }
+        if(memcmp(header.uuid, _properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+            return false;
+        }
+        UGIHash<APHash> hasher;
+        hasher.hashBuffer(data, header.dataSize);
+        return header.dataHash == (uint64_t)hasher;
+    }
+
+    bool PipelineCache::_loadBlob(std::vector<uint8_t>& data) {
+        if(!_archive) {
+            return false;
+        }
+        auto file = _archive->openIStream(DefaultPath, {comm::ReadFlag::binary});
+        if(!file) {
+            return false;
+        }
+        size_t fileSize = (size_t)file->size();
+        if(fileSize <= sizeof(blob_header_t)) {
+            file->close();
+            _blobRejected = true;
+            return false;
+        }
+        blob_header_t header;
+        file->read(&header, sizeof(header));
+        if(header.dataSize != fileSize - sizeof(blob_header_t)) {
+            file->close();
+            _blobRejected = true;
+            return false;
+        }
+        data.resize(header.dataSize);
+        file->read(data.data(), header.dataSize);
+        file->close();
+        if(!_validateHeader(header, data.data())) { // 驱动升级或换了显卡，旧数据直接丢掉
+            data.clear();
+            _blobRejected = true;
+            return false;
+        }
+        return true;
+    }
+
+    VkPipelineCache PipelineCache::_createCache(std::vector<uint8_t> const& data) const {
+        VkPipelineCacheCreateInfo createInfo = {}; {
+            createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            createInfo.pNext = nullptr;
+            createInfo.flags = 0;
+            createInfo.initialDataSize = data.size();
+            createInfo.pInitialData = data.size() ? data.data() : nullptr;
+        }
+        VkPipelineCache cache = VK_NULL_HANDLE;
+        if(VK_SUCCESS != vkCreatePipelineCache(_device, &createInfo, nullptr, &cache)) {
+            return VK_NULL_HANDLE;
+        }
+        return cache;
+    }
+
+    bool PipelineCache::initialize(VkDevice device, VkPhysicalDeviceProperties const& properties, comm::IArchive* archive, bool creationFeedback) {
+        _device = device;
+        _properties = properties;
+        _archive = archive;
+        _creationFeedback = creationFeedback;
+        if(_loadBlob(_initialData)) {
+            _loadedBytes = _initialData.size();
+        }
+        _cache = _createCache(_initialData);
+        if(!_cache && _initialData.size()) {
+            // 驱动不认这个 blob，退回到空 cache
+            _loadedBytes = 0;
+            _blobRejected = true;
+            _initialData.clear();
+            _cache = _createCache(_initialData);
+        }
+        return _cache != VK_NULL_HANDLE;
+    }
+
+    VkPipelineCache PipelineCache::workerCache() {
+        std::lock_guard<std::mutex> lock(_workerMutex);
+        auto iter = _workerCaches.find(std::this_thread::get_id());
+        if(iter != _workerCaches.end()) {
+            return iter->second;
+        }
+        VkPipelineCache cache = _createCache(_initialData);
+        if(!cache) { // 创建失败就和渲染线程共用设备 cache
+            return _cache;
+        }
+        _workerCaches[std::this_thread::get_id()] = cache;
+        return cache;
+    }
+
+    bool PipelineCache::mergeWorkerCaches() {
+        std::vector<VkPipelineCache> sources;
+        {
+            std::lock_guard<std::mutex> lock(_workerMutex);
+            for(auto const& worker: _workerCaches) {
+                sources.push_back(worker.second);
+            }
+        }
+        if(!_cache || sources.empty()) {
+            return false;
+        }
+        // worker cache 保留，下一轮编译继续往里加；重复合并的部分驱动会去重
+        return VK_SUCCESS == vkMergePipelineCaches(_device, _cache, (uint32_t)sources.size(), sources.data());
+    }
+
+    bool PipelineCache::save() {
+        if(!_cache || !_archive || _archive->readonly()) {
+            return false;
+        }
+        mergeWorkerCaches();
+        size_t dataSize = 0;
+        if(VK_SUCCESS != vkGetPipelineCacheData(_device, _cache, &dataSize, nullptr) || !dataSize) {
+            return false;
+        }
+        std::vector<uint8_t> data(dataSize);
+        if(VK_SUCCESS != vkGetPipelineCacheData(_device, _cache, &dataSize, data.data())) {
+            return false;
+        }
+        blob_header_t header;
+        memset(&header, 0, sizeof(header)); // padding 也会写到磁盘上
+        {
+            header.magic = Magic;
+            header.version = Version;
+            header.vendorID = _properties.vendorID;
+            header.deviceID = _properties.deviceID;
+            header.driverVersion = _properties.driverVersion;
+            memcpy(header.uuid, _properties.pipelineCacheUUID, VK_UUID_SIZE);
+            header.dataSize = dataSize;
+            UGIHash<APHash> hasher;
+            hasher.hashBuffer(data.data(), dataSize);
+            header.dataHash = hasher;
+        }
+        std::error_code ec;
+        std::filesystem::path cacheDir = std::filesystem::path(_archive->rootPath() + DefaultPath).parent_path();
+        std::filesystem::create_directories(cacheDir, ec);
+        if(ec) {
+            printf("[pipeline cache] create directory failed: %s\n", cacheDir.string().c_str());
+            return false;
+        }
+        auto file = _archive->openOStream(DefaultPath, {comm::WriteFlag::binary});
+        if(!file) {
+            printf("[pipeline cache] open %s failed\n", DefaultPath);
+            return false;
+        }
+        // 写坏的文件下次加载时 dataSize/hash 对不上会被丢弃
+        bool ok = file->write(&header, sizeof(header)) == (int64_t)sizeof(header)
+            && file->write(data.data(), dataSize) == (int64_t)dataSize;
+        file->close();
+        if(!ok) {
+            printf("[pipeline cache] write %s failed\n", DefaultPath);
+            return false;
+        }
+        _savedBytes = dataSize;
+        return true;
+    }
+
+    void PipelineCache::destroy() {
+        {
+            std::lock_guard<std::mutex> lock(_workerMutex);
+            for(auto const& worker: _workerCaches) {
+                vkDestroyPipelineCache(_device, worker.second, nullptr);
+            }
+            _workerCaches.clear();
+        }
+        if(_cache) {
+            vkDestroyPipelineCache(_device, _cache, nullptr);
+            _cache = VK_NULL_HANDLE;
+        }
+    }
+
+    void PipelineCache::recordCreation(pipeline_creation_feedback_t const& feedback, uint64_t microseconds) {
+        if(_creationFeedback && (feedback.pipeline.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT)
+            && (feedback.pipeline.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT)) {
+            _hits.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        _compileMicroseconds.fetch_add(microseconds, std::memory_order_relaxed);
+    }
+
+    pipeline_cache_stat_t PipelineCache::stat() const {
+        pipeline_cache_stat_t rst; {
+            rst.hits = _hits.load(std::memory_order_relaxed);
+            rst.misses = _misses.load(std::memory_order_relaxed);
+            rst.compileMicroseconds = _compileMicroseconds.load(std::memory_order_relaxed);
+            rst.loadedBytes = _loadedBytes;
+            rst.savedBytes = _savedBytes;
+            rst.blobRejected = _blobRejected;
+        }
+        return rst;
+    }
+
+}
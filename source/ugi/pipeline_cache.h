@@ -0,0 +1,99 @@
+#pragma once
+
+#include "vulkan_declare.h"
+#include "ugi_declare.h"
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace comm {
+    class IArchive;
+}
+
+namespace ugi {
+
+    struct pipeline_cache_stat_t {
+        uint64_t    hits;               ///> 驱动报告命中 pipeline cache（VK_EXT_pipeline_creation_feedback，不支持时恒为0）
+        uint64_t    misses;             ///> 走了 vkCreate*Pipelines 且没有命中（不支持 feedback 时所有创建都算）
+        uint64_t    compileMicroseconds;///> misses 累计的编译耗时
+        uint64_t    loadedBytes;        ///> 启动时从磁盘读入的 blob 大小（被拒绝时为0）
+        uint64_t    savedBytes;         ///> 最近一次写回磁盘的 blob 大小
+        bool        blobRejected;       ///> 磁盘上的 blob 与当前设备/驱动不匹配
+    };
+
+    // 挂到 Vk*PipelineCreateInfo::pNext 上，创建完成后交给 PipelineCache::recordCreation
+    struct pipeline_creation_feedback_t {
+        VkPipelineCreationFeedbackCreateInfoEXT     info;
+        VkPipelineCreationFeedbackEXT               pipeline;
+        std::vector<VkPipelineCreationFeedbackEXT>  stages;
+        //
+        void const* chain(void const* next, uint32_t stageCount);
+    };
+
+    /*
+     *  设备级的 VkPipelineCache
+     *  1. Device 创建时从 archive 读入磁盘上的 blob，blob 头部记录 vendor/device/driver/UUID，不匹配直接丢弃
+     *  2. 渲染线程直接用设备 cache；后台编译线程各自用一个以同一份 blob 初始化的 worker cache，互相不争 cache 内部的锁
+     *     save 之前 mergeWorkerCaches 把 worker cache 合并回设备 cache（vkMergePipelineCaches）
+     *  3. 设备开启了 VK_EXT_pipeline_creation_feedback 时，按驱动报告的 APPLICATION_PIPELINE_CACHE_HIT 统计命中
+     *  4. 关闭时 save 写回磁盘，Device::release 里 destroy
+     * */
+    class PipelineCache {
+    public:
+        static constexpr uint32_t Magic = 0x43504755;          // 'UGPC'
+        static constexpr uint32_t Version = 1;
+        static constexpr const char* DefaultPath = "/cache/pipeline_cache.bin";
+    private:
+        struct blob_header_t {
+            uint32_t    magic;
+            uint32_t    version;
+            uint32_t    vendorID;
+            uint32_t    deviceID;
+            uint32_t    driverVersion;
+            uint8_t     uuid[VK_UUID_SIZE];
+            uint64_t    dataSize;
+            uint64_t    dataHash;
+        };
+        VkDevice                            _device;
+        VkPipelineCache                     _cache;
+        VkPhysicalDeviceProperties          _properties;
+        comm::IArchive*                     _archive;
+        std::vector<uint8_t>                _initialData;       ///> 启动时读入的 blob，worker cache 用它初始化
+        std::mutex                          _workerMutex;
+        std::unordered_map<std::thread::id, VkPipelineCache> _workerCaches;
+        bool                                _creationFeedback;
+        //
+        std::atomic<uint64_t>               _hits;
+        std::atomic<uint64_t>               _misses;
+        std::atomic<uint64_t>               _compileMicroseconds;
+        uint64_t                            _loadedBytes;
+        uint64_t                            _savedBytes;
+        bool                                _blobRejected;
+    private:
+        bool _loadBlob(std::vector<uint8_t>& data);
+        bool _validateHeader(blob_header_t const& header, uint8_t const* data) const;
+        VkPipelineCache _createCache(std::vector<uint8_t> const& data) const;
+    public:
+        PipelineCache();
+        bool initialize(VkDevice device, VkPhysicalDeviceProperties const& properties, comm::IArchive* archive, bool creationFeedback = false);
+        operator VkPipelineCache() const {
+            return _cache;
+        }
+        // 当前线程的 worker cache，第一次调用时创建，只给后台编译线程用
+        VkPipelineCache workerCache();
+        // 调用时后台编译线程必须空闲（worker cache 作为 src 不能同时在用）
+        bool mergeWorkerCaches();
+        bool save();
+        void destroy();
+        //
+        bool creationFeedback() const {
+            return _creationFeedback;
+        }
+        void recordCreation(pipeline_creation_feedback_t const& feedback, uint64_t microseconds);
+        pipeline_cache_stat_t stat() const;
+    };
+
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "vulkan_declare.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ugi {
+
+    /*
+     *  pipeline 变体的紧凑 key
+     *  raster state 在 setRasterizationState 时打包一次，bind 时只需要补上 subpass hash
+     *  比较是几个整数比较，hash 是一次整数混合，不再逐字节跑 APHash
+     * */
+    struct pipeline_state_key_t {
+        enum : uint32_t {
+            DepthClampBit = 1u << 5,
+            DepthBiasBit = 1u << 6,
+        };
+        uint64_t    subpassHash;
+        uint32_t    rasterBits;     ///> polygonMode:2 | cullMode:2 | frontFace:1 | depthClamp:1 | depthBias:1
+        float       depthBias[3];   ///> constant / clamp / slope，depth bias 关闭时全部为 0
+        //
+        void setRasterState(VkPipelineRasterizationStateCreateInfo const& info) {
+            rasterBits = ((uint32_t)info.polygonMode & 0x3)
+                | (((uint32_t)info.cullMode & 0x3) << 2)
+                | (((uint32_t)info.frontFace & 0x1) << 4)
+                | (info.depthClampEnable ? DepthClampBit : 0)
+                | (info.depthBiasEnable ? DepthBiasBit : 0);
+            if(info.depthBiasEnable) {
+                depthBias[0] = info.depthBiasConstantFactor;
+                depthBias[1] = info.depthBiasClamp;
+                depthBias[2] = info.depthBiasSlopeFactor;
+            } else {
+                depthBias[0] = depthBias[1] = depthBias[2] = 0.0f;
+            }
+        }
+        bool operator == (pipeline_state_key_t const& other) const {
+            return subpassHash == other.subpassHash
+                && rasterBits == other.rasterBits
+                && memcmp(depthBias, other.depthBias, sizeof(depthBias)) == 0;
+        }
+        bool operator != (pipeline_state_key_t const& other) const {
+            return !(*this == other);
+        }
+        uint64_t hash() const {
+            uint64_t h = subpassHash ^ ((uint64_t)rasterBits * 0x9E3779B97F4A7C15ull);
+            if(rasterBits & DepthBiasBit) {
+                uint32_t bits[3];
+                memcpy(bits, depthBias, sizeof(bits));
+                h ^= ((uint64_t)bits[0] << 32 | bits[1]) * 0xC2B2AE3D27D4EB4Full;
+                h ^= (uint64_t)bits[2] * 0x165667B19E3779F9ull;
+            }
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 33;
+            return h;
+        }
+    };
+
+    /*
+     *  开放寻址（线性探测）的 pipeline 表，只增不删
+     *  pipeline 变体数量一般就几个到几十个，装载因子控制在 1/2 以内，一次探测基本就能命中
+     * */
+    class PipelineStateTable {
+    private:
+        struct slot_t {
+            pipeline_state_key_t    key;
+            VkPipeline              pipeline;   ///> VK_NULL_HANDLE 表示空槽
+        };
+        std::vector<slot_t>         _slots;
+        uint32_t                    _mask;
+        uint32_t                    _count;
+    private:
+        void _grow() {
+            std::vector<slot_t> old = std::move(_slots);
+            uint32_t capacity = old.empty() ? 16 : (uint32_t)old.size() * 2;
+            _slots.assign(capacity, slot_t{});
+            _mask = capacity - 1;
+            _count = 0;
+            for(auto const& slot: old) {
+                if(slot.pipeline) {
+                    insert(slot.key, slot.pipeline);
+                }
+            }
+        }
+    public:
+        PipelineStateTable()
+            : _slots{}
+            , _mask(0)
+            , _count(0)
+        {}
+
+        VkPipeline find(pipeline_state_key_t const& key) const {
+            if(_slots.empty()) {
+                return VK_NULL_HANDLE;
+            }
+            uint32_t index = (uint32_t)key.hash() & _mask;
+            while(true) {
+                slot_t const& slot = _slots[index];
+                if(!slot.pipeline) {
+                    return VK_NULL_HANDLE;
+                }
+                if(slot.key == key) {
+                    return slot.pipeline;
+                }
+                index = (index + 1) & _mask;
+            }
+        }
+
+        // 调用方保证 key 不存在
+        void insert(pipeline_state_key_t const& key, VkPipeline pipeline) {
+            if((_count + 1) * 2 > (uint32_t)_slots.size()) {
+                _grow();
+            }
+            uint32_t index = (uint32_t)key.hash() & _mask;
+            while(_slots[index].pipeline) {
+                index = (index + 1) & _mask;
+            }
+            _slots[index].key = key;
+            _slots[index].pipeline = pipeline;
+            ++_count;
+        }
+
+        uint32_t size() const {
+            return _count;
+        }
+
+        template<class F>
+        void forEach(F&& func) const {
+            for(auto const& slot: _slots) {
+                if(slot.pipeline) {
+                    func(slot.key, slot.pipeline);
+                }
+            }
+        }
+    };
+
+}
@@ -6,23 +6,78 @@
 #include <buffer.h>
 #include <device.h>
 #include <command_queue.h>
+#include <command_encoder/resource_cmd_encoder.h>
 #include <asyncload/gpu_asyncload_manager.h>
 #include <asyncload/gpu_asyncload_item.h>
+#include <asyncload/staging_upload_ring.h>
 #include <mesh_buffer_allocator.h>
+#include <mutex>
+#include <atomic>
 
 namespace ugi {
 
     static_assert(sizeof(uint64_t) == sizeof(VkDeviceSize),"must be same");
 
+    static std::mutex meshPoolMutex;
+    static std::vector<void*> meshPool; // 删掉的 Mesh 内存留着下次用，只增不减
+    static std::atomic<uint64_t> meshHeapAllocations(0);
+
+    void* Mesh::operator new(size_t size) {
+        assert(size == sizeof(Mesh));
+        {
+            std::unique_lock<std::mutex> lock(meshPoolMutex);
+            if(meshPool.size()) {
+                void* ptr = meshPool.back();
+                meshPool.pop_back();
+                return ptr;
+            }
+        }
+        meshHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+
+    void Mesh::operator delete(void* ptr) {
+        if(!ptr) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(meshPoolMutex);
+        meshPool.push_back(ptr);
+    }
+
+    void Mesh::ReleasePool() {
+        std::unique_lock<std::mutex> lock(meshPoolMutex);
+        for(auto ptr: meshPool) {
+            ::operator delete(ptr);
+        }
+        meshPool.clear();
+        meshPool.shrink_to_fit();
+    }
+
+    uint64_t Mesh::HeapAllocations() {
+        return meshHeapAllocations.load(std::memory_order_relaxed);
+    }
+
     void Mesh::bind(const RenderCommandEncoder* encoder) const {
+        // allocation 可能被整理搬走，偏移都是相对 allocation 起始位置的，每次 bind 重新取
         auto alloc = meshbufferAllocator->deref(buffer_);
         VkBuffer vbuf[MaxVertexBufferBinding];
+        VkDeviceSize offsets[MaxVertexBufferBinding];
         for( uint32_t i = 0; i<this->attriCount_; ++i) {
             vbuf[i] = alloc.buffer;
+            offsets[i] = alloc.offset + attriOffsets_[i];
         }
         VkCommandBuffer cmd = *encoder->commandBuffer();
-        vkCmdBindVertexBuffers(cmd, 0, attriCount_, vbuf, attriOffsets_);
-        vkCmdBindIndexBuffer(cmd, alloc.buffer, iboffset_, VkIndexType::VK_INDEX_TYPE_UINT16);
+        vkCmdBindVertexBuffers(cmd, 0, attriCount_, vbuf, offsets);
+        vkCmdBindIndexBuffer(cmd, alloc.buffer, alloc.offset + iboffset_, VkIndexType::VK_INDEX_TYPE_UINT16);
+    }
+
+    void Mesh::update(ResourceCommandEncoder* encoder, uint32_t offset, void const* data, uint32_t size) const {
+        assert(uploaded_);
+        mesh_buffer_alloc_t targets[2];
+        uint32_t count = meshbufferAllocator->writeTargets(buffer_, targets);
+        for(uint32_t i = 0; i<count; ++i) { // 整理搬迁中的新旧位置都写，切换前后都是新数据
+            encoder->updateBufferInline(targets[i].buffer, targets[i].offset + offset, data, size);
+        }
     }
 
     /**
@@ -63,9 +118,27 @@ namespace ugi {
         mesh->buffer_ = alloc.first;
 
         mesh->attriCount_ = layout.bufferCount;
-        mesh->iboffset_ = alloc.second.offset + vbSize;
+        mesh->iboffset_ = vbSize;
         for(auto i = 0; i<layout.bufferCount; ++i) {
-            mesh->attriOffsets_[i] = alloc.second.offset + layout.buffers[i].offset;
+            mesh->attriOffsets_[i] = layout.buffers[i].offset;
+        }
+        if(StagingUploadRing* uploadRing = asyncLoadManager->uploadRing()) {
+            // 走 staging ring，和这一帧其它的上传合并成一次提交
+            upload_piece_t pieces[] = {
+                { vb, vbSize },
+                { indice, (uint32_t)ibSize },
+            };
+            auto onComplete = [mesh, callback](CommandBuffer* logicCB) {
+                mesh->uploaded_ = 1;
+                mesh->meshbufferAllocator->markUploaded(mesh->buffer_);
+                callback(mesh, logicCB);
+            };
+            if(!uploadRing->upload(alloc.second.buffer, alloc.second.offset, pieces, 2, onComplete)) {
+                allocator->free(alloc.first);
+                delete mesh;
+                return nullptr;
+            }
+            return mesh;
         }
         CommandQueue* transferQueue = device->transferQueues()[0];
         auto cb = transferQueue->createCommandBuffer(device, CmdbufType::Transient);
@@ -91,30 +164,23 @@ namespace ugi {
             encoder->endEncode();
         }
         cb->endEncode();
-        // submit command buffer to transfer queue
-        auto fence = device->createFence();
-        if (!fence) {
-            transferQueue->destroyCommandBuffer(device, cb);
-            device->destroyBuffer(stagingBuffer);
-            allocator->free(alloc.first);
-            delete mesh;
-            return nullptr;
-        }
-        {
-            QueueSubmitInfo submitInfo(&cb, 1, nullptr, 0, nullptr, 0);
-            QueueSubmitBatchInfo submitBatch(&submitInfo, 1, fence);
-            transferQueue->submitCommandBuffers(submitBatch);
-        }
         auto onComplete = [](Mesh* mesh, Device* device, Buffer* buffer, CommandBuffer* cb, CommandQueue* queue, std::function<void(void*, CommandBuffer*)> callback, CommandBuffer* logicCB)->void{
             queue->destroyCommandBuffer(device, cb);
             device->destroyBuffer(buffer);
             mesh->uploaded_ = 1;
+            mesh->meshbufferAllocator->markUploaded(mesh->buffer_);
             callback(mesh, logicCB);
         };
         using namespace std::placeholders;
         auto binder = std::bind(onComplete, mesh, device, stagingBuffer, cb, transferQueue, callback, _1) ;
-        GPUAsyncLoadItem asyncLoadItem(device, fence, binder);
-        asyncLoadManager->registerAsyncLoad(std::move(asyncLoadItem));
+        // submit command buffer to transfer queue
+        if (!asyncLoadManager->submitAsyncLoad(device, transferQueue, cb, binder)) {
+            transferQueue->destroyCommandBuffer(device, cb);
+            device->destroyBuffer(stagingBuffer);
+            allocator->free(alloc.first);
+            delete mesh;
+            return nullptr;
+        }
         return mesh;
     }
 
@@ -13,10 +13,10 @@ namespace ugi {
         MeshBufferAllocator*    meshbufferAllocator;
         mesh_buffer_handle_t    buffer_;
         // uint32_t                vboffset_;
-        uint32_t                iboffset_;
+        uint32_t                iboffset_;      // 相对 allocation 起始位置
         size_t                  indexCount_; // index count of primitive
         uint32_t                attriCount_;
-        uint64_t                attriOffsets_[MaxVertexAttribute];
+        uint64_t                attriOffsets_[MaxVertexAttribute]; // 相对 allocation 起始位置
         //
         vertex_layout_t         vertexLayout_;
         topology_mode_t         topologyMode_;
@@ -38,6 +38,14 @@ namespace ugi {
 
         ~Mesh();
 
+        // UI 重建 batch 时 mesh 建了又删，对象本身走空闲链表，不用每次都进全局堆
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr);
+        // 退出时调用，把空闲链表里的内存还给全局堆
+        static void ReleasePool();
+        // 累计向全局堆要了几次内存，池子稳定之后不应该再涨
+        static uint64_t HeapAllocations();
+
 
         mesh_buffer_alloc_t buffer() const {
             return meshbufferAllocator->deref(buffer_);
@@ -68,6 +76,9 @@ namespace ugi {
         }
 
         void bind(const RenderCommandEncoder* encoder) const;
+        // 在渲染队列的 command buffer 里原地改写一段数据（vkCmdUpdateBuffer），offset 相对 allocation 起始位置
+        // 前后的 barrier 由调用方统一加；上传还没完成（!prepared）时不能改，上传会把它覆盖掉
+        void update(ResourceCommandEncoder* encoder, uint32_t offset, void const* data, uint32_t size) const;
 
         static Mesh* CreateMesh(
             Device* device,
@@ -51,6 +51,13 @@ namespace ugi {
         });
     }
 
+    void Renderable::resetMesh(Mesh* mesh) {
+        if(mesh_) {
+            delete mesh_;
+        }
+        mesh_ = mesh;
+    }
+
     Renderable::~Renderable() {
         if(mesh_) {
             delete mesh_;
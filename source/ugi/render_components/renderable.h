@@ -31,6 +31,10 @@ namespace ugi {
         /// </summary>
         void release();
 
+        /// 换一个 mesh，旧的直接删掉（调用方保证 GPU 已经不再用它）
+        /// 复用 Renderable 和 Material 的时候用，传 nullptr 只释放 mesh
+        void resetMesh(Mesh* mesh);
+
         ~Renderable();
     };
 
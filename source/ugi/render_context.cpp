@@ -9,6 +9,7 @@
 #include <ugi/swapchain.h>
 #include <ugi/uniform_buffer_allocator.h>
 #include <ugi/texture_util.h>
+#include <algorithm>
 
 namespace ugi {
 
@@ -23,6 +24,7 @@ namespace ugi {
         , _graphicsQueue(nullptr)
         , _uploadQueue(nullptr)
         , _uniformAllocator(nullptr)
+        , _storageAllocator(nullptr)
         , _descriptorSetAllocator(nullptr)
         , _asyncLoadManager(nullptr)
         , _flightIndex(0)
@@ -35,11 +37,13 @@ namespace ugi {
         _renderSystem = new RenderSystem();
         _device = _renderSystem->createDevice(deviceDesc, archive);
         _uniformAllocator = _device->createUniformAllocator();
+        _storageAllocator = _device->createUniformAllocator((uint32_t)std::min<uint64_t>(_device->descriptor().properties.limits.maxStorageBufferRange, 0x80000000u));
         _descriptorSetAllocator = _device->descriptorSetAllocator();
         _swapchain = _device->createSwapchain(wnd);
         _graphicsQueue = _device->graphicsQueues()[0];
         _uploadQueue = _device->transferQueues()[0];
         _asyncLoadManager = new ugi::GPUAsyncLoadManager();
+        _asyncLoadManager->initializeUploadRing(_device, _uploadQueue);
         for( size_t i = 0; i<MaxFlightCount; ++i) {
             _frameCompleteFences[i] = _device->createFence();
         }
@@ -61,6 +65,7 @@ namespace ugi {
         _device->cycleInvoker().tick();
         _descriptorSetAllocator->tick();
         _uniformAllocator->tick();
+        _storageAllocator->tick();
         GPURetireManager::Instance()->onFrameTick();
         //
         auto cb = _graphicsQueue->createCommandBuffer(_device, CmdbufType::Resetable);
@@ -92,6 +97,7 @@ namespace ugi {
             return false;
         }
 #endif
+        _asyncLoadManager->flushUploads(); // 这一帧创建的 mesh 等一次提交到传输队列
         std::vector<QueueSubmitInfo> submitInfos;
         for(queue_submit_t& submit: _submits) {
             submitInfos.emplace_back(
@@ -118,6 +124,30 @@ namespace ugi {
         return _swapchain->resize(_device, width, height);
     }
 
+    void StandardRenderContext::release() {
+        if(!_device) {
+            return;
+        }
+        _asyncLoadManager->flushUploads();
+        vkDeviceWaitIdle(_device->device());
+        // 最后一次 tick 异步加载，回调里录制的命令（纹理 layout 转换等）提交后再等一次
+        auto cb = _graphicsQueue->createCommandBuffer(_device, CmdbufType::Transient);
+        cb->beginEncode(); {
+            _asyncLoadManager->destroy(cb);
+            cb->endEncode();
+        }
+        QueueSubmitInfo submitInfo(&cb, 1, nullptr, 0, nullptr, 0);
+        QueueSubmitBatchInfo submitBatch(&submitInfo, 1, nullptr);
+        _graphicsQueue->submitCommandBuffers(submitBatch);
+        vkDeviceWaitIdle(_device->device());
+        _graphicsQueue->destroyCommandBuffer(_device, cb);
+        delete _asyncLoadManager;
+        _asyncLoadManager = nullptr;
+        GPURetireManager::Instance()->flush(); // 延迟销毁的资源和回池的对象这里全部落地
+        _device->savePipelineCache();
+        _device->release();
+    }
+
     CommandQueue* StandardRenderContext::primaryQueue() const {
         return _graphicsQueue;
     }
@@ -134,6 +164,10 @@ namespace ugi {
         return _uniformAllocator;
     }
 
+    UniformAllocator* StandardRenderContext::storageAllocator() const {
+        return _storageAllocator;
+    }
+
     Semaphore* StandardRenderContext::renderCompleteSemephore() const {
         return _renderCompleteSemaphores[_imageIndex];
     }
@@ -180,4 +214,8 @@ namespace ugi {
         return tex;
     }
 
+    Texture* StandardRenderContext::createTextureRGBA8(uint8_t const* pixels, uint32_t width, uint32_t height, AsyncLoadCallback&& asyncCallback) {
+        return CreateTextureRGBA8(_device, pixels, width, height, _asyncLoadManager, std::move(asyncCallback));
+    }
+
 }
\ No newline at end of file
@@ -31,6 +31,7 @@ namespace ugi {
         ugi::CommandQueue*              _graphicsQueue;
         ugi::CommandQueue*              _uploadQueue;
         ugi::UniformAllocator*          _uniformAllocator;
+        ugi::UniformAllocator*          _storageAllocator;                                 // 每帧的大块 storage 数据（UI 实例参数），单次分配可以到 maxStorageBufferRange
         ugi::DescriptorSetAllocator*    _descriptorSetAllocator;
         ugi::GPUAsyncLoadManager*       _asyncLoadManager;
         ugi::IRenderPass*               _mainRenderPass;
@@ -46,11 +47,13 @@ namespace ugi {
         bool onPreTick(); // sync gpu result
         bool onPostTick(); // present the swapchain
         bool onResize(uint32_t width, uint32_t height);
+        void release(); // wait device idle, flush persistent states(pipeline cache etc.)
         //
         CommandQueue* primaryQueue() const;
         CommandQueue* transferQueue() const;
         GPUAsyncLoadManager* asyncLoadManager() const;
         UniformAllocator* uniformAllocator() const;
+        UniformAllocator* storageAllocator() const;
         Semaphore* renderCompleteSemephore() const;
         Semaphore* mainFramebufferAvailSemaphore() const;
         Device* device() const;
@@ -61,6 +64,7 @@ namespace ugi {
 
         Texture* createTexture(tex_desc_t const& desc);
         Texture* createTexturePNG(uint8_t const* data, uint32_t length, AsyncLoadCallback&& asyncCallback);
+        Texture* createTextureRGBA8(uint8_t const* pixels, uint32_t width, uint32_t height, AsyncLoadCallback&& asyncCallback); // 像素已经在别处解码好
 
         void updateTexture(
             Texture* texture,
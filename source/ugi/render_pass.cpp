@@ -270,14 +270,14 @@ namespace ugi {
         _clearValues[_colorTextureCount].depthStencil.stencil = clearValues.stencil;
     }
 
-    void RenderPass::begin( RenderCommandEncoder* encoder ) const {
+    void RenderPass::begin( RenderCommandEncoder* encoder, VkSubpassContents contents ) const {
         for( uint32_t i = 0; i<_decription.colorAttachmentCount; ++i ) {
             ((ResourceCommandEncoder*)encoder)->imageTransitionBarrier(_colorTexture[i], _decription.colorAttachments[i].initialAccessType, pipeline_stage_t::Bottom, StageAccess::Read, pipeline_stage_t::ColorAttachmentOutput, StageAccess::Write );
         }
         if(_dsTexture) {
             ((ResourceCommandEncoder*)encoder)->imageTransitionBarrier(_dsTexture, _decription.depthStencil.initialAccessType, pipeline_stage_t::Bottom, StageAccess::Read, pipeline_stage_t::EaryFragmentTestShading, StageAccess::Write);
         }
-        vkCmdBeginRenderPass( *encoder->commandBuffer(), &_renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBeginRenderPass( *encoder->commandBuffer(), &_renderPassBeginInfo, contents);
     }
     
     void RenderPass::end( RenderCommandEncoder* encoder ) const {
@@ -49,7 +49,9 @@ namespace ugi {
         virtual uint32_t subpassColorAttachmentCount( uint32_t subpassIndex ) const = 0;
         virtual uint64_t subpassHash( uint32_t subpassIndex ) const = 0;
         virtual VkRenderPass renderPass() const = 0;
-        virtual void begin( RenderCommandEncoder* encoder ) const = 0;
+        virtual VkFramebuffer framebuffer() const = 0;
+        // contents 为 VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS 时，subpass 里只能 execute secondary command buffer
+        virtual void begin( RenderCommandEncoder* encoder, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE ) const = 0;
         virtual void end( RenderCommandEncoder* encoder ) const = 0;
         virtual void release(Device* device) = 0;
         virtual image_view_t colorView(uint32_t index) = 0;
@@ -95,6 +97,9 @@ namespace ugi {
         virtual VkRenderPass renderPass() const override {
             return _renderPass;
         }
+        virtual VkFramebuffer framebuffer() const override {
+            return _framebuffer;
+        }
         virtual image_view_t colorView( uint32_t index ) override {
             if(index<_colorTextureCount) {
                 return _colorViews[index];
@@ -108,7 +113,7 @@ namespace ugi {
             return nullptr;
         }
         virtual ~RenderPass() {};
-        virtual void begin( RenderCommandEncoder* encoder ) const override;
+        virtual void begin( RenderCommandEncoder* encoder, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE ) const override;
         virtual void end( RenderCommandEncoder* encoder ) const override;
         virtual void release( Device* device ) override;
         //
@@ -2,6 +2,7 @@
 #include "../descriptor_binder.h"
 #include "../material_layout.inl"
 #include "../device.h"
+#include "../descriptor_set_allocator.h"
 #include "../ugi_type_mapping.h"
 #include "hash_object_pool.h"
 
@@ -82,6 +83,7 @@ namespace ugi {
                 assert( rst == VK_SUCCESS );
                 if( VK_SUCCESS == rst ) {
                     groupLayout._descriptorSetLayouts[setID] = setLayout;
+                    device->descriptorSetAllocator()->registerLayout(setLayout, bindings, layoutInfo.bindingCount);
                 }
             }
             std::vector<VkPushConstantRange> ranges;
@@ -13,6 +13,7 @@
 #include <unordered_map>
 #include <vector>
 #include <cassert>
+#include <cstdio>
 
 namespace ugi {
 
@@ -199,6 +200,10 @@ namespace ugi {
     void Texture::updateRegions(Device* device, const image_region_t* regions, uint32_t count, uint8_t const* data, uint32_t size, uint64_t const* offsets, GPUAsyncLoadManager* asyncLoadManager, std::function<void(void*, CommandBuffer*)>&& callback) { 
         // dealing staging buffer
         Buffer* staging = device->createBuffer(BufferType::StagingBuffer, size);
+        if(!staging) {
+            printf("[texture] update regions failed, can not create staging buffer\n");
+            return;
+        }
         auto ptr = staging->map(device);
         memcpy(ptr, data, size);
         staging->unmap(device);
@@ -217,11 +222,6 @@ namespace ugi {
         }
         cb->endEncode();
         //
-        auto fence = device->createFence(); {
-            QueueSubmitInfo submitInfo(&cb, 1, nullptr, 0, nullptr, 0);
-            QueueSubmitBatchInfo submitBatch(&submitInfo, 1, fence);
-            queue->submitCommandBuffers(submitBatch);
-        }
         auto onComplete = [](Texture* tex, Device* device, Buffer* stgbuf, CommandBuffer* transferCmd, CommandQueue* queue, std::function<void(void*,CommandBuffer*)> callback, CommandBuffer* exeBuf)->void{
             queue->destroyCommandBuffer(device, transferCmd);
             device->destroyBuffer(stgbuf);
@@ -229,8 +229,12 @@ namespace ugi {
         };
         using namespace std::placeholders;
         auto binder = std::bind(onComplete, this, device, staging, cb, queue, callback, _1);
-        GPUAsyncLoadItem asyncLoadItem = GPUAsyncLoadItem(device, fence, std::move(binder));
-        asyncLoadManager->registerAsyncLoad(std::move(asyncLoadItem));
+        if(!asyncLoadManager->submitAsyncLoad(device, queue, cb, std::move(binder))) {
+            // 提交失败回调不会被调用，cb 和 staging buffer 在这里归还
+            printf("[texture] update regions failed, submit error\n");
+            queue->destroyCommandBuffer(device, cb);
+            device->destroyBuffer(staging);
+        }
     }
 
     void Texture::generateMipmap(CommandBuffer* cmdbuf) {
@@ -157,37 +157,59 @@ namespace ugi {
 		return texture;
     }
 
-    Texture* CreateTexturePNG(Device* device, uint8_t const* data, uint32_t dataLen, GPUAsyncLoadManager* asyncLoadMgr, AsyncLoadCallback&& callback) {
+    bool DecodePNG(uint8_t const* data, uint32_t dataLen, std::vector<uint8_t>& pixels, uint32_t& width, uint32_t& height) {
         int x; int y; int channels;
         auto pixel = stbi_load_from_memory( (stbi_uc*)data, dataLen,&x, &y, &channels, 4 );
+        if(!pixel) {
+            return false;
+        }
+        width = (uint32_t)x;
+        height = (uint32_t)y;
+        pixels.assign(pixel, pixel + (size_t)x * y * 4);
+        stbi_image_free(pixel); // cleanup!!!
+        return true;
+    }
+
+    Texture* CreateTextureRGBA8(Device* device, uint8_t const* pixels, uint32_t width, uint32_t height, GPUAsyncLoadManager* asyncLoadMgr, AsyncLoadCallback&& callback) {
         tex_desc_t textureDescription;
 		//
 		uint32_t mipmapLevel = 1; {
-			int mipmapRefSize = x > y ? x : y;
-			while(mipmapRefSize!=1) {
+			uint32_t mipmapRefSize = width > height ? width : height;
+			while(mipmapRefSize > 1) {
 				++mipmapLevel;
 				mipmapRefSize = mipmapRefSize >> 1;
 			}
 		}
         textureDescription.format = ugi::UGIFormat::RGBA8888_UNORM;
-        textureDescription.width = x;
-        textureDescription.height = y;
+        textureDescription.width = width;
+        textureDescription.height = height;
         textureDescription.depth = 1;
         textureDescription.mipmapLevel = mipmapLevel;
         textureDescription.layerCount = 1;
         textureDescription.type = TextureType::Texture2D;
         auto texture = device->createTexture(textureDescription);
+        if(!texture) {
+            return nullptr;
+        }
 		//
 		image_region_t region;
 		region.arrayIndex = 0;
 		region.arrayCount = 1;
-		region.extent = { (uint32_t)x, (uint32_t)y, (uint32_t)1 };
+		region.extent = { width, height, (uint32_t)1 };
 		region.mipLevel = 0;
 		region.offset = {};
 		uint64_t offset = 0;
-		texture->updateRegions(device, &region, 1, pixel, x*y*4, &offset, asyncLoadMgr, std::move(callback));
-		stbi_image_free(pixel); // cleanup!!!
+		texture->updateRegions(device, &region, 1, pixels, width * height * 4, &offset, asyncLoadMgr, std::move(callback));
 		return texture;
+    }
+
+    Texture* CreateTexturePNG(Device* device, uint8_t const* data, uint32_t dataLen, GPUAsyncLoadManager* asyncLoadMgr, AsyncLoadCallback&& callback) {
+        std::vector<uint8_t> pixels;
+        uint32_t width, height;
+        if(!DecodePNG(data, dataLen, pixels, width, height)) {
+            return nullptr;
+        }
+        return CreateTextureRGBA8(device, pixels.data(), width, height, asyncLoadMgr, std::move(callback));
 	}
 
 }
\ No newline at end of file
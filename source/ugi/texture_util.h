@@ -2,6 +2,7 @@
 
 #include <ugi/ugi_declare.h>
 #include <cstdint>
+#include <vector>
 
 namespace ugi {
     
@@ -34,6 +35,17 @@ namespace ugi {
 
     Texture* CreateTexturePNG(Device* device, uint8_t const* data, uint32_t dataLen, GPUAsyncLoadManager* asyncLoadMgr, AsyncLoadCallback&& callback);
 
+    /**
+     * @brief PNG 解码成 RGBA8，不碰 device，可以在工作线程调用
+     *  配合 CreateTextureRGBA8 把解码和上传拆开
+     */
+    bool DecodePNG(uint8_t const* data, uint32_t dataLen, std::vector<uint8_t>& pixels, uint32_t& width, uint32_t& height);
+
+    /**
+     * @brief 用解码好的 RGBA8 像素创建带完整 mip 链的纹理并提交上传，只能在主线程调用
+     */
+    Texture* CreateTextureRGBA8(Device* device, uint8_t const* pixels, uint32_t width, uint32_t height, GPUAsyncLoadManager* asyncLoadMgr, AsyncLoadCallback&& callback);
+
     void GenerateMipmap(Device* deivce, Texture* texture);
 
 }
\ No newline at end of file
@@ -21,12 +21,15 @@ namespace ugi {
     class GraphicsPipeline;
     class DescriptorBinder;
     class DescriptorSetAllocator;
+    class PipelineCache;
+    class WorkerPool;
     // class Drawable;
     class UniformAllocator;
     class ResourceManager;
     class MaterialLayout;
     class ComputePipeline;
     class GPUAsyncLoadManager;
+    class StagingUploadRing;
     class Material;
     class Mesh;
     class MeshBufferAllocator;
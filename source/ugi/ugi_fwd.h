@@ -14,6 +14,7 @@ namespace ugi {
     class Fence;
     class FlightCycleInvoker;
     class GPUAsyncLoadManager;
+    class StagingUploadRing;
     class GPUAsyncLoadItem;
     class GraphicsPipeline;
     class IRenderPass;
@@ -22,6 +23,7 @@ namespace ugi {
     class MaterialLayout;
     class Mesh;
     class MeshBufferAllocator;
+    class PipelineCache;
     class PipelineHelper;
     class Renderable;
     class RenderCommandEncoder;
@@ -37,4 +39,5 @@ namespace ugi {
     class TextureUpdateTask;
     class UniformAllocator;
     class WorkThread;
+    class WorkerPool;
 }
@@ -529,6 +529,9 @@ namespace ugi {
         case res_descriptor_type::StorageBuffer :
             vkType = VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
             break;
+        case res_descriptor_type::DynamicStorageBuffer :
+            vkType = VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+            break;
         case res_descriptor_type::StorageImage:
             vkType = VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
             break;
@@ -435,6 +435,13 @@ namespace ugi {
         Fill = 2,
     };
 
+    // 某个 raster state 变体第一次出现时 pipeline 的创建方式
+    enum class pipeline_compile_mode_t : uint8_t {
+        Synchronous = 0,        // 在 bind 里同步创建（默认）
+        AsyncSkipDraw = 1,      // 后台编译，编译完成之前 bind 返回 false，调用方跳过 draw
+        AsyncFallback = 2,      // 后台编译，编译完成之前使用同一 subpass 下已有的 pipeline 顶替
+    };
+
     struct raster_state_t {
         uint8_t depthBiasEnabled = 0;
         float depthBiasConstantFactor = 0.0f;
@@ -523,6 +530,7 @@ namespace ugi {
         UniformBuffer = 4,
         UniformTexelBuffer = 5,
         InputAttachment = 6,
+        DynamicStorageBuffer = 7,   // 按 dynamic offset 绑定的 storage buffer，pipeline.json 里逐个 binding 指定
     };
 
     struct res_descriptor_info_t {
@@ -2,22 +2,36 @@
 // #include "buffer.h"
 #include "device.h"
 #include <cassert>
+#include <algorithm>
+#include <cstring>
 
 namespace ugi {
 
     // constexpr uint32_t UniformAlignBytes = 256;
-    constexpr uint32_t InitialBlockSize = 0x10000;
+    constexpr uint32_t InitialBlockSize = UniformAllocator::MaxAllocationSize;
+
+    // 同一块内存也会按 storage buffer 绑定，offset 要同时满足两种对齐
+    static uint32_t dynamicOffsetAlignMask(Device* device) {
+        auto const& limits = device->descriptor().properties.limits;
+        uint32_t align = (uint32_t)std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment);
+        return align >= 8 ? align - 1 : 7;
+    }
     //
-    UniformAllocator::UniformAllocator( Device* device ) 
+    UniformAllocator::UniformAllocator( Device* device, uint32_t maxAllocationSize ) 
         : _device(device)
-        , _alignSize(device->descriptor().properties.limits.minUniformBufferOffsetAlignment >= 8 ? device->descriptor().properties.limits.minUniformBufferOffsetAlignment - 1 : 7 )
-        , _maxCapacity(InitialBlockSize)
-        , _overflow(false)
-        , _buffer{}
-        , _ring(InitialBlockSize, _alignSize)
-        , _freeTable{}
+        , _alignSize(dynamicOffsetAlignMask(device))
+        , _maxAllocationSize(maxAllocationSize)
+        , _blockCapacity(InitialBlockSize)
+        , _current(nullptr)
+        , _flightBlocks{}
+        , _chainMutex()
         , _flight(0)
+        , _frame(0)
+        , _usageHistory{}
+        , _lastFrameBytes(0)
+        , _overflowBlocks(0)
     {
+        assert(((_alignSize + 1) & _alignSize) == 0 && ChunkSize % (_alignSize + 1) == 0);
     }
 
     UniformAllocator::buf_t UniformAllocator::createUniformBlock(uint32_t size) {
@@ -35,7 +49,7 @@ namespace ugi {
                 bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
             }
             bufferInfo.size = size;
-            bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT;
+            bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
         }
         VmaAllocationCreateInfo allocationCreateInfo = {}; {
             allocationCreateInfo.usage = VmaMemoryUsage::VMA_MEMORY_USAGE_CPU_ONLY;
@@ -52,56 +66,134 @@ namespace ugi {
         return buf;
     }
 
+    UniformAllocator::block_t* UniformAllocator::_createBlock(uint32_t size) {
+        block_t* block = new block_t();
+        block->buffer = createUniformBlock(size);
+        block->cursor.store(0, std::memory_order_relaxed);
+        return block;
+    }
+
+    void UniformAllocator::_destroyBlock(block_t* block) {
+        VmaAllocator vma = _device->vmaAllocator();
+        vmaUnmapMemory(vma, block->buffer.vmaAlloc);
+        vmaDestroyBuffer(vma, block->buffer.buf, block->buffer.vmaAlloc);
+        delete block;
+    }
+
     void UniformAllocator::tick() 
     {
-        auto prevFlight = _flight;
+        // 统计这一帧的用量
+        uint32_t used = 0;
+        for(auto block: _flightBlocks[_flight]) {
+            used += std::min(block->cursor.load(std::memory_order_relaxed), block->buffer.size);
+        }
+        _lastFrameBytes = used;
+        _usageHistory[_frame % HistoryFrameCount] = used;
+        ++_frame;
         ++_flight;
         _flight = _flight % MaxFlightCount;
-        if(_overflow) {
-            _maxCapacity = _maxCapacity * 1.2;
-            _maxCapacity = (_maxCapacity + _alignSize)&~(_alignSize);
-            _freeTable[prevFlight].push_back(_buffer); // 回收上帧buffer
-            _buffer = createUniformBlock(_maxCapacity);
-            _ring.reset(_maxCapacity);
-            _overflow = false;
+        // 按最近几帧的峰值留 25% 余量，变大立即生效，变小要小到一半以下才缩，避免来回重建
+        uint32_t highWater = *std::max_element(_usageHistory.begin(), _usageHistory.end());
+        uint32_t target = std::max<uint32_t>(InitialBlockSize, highWater + highWater / 4);
+        target = (target + ChunkSize - 1) & ~(ChunkSize - 1);
+        if(target > _blockCapacity || target * 2 < _blockCapacity) {
+            _blockCapacity = target;
         }
-        _ring.prepareNextFlight();
-        VmaAllocator vma = _device->vmaAllocator();
-        for(auto& buf: _freeTable[_flight]) {
-            vmaDestroyBuffer(vma, buf.buf, buf.vmaAlloc);
+        // 这个 flight 的 block GPU 已经用完了，大小合适就直接复用，否则合成一个新的
+        auto& blocks = _flightBlocks[_flight];
+        if(blocks.size() == 1 && blocks[0]->buffer.size == _blockCapacity) {
+            blocks[0]->cursor.store(0, std::memory_order_relaxed);
+        } else {
+            for(auto block: blocks) {
+                _destroyBlock(block);
+            }
+            blocks.clear();
+            blocks.push_back(_createBlock(_blockCapacity));
+        }
+        _current.store(blocks[0], std::memory_order_release);
+    }
+
+    uint32_t UniformAllocator::_reserve(uint32_t size, block_t*& block) {
+        while(true) {
+            block = _current.load(std::memory_order_acquire);
+            uint32_t offset = block->cursor.fetch_add(size, std::memory_order_relaxed);
+            if(offset + size <= block->buffer.size) {
+                return offset;
+            }
+            // 溢出了，立即串一个新 block，只有第一个发现溢出的线程去创建
+            std::lock_guard<std::mutex> lock(_chainMutex);
+            if(_current.load(std::memory_order_relaxed) == block) {
+                block_t* next = _createBlock(std::max(_blockCapacity, (size + ChunkSize - 1) & ~(ChunkSize - 1)));
+                _flightBlocks[_flight].push_back(next);
+                _current.store(next, std::memory_order_release);
+                _overflowBlocks.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    UniformAllocator::thread_chunk_t& UniformAllocator::_threadChunk() {
+        // 一个线程一般只用一两个 allocator，缓存几个槽位就够了
+        static thread_local std::array<thread_chunk_t, 4> chunks = {};
+        static thread_local uint32_t replaceIndex = 0;
+        for(auto& chunk: chunks) {
+            if(chunk.owner == this) {
+                return chunk;
+            }
         }
+        auto& chunk = chunks[replaceIndex++ % chunks.size()];
+        chunk.owner = this;
+        chunk.frame = ~0ull;
+        chunk.block = nullptr;
+        chunk.cursor = chunk.end = 0;
+        return chunk;
     }
 
     uniform_t UniformAllocator::allocate(uint32_t size) {
-        assert(size <= InitialBlockSize);
+        assert(size <= _maxAllocationSize);
         uniform_t rst {};
-        auto offset = _ring.alloc(size);
-        if(offset == _ring.InvalidAlloc) { // 超出最大值了
-            _freeTable[_flight].push_back(_buffer); // to free table, will be freed next cycle
-            _buffer = createUniformBlock(InitialBlockSize);
-            _maxCapacity += InitialBlockSize;
-            _ring.reset(InitialBlockSize);
-            _overflow = true;
-            offset = _ring.alloc(size);
+        uint32_t alignedSize = (size + _alignSize)&~(_alignSize);
+        block_t* block = nullptr;
+        uint32_t offset = 0;
+        if(alignedSize > ChunkSize / 2) { // 大的直接从 block 上切，不占线程 chunk
+            offset = _reserve(alignedSize, block);
+        } else {
+            auto& chunk = _threadChunk();
+            if(chunk.frame != _frame || chunk.cursor + alignedSize > chunk.end) {
+                chunk.frame = _frame;
+                chunk.cursor = _reserve(ChunkSize, chunk.block);
+                chunk.end = chunk.cursor + ChunkSize;
+            }
+            block = chunk.block;
+            offset = chunk.cursor;
+            chunk.cursor += alignedSize;
         }
-        assert(offset != _ring.InvalidAlloc);
-        rst.buffer = (size_t)_buffer.buf;
+        rst.buffer = (size_t)block->buffer.buf;
         rst.offset = offset;
-        rst.ptr = _buffer.ptr + offset;
+        rst.ptr = block->buffer.ptr + offset;
         rst.size = size;
         return rst;
     }
 
-    UniformAllocator* UniformAllocator::createUniformAllocator(Device* device) {
-        UniformAllocator* allocator = new UniformAllocator(device);
-        ///> 我们需要注意的是 ringbuffer 必须是 2 的n次方且是 uniform buffer 最小对齐大小的倍数
-        allocator->_buffer = allocator->createUniformBlock(InitialBlockSize);
-        allocator->_ring.reset(InitialBlockSize);
+    uniform_allocator_stat_t UniformAllocator::stat() const {
+        uniform_allocator_stat_t rst; {
+            rst.blockCapacity = _blockCapacity;
+            rst.lastFrameBytes = _lastFrameBytes;
+            rst.highWaterBytes = *std::max_element(_usageHistory.begin(), _usageHistory.end());
+            rst.overflowBlocks = _overflowBlocks.load(std::memory_order_relaxed);
+        }
+        return rst;
+    }
+
+    UniformAllocator* UniformAllocator::createUniformAllocator(Device* device, uint32_t maxAllocationSize) {
+        UniformAllocator* allocator = new UniformAllocator(device, maxAllocationSize);
+        block_t* block = allocator->_createBlock(InitialBlockSize);
+        allocator->_flightBlocks[0].push_back(block);
+        allocator->_current.store(block, std::memory_order_release);
         return allocator;
     }
 
     void UniformAllocator::allocateForDescriptor(res_descriptor_t& descriptor, void* ptr) {
-        assert( descriptor.type == res_descriptor_type::UniformBuffer );
+        assert( descriptor.type == res_descriptor_type::UniformBuffer || descriptor.type == res_descriptor_type::DynamicStorageBuffer );
         auto ubo = allocate(descriptor.res.buffer.size);
         memcpy(ubo.ptr, ptr, descriptor.res.buffer.size);
         descriptor.res.buffer.buffer = ubo.buffer;
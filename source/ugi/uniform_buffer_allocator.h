@@ -8,8 +8,9 @@
 #include <cstdint>
 #include <cassert>
 #include <functional>
+#include <atomic>
+#include <mutex>
 
-#include <LightWeightCommon/memory/flight_ring.h>
 #include <vk_mem_alloc.h>
 
 namespace ugi {
@@ -33,13 +34,38 @@ namespace ugi {
         uint8_t*    ptr;
     };
 
+    struct uniform_allocator_stat_t {
+        uint32_t    blockCapacity;      ///> 当前每帧首个 block 的大小
+        uint32_t    lastFrameBytes;     ///> 上一帧实际用掉的字节数
+        uint32_t    highWaterBytes;     ///> 最近 HistoryFrameCount 帧的峰值
+        uint32_t    overflowBlocks;     ///> 累计因为溢出而临时串上的 block 数
+    };
+
+    /*
+     *  多线程版本：
+     *  1. 每个 flight 有一串 block，正常情况下只有一个，溢出时立即串上一个新 block，不用等到下一次 tick
+     *  2. 录制线程每次用原子加法从当前 block 上切一大块（chunk），然后在线程自己的 chunk 里分配，互不竞争
+     *  3. tick 时按最近几帧的峰值调整 block 大小，把多个 block 合成一个，尽量减少 buffer 对象的切换
+     *  4. block 同时带 storage buffer usage，分配出来的也可以当 DynamicStorageBuffer 绑定
+     *  5. 单次 allocate 的上限创建时指定，默认 MaxAllocationSize；专门放 storage 数据的 allocator（UI 实例参数）可以给到 maxStorageBufferRange，
+     *     超过 block 的分配会立即串一个够大的 block，tick 时再按峰值合并，所以 block 会跟着用量长
+     *  tick 和 allocate 不能并发（tick 在渲染线程帧开始时调用，此时没有线程在录制）
+     * */
     class UniformAllocator 
     {
     public:
-        UniformAllocator(Device* device);
+        static constexpr uint32_t ChunkSize = 0x1000;
+        static constexpr uint32_t HistoryFrameCount = 16;
+        static constexpr uint32_t MaxAllocationSize = 0x10000;   ///> 默认的单次 allocate 上限（也是初始 block 的大小）
+    public:
+        UniformAllocator(Device* device, uint32_t maxAllocationSize = MaxAllocationSize);
         void tick();
         uniform_t allocate(uint32_t size);
         void allocateForDescriptor(res_descriptor_t& descriptor, void* ptr);
+        uniform_allocator_stat_t stat() const;
+        uint32_t maxAllocationSize() const {
+            return _maxAllocationSize;
+        }
     private:
         struct buf_t {
             VkBuffer buf;
@@ -47,17 +73,38 @@ namespace ugi {
             uint8_t* ptr;
             VmaAllocation vmaAlloc;
         };
+        struct block_t {
+            buf_t                   buffer;
+            std::atomic<uint32_t>   cursor;
+        };
+        struct thread_chunk_t {     ///> 线程自己的 chunk，只在同一帧、同一个 allocator 下有效
+            UniformAllocator const* owner;
+            uint64_t                frame;
+            block_t*                block;
+            uint32_t                cursor;
+            uint32_t                end;
+        };
         Device*                                             _device;
         uint32_t                                            _alignSize;
-        uint32_t                                            _maxCapacity;
-        bool                                                _overflow;
-        buf_t                                               _buffer;
-        comm::FlightRing<MaxFlightCount>                    _ring;
-        std::array<std::vector<buf_t>, MaxFlightCount>      _freeTable;
+        uint32_t                                            _maxAllocationSize;
+        uint32_t                                            _blockCapacity;
+        std::atomic<block_t*>                               _current;
+        std::array<std::vector<block_t*>, MaxFlightCount>   _flightBlocks;
+        std::mutex                                          _chainMutex;
         uint32_t                                            _flight;
+        uint64_t                                            _frame;
+        //
+        std::array<uint32_t, HistoryFrameCount>             _usageHistory;
+        uint32_t                                            _lastFrameBytes;
+        std::atomic<uint32_t>                               _overflowBlocks;
+    private:
         buf_t createUniformBlock(uint32_t size);
+        block_t* _createBlock(uint32_t size);
+        void _destroyBlock(block_t* block);
+        uint32_t _reserve(uint32_t size, block_t*& block);  ///> 从当前 block 上原子地切出 size 字节，不够就串新 block
+        thread_chunk_t& _threadChunk();
     public:
-        static UniformAllocator* createUniformAllocator( Device* device );
+        static UniformAllocator* createUniformAllocator( Device* device, uint32_t maxAllocationSize = MaxAllocationSize );
     };
 
 
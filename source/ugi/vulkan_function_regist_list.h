@@ -167,6 +167,13 @@ REGIST_VULKAN_FUNCTION(vkGetPhysicalDeviceExternalFenceProperties)
 REGIST_VULKAN_FUNCTION(vkGetPhysicalDeviceExternalSemaphoreProperties)
 REGIST_VULKAN_FUNCTION(vkGetDescriptorSetLayoutSupport)
 
+// ---------------------- Vulka 1.2 API ----------------------
+// timeline semaphore, 老的 loader 上为空
+
+REGIST_VULKAN_FUNCTION(vkGetSemaphoreCounterValue)
+REGIST_VULKAN_FUNCTION(vkWaitSemaphores)
+REGIST_VULKAN_FUNCTION(vkSignalSemaphore)
+
 // ---------------------- Vulka API KHR ----------------------
 
 REGIST_VULKAN_FUNCTION(vkDestroySurfaceKHR)